@@ -0,0 +1,62 @@
+// Estágio de boot da atualização A/B
+//
+// Fica no início da flash, fora dos slots (lib/flash_mapa.h): é o programa que o boot2 executa.
+// Se os metadados registram uma troca de A e B, ele a executa com ota_retomar() (lib/ota.c),
+// continuando de onde uma queda de energia a interrompeu, e só então salta para o firmware do
+// slot A. Compilado como copy_to_ram: roda da RAM enquanto apaga e grava a flash.
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"              // save_and_disable_interrupts
+#include "hardware/structs/scb.h"       // VTOR
+#include "hardware/structs/watchdog.h"
+#include "lib/flash_mapa.h"
+#include "lib/ota.h"
+
+#define ESTAGIO_VETORES 0x100           // a tabela de vetores da imagem vem logo após o boot2 dela
+
+// sem XIP em uso (o código está na RAM) e sem o outro núcleo: as operações vão direto à flash
+static bool estagio_apagar(uint32_t deslocamento) {
+    flash_range_erase(deslocamento, FLASH_SETOR);
+    return true;
+}
+
+static bool estagio_gravar(uint32_t deslocamento, const uint8_t *dados, size_t tamanho) {
+    flash_range_program(deslocamento, dados, tamanho);
+    return true;
+}
+
+static const uint8_t *estagio_mapa(uint32_t deslocamento) {
+    return (const uint8_t *)(uintptr_t)(XIP_BASE + deslocamento);
+}
+
+static void estagio_reiniciar(void) {
+    watchdog_hw->ctrl = WATCHDOG_CTRL_TRIGGER_BITS;
+    while (true) {
+    }
+}
+
+// salta para o firmware do slot A como o boot2 faria: VTOR, pilha e reset da tabela de vetores dele
+static void __attribute__((noreturn)) estagio_saltar(void) {
+    const uint32_t *vetores = (const uint32_t *)(uintptr_t)(XIP_BASE + FLASH_SLOT_A + ESTAGIO_VETORES);
+    irq_set_mask_enabled(0xFFFFFFFFu, false); // nenhuma interrupção do estágio segue habilitada
+    scb_hw->vtor = (uintptr_t)vetores;
+    __asm volatile("msr msp, %0\n"
+                   "bx %1\n" : : "r"(vetores[0]), "r"(vetores[1]) : "memory");
+    __builtin_unreachable();
+}
+
+int main(void) {
+    hw_clear_bits(&watchdog_hw->ctrl, WATCHDOG_CTRL_ENABLE_BITS); // a troca leva mais que o watchdog da imagem em teste
+    static const OtaFlash flash = {
+        .slot_a = FLASH_SLOT_A, .slot_b = FLASH_SLOT_B, .tamanho_slot = FLASH_OTA_SLOT,
+        .meta = FLASH_OTA_META, .rascunho = FLASH_OTA_RASCUNHO, .tamanho_setor = FLASH_SETOR, .tamanho_pagina = FLASH_PAGINA,
+        .mapa = estagio_mapa, .apagar = estagio_apagar, .gravar = estagio_gravar, .reiniciar = estagio_reiniciar,
+    };
+    uint32_t interrupcoes = save_and_disable_interrupts();
+    bool pronto = ota_retomar(&flash);
+    restore_interrupts(interrupcoes);
+    if (!pronto) estagio_reiniciar();   // A está pela metade: tenta de novo a partir do último registro
+    estagio_saltar();
+}
@@ -0,0 +1,64 @@
+// Amostragem contínua do ADC via DMA
+
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "adc_amostragem.h"
+
+#define ADC_MASCARA_ROUND_ROBIN 0x17    // canais 0, 1, 2 e 4
+#define ADC_BITS_ANEL 9                 // 2^9 bytes = ADC_AMOSTRAS amostras de 16 bits
+
+#if (ADC_AMOSTRAS * 2) != (1 << ADC_BITS_ANEL)
+#error "ADC_AMOSTRAS deve ocupar exatamente 2^ADC_BITS_ANEL bytes"
+#endif
+
+// anel alinhado ao próprio tamanho (exigência do modo ring do DMA)
+static uint16_t amostras[ADC_AMOSTRAS] __attribute__((aligned(ADC_AMOSTRAS * sizeof(uint16_t))));
+static int dma_canal = -1;              // canal DMA reservado
+static const int8_t posicao_canal[5] = { 0, 1, 2, -1, 3 }; // posição de cada canal no ciclo do round-robin
+
+// (re)inicia conversão e DMA alinhados: a amostra i do anel pertence ao canal da posição i % 4
+static void adc_amostragem_iniciar(void) {
+    adc_run(false);
+    adc_fifo_drain();
+    adc_select_input(0);                // o round-robin começa no canal 0
+    dma_channel_config c = dma_channel_get_default_config(dma_canal);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false); // sempre lê a FIFO do ADC
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, ADC_BITS_ANEL); // escrita circular no anel
+    channel_config_set_dreq(&c, DREQ_ADC);
+    dma_channel_configure(dma_canal, &c, amostras, &adc_hw->fifo, 0xFFFFFFFFu, true); // ~12 dias a 4 kHz
+    adc_run(true);
+}
+
+void adc_amostragem_init(void) {
+    adc_init();
+    adc_set_temp_sensor_enabled(true);  // ativa sensor de temperatura interno do RP2040
+    adc_gpio_init(26);                  // ADC0
+    adc_gpio_init(27);                  // ADC1
+    adc_gpio_init(28);                  // ADC2
+    adc_set_round_robin(ADC_MASCARA_ROUND_ROBIN);
+    adc_fifo_setup(true, true, 1, false, false); // FIFO com DREQ a cada amostra, 12 bits
+    adc_set_clkdiv(48000000.0f / ADC_TAXA_HZ - 1.0f); // clock do ADC: 48 MHz
+    dma_canal = dma_claim_unused_channel(true);
+    adc_amostragem_iniciar();
+}
+
+void adc_amostragem_manter(void) {
+    if (!dma_channel_is_busy(dma_canal)) adc_amostragem_iniciar(); // contagem esgotada: recomeça alinhado
+}
+
+float adc_amostragem_media(uint8_t canal, uint8_t n) {
+    if (canal > 4 || posicao_canal[canal] < 0 || n == 0) return 0.0f;
+    if (n > ADC_AMOSTRAS / ADC_CANAIS_ATIVOS) n = ADC_AMOSTRAS / ADC_CANAIS_ATIVOS;
+    uint32_t escrita = (dma_channel_hw_addr(dma_canal)->write_addr - (uintptr_t)amostras) / sizeof(uint16_t);
+    // amostra mais recente do canal: maior índice antes da escrita com índice % 4 == posição
+    uint32_t i = (escrita - 1 - ((escrita - 1 - posicao_canal[canal]) & (ADC_CANAIS_ATIVOS - 1))) & (ADC_AMOSTRAS - 1);
+    uint32_t soma = 0;
+    for (uint8_t k = 0; k < n; k++) {
+        soma += amostras[i];
+        i = (i - ADC_CANAIS_ATIVOS) & (ADC_AMOSTRAS - 1);
+    }
+    return (float)soma / n;
+}
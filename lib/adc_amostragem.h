@@ -0,0 +1,19 @@
+// Amostragem contínua do ADC
+// O ADC converte em round-robin os canais 0, 1, 2 e 4 (sensor interno) e o DMA grava as
+// amostras num anel em RAM, sem uso da CPU. Os leitores calculam médias das últimas amostras.
+
+#ifndef ADC_AMOSTRAGEM_H
+#define ADC_AMOSTRAGEM_H
+
+#include <stdint.h>
+
+#define ADC_CANAL_TEMPERATURA 4         // sensor de temperatura interno do RP2040
+#define ADC_CANAIS_ATIVOS     4         // canais no round-robin: 0, 1, 2 e 4
+#define ADC_TAXA_HZ           4000      // conversões por segundo (somando os canais)
+#define ADC_AMOSTRAS          256       // tamanho do anel (potência de 2, múltiplo de ADC_CANAIS_ATIVOS)
+
+void adc_amostragem_init(void);                     // configura ADC, DMA e inicia a conversão contínua
+void adc_amostragem_manter(void);                   // reinicia o DMA se a contagem de transferências acabou
+float adc_amostragem_media(uint8_t canal, uint8_t n); // média das últimas n amostras do canal (0-4095)
+
+#endif
@@ -0,0 +1,80 @@
+// Caminho rápido do alarme de temperatura
+
+#include "alarme.h"
+
+static int8_t confirmado = -1;          // valor confirmado pelo broker nesta conexão (-1: nenhum)
+static int8_t em_voo = -1;              // valor publicado aguardando PUBACK (-1: nenhum)
+static uint64_t deteccao_us;            // detecção ainda sem PUBACK (0: nenhuma)
+static bool envio_medido;               // latência de envio da detecção atual já registrada
+static AlarmeEstatisticas estatisticas;
+
+void alarme_iniciar(float valor) {
+    estatisticas.filtrada = valor;
+}
+
+float alarme_filtrar(float valor, uint32_t decorrido_ms) {
+    // mesma constante de tempo com qualquer período: peso 1 - (1 - FILTRO)^passos
+    uint32_t passos = decorrido_ms / ALARME_PERIODO_MS;
+    if (passos < 1) passos = 1;
+    if (passos > 16) passos = 16;       // além disso o peso da leitura antiga já é desprezível
+    float resto = 1.0f;
+    while (passos--) resto *= 1.0f - ALARME_FILTRO;
+    estatisticas.filtrada += (1.0f - resto) * (valor - estatisticas.filtrada);
+    return estatisticas.filtrada;
+}
+
+uint32_t alarme_periodo(float margem) {
+    return margem < ALARME_MARGEM ? ALARME_PERIODO_MS : ALARME_PERIODO_REPOUSO_MS;
+}
+
+void alarme_detectado(uint64_t agora_us) {
+    estatisticas.deteccoes++;
+    deteccao_us = agora_us ? agora_us : 1;
+    envio_medido = false;
+}
+
+bool alarme_pendente(bool emergencia) {
+    return em_voo < 0 && confirmado != (int8_t)emergencia;
+}
+
+static void registrar(uint32_t *ultima, uint32_t *maxima, uint64_t agora_us) {
+    *ultima = (uint32_t)(agora_us - deteccao_us);
+    if (*ultima > *maxima) *maxima = *ultima;
+}
+
+void alarme_enviado(bool emergencia, uint64_t agora_us) {
+    em_voo = (int8_t)emergencia;
+    estatisticas.envios++;
+    if (deteccao_us && emergencia && !envio_medido) { // só o primeiro envio após a detecção
+        registrar(&estatisticas.envio_us, &estatisticas.envio_max_us, agora_us);
+        envio_medido = true;
+    }
+}
+
+void alarme_resultado(bool ok, uint64_t agora_us) {
+    if (em_voo < 0) return;
+    if (ok) {
+        confirmado = em_voo;
+        if (deteccao_us && em_voo) {
+            registrar(&estatisticas.confirmacao_us, &estatisticas.confirmacao_max_us, agora_us);
+            deteccao_us = 0;
+        }
+    } else {
+        estatisticas.reenvios++;        // o próximo alarme_pendente reenvia o valor do momento
+    }
+    em_voo = -1;
+}
+
+void alarme_conexao(void) {
+    if (em_voo >= 0) estatisticas.reenvios++; // o lwIP descarta os pedidos em voo ao fechar a conexão
+    em_voo = -1;
+    confirmado = -1;
+}
+
+void alarme_republicar(void) {
+    confirmado = -1;
+}
+
+const AlarmeEstatisticas *alarme_estatisticas(void) {
+    return &estatisticas;
+}
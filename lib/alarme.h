@@ -0,0 +1,45 @@
+// Caminho rápido do alarme de temperatura
+// O sensor interno é lido do anel do ADC sem esperar o período de 1 s do registro de sensores e passa
+// por um filtro exponencial antes das regras de temperatura: a emergência sobe poucos ms depois que o
+// valor filtrado cruza o limite. A leitura é a cada ALARME_PERIODO_MS só perto de um limite (dentro de
+// ALARME_MARGEM); longe dele, a cada ALARME_PERIODO_REPOUSO_MS, junto com a leitura do joystick em
+// repouso, para o núcleo não acordar a 100 Hz o tempo todo. Um degrau grande é pego já na leitura
+// seguinte (o filtro pesa o tempo decorrido), então o repouso atrasa a detecção em até ~40 ms. O estado da emergência
+// sai na classe de maior prioridade da saída MQTT (lib/fila_mqtt.h) e é reenviado até o PUBACK.
+// Código C puro (sem SDK).
+
+#ifndef ALARME_H
+#define ALARME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ALARME_PERIODO_MS 10            // leitura do caminho rápido perto de um limite
+#define ALARME_PERIODO_REPOUSO_MS 50    // leitura longe dos limites (= JOYSTICK_PERIODO_MS: uma só acordada)
+#define ALARME_MARGEM     3.0f          // °C do próximo limite ou rearme que passam ao período rápido
+#define ALARME_MEDIA      16            // amostras do anel por leitura (16 ms a 1 kHz)
+#define ALARME_FILTRO     0.25f         // peso da leitura nova a cada ALARME_PERIODO_MS (constante de tempo ~35 ms)
+
+typedef struct {
+    float filtrada;                     // última temperatura filtrada (°C)
+    uint32_t deteccoes;                 // emergências levantadas pelas regras do caminho rápido
+    uint32_t envios;                    // estado/emergencia aceito pelo cliente MQTT
+    uint32_t reenvios;                  // envios repetidos: PUBACK expirado ou conexão perdida com o pedido em voo
+    uint32_t envio_us, envio_max_us;    // detecção -> publicação aceita pelo cliente MQTT
+    uint32_t confirmacao_us, confirmacao_max_us; // detecção -> PUBACK do broker
+} AlarmeEstatisticas;
+
+void alarme_iniciar(float valor);       // filtro começa no valor atual (sem transitório no boot)
+float alarme_filtrar(float valor, uint32_t decorrido_ms); // nova leitura -> valor filtrado
+uint32_t alarme_periodo(float margem);  // próxima leitura, pela distância ao limite mais próximo
+void alarme_detectado(uint64_t agora_us); // emergência levantada: mede até o envio e o PUBACK
+
+// estado/emergencia: publicado até o broker confirmar o valor atual
+bool alarme_pendente(bool emergencia);  // valor ainda não confirmado e nenhum envio em voo
+void alarme_enviado(bool emergencia, uint64_t agora_us); // publicação aceita pelo cliente MQTT
+void alarme_resultado(bool confirmado, uint64_t agora_us); // PUBACK (true) ou expiração (reenvia)
+void alarme_conexao(void);              // conexão nova: nada confirmado, o envio em voo se perdeu
+void alarme_republicar(void);           // republicação periódica dos estados retidos
+const AlarmeEstatisticas *alarme_estatisticas(void);
+
+#endif
@@ -0,0 +1,138 @@
+// Cenas: várias mudanças do painel aplicadas de uma vez
+
+#include <stdlib.h>
+#include <string.h>
+#include "cenas.h"
+#include "kv_flash.h"
+#include "painel.h"
+
+// chaves no armazenamento (ver lib/config_painel.c): campos (4 bytes, 0xFF = mantém) seguidos do nome
+#define KV_CENA(i)     (16 + (i))
+#define SEPARADORES    " ,;"
+
+typedef struct {
+    char nome[CENA_NOME_MAX];           // vazio: posição livre
+    Cena cena;
+} CenaGravada;
+
+static CenaGravada cenas[CENAS_MAX];
+
+void cenas_carregar(void) {
+    memset(cenas, 0, sizeof(cenas));
+    for (int i = 0; i < CENAS_MAX; i++) {
+        uint8_t registro[4 + CENA_NOME_MAX];
+        int n = kv_ler(KV_CENA(i), registro, sizeof(registro));
+        if (n <= 4 || n >= (int)sizeof(registro)) continue; // ausente, removida ou corrompida
+        memcpy(&cenas[i].cena, registro, 4);
+        memcpy(cenas[i].nome, registro + 4, (size_t)(n - 4));
+    }
+}
+
+static bool nome_valido(const char *nome, size_t n) {
+    if (n == 0 || n >= CENA_NOME_MAX) return false;
+    for (size_t i = 0; i < n; i++) {
+        char c = nome[i];
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+        if (!ok) return false;
+    }
+    return true;
+}
+
+static CenaGravada *buscar(const char *nome, size_t n) {
+    for (int i = 0; i < CENAS_MAX; i++) {
+        if (strlen(cenas[i].nome) == n && strncmp(cenas[i].nome, nome, n) == 0) return &cenas[i];
+    }
+    return NULL;
+}
+
+// um campo "nome=valor" (n caracteres); false se o nome ou o valor é inválido
+static bool interpretar_campo(const char *campo, size_t n, Cena *cena) {
+    const char *igual = memchr(campo, '=', n);
+    if (!igual) return false;
+    char valor[16];
+    size_t tamanho_nome = (size_t)(igual - campo), tamanho_valor = n - tamanho_nome - 1;
+    if (tamanho_valor == 0 || tamanho_valor >= sizeof(valor)) return false;
+    memcpy(valor, igual + 1, tamanho_valor);
+    valor[tamanho_valor] = '\0';
+    if (tamanho_nome == 6 && strncmp(campo, "brilho", 6) == 0) {
+        char *fim;
+        long brilho = strtol(valor, &fim, 10);
+        if (*fim || brilho < 1 || brilho > 100) return false;
+        cena->brilho = (int8_t)brilho;
+        return true;
+    }
+    static const TipoComando campos[] = { COMANDO_LED, COMANDO_COR, COMANDO_COMODO }; // o alarme não entra em cenas
+    for (unsigned i = 0; i < sizeof(campos) / sizeof(campos[0]); i++) {
+        const char *nome = painel_nomes_comando[campos[i]];
+        if (strlen(nome) != tamanho_nome || strncmp(nome, campo, tamanho_nome) != 0) continue;
+        int v = painel_valor_comando(campos[i], valor);
+        if (v < 0) return false;
+        int8_t *destino = campos[i] == COMANDO_LED ? &cena->led : campos[i] == COMANDO_COR ? &cena->cor : &cena->comodo;
+        *destino = (int8_t)v;
+        return true;
+    }
+    return false;
+}
+
+// campos separados por SEPARADORES; ao menos um, todos válidos
+static bool interpretar_campos(const char *texto, Cena *cena) {
+    *cena = (Cena){ -1, -1, -1, -1 };
+    bool algum = false;
+    for (const char *p = texto + strspn(texto, SEPARADORES); *p; p += strspn(p, SEPARADORES)) {
+        size_t n = strcspn(p, SEPARADORES);
+        if (!interpretar_campo(p, n, cena)) return false;
+        algum = true;
+        p += n;
+    }
+    return algum;
+}
+
+bool cenas_resolver(const char *texto, Cena *cena) {
+    if (strchr(texto, '=')) return interpretar_campos(texto, cena);
+    const char *inicio = texto + strspn(texto, SEPARADORES);
+    size_t n = strcspn(inicio, SEPARADORES);
+    if (inicio[n + strspn(inicio + n, SEPARADORES)] != '\0') return false; // só um nome
+    const CenaGravada *gravada = nome_valido(inicio, n) ? buscar(inicio, n) : NULL;
+    if (!gravada) return false;
+    *cena = gravada->cena;
+    return true;
+}
+
+void cenas_aplicar(const Cena *cena) {
+    if (cena->comodo >= 0) painel_aplicar_valor(COMANDO_COMODO, cena->comodo); // também liga os LEDs...
+    if (cena->cor >= 0) painel_aplicar_valor(COMANDO_COR, cena->cor);
+    if (cena->led >= 0) painel_aplicar_valor(COMANDO_LED, cena->led);          // ...salvo led=Off na mesma cena
+    if (cena->brilho >= 0) painel.brilho = (uint8_t)cena->brilho;
+}
+
+ResultadoCena cenas_definir(const char *texto, uint32_t agora, char nome[CENA_NOME_MAX]) {
+    const char *inicio = texto + strspn(texto, SEPARADORES);
+    size_t n = strcspn(inicio, SEPARADORES);
+    if (!nome_valido(inicio, n)) return CENA_INVALIDA;
+    memcpy(nome, inicio, n);
+    nome[n] = '\0';
+    CenaGravada *gravada = buscar(inicio, n);
+    const char *campos = inicio + n + strspn(inicio + n, SEPARADORES);
+    if (!*campos) {                     // só o nome: remove
+        if (!gravada || !kv_escrever(KV_CENA(gravada - cenas), "", 0, agora)) return CENA_INVALIDA;
+        memset(gravada, 0, sizeof(*gravada));
+        return CENA_REMOVIDA;
+    }
+    Cena cena;
+    if (!interpretar_campos(campos, &cena)) return CENA_INVALIDA;
+    if (!gravada) gravada = buscar("", 0); // posição livre
+    if (!gravada) return CENA_INVALIDA;
+    uint8_t registro[4 + CENA_NOME_MAX];
+    memcpy(registro, &cena, 4);
+    memcpy(registro + 4, inicio, n);
+    if (!kv_escrever(KV_CENA(gravada - cenas), registro, 4 + n, agora)) return CENA_INVALIDA;
+    memcpy(gravada->nome, nome, n + 1);
+    gravada->cena = cena;
+    return CENA_GRAVADA;
+}
+
+uint8_t cenas_total(void) {
+    uint8_t total = 0;
+    for (int i = 0; i < CENAS_MAX; i++) total += cenas[i].nome[0] != '\0';
+    return total;
+}
@@ -0,0 +1,39 @@
+// Cenas: várias mudanças do painel aplicadas de uma vez
+// Uma cena traz campos "nome=valor" com os valores de <prefixo>/comando/* (led, cor, comodo) e o
+// brilho em %, ou o nome de uma cena gravada no painel. Todos os campos são validados antes de o
+// primeiro ser aplicado e a aplicação acontece num só callback, então o loop principal vê o estado
+// anterior ou o novo, nunca um intermediário: um quadro da matriz e um lote de estados publicados.
+// As cenas gravadas ficam no armazenamento chave-valor (lib/kv_flash.c) e voltam no boot.
+// Código C puro (sem SDK).
+//
+// Exemplos de payload:
+//   comodo=Cozinha cor=Azul led=On      campos (separados por espaço, ',' ou ';'; os ausentes ficam)
+//   noite                               cena gravada
+// Definição ("<nome> <campos>" grava ou substitui, só "<nome>" remove):
+//   noite comodo=Quarto1 cor=Lilas brilho=20
+
+#ifndef CENAS_H
+#define CENAS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CENAS_MAX      8                // cenas gravadas
+#define CENA_NOME_MAX  16               // maior nome, com o terminador (letras, dígitos, '_' e '-')
+
+typedef struct {
+    int8_t led, cor, comodo;            // valor numérico do comando (painel_valor_comando); -1: mantém
+    int8_t brilho;                      // 1-100 %; -1: mantém
+} Cena;
+
+typedef enum { CENA_INVALIDA = -1, CENA_GRAVADA, CENA_REMOVIDA } ResultadoCena;
+
+void cenas_carregar(void);              // lê as cenas gravadas (depois de kv_iniciar)
+bool cenas_resolver(const char *texto, Cena *cena); // campos ou nome de uma cena gravada; false se inválido
+void cenas_aplicar(const Cena *cena);   // aplica os campos presentes (cômodo, cor, LED e brilho, nessa ordem)
+
+// "<nome> <campos>" ou "<nome>"; grava em segundo plano e copia o nome para 'nome'
+ResultadoCena cenas_definir(const char *texto, uint32_t agora, char nome[CENA_NOME_MAX]);
+uint8_t cenas_total(void);              // cenas gravadas
+
+#endif
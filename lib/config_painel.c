@@ -0,0 +1,79 @@
+// Configuração persistente e último estado do painel
+
+#include <string.h>
+#include "config_painel.h"
+#include "kv_flash.h"
+#include "painel.h"
+
+// chaves no armazenamento: 0 = estado do painel, 1.. = configuração, 16.. = cenas (lib/cenas.c)
+#define KV_ESTADO_PAINEL 0
+#define KV_CONFIG(c)     (1 + (c))
+
+static const char *const nomes[CONFIG_TOTAL] = {
+    "wifi_ssid", "wifi_senha", "broker_ip", "mqtt_usuario", "mqtt_senha", "client_id", "prefixo", "gateway"
+};
+static char valores[CONFIG_TOTAL][CONFIG_VALOR_MAX];
+
+void config_carregar(const char *const padroes[CONFIG_TOTAL]) {
+    for (int c = 0; c < CONFIG_TOTAL; c++) {
+        int n = kv_ler(KV_CONFIG(c), valores[c], CONFIG_VALOR_MAX - 1);
+        if (n < 0 || n >= CONFIG_VALOR_MAX) {
+            strncpy(valores[c], padroes[c], CONFIG_VALOR_MAX - 1);
+            n = (int)strlen(valores[c]);
+        }
+        valores[c][n] = '\0';
+    }
+}
+
+const char *config_valor(ChaveConfig chave) {
+    return chave < CONFIG_TOTAL ? valores[chave] : "";
+}
+
+const char *config_nome(ChaveConfig chave) {
+    return chave < CONFIG_TOTAL ? nomes[chave] : "?";
+}
+
+// valores que quebrariam os tópicos do painel são recusados antes de chegar à flash
+static bool valor_valido(ChaveConfig chave, const char *valor, size_t tamanho) {
+    switch (chave) {
+        case CONFIG_PREFIXO:
+            if (tamanho == 0 || tamanho > CONFIG_PREFIXO_MAX || valor[0] == '/' || valor[tamanho - 1] == '/') return false;
+            return strpbrk(valor, "+#") == NULL && strstr(valor, "//") == NULL;
+        case CONFIG_GATEWAY:
+            return strcmp(valor, "0") == 0 || strcmp(valor, "1") == 0;
+        default:
+            return true;
+    }
+}
+
+int config_definir(const char *texto, uint32_t agora) {
+    const char *igual = strchr(texto, '=');
+    if (!igual) return -1;
+    size_t tamanho_nome = (size_t)(igual - texto);
+    size_t tamanho_valor = strlen(igual + 1);
+    if (tamanho_valor >= CONFIG_VALOR_MAX) return -1;
+    for (int c = 0; c < CONFIG_TOTAL; c++) {
+        if (strlen(nomes[c]) == tamanho_nome && strncmp(nomes[c], texto, tamanho_nome) == 0) {
+            if (!valor_valido((ChaveConfig)c, igual + 1, tamanho_valor)) return -1;
+            return kv_escrever(KV_CONFIG(c), igual + 1, tamanho_valor, agora) ? c : -1;
+        }
+    }
+    return -1;
+}
+
+bool config_restaurar_painel(void) {
+    uint8_t estado[4] = { 0, 0, 0, 100 }; // gravado sem o brilho (3 bytes): brilho máximo
+    int n = kv_ler(KV_ESTADO_PAINEL, estado, sizeof(estado));
+    if (n != 3 && n != 4) return false;
+    if (estado[0] >= COR_TOTAL || estado[1] >= COMODO_TOTAL || estado[2] > 1 || estado[3] > 100) return false;
+    painel.cor = (Cor)estado[0];
+    painel.comodo = (Comodo)estado[1];
+    painel.led_ligado = estado[2] == 1;
+    painel.brilho = estado[3];
+    return true;
+}
+
+void config_salvar_painel(uint32_t agora) {
+    const uint8_t estado[4] = { (uint8_t)painel.cor, (uint8_t)painel.comodo, painel.led_ligado, painel.brilho };
+    kv_escrever(KV_ESTADO_PAINEL, estado, sizeof(estado), agora); // valor igual ao gravado não gera escrita
+}
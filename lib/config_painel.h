@@ -0,0 +1,34 @@
+// Configuração persistente e último estado do painel (sobre lib/kv_flash.c)
+// Wi-Fi, broker, credenciais MQTT, prefixo dos tópicos e modo gateway começam com os valores de
+// compilação e podem ser alterados por "nome=valor" (valem após reiniciar); cor, cômodo, LED e brilho
+// são restaurados no boot.
+// Código C puro (sem SDK).
+
+#ifndef CONFIG_PAINEL_H
+#define CONFIG_PAINEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+    CONFIG_WIFI_SSID, CONFIG_WIFI_SENHA, CONFIG_BROKER_IP,
+    CONFIG_MQTT_USUARIO, CONFIG_MQTT_SENHA, CONFIG_CLIENT_ID, CONFIG_PREFIXO, CONFIG_GATEWAY, CONFIG_TOTAL
+} ChaveConfig;
+
+#define CONFIG_VALOR_MAX 64             // maior valor (inclui o terminador)
+#define CONFIG_PREFIXO_MAX 32           // maior prefixo de tópicos ("casa/sala"), sem curingas nem '/' nas pontas;
+                                        // o gateway agrega só os prefixos "<raiz>/<nome>" (lib/gateway.h)
+
+// carrega os valores gravados; chaves ausentes ficam com 'padroes' (na ordem de ChaveConfig)
+void config_carregar(const char *const padroes[CONFIG_TOTAL]);
+const char *config_valor(ChaveConfig chave);
+
+// "nome=valor" (ex.: "broker_ip=192.168.0.50"); grava em segundo plano e retorna a chave, ou -1 se inválido
+// (prefixo fora do formato acima, gateway diferente de 0 ou 1)
+int config_definir(const char *texto, uint32_t agora);
+const char *config_nome(ChaveConfig chave); // nome usado em config_definir ("wifi_ssid", ...)
+
+bool config_restaurar_painel(void);     // aplica cor, cômodo, LED e brilho gravados; false se não havia estado
+void config_salvar_painel(uint32_t agora); // agenda a gravação do estado atual (ignorada se não mudou)
+
+#endif
@@ -0,0 +1,81 @@
+// Gerenciador de ociosidade e energia
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"            // cyw43_wifi_pm e modos de economia
+#include "energia.h"
+#include "log_binario.h"
+
+static volatile uint32_t ultima_atividade = 0; // timestamp (ms) da última atividade do usuário/rede
+static uint32_t modo_pm_atual = 0;      // modo de economia aplicado ao CYW43
+static uint64_t janela_inicio_us = 0;   // início da janela de medição
+static uint64_t dormindo_us = 0;        // tempo dormindo dentro da janela
+static uint16_t ciclo_ativo = 10000;    // último ciclo ativo medido (centésimos de %)
+
+// aplica um modo de economia apenas se mudou
+static void energia_aplicar_pm(uint32_t modo) {
+    if (modo == modo_pm_atual) return;
+    cyw43_arch_lwip_begin();
+    int erro = cyw43_wifi_pm(&cyw43_state, modo);
+    cyw43_arch_lwip_end();
+    if (erro == 0) {
+        modo_pm_atual = modo;
+        LOG_INFO(EV_ENERGIA_MODO_PM, modo == CYW43_PERFORMANCE_PM ? 0 : modo == CYW43_DEFAULT_PM ? 1 : 2);
+    }
+}
+
+void energia_init(void) {
+    ultima_atividade = to_ms_since_boot(get_absolute_time());
+    janela_inicio_us = time_us_64();
+    dormindo_us = 0;
+    energia_aplicar_pm(CYW43_PERFORMANCE_PM); // começa responsivo
+}
+
+void energia_atividade(void) {
+    ultima_atividade = to_ms_since_boot(get_absolute_time());
+}
+
+// tempo sem atividade; uma IRQ pode registrar atividade depois de o loop ler 'agora'
+static uint32_t energia_ocioso(uint32_t agora) {
+    uint32_t ocioso = agora - ultima_atividade;
+    return (int32_t)ocioso < 0 ? 0 : ocioso;
+}
+
+void energia_atualizar(uint32_t agora) {
+    uint32_t ocioso = energia_ocioso(agora);
+    if (ocioso >= ENERGIA_PM_AGRESSIVO_MS) {
+        energia_aplicar_pm(CYW43_AGGRESSIVE_PM);
+    } else if (ocioso >= ENERGIA_PM_ECONOMIA_MS) {
+        energia_aplicar_pm(CYW43_DEFAULT_PM);
+    } else {
+        energia_aplicar_pm(CYW43_PERFORMANCE_PM);
+    }
+
+    uint64_t agora_us = time_us_64();
+    uint64_t decorrido = agora_us - janela_inicio_us;
+    if (decorrido >= (uint64_t)ENERGIA_JANELA_MS * 1000) { // fecha a janela de medição
+        ciclo_ativo = (uint16_t)(((decorrido - dormindo_us) * 10000) / decorrido);
+        LOG_INFO(EV_ENERGIA_CICLO, ciclo_ativo);
+        janela_inicio_us = agora_us;
+        dormindo_us = 0;
+    }
+}
+
+void energia_dormir(uint32_t espera_ms) {
+    if (espera_ms == 0) return;
+    uint64_t inicio = time_us_64();
+    // WFE: acorda com o alarme do prazo ou com qualquer IRQ (GPIO dos botões, CYW43/lwIP);
+    // em ambos os casos o loop principal recalcula os prazos e volta a dormir
+    best_effort_wfe_or_timeout(make_timeout_time_ms(espera_ms));
+    dormindo_us += time_us_64() - inicio;
+}
+
+EstadoDisplay energia_estado_display(uint32_t agora) {
+    uint32_t ocioso = energia_ocioso(agora);
+    if (ocioso >= ENERGIA_APAGAR_MS) return DISPLAY_APAGADO;
+    if (ocioso >= ENERGIA_ESCURECER_MS) return DISPLAY_ESCURO;
+    return DISPLAY_NORMAL;
+}
+
+uint16_t energia_ciclo_ativo(void) {
+    return ciclo_ativo;
+}
@@ -0,0 +1,26 @@
+// Gerenciador de ociosidade e energia
+// Dorme o núcleo (WFE) até o próximo prazo ou até uma interrupção de GPIO/rede,
+// escolhe o modo de economia do CYW43 conforme a atividade e mede o ciclo ativo.
+
+#ifndef ENERGIA_H
+#define ENERGIA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ENERGIA_ESCURECER_MS    30000   // sem atividade por 30s: reduz contraste do OLED
+#define ENERGIA_APAGAR_MS       120000  // sem atividade por 2min: desliga o OLED
+#define ENERGIA_PM_ECONOMIA_MS  30000   // sem atividade por 30s: CYW43 em modo de economia padrão
+#define ENERGIA_PM_AGRESSIVO_MS 300000  // sem atividade por 5min: CYW43 em economia agressiva
+#define ENERGIA_JANELA_MS       60000   // janela de medição do ciclo ativo
+
+typedef enum { DISPLAY_NORMAL, DISPLAY_ESCURO, DISPLAY_APAGADO } EstadoDisplay; // brilho desejado do OLED
+
+void energia_init(void);                          // zera medições e coloca o CYW43 em modo de desempenho
+void energia_atividade(void);                     // registra atividade (botão, comando); seguro em IRQ
+void energia_atualizar(uint32_t agora);           // ajusta o modo do CYW43 conforme a ociosidade
+void energia_dormir(uint32_t espera_ms);          // dorme até espera_ms ou até uma interrupção
+EstadoDisplay energia_estado_display(uint32_t agora); // brilho do OLED para a ociosidade atual
+uint16_t energia_ciclo_ativo(void);               // ciclo ativo da última janela, em centésimos de %
+
+#endif
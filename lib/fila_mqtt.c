@@ -0,0 +1,44 @@
+// Classes de prioridade da saída MQTT
+
+#include "fila_mqtt.h"
+
+static const uint8_t reserva[MQTT_CLASSES] = { 0, 1, 2 }; // pedidos deixados para as classes mais urgentes
+
+static uint8_t pedidos = 1;
+static uint8_t pendentes;               // bit por classe
+static FilaMqttEstatisticas estatisticas;
+
+void fila_mqtt_iniciar(uint8_t total) {
+    pedidos = total;
+    pendentes = 0;
+    for (int c = 0; c < MQTT_CLASSES; c++) estatisticas.em_voo[c] = 0;
+}
+
+bool fila_mqtt_pode(ClasseMqtt classe) {
+    unsigned em_voo = 0;
+    for (int c = 0; c < MQTT_CLASSES; c++) em_voo += estatisticas.em_voo[c];
+    bool urgente = pendentes & ((1u << classe) - 1); // classe mais urgente esperando
+    if (urgente || em_voo + reserva[classe] >= pedidos) {
+        estatisticas.adiados[classe]++;
+        return false;
+    }
+    return true;
+}
+
+void fila_mqtt_enviado(ClasseMqtt classe) {
+    estatisticas.em_voo[classe]++;
+    estatisticas.enviados[classe]++;
+}
+
+void fila_mqtt_concluido(ClasseMqtt classe) {
+    if (estatisticas.em_voo[classe]) estatisticas.em_voo[classe]--;
+}
+
+void fila_mqtt_pendente(ClasseMqtt classe, bool pendente) {
+    if (pendente) pendentes |= (uint8_t)(1u << classe);
+    else pendentes &= (uint8_t)~(1u << classe);
+}
+
+const FilaMqttEstatisticas *fila_mqtt_estatisticas(void) {
+    return &estatisticas;
+}
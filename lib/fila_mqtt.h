@@ -0,0 +1,32 @@
+// Classes de prioridade da saída MQTT
+// O lwIP aceita até MQTT_REQ_MAX_IN_FLIGHT pedidos sem resposta (publicações QoS 1 e inscrições) e
+// os atende por ordem de chegada. Aqui cada pedido tem uma classe: o alarme pode ocupar todos os
+// pedidos, o controle (inscrições, estados e respostas) deixa um livre para o alarme e a telemetria
+// (sensores e consolidado do gateway) deixa dois. Uma classe também espera enquanto outra mais
+// urgente tem mensagem pendente, então a telemetria nunca toma o pedido de que o alarme precisa.
+// O que espera não fica copiado aqui: alarme e estados são relidos no envio (máscaras em main.c)
+// e a telemetria recusada é descartada, já que o próximo lote a substitui.
+// Código C puro (sem SDK).
+
+#ifndef FILA_MQTT_H
+#define FILA_MQTT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum { MQTT_CLASSE_ALARME, MQTT_CLASSE_CONTROLE, MQTT_CLASSE_TELEMETRIA, MQTT_CLASSES } ClasseMqtt;
+
+typedef struct {
+    uint8_t em_voo[MQTT_CLASSES];       // pedidos aguardando PUBACK/SUBACK
+    uint32_t enviados[MQTT_CLASSES];    // pedidos aceitos pelo lwIP
+    uint32_t adiados[MQTT_CLASSES];     // recusados pela reserva ou por classe mais urgente pendente
+} FilaMqttEstatisticas;
+
+void fila_mqtt_iniciar(uint8_t pedidos); // conexão nova: o lwIP descartou os pedidos em voo
+bool fila_mqtt_pode(ClasseMqtt classe); // há pedido para a classe (conta como adiado se não houver)
+void fila_mqtt_enviado(ClasseMqtt classe); // pedido aceito pelo lwIP
+void fila_mqtt_concluido(ClasseMqtt classe); // PUBACK/SUBACK ou expiração do pedido
+void fila_mqtt_pendente(ClasseMqtt classe, bool pendente); // a classe tem mensagem esperando pedido
+const FilaMqttEstatisticas *fila_mqtt_estatisticas(void);
+
+#endif
@@ -0,0 +1,33 @@
+// Mapa da flash do painel (deslocamentos a partir do início da flash)
+//
+//   0x000000   estágio de boot (estagio_boot.c): termina uma troca A/B e salta para o slot A
+//   0x004000   slot A: firmware em execução (ligado neste endereço, ver CMakeLists.txt)
+//   A + slot   slot B: imagem recebida pela rede / imagem anterior após a troca (lib/ota.c)
+//   fim - 28K  rascunho da troca A/B (1 setor)
+//   fim - 24K  metadados da atualização (2 setores alternados)
+//   fim - 16K  armazenamento chave-valor (lib/kv_flash.c), 4 setores em anel
+//
+// Código C puro: usado também pelas ferramentas do host com flash simulada.
+
+#ifndef FLASH_MAPA_H
+#define FLASH_MAPA_H
+
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024) // Pico W: 2 MB
+#endif
+
+#define FLASH_SETOR   4096              // menor unidade apagável
+#define FLASH_PAGINA  256               // menor unidade gravável
+
+#define FLASH_KV_SETORES 4              // setores do armazenamento chave-valor
+#define FLASH_KV_INICIO  (PICO_FLASH_SIZE_BYTES - FLASH_KV_SETORES * FLASH_SETOR)
+
+#define FLASH_ESTAGIO_BOOT 0x4000        // reservado ao estágio de boot; o CMakeLists.txt lê este valor
+
+#define FLASH_OTA_META   (FLASH_KV_INICIO - 2 * FLASH_SETOR) // registros de estado da troca A/B (2 setores)
+#define FLASH_OTA_RASCUNHO (FLASH_OTA_META - FLASH_SETOR) // cópia do setor em troca
+#define FLASH_OTA_SLOT   ((FLASH_OTA_RASCUNHO - FLASH_ESTAGIO_BOOT) / 2 / FLASH_SETOR * FLASH_SETOR) // cada slot (1000 KB com 2 MB)
+#define FLASH_SLOT_A     FLASH_ESTAGIO_BOOT
+#define FLASH_SLOT_B     (FLASH_SLOT_A + FLASH_OTA_SLOT)
+
+#endif
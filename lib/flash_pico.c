@@ -0,0 +1,36 @@
+// Apagamento e gravação da flash interna
+
+#include "pico/stdlib.h"
+#include "pico/flash.h"                 // flash_safe_execute
+#include "hardware/flash.h"
+#include "flash_pico.h"
+
+typedef struct {
+    uint32_t deslocamento;
+    const uint8_t *dados;               // NULL: apagar
+    size_t tamanho;
+} OperacaoFlash;
+
+// executada com o XIP desligado: não pode chamar código na flash
+static void __no_inline_not_in_flash_func(flash_pico_executar)(void *parametro) {
+    const OperacaoFlash *op = parametro;
+    if (op->dados) {
+        flash_range_program(op->deslocamento, op->dados, op->tamanho);
+    } else {
+        flash_range_erase(op->deslocamento, op->tamanho);
+    }
+}
+
+bool flash_pico_apagar(uint32_t deslocamento, size_t tamanho) {
+    OperacaoFlash op = { deslocamento, NULL, tamanho };
+    return flash_safe_execute(flash_pico_executar, &op, UINT32_MAX) == PICO_OK;
+}
+
+bool flash_pico_gravar(uint32_t deslocamento, const uint8_t *dados, size_t tamanho) {
+    OperacaoFlash op = { deslocamento, dados, tamanho };
+    return flash_safe_execute(flash_pico_executar, &op, UINT32_MAX) == PICO_OK;
+}
+
+const uint8_t *flash_pico_mapa(uint32_t deslocamento) {
+    return (const uint8_t *)(uintptr_t)(XIP_BASE + deslocamento);
+}
@@ -0,0 +1,15 @@
+// Apagamento e gravação da flash interna com o XIP desligado com segurança
+// (interrupções bloqueadas e o outro núcleo em espera via flash_safe_execute)
+
+#ifndef FLASH_PICO_H
+#define FLASH_PICO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+bool flash_pico_apagar(uint32_t deslocamento, size_t tamanho);   // múltiplos de FLASH_SETOR
+bool flash_pico_gravar(uint32_t deslocamento, const uint8_t *dados, size_t tamanho); // múltiplos de FLASH_PAGINA
+const uint8_t *flash_pico_mapa(uint32_t deslocamento);         // endereço de leitura (XIP)
+
+#endif
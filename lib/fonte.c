@@ -0,0 +1,36 @@
+#include "fonte.h"
+
+uint8_t fonte_proximo_codigo(const char **texto) {
+    const uint8_t *s = (const uint8_t *)*texto;
+    uint8_t c = *s;
+    if (c == 0) return 0;
+    if (c < 0x80) {                     // ASCII
+        *texto += 1;
+        return c;
+    }
+    if ((c == 0xC2 || c == 0xC3) && (s[1] & 0xC0) == 0x80) { // U+0080..U+00FF em dois bytes
+        *texto += 2;
+        return (uint8_t)((c & 0x03) << 6 | (s[1] & 0x3F));
+    }
+    s++;                                // fora do Latin-1 (ou inválido): pula as continuações
+    while ((*s & 0xC0) == 0x80) s++;
+    *texto = (const char *)s;
+    return '?';
+}
+
+const FonteGlifo *fonte_glifo(const Fonte *fonte, uint8_t codigo) {
+    for (uint8_t i = 0; i < fonte->num_faixas; i++) {
+        const FonteFaixa *f = &fonte->faixas[i];
+        if (codigo < f->primeiro) break; // faixas em ordem crescente
+        if (codigo <= f->ultimo) return &fonte->glifos[f->glifo + (codigo - f->primeiro)];
+    }
+    return &fonte->glifos[fonte->substituto];
+}
+
+uint16_t fonte_largura_texto(const Fonte *fonte, const char *texto) {
+    uint16_t largura = 0;
+    uint8_t codigo;
+    while ((codigo = fonte_proximo_codigo(&texto)) != 0)
+        largura += fonte_glifo(fonte, codigo)->avanco;
+    return largura;
+}
@@ -0,0 +1,87 @@
+// Fontes e imagens 1-bit em flash, geradas na compilação por tools/gerar_fontes.py a partir de assets/.
+// Os dados já vêm alinhados às páginas do SSD1306: página a página, um byte por coluna com 8 linhas
+// (bit 0 em cima), então o desenho copia bytes em vez de pixels (com deslocamento se y % 8 != 0).
+//
+// Compressão (opcional por recurso): RLE em bytes, estilo PackBits
+//   0x00-0x7F  n+1 bytes literais a seguir
+//   0x80-0xFF  o próximo byte repetido (n & 0x7F) + 2 vezes
+
+#ifndef FONTE_H
+#define FONTE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FONTE_RLE 0x8000u               // bit de FonteGlifo.deslocamento: glifo comprimido
+
+typedef struct {
+    uint8_t primeiro, ultimo;           // códigos Latin-1 da faixa (inclusive)
+    uint8_t glifo;                      // índice do glifo de 'primeiro' em Fonte.glifos
+} FonteFaixa;
+
+typedef struct {
+    uint16_t deslocamento;              // início em Fonte.dados; FONTE_RLE se comprimido
+    uint8_t largura;                    // colunas desenhadas
+    uint8_t avanco;                     // avanço do cursor (largura proporcional + espaçamento)
+} FonteGlifo;
+
+typedef struct {
+    uint8_t altura;                     // linhas (ascendente + descendente)
+    uint8_t paginas;                    // (altura + 7) / 8
+    uint8_t num_faixas;
+    uint8_t num_glifos;
+    uint8_t substituto;                 // glifo desenhado para códigos fora das faixas
+    uint16_t tamanho_dados;             // bytes em dados (para o relatório de ocupação)
+    const FonteFaixa *faixas;
+    const FonteGlifo *glifos;
+    const uint8_t *dados;
+} Fonte;
+
+typedef struct {
+    uint8_t largura, altura;            // pixels
+    uint8_t paginas;
+    bool rle;
+    uint16_t tamanho_dados;
+    const uint8_t *dados;
+} Imagem;
+
+// Leitor de um fluxo de páginas, comprimido ou não: devolve um byte por chamada,
+// sem buffer intermediário (o desenho descomprime direto no framebuffer)
+typedef struct {
+    const uint8_t *p;
+    uint8_t restante;                   // bytes que faltam na sequência atual (RLE)
+    uint8_t valor;                      // byte repetido
+    bool repetindo;
+    bool rle;
+} FonteLeitor;
+
+static inline void fonte_leitor_iniciar(FonteLeitor *l, const uint8_t *dados, bool rle) {
+    l->p = dados;
+    l->restante = 0;
+    l->repetindo = false;
+    l->rle = rle;
+}
+
+static inline uint8_t fonte_ler(FonteLeitor *l) {
+    if (!l->rle) return *l->p++;
+    if (l->restante == 0) {             // próxima sequência
+        uint8_t controle = *l->p++;
+        l->repetindo = controle & 0x80;
+        l->restante = l->repetindo ? (uint8_t)((controle & 0x7F) + 2) : (uint8_t)(controle + 1);
+        if (l->repetindo) l->valor = *l->p++;
+    }
+    l->restante--;
+    return l->repetindo ? l->valor : *l->p++;
+}
+
+// Próximo caractere de uma string UTF-8 como código Latin-1; avança *texto.
+// 0 no fim; '?' para caracteres fora do Latin-1
+uint8_t fonte_proximo_codigo(const char **texto);
+
+// Glifo do código, ou o substituto da fonte
+const FonteGlifo *fonte_glifo(const Fonte *fonte, uint8_t codigo);
+
+// Largura em pixels da string UTF-8 desenhada com a fonte (soma dos avanços)
+uint16_t fonte_largura_texto(const Fonte *fonte, const char *texto);
+
+#endif
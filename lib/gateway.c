@@ -0,0 +1,165 @@
+// Agregador da casa (modo gateway)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gateway.h"
+#include "painel.h"
+
+typedef enum { CAMPO_LED, CAMPO_COR, CAMPO_COMODO, CAMPO_EMERGENCIA, CAMPO_BRILHO, CAMPO_STATUS, CAMPO_TEMPERATURA, CAMPO_TOTAL } Campo;
+
+// resto do tópico depois de "<raiz>/<nó>/" (tópicos de estado e status publicados por main.c de cada nó)
+static const char *const nomes_campo[CAMPO_TOTAL] = {
+    "estado/led", "estado/cor", "estado/comodo", "estado/emergencia", "estado/brilho", "painel/status", "temperatura"
+};
+
+typedef struct {
+    char nome[GATEWAY_NOME_MAX];        // vazio: posição livre
+    bool online;
+    int8_t led, cor, comodo, emergencia, brilho; // -1 enquanto desconhecido (brilho em %)
+    bool tem_temperatura;
+    int16_t temperatura;                // décimos de °C (média do último minuto)
+    uint32_t ordem;                     // última mensagem recebida (escolhe o nó offline substituído)
+} No;
+
+static No nos[GATEWAY_NOS_MAX];
+static char raiz[GATEWAY_NOME_MAX];
+static size_t raiz_n;
+static uint32_t ordem;
+static bool pendente;
+static GatewayEstatisticas estatisticas;
+
+void gateway_iniciar(const char *nome_raiz) {
+    memset(nos, 0, sizeof(nos));
+    memset(&estatisticas, 0, sizeof(estatisticas));
+    snprintf(raiz, sizeof(raiz), "%s", nome_raiz);
+    raiz_n = strlen(raiz);
+    pendente = false;
+}
+
+// posição do nó; um nó novo ocupa uma posição livre ou a do nó offline mais antigo (NULL se não houver)
+static No *buscar_no(const char *nome, size_t n) {
+    No *livre = NULL;
+    for (int i = 0; i < GATEWAY_NOS_MAX; i++) {
+        No *no = &nos[i];
+        if (!no->nome[0]) {
+            if (!livre) livre = no;
+        } else if (strlen(no->nome) == n && strncmp(no->nome, nome, n) == 0) {
+            return no;
+        } else if (!no->online && (!livre || (livre->nome[0] && no->ordem < livre->ordem))) {
+            livre = no;
+        }
+    }
+    if (!livre) return NULL;
+    if (livre->nome[0]) estatisticas.nos--; // nó offline substituído
+    memset(livre, 0, sizeof(*livre));
+    for (size_t i = 0; i < n; i++) livre->nome[i] = nome[i] == '"' || nome[i] == '\\' ? '_' : nome[i]; // vai para o JSON
+    livre->led = livre->cor = livre->comodo = livre->emergencia = livre->brilho = -1;
+    estatisticas.nos++;
+    return livre;
+}
+
+static bool atualizar_i8(int8_t *campo, int valor) {
+    if (*campo == valor) return false;
+    *campo = (int8_t)valor;
+    return true;
+}
+
+bool gateway_receber(const char *topico, const char *payload) {
+    estatisticas.mensagens++;
+    const char *nome = topico + raiz_n + 1;
+    const char *barra = strncmp(topico, raiz, raiz_n) == 0 && topico[raiz_n] == '/' ? strchr(nome, '/') : NULL;
+    size_t n = barra ? (size_t)(barra - nome) : 0;
+    int campo = 0;
+    while (barra && campo < CAMPO_TOTAL && strcmp(barra + 1, nomes_campo[campo]) != 0) campo++;
+    No *no = n > 0 && n < GATEWAY_NOME_MAX && campo < CAMPO_TOTAL ? buscar_no(nome, n) : NULL;
+    if (!no) {
+        estatisticas.ignoradas++;
+        return false;
+    }
+    no->ordem = ++ordem;
+    bool mudou = false;
+    switch ((Campo)campo) {
+        case CAMPO_LED: mudou = atualizar_i8(&no->led, strcmp(payload, "LIGADO") == 0); break;
+        case CAMPO_COR: mudou = atualizar_i8(&no->cor, painel_valor_comando(COMANDO_COR, payload)); break;
+        case CAMPO_COMODO: mudou = atualizar_i8(&no->comodo, painel_valor_comando(COMANDO_COMODO, payload)); break;
+        case CAMPO_EMERGENCIA: mudou = atualizar_i8(&no->emergencia, strcmp(payload, "LIGADA") == 0); break;
+        case CAMPO_BRILHO: {
+            int brilho = atoi(payload);
+            if (brilho >= 0 && brilho <= 100) mudou = atualizar_i8(&no->brilho, brilho);
+            break;
+        }
+        case CAMPO_STATUS: {
+            bool online = strcmp(payload, "online") == 0;
+            mudou = online != no->online;
+            estatisticas.online += online - no->online;
+            no->online = online;
+            break;
+        }
+        case CAMPO_TEMPERATURA: {
+            float valor = strtof(payload, NULL) * 10.0f;
+            int16_t decimos = (int16_t)(valor < 0 ? valor - 0.5f : valor + 0.5f);
+            mudou = !no->tem_temperatura || decimos != no->temperatura;
+            no->tem_temperatura = true;
+            no->temperatura = decimos;
+            break;
+        }
+        default: break;
+    }
+    pendente |= mudou;
+    return mudou;
+}
+
+bool gateway_pendente(void) {
+    return pendente;
+}
+
+void gateway_publicado(void) {
+    pendente = false;
+}
+
+size_t gateway_json(char *buf, size_t tamanho) {
+    unsigned emergencias = 0;
+    for (int i = 0; i < GATEWAY_NOS_MAX; i++) emergencias += nos[i].nome[0] && nos[i].emergencia == 1;
+    int escrito = snprintf(buf, tamanho, "{\"nos\":%u,\"online\":%u,\"emergencias\":%u,\"paineis\":{",
+                           estatisticas.nos, estatisticas.online, emergencias);
+    if (escrito < 0 || (size_t)escrito >= tamanho) return 0;
+    size_t n = (size_t)escrito;
+    bool primeiro = true;
+    unsigned omitidos = 0;
+    static const size_t fim_max = sizeof("},\"truncado\":12}"); // maior fechamento
+    for (int i = 0; i < GATEWAY_NOS_MAX; i++) {
+        const No *no = &nos[i];
+        if (!no->nome[0]) continue;
+        if (omitidos) {                 // sem espaço: os nós seguintes também ficam de fora
+            omitidos++;
+            continue;
+        }
+        char item[GATEWAY_ITEM_MAX];    // campos desconhecidos ficam de fora
+        int k = snprintf(item, sizeof(item), "%s\"%s\":{\"on\":%d", primeiro ? "" : ",", no->nome, no->online);
+        if (no->led >= 0) k += snprintf(item + k, sizeof(item) - k, ",\"led\":%d", no->led);
+        if (no->cor >= 0) k += snprintf(item + k, sizeof(item) - k, ",\"cor\":\"%s\"", painel_nome_cor((Cor)no->cor));
+        if (no->comodo >= 0) k += snprintf(item + k, sizeof(item) - k, ",\"comodo\":\"%s\"", painel_nome_comodo((Comodo)no->comodo));
+        if (no->emergencia >= 0) k += snprintf(item + k, sizeof(item) - k, ",\"alarme\":%d", no->emergencia);
+        if (no->brilho >= 0) k += snprintf(item + k, sizeof(item) - k, ",\"brilho\":%d", no->brilho);
+        if (no->tem_temperatura) {
+            k += snprintf(item + k, sizeof(item) - k, ",\"t\":%s%d.%d", no->temperatura < 0 ? "-" : "",
+                          abs(no->temperatura) / 10, abs(no->temperatura) % 10);
+        }
+        k += snprintf(item + k, sizeof(item) - k, "}");
+        if ((size_t)k >= sizeof(item) || n + (size_t)k + fim_max > tamanho) {
+            omitidos++;
+            continue;
+        }
+        memcpy(buf + n, item, (size_t)k);
+        n += (size_t)k;
+        primeiro = false;
+    }
+    if (n + fim_max > tamanho) return 0; // nem o cabeçalho e o fechamento cabem
+    escrito = omitidos ? snprintf(buf + n, tamanho - n, "},\"truncado\":%u}", omitidos) : snprintf(buf + n, tamanho - n, "}}");
+    return n + (size_t)escrito;
+}
+
+const GatewayEstatisticas *gateway_estatisticas(void) {
+    return &estatisticas;
+}
@@ -0,0 +1,39 @@
+// Agregador da casa (modo gateway)
+// Um painel inscrito com curingas nos tópicos dos demais ("<raiz>/+/estado/+", "<raiz>/+/painel/status"
+// e "<raiz>/+/temperatura") guarda o último estado de cada nó e publica um único estado consolidado,
+// então os dashboards assinam um tópico em vez de quatro por painel.
+// Código C puro (sem SDK).
+
+#ifndef GATEWAY_H
+#define GATEWAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "config_painel.h"
+
+#define GATEWAY_NOS_MAX 12              // painéis acompanhados (nós offline cedem o lugar a nós novos)
+#define GATEWAY_NOME_MAX CONFIG_PREFIXO_MAX // nome do nó (o nível depois da raiz): cabe o de qualquer prefixo válido
+#define GATEWAY_ITEM_MAX (GATEWAY_NOME_MAX + 112) // um nó no consolidado, com todos os campos conhecidos
+// consolidado com GATEWAY_NOS_MAX nós de nome máximo (cabe no buffer de saída do MQTT, MQTT_OUTPUT_RINGBUF_SIZE)
+#define GATEWAY_JSON_MAX (96 + GATEWAY_NOS_MAX * GATEWAY_ITEM_MAX)
+
+void gateway_iniciar(const char *raiz); // raiz dos tópicos ("casa")
+
+// mensagem de um filtro do gateway ("<raiz>/<nó>/estado/cor", ...); true se o consolidado mudou
+bool gateway_receber(const char *topico, const char *payload);
+bool gateway_pendente(void);            // consolidado mudou desde a última publicação
+// {"nos":..,"online":..,"emergencias":..,"paineis":{..}}; com um buffer menor que GATEWAY_JSON_MAX os nós que
+// não couberem ficam de fora e o consolidado termina com "truncado":<nós omitidos>
+size_t gateway_json(char *buf, size_t tamanho);
+void gateway_publicado(void);           // o consolidado montado por último foi aceito pelo broker
+
+typedef struct {
+    uint16_t nos;                       // nós na tabela
+    uint16_t online;                    // nós com "online" em <nó>/painel/status
+    uint32_t mensagens;                 // mensagens recebidas dos filtros
+    uint32_t ignoradas;                 // tópico desconhecido ou tabela cheia
+} GatewayEstatisticas;
+const GatewayEstatisticas *gateway_estatisticas(void);
+
+#endif
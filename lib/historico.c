@@ -0,0 +1,159 @@
+// Histórico de séries em resoluções fixas
+
+#include <stdio.h>
+#include <string.h>
+#include "historico.h"
+
+#define HISTORICO_BYTES_BALDE 40        // pior caso de um intervalo serializado ("[-123.4,-123.4,-123.4,65535],")
+
+static const uint32_t periodos[HISTORICO_NIVEIS] = { 60, 900, 3600 };       // segundos por intervalo
+static const uint16_t capacidades[HISTORICO_NIVEIS] = { 60, 96, 168 };      // 1 h, 24 h e 7 dias
+static const char *const nomes_nivel[HISTORICO_NIVEIS] = { "1m", "15m", "1h" };
+
+#define HISTORICO_BALDES (60 + 96 + 168) // soma de capacidades[]
+
+typedef struct {
+    uint32_t numero;                    // número do intervalo aberto (segundos / período)
+    HistoricoBalde aberto;              // agregado em construção
+    uint16_t cabeca;                    // posição do próximo intervalo fechado no anel
+    uint16_t cheios;                    // intervalos fechados guardados (até a capacidade)
+} HistoricoNivel;
+
+typedef struct {
+    const char *nome;
+    bool iniciada;                      // já recebeu a primeira amostra
+    HistoricoNivel niveis[HISTORICO_NIVEIS];
+    HistoricoBalde baldes[HISTORICO_BALDES]; // anéis dos níveis, em sequência
+} HistoricoSerie;
+
+static HistoricoSerie series[HISTORICO_SERIES];
+static int total_series = 0;
+
+// anel do nível dentro de baldes[]
+static HistoricoBalde *historico_anel(HistoricoSerie *s, int nivel) {
+    uint16_t inicio = 0;
+    for (int i = 0; i < nivel; i++) inicio += capacidades[i];
+    return &s->baldes[inicio];
+}
+
+int historico_criar(const char *nome) {
+    if (total_series >= HISTORICO_SERIES) return -1;
+    HistoricoSerie *s = &series[total_series];
+    memset(s, 0, sizeof(*s));
+    s->nome = nome;
+    return total_series++;
+}
+
+// fecha o intervalo aberto e os vazios até 'numero' (lacunas sem amostras viram intervalos vazios)
+static void historico_avancar(HistoricoSerie *s, int nivel, uint32_t numero) {
+    HistoricoNivel *h = &s->niveis[nivel];
+    HistoricoBalde *anel = historico_anel(s, nivel);
+    uint32_t passos = numero - h->numero;
+    if (passos > capacidades[nivel]) {  // lacuna maior que o anel (ou relógio para trás): a janela toda é vazia
+        memset(anel, 0, capacidades[nivel] * sizeof(HistoricoBalde)); // o aberto não cabe mais em nenhum intervalo guardado
+        h->cabeca = 0;
+        h->cheios = capacidades[nivel];
+        passos = 0;
+    }
+    for (uint32_t i = 0; i < passos; i++) {
+        anel[h->cabeca] = i == 0 ? h->aberto : (HistoricoBalde){ 0 };
+        h->cabeca = (h->cabeca + 1) % capacidades[nivel];
+        if (h->cheios < capacidades[nivel]) h->cheios++;
+    }
+    h->numero = numero;
+    h->aberto = (HistoricoBalde){ 0 };
+}
+
+bool historico_adicionar(int serie, uint32_t segundos, float valor, HistoricoBalde *fechado) {
+    if (serie < 0 || serie >= total_series) return false;
+    HistoricoSerie *s = &series[serie];
+    bool fechou = false;
+    for (int nivel = 0; nivel < HISTORICO_NIVEIS; nivel++) {
+        HistoricoNivel *h = &s->niveis[nivel];
+        uint32_t numero = segundos / periodos[nivel];
+        if (!s->iniciada) {
+            h->numero = numero;
+        } else if (numero != h->numero) {
+            if (nivel == 0) {
+                fechou = h->aberto.n > 0;
+                if (fechado) *fechado = h->aberto;
+            }
+            historico_avancar(s, nivel, numero);
+        }
+        HistoricoBalde *b = &h->aberto;
+        if (b->n == 0) {
+            b->min = b->max = valor;
+        } else {
+            if (valor < b->min) b->min = valor;
+            if (valor > b->max) b->max = valor;
+        }
+        if (b->n < UINT16_MAX) {        // soma e contagem param juntas: a média continua certa
+            b->soma += valor;
+            b->n++;
+        }
+    }
+    s->iniciada = true;
+    return fechou;
+}
+
+int historico_por_nome(const char *nome) {
+    for (int i = 0; i < total_series; i++) {
+        if (strcmp(series[i].nome, nome) == 0) return i;
+    }
+    return -1;
+}
+
+int historico_nivel_por_nome(const char *nome) {
+    for (int i = 0; i < HISTORICO_NIVEIS; i++) {
+        if (strcmp(nomes_nivel[i], nome) == 0) return i;
+    }
+    return -1;
+}
+
+uint32_t historico_periodo(int nivel) {
+    return (nivel >= 0 && nivel < HISTORICO_NIVEIS) ? periodos[nivel] : 0;
+}
+
+uint16_t historico_capacidade(int nivel) {
+    return (nivel >= 0 && nivel < HISTORICO_NIVEIS) ? capacidades[nivel] : 0;
+}
+
+// escreve um intervalo como [min,max,media,n] ou null
+static int historico_balde_json(char *buf, size_t tamanho, const HistoricoBalde *b) {
+    if (b->n == 0) return snprintf(buf, tamanho, "null");
+    return snprintf(buf, tamanho, "[%.1f,%.1f,%.2f,%u]", b->min, b->max, b->soma / b->n, b->n);
+}
+
+size_t historico_json(int serie, int nivel, uint16_t quantidade, char *buf, size_t tamanho) {
+    if (serie < 0 || serie >= total_series || nivel < 0 || nivel >= HISTORICO_NIVEIS || tamanho == 0) return 0;
+    HistoricoSerie *s = &series[serie];
+    HistoricoNivel *h = &s->niveis[nivel];
+    const HistoricoBalde *anel = historico_anel(s, nivel);
+
+    uint16_t cabe = tamanho > 2 * HISTORICO_BYTES_BALDE + 96 ? (tamanho - 2 * HISTORICO_BYTES_BALDE - 96) / HISTORICO_BYTES_BALDE : 0;
+    if (quantidade == 0 || quantidade > h->cheios) quantidade = h->cheios;
+    if (quantidade > cabe) quantidade = cabe; // mantém os mais recentes
+
+    size_t n = 0;
+    int escrito = snprintf(buf, tamanho, "{\"serie\":\"%s\",\"periodo\":%lu,\"fim\":%lu,\"baldes\":[", s->nome,
+                           (unsigned long)periodos[nivel], (unsigned long)(h->numero * periodos[nivel]));
+    if (escrito < 0 || (size_t)escrito >= tamanho) return 0;
+    n = (size_t)escrito;
+    uint16_t capacidade = capacidades[nivel];
+    for (uint16_t k = quantidade; k > 0; k--) { // k intervalos antes da cabeça, do mais antigo ao mais recente
+        uint16_t i = (uint16_t)((h->cabeca + capacidade - k) % capacidade);
+        if (k != quantidade) buf[n++] = ',';
+        escrito = historico_balde_json(buf + n, tamanho - n, &anel[i]);
+        if (escrito < 0 || (size_t)escrito >= tamanho - n) return 0;
+        n += (size_t)escrito;
+    }
+    escrito = snprintf(buf + n, tamanho - n, "],\"aberto\":");
+    if (escrito < 0 || (size_t)escrito >= tamanho - n) return 0;
+    n += (size_t)escrito;
+    escrito = historico_balde_json(buf + n, tamanho - n, &h->aberto);
+    if (escrito < 0 || (size_t)escrito + 1 >= tamanho - n) return 0;
+    n += (size_t)escrito;
+    buf[n++] = '}';
+    buf[n] = '\0';
+    return n;
+}
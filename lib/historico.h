@@ -0,0 +1,42 @@
+// Histórico de séries em resoluções fixas
+// Cada série guarda agregados (mínimo, máximo, média e contagem) em 3 níveis circulares:
+// 1 min (última hora), 15 min (último dia) e 1 h (última semana). Memória fixa na
+// compilação e custo O(1) por amostra. Código C puro (sem SDK).
+
+#ifndef HISTORICO_H
+#define HISTORICO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef HISTORICO_SERIES
+#define HISTORICO_SERIES  1             // séries simultâneas (só a temperatura tem histórico; ~5 KB por série)
+#endif
+#define HISTORICO_NIVEIS  3             // resoluções por série
+
+typedef struct {
+    float min;                          // menor valor do intervalo
+    float max;                          // maior valor do intervalo
+    float soma;                         // soma dos valores (média = soma / n)
+    uint16_t n;                         // amostras no intervalo (0 = sem dados)
+} HistoricoBalde;
+
+// cria uma série; retorna o índice ou -1 se não há espaço
+int historico_criar(const char *nome);
+
+// acrescenta uma amostra no instante 'segundos' (tempo monotônico);
+// retorna true se fechou um intervalo de 1 min, copiado em *fechado (pode ser NULL)
+bool historico_adicionar(int serie, uint32_t segundos, float valor, HistoricoBalde *fechado);
+
+int historico_por_nome(const char *nome);       // índice da série ou -1
+int historico_nivel_por_nome(const char *nome); // "1m", "15m", "1h" -> nível ou -1
+uint32_t historico_periodo(int nivel);          // duração de um intervalo do nível, em segundos
+uint16_t historico_capacidade(int nivel);       // intervalos guardados no nível
+
+// serializa os últimos 'quantidade' intervalos fechados (do mais antigo ao mais recente) e o intervalo aberto:
+// {"serie":"temperatura","periodo":900,"fim":86400,"baldes":[[min,max,media,n],null,...],"aberto":[...]}
+// intervalos sem amostras saem como null; a quantidade é reduzida para caber no buffer
+size_t historico_json(int serie, int nivel, uint16_t quantidade, char *buf, size_t tamanho);
+
+#endif
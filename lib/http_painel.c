@@ -0,0 +1,106 @@
+// Servidor HTTP local do painel
+// Arquivos estáticos vêm do fsdata gerado por tools/gerar_fsdata.py (gzip + cabeçalho pronto, sem cópia).
+// /estado.json é um arquivo "custom" montado num buffer estático: nenhuma alocação por requisição.
+
+#include <stdio.h>
+#include <string.h>
+#include "lwip/apps/httpd.h"
+#include "lwip/apps/fs.h"
+#include "lwip/pbuf.h"
+#include "http_painel.h"
+
+#define HTTP_JSON_MAX 1024              // tamanho máximo do corpo JSON (estado + diagnóstico do joystick, alarme e sensores)
+#define HTTP_POST_MAX 128               // maior corpo de POST /comando.cgi (todos os comandos cabem com folga)
+
+static const HttpPainelCallbacks *http_cb = NULL; // integração com o painel
+static char corpo_json[HTTP_JSON_MAX];  // corpo da resposta JSON
+static char resposta_json[HTTP_JSON_MAX + 128]; // cabeçalho + corpo (copiado para o TCP na primeira escrita)
+
+// POST de comandos: um por vez (o corpo é curto e chega quase sempre num só segmento)
+static char corpo_post[HTTP_POST_MAX];
+static u16_t post_recebidos;
+static void *post_conexao = NULL;       // conexão dona do corpo_post (NULL: nenhuma)
+static bool post_descartar;             // corpo maior que HTTP_POST_MAX
+
+// corpo "led=On&cor=Azul": cada par é um comando (led, cor, comodo, alarme)
+static void aplicar_comandos(char *corpo) {
+    bool mudou = false;
+    for (char *par = corpo, *proximo; par; par = proximo) { // strtok não: o loop principal pode estar no meio de um
+        proximo = strchr(par, '&');
+        if (proximo) *proximo++ = '\0';
+        char *valor = strchr(par, '=');
+        if (!valor) continue;
+        *valor++ = '\0';
+        TipoComando tipo = painel_comando_por_nome(par);
+        if (tipo < COMANDO_TOTAL && http_cb->executar(tipo, valor)) {
+            mudou = true;
+        }
+    }
+    if (mudou) http_cb->publicar();     // um único lote de publicações para todos os comandos
+}
+
+err_t httpd_post_begin(void *connection, const char *uri, const char *http_request, u16_t http_request_len,
+                       int content_len, char *response_uri, u16_t response_uri_len, u8_t *post_auto_wnd) {
+    (void)http_request;
+    (void)http_request_len;
+    (void)post_auto_wnd;
+    if (strcmp(uri, "/comando.cgi") != 0) {
+        snprintf(response_uri, response_uri_len, "/404.html");
+        return ERR_VAL;
+    }
+    post_conexao = connection;          // um POST abandonado no meio não prende o buffer
+    post_recebidos = 0;
+    post_descartar = content_len < 0 || content_len >= HTTP_POST_MAX;
+    return ERR_OK;
+}
+
+err_t httpd_post_receive_data(void *connection, struct pbuf *p) {
+    if (connection == post_conexao && !post_descartar) {
+        if (post_recebidos + p->tot_len < HTTP_POST_MAX) {
+            post_recebidos += pbuf_copy_partial(p, corpo_post + post_recebidos, p->tot_len, 0);
+        } else {
+            post_descartar = true;
+        }
+    }
+    pbuf_free(p);
+    return ERR_OK;
+}
+
+void httpd_post_finished(void *connection, char *response_uri, u16_t response_uri_len) {
+    bool valido = connection == post_conexao && !post_descartar;
+    if (valido) {
+        corpo_post[post_recebidos] = '\0';
+        aplicar_comandos(corpo_post);
+    }
+    if (connection == post_conexao) post_conexao = NULL;
+    snprintf(response_uri, response_uri_len, valido ? "/estado.json" : "/404.html"); // estado resultante
+}
+
+// arquivos dinâmicos: só /estado.json
+int fs_open_custom(struct fs_file *file, const char *name) {
+    if (strcmp(name, "/estado.json") != 0) return 0;
+    size_t tamanho_corpo = http_cb->gerar_status(corpo_json, sizeof(corpo_json));
+    int n = snprintf(resposta_json, sizeof(resposta_json),
+                     "HTTP/1.0 200 OK\r\n"
+                     "Server: painel-casa\r\n"
+                     "Content-Type: application/json\r\n"
+                     "Content-Length: %u\r\n"
+                     "Cache-Control: no-store\r\n"
+                     "\r\n%s", (unsigned)tamanho_corpo, corpo_json);
+    if (n < 0 || (size_t)n >= sizeof(resposta_json)) return 0;
+    memset(file, 0, sizeof(*file));
+    file->data = resposta_json;
+    file->len = n;
+    file->index = n;                    // conteúdo inteiro disponível
+    file->flags = FS_FILE_FLAGS_HEADER_INCLUDED; // não persistente: o httpd copia para o buffer TCP
+    return 1;
+}
+
+void fs_close_custom(struct fs_file *file) {
+    (void)file;                         // buffer estático, nada a liberar
+}
+
+void http_painel_init(const HttpPainelCallbacks *callbacks) {
+    http_cb = callbacks;
+    httpd_init();
+}
@@ -0,0 +1,23 @@
+// Servidor HTTP local do painel (lwIP httpd)
+// Serve a página de status (comprimida, direto da flash) e uma API JSON:
+//   GET /estado.json                                -> estado e diagnóstico
+//   POST /comando.cgi, corpo "cor=Azul&comodo=..."  -> aplica comandos e responde com /estado.json
+// Comandos só por POST: um GET (link, pré-carregamento do navegador) nunca muda o estado.
+// Os arquivos estáticos só existem comprimidos: clientes sem Accept-Encoding gzip não são suportados.
+
+#ifndef HTTP_PAINEL_H
+#define HTTP_PAINEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "painel.h"
+
+typedef struct {
+    size_t (*gerar_status)(char *buf, size_t tamanho);     // escreve o JSON de /estado.json
+    bool (*executar)(TipoComando tipo, const char *valor); // aplica um comando; true se reconhecido
+    void (*publicar)(void);                                // publica o estado após um lote de comandos
+} HttpPainelCallbacks;
+
+void http_painel_init(const HttpPainelCallbacks *callbacks); // registra CGI e inicia o httpd na porta 80
+
+#endif
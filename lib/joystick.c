@@ -0,0 +1,83 @@
+// Eixos do joystick analógico
+
+#include <math.h>
+#include "joystick.h"
+
+#define ESCALA_MEIO 2048.0f
+#define CENTRO_TOLERANCIA 512.0f        // centro medido aceito a até 1/8 da escala do meio
+#define DT_MAX_MS 50                    // primeira leitura após o repouso não acumula o tempo parado
+
+static float centro_x = ESCALA_MEIO, centro_y = ESCALA_MEIO;
+static bool ativo_x, ativo_y;           // eixo fora da zona morta (com histerese)
+static bool comodo_armado = true;       // eixo Y voltou ao centro desde a última troca
+static uint32_t ultima_troca, ultima_leitura;
+static float brilho_fracao;             // brilho acumulado abaixo de 1 %
+static JoystickEstatisticas estatisticas;
+
+void joystick_iniciar(float x, float y) {
+    centro_x = fabsf(x - ESCALA_MEIO) <= CENTRO_TOLERANCIA ? x : ESCALA_MEIO;
+    centro_y = fabsf(y - ESCALA_MEIO) <= CENTRO_TOLERANCIA ? y : ESCALA_MEIO;
+}
+
+// zona morta com histerese: entra acima de ZONA_MORTA, sai abaixo de ZONA_MORTA - HISTERESE
+static bool fora_do_centro(bool ativo, float deflexao) {
+    float limite = ativo ? JOYSTICK_ZONA_MORTA - JOYSTICK_HISTERESE : JOYSTICK_ZONA_MORTA;
+    return fabsf(deflexao) > limite;
+}
+
+bool joystick_atualizar(float x, float y, uint32_t agora, uint8_t brilho, JoystickAcao *acao) {
+    float dx = x - centro_x, dy = y - centro_y;
+    uint32_t dt = agora - ultima_leitura;
+    ultima_leitura = agora;
+    if (dt > DT_MAX_MS) dt = DT_MAX_MS;
+    estatisticas.x = (int16_t)dx;
+    estatisticas.y = (int16_t)dy;
+    ativo_x = fora_do_centro(ativo_x, dx);
+    ativo_y = fora_do_centro(ativo_y, dy);
+    acao->brilho = brilho;
+    acao->comodo = 0;
+
+    if (ativo_x) {                      // velocidade proporcional à deflexão além da zona morta
+        float alcance = ESCALA_MEIO - JOYSTICK_ZONA_MORTA;
+        float forca = (fabsf(dx) - JOYSTICK_ZONA_MORTA) / alcance;
+        if (forca < 0.0f) forca = 0.0f;
+        if (forca > 1.0f) forca = 1.0f;
+        brilho_fracao += (dx > 0 ? 1.0f : -1.0f) * forca * JOYSTICK_BRILHO_POR_S * (float)dt / 1000.0f;
+        int passo = (int)brilho_fracao; // só os % inteiros; o resto fica para a próxima leitura
+        brilho_fracao -= (float)passo;
+        int novo = brilho + passo;
+        if (novo < JOYSTICK_BRILHO_MIN) novo = JOYSTICK_BRILHO_MIN;
+        if (novo > 100) novo = 100;
+        acao->brilho = (uint8_t)novo;
+    } else {
+        brilho_fracao = 0.0f;
+    }
+
+    if (!ativo_y) {
+        comodo_armado = true;
+    } else if (fabsf(dy) >= JOYSTICK_LIMIAR_COMODO &&
+               (comodo_armado || agora - ultima_troca >= JOYSTICK_REPETICAO_MS)) {
+        acao->comodo = dy > 0 ? 1 : -1;
+        comodo_armado = false;
+        ultima_troca = agora;
+    }
+
+    bool mudou = acao->brilho != brilho || acao->comodo != 0;
+    estatisticas.acoes += mudou;
+    return mudou;
+}
+
+bool joystick_ativo(void) {
+    return ativo_x || ativo_y;
+}
+
+void joystick_latencia(uint32_t us) {
+    estatisticas.medidas++;
+    estatisticas.latencia_us = us;
+    if (us > estatisticas.latencia_max_us) estatisticas.latencia_max_us = us;
+    estatisticas.latencia_soma_us += us;
+}
+
+const JoystickEstatisticas *joystick_estatisticas(void) {
+    return &estatisticas;
+}
@@ -0,0 +1,49 @@
+// Eixos do joystick analógico da BitDogLab (Y no ADC0/GPIO 26, X no ADC1/GPIO 27)
+// As leituras são médias do anel do ADC (lib/adc_amostragem.c): o DMA amostra os eixos junto com a
+// temperatura e o loop só lê a memória. Zona morta com histerese em torno do centro calibrado; o eixo
+// X ajusta o brilho com velocidade proporcional à deflexão, o eixo Y troca de cômodo (um passo por
+// deflexão, repetido enquanto mantido).
+// Código C puro (sem SDK).
+
+#ifndef JOYSTICK_H
+#define JOYSTICK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define JOYSTICK_CANAL_X        1       // canais do ADC
+#define JOYSTICK_CANAL_Y        0
+#define JOYSTICK_MEDIA          8       // amostras por leitura (8 ms a 1 kHz por canal)
+#define JOYSTICK_PERIODO_MS     50      // leitura em repouso (= ALARME_PERIODO_REPOUSO_MS: uma só acordada)
+#define JOYSTICK_PERIODO_ATIVO_MS 10    // leitura com o joystick fora do centro
+#define JOYSTICK_ZONA_MORTA     250     // contagens em torno do centro ignoradas (ruído e folga da mola)
+#define JOYSTICK_HISTERESE      60      // o eixo volta ao repouso abaixo de ZONA_MORTA - HISTERESE
+#define JOYSTICK_LIMIAR_COMODO  1400    // deflexão do eixo Y que troca de cômodo
+#define JOYSTICK_REPETICAO_MS   500     // próxima troca com o eixo Y mantido
+#define JOYSTICK_BRILHO_POR_S   80      // % por segundo na deflexão máxima do eixo X
+#define JOYSTICK_BRILHO_MIN     5       // % (o LED não apaga pelo brilho: para isso, o botão A)
+
+typedef struct {
+    uint8_t brilho;                     // novo brilho (%)
+    int8_t comodo;                      // passo de cômodo: -1, 0 ou +1
+} JoystickAcao;
+
+typedef struct {
+    uint32_t acoes;                     // leituras que mudaram brilho ou cômodo
+    uint32_t medidas;                   // latências registradas (ações próximas saem numa só atualização)
+    uint32_t latencia_us;               // última leitura sem a ação -> LED RGB e matriz atualizados
+    uint32_t latencia_max_us;
+    uint64_t latencia_soma_us;          // média = soma / medidas
+    int16_t x, y;                       // última deflexão lida (-2048 a 2047)
+} JoystickEstatisticas;
+
+// centro medido com o joystick em repouso; leituras longe do meio da escala (sem joystick) usam 2048
+void joystick_iniciar(float x, float y);
+
+// médias dos eixos (0-4095); true se brilho ou cômodo mudou (preenche acao)
+bool joystick_atualizar(float x, float y, uint32_t agora, uint8_t brilho, JoystickAcao *acao);
+bool joystick_ativo(void);              // algum eixo fora da zona morta: ler a cada JOYSTICK_PERIODO_ATIVO_MS
+void joystick_latencia(uint32_t us);    // da leitura anterior à ação até as saídas a refletirem
+const JoystickEstatisticas *joystick_estatisticas(void);
+
+#endif
@@ -0,0 +1,315 @@
+// Armazenamento chave-valor em flash
+
+#include <string.h>
+#include "kv_flash.h"
+
+#define KV_MAGICO        0x3153564Bu    // "KVS1"
+#define KV_CABECALHO     8              // mágico + sequência
+#define KV_CONFIRMACAO   0xFE           // chave do registro que fecha um lote
+#define KV_APAGADO       0xFF           // byte de flash apagada
+#define KV_REGISTRO(n)   (2 + (n))      // chave + tamanho + valor
+#define KV_LOTE_MAX      (KV_CABECALHO + KV_CHAVES_MAX * KV_REGISTRO(KV_VALOR_MAX) + KV_REGISTRO(4) + 4)
+#define KV_PAGINA_MAX    256
+
+typedef enum { KV_OCIOSO, KV_APAGANDO, KV_GRAVANDO } KvFase;
+
+static const KvFlash *flash;
+static uint32_t posicao[KV_CHAVES_MAX]; // deslocamento do valor mais recente na flash (0 = ausente)
+static uint8_t tamanho[KV_CHAVES_MAX];  // tamanho do valor na flash
+static uint8_t setor_atual;             // setor com os dados válidos mais recentes
+static uint32_t sequencia;              // sequência do setor atual
+static uint32_t livre;                  // próximo deslocamento livre (relativo ao setor atual)
+
+// alterações ainda não gravadas
+static uint8_t pendente[KV_CHAVES_MAX][KV_VALOR_MAX];
+static uint8_t tamanho_pendente[KV_CHAVES_MAX];
+static uint32_t sujas;                  // bitmap de chaves pendentes
+static uint32_t geracao[KV_CHAVES_MAX]; // incrementa a cada kv_escrever (detecta escrita durante a gravação)
+static uint32_t primeira_alteracao, ultima_alteracao;
+
+// lote em gravação
+static KvFase fase = KV_OCIOSO;
+static uint8_t lote[KV_LOTE_MAX];
+static uint32_t lote_tamanho;           // bytes montados
+static uint32_t lote_destino;           // deslocamento do lote na área
+static uint32_t lote_gravado;           // bytes já programados
+static uint8_t lote_setor;              // setor de destino
+static bool lote_rotacao;               // lote abre um novo setor (cópia completa)
+static uint32_t lote_chaves;            // bitmap de chaves no lote
+static uint32_t lote_geracao[KV_CHAVES_MAX];
+
+static KvEstatisticas estatisticas;
+
+static uint32_t kv_crc32(const uint8_t *dados, uint32_t n) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (uint32_t i = 0; i < n; i++) {
+        crc ^= dados[i];
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+    return ~crc;
+}
+
+static uint32_t kv_ler32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void kv_escrever32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t kv_alinhar4(uint32_t n) {
+    return (n + 3u) & ~3u;
+}
+
+// percorre os lotes de um setor; aplica ao índice os confirmados se 'aplicar'
+// (o CRC do primeiro lote cobre também o cabeçalho do setor)
+// retorna o fim do último lote confirmado (0 se nenhum)
+static uint32_t kv_percorrer(uint8_t setor, bool aplicar, uint32_t *lotes) {
+    const uint8_t *s = flash->base + (uint32_t)setor * flash->tamanho_setor;
+    uint32_t fim_confirmado = 0;
+    uint32_t p = KV_CABECALHO;
+    uint32_t chaves_lote[KV_CHAVES_MAX];
+    uint8_t total_lote = 0;
+    uint32_t inicio_lote = 0;
+    while (p + 2 <= flash->tamanho_setor) {
+        uint8_t chave = s[p], n = s[p + 1];
+        if (chave == KV_APAGADO) break; // fim do log
+        if (p + KV_REGISTRO(n) > flash->tamanho_setor) break;
+        if (chave == KV_CONFIRMACAO) {
+            if (n != 4 || kv_crc32(s + inicio_lote, p - inicio_lote) != kv_ler32(s + p + 2)) break;
+            if (aplicar) {
+                for (uint8_t i = 0; i < total_lote; i++) {
+                    uint32_t r = chaves_lote[i];
+                    posicao[s[r]] = (uint32_t)setor * flash->tamanho_setor + r + 2;
+                    tamanho[s[r]] = s[r + 1];
+                }
+            }
+            if (lotes) (*lotes)++;
+            p = kv_alinhar4(p + KV_REGISTRO(4));
+            fim_confirmado = p;
+            inicio_lote = p;
+            total_lote = 0;
+            continue;
+        }
+        if (chave >= KV_CHAVES_MAX || n > KV_VALOR_MAX || total_lote == KV_CHAVES_MAX) break; // lixo de uma gravação interrompida
+        chaves_lote[total_lote++] = p;
+        p += KV_REGISTRO(n);
+    }
+    return fim_confirmado;
+}
+
+// setor válido: cabeçalho e cópia inicial confirmados
+static bool kv_setor_valido(uint8_t setor, uint32_t *seq) {
+    const uint8_t *s = flash->base + (uint32_t)setor * flash->tamanho_setor;
+    if (kv_ler32(s) != KV_MAGICO) return false;
+    *seq = kv_ler32(s + 4);
+    return kv_percorrer(setor, false, NULL) > 0;
+}
+
+bool kv_iniciar(const KvFlash *f) {
+    flash = f;
+    memset(posicao, 0, sizeof(posicao));
+    memset(tamanho, 0, sizeof(tamanho));
+    sujas = 0;
+    fase = KV_OCIOSO;
+    memset(&estatisticas, 0, sizeof(estatisticas));
+
+    // setor válido com maior sequência (comparação tolerante a estouro)
+    bool achou = false;
+    for (uint8_t i = 0; i < flash->setores; i++) {
+        uint32_t seq;
+        if (!kv_setor_valido(i, &seq)) continue;
+        if (!achou || (int32_t)(seq - sequencia) > 0) {
+            setor_atual = i;
+            sequencia = seq;
+            achou = true;
+        }
+    }
+    if (!achou) {                       // flash vazia ou nunca confirmada: o primeiro lote abre o setor 0
+        setor_atual = flash->setores - 1;
+        sequencia = 0;
+        livre = flash->tamanho_setor;   // força rotação na primeira gravação
+        return false;
+    }
+
+    uint32_t fim = kv_percorrer(setor_atual, true, &estatisticas.lotes);
+    // restos de uma gravação interrompida depois do último lote confirmado tornariam os lotes
+    // seguintes inalcançáveis: a próxima gravação abre um setor novo com a cópia completa
+    const uint8_t *s = flash->base + (uint32_t)setor_atual * flash->tamanho_setor;
+    livre = fim;
+    for (uint32_t p = fim; p < flash->tamanho_setor; p++) {
+        if (s[p] != KV_APAGADO) {
+            livre = flash->tamanho_setor;
+            estatisticas.descartados++;
+            break;
+        }
+    }
+    return true;
+}
+
+// valor atual de uma chave (pendente ou na flash)
+static const uint8_t *kv_valor(uint8_t chave, uint8_t *n) {
+    if (sujas & (1u << chave)) {
+        *n = tamanho_pendente[chave];
+        return pendente[chave];
+    }
+    if (!posicao[chave]) return NULL;
+    *n = tamanho[chave];
+    return flash->base + posicao[chave];
+}
+
+int kv_ler(uint8_t chave, void *dados, size_t max) {
+    if (chave >= KV_CHAVES_MAX) return -1;
+    uint8_t n;
+    const uint8_t *v = kv_valor(chave, &n);
+    if (!v) return -1;
+    memcpy(dados, v, n < max ? n : max);
+    return n;
+}
+
+bool kv_escrever(uint8_t chave, const void *dados, size_t n, uint32_t agora) {
+    if (chave >= KV_CHAVES_MAX || n > KV_VALOR_MAX) return false;
+    uint8_t atual_n;
+    const uint8_t *atual = kv_valor(chave, &atual_n);
+    if (atual && atual_n == n && memcmp(atual, dados, n) == 0) return true; // sem mudança: nada a gravar
+    if (!sujas) primeira_alteracao = agora;
+    ultima_alteracao = agora;
+    memcpy(pendente[chave], dados, n);
+    tamanho_pendente[chave] = (uint8_t)n;
+    sujas |= 1u << chave;
+    geracao[chave]++;
+    estatisticas.bytes_pedidos += (uint32_t)n;
+    return true;
+}
+
+// acrescenta um registro ao lote
+static void kv_lote_registro(uint8_t chave, const uint8_t *valor, uint8_t n) {
+    lote[lote_tamanho++] = chave;
+    lote[lote_tamanho++] = n;
+    memcpy(&lote[lote_tamanho], valor, n);
+    lote_tamanho += n;
+}
+
+// monta o próximo lote: alterações pendentes ou, se não couberem, cópia completa num novo setor
+static void kv_montar_lote(void) {
+    uint32_t necessario = KV_REGISTRO(4);
+    for (uint8_t c = 0; c < KV_CHAVES_MAX; c++) {
+        if (sujas & (1u << c)) necessario += KV_REGISTRO(tamanho_pendente[c]);
+    }
+    lote_rotacao = livre + necessario > flash->tamanho_setor;
+    lote_tamanho = 0;
+    lote_chaves = 0;
+    if (lote_rotacao) {
+        lote_setor = (uint8_t)((setor_atual + 1) % flash->setores); // o mais antigo: não guarda nenhuma cópia única
+        lote_destino = (uint32_t)lote_setor * flash->tamanho_setor;
+        kv_escrever32(&lote[0], KV_MAGICO);
+        kv_escrever32(&lote[4], sequencia + 1);
+        lote_tamanho = KV_CABECALHO;
+    } else {
+        lote_setor = setor_atual;
+        lote_destino = (uint32_t)setor_atual * flash->tamanho_setor + livre;
+    }
+    for (uint8_t c = 0; c < KV_CHAVES_MAX; c++) {
+        uint8_t n;
+        const uint8_t *v;
+        if (sujas & (1u << c)) {
+            v = pendente[c];
+            n = tamanho_pendente[c];
+        } else if (lote_rotacao && posicao[c]) { // cópia das chaves vivas
+            v = flash->base + posicao[c];
+            n = tamanho[c];
+        } else {
+            continue;
+        }
+        kv_lote_registro(c, v, n);
+        lote_chaves |= 1u << c;
+        lote_geracao[c] = geracao[c];
+    }
+    uint8_t crc[4];
+    kv_escrever32(crc, kv_crc32(lote, lote_tamanho)); // inclui o cabeçalho do setor na rotação
+    kv_lote_registro(KV_CONFIRMACAO, crc, 4);
+    lote_gravado = 0;
+    estatisticas.bytes_lotes += lote_tamanho;
+    fase = lote_rotacao ? KV_APAGANDO : KV_GRAVANDO;
+}
+
+// grava a página que contém o próximo byte do lote (0xFF preserva o que já estava na página)
+static bool kv_gravar_pagina(void) {
+    static uint8_t pagina[KV_PAGINA_MAX];
+    uint32_t absoluto = lote_destino + lote_gravado;
+    uint32_t inicio_pagina = absoluto - absoluto % flash->tamanho_pagina;
+    uint32_t dentro = absoluto - inicio_pagina;
+    uint32_t n = flash->tamanho_pagina - dentro;
+    if (n > lote_tamanho - lote_gravado) n = lote_tamanho - lote_gravado;
+    memset(pagina, KV_APAGADO, flash->tamanho_pagina);
+    memcpy(pagina + dentro, lote + lote_gravado, n);
+    if (!flash->gravar(inicio_pagina, pagina)) return false;
+    estatisticas.paginas_gravadas++;
+    lote_gravado += n;
+    return true;
+}
+
+// lote confirmado: atualiza o índice e libera as chaves que não mudaram durante a gravação
+static void kv_concluir_lote(void) {
+    uint32_t p = lote_rotacao ? KV_CABECALHO : 0;
+    while (p < lote_tamanho) {
+        uint8_t c = lote[p], n = lote[p + 1];
+        if (c == KV_CONFIRMACAO) break;
+        posicao[c] = lote_destino + p + 2;
+        tamanho[c] = n;
+        if (geracao[c] == lote_geracao[c]) sujas &= ~(1u << c);
+        p += KV_REGISTRO(n);
+    }
+    if (lote_rotacao) {
+        setor_atual = lote_setor;
+        sequencia++;
+        livre = kv_alinhar4(lote_tamanho);
+    } else {
+        livre = kv_alinhar4(livre + lote_tamanho);
+    }
+    estatisticas.lotes++;
+    fase = KV_OCIOSO;
+}
+
+bool kv_manter(uint32_t agora) {
+    if (!flash) return false;
+    switch (fase) {
+        case KV_OCIOSO:
+            if (!sujas) return false;
+            if (agora - ultima_alteracao < KV_ATRASO_MS && agora - primeira_alteracao < KV_ATRASO_MAX_MS) return true;
+            kv_montar_lote();
+            return true;
+        case KV_APAGANDO:
+            if (!flash->apagar(lote_destino)) return true; // tenta de novo no próximo passo
+            estatisticas.setores_apagados++;
+            fase = KV_GRAVANDO;
+            return true;
+        case KV_GRAVANDO:
+            if (!kv_gravar_pagina()) return true;
+            if (lote_gravado == lote_tamanho) kv_concluir_lote();
+            return sujas != 0 || fase != KV_OCIOSO;
+    }
+    return false;
+}
+
+uint32_t kv_espera(uint32_t agora) {
+    if (!flash || (!sujas && fase == KV_OCIOSO)) return UINT32_MAX;
+    if (fase != KV_OCIOSO) return 0;
+    uint32_t ate_ultima = KV_ATRASO_MS - (agora - ultima_alteracao);
+    uint32_t ate_primeira = KV_ATRASO_MAX_MS - (agora - primeira_alteracao);
+    if (agora - ultima_alteracao >= KV_ATRASO_MS || agora - primeira_alteracao >= KV_ATRASO_MAX_MS) return 0;
+    return ate_ultima < ate_primeira ? ate_ultima : ate_primeira;
+}
+
+bool kv_sincronizar(uint32_t agora) {
+    if (!flash) return false;
+    for (int tentativas = 0; (sujas || fase != KV_OCIOSO) && tentativas < 1000; tentativas++) {
+        if (fase == KV_OCIOSO) kv_montar_lote(); // ignora o atraso de agrupamento
+        else kv_manter(agora);
+    }
+    return !sujas && fase == KV_OCIOSO;
+}
+
+const KvEstatisticas *kv_estatisticas(void) {
+    return &estatisticas;
+}
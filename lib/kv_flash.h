@@ -0,0 +1,52 @@
+// Armazenamento chave-valor em flash, estruturado em log e com desgaste distribuído
+//
+// Os setores formam um anel. Cada setor começa com um cabeçalho (número de sequência) e uma
+// cópia completa das chaves vivas, seguida de lotes de atualizações. Cada lote termina com um
+// registro de confirmação (CRC32): após uma queda de energia, lotes sem confirmação são
+// ignorados e o setor anterior continua válido até a cópia do novo ser confirmada.
+//
+// Escritas ficam em RAM e são agrupadas; kv_manter() grava uma página (ou apaga um setor)
+// por chamada, sem bloquear o loop por mais que uma operação de flash.
+// Código C puro (sem SDK): a flash é acessada pelas operações em KvFlash.
+
+#ifndef KV_FLASH_H
+#define KV_FLASH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define KV_CHAVES_MAX    32             // chaves possíveis (0 .. KV_CHAVES_MAX - 1)
+#define KV_VALOR_MAX     64             // maior valor, em bytes
+#define KV_ATRASO_MS     2000           // grava após 2s sem novas alterações...
+#define KV_ATRASO_MAX_MS 10000          // ...ou no máximo 10s após a primeira alteração pendente
+
+typedef struct {
+    const uint8_t *base;                // área mapeada para leitura direta (XIP no RP2040)
+    uint32_t tamanho_setor;             // unidade de apagamento
+    uint32_t tamanho_pagina;            // unidade de gravação
+    uint8_t setores;                    // setores no anel (mínimo 2)
+    bool (*apagar)(uint32_t deslocamento); // apaga o setor em 'deslocamento' (relativo a base)
+    bool (*gravar)(uint32_t deslocamento, const uint8_t *pagina); // grava uma página (bits só passam de 1 para 0)
+} KvFlash;
+
+typedef struct {
+    uint32_t bytes_pedidos;             // bytes passados a kv_escrever que mudaram algum valor
+    uint32_t bytes_lotes;               // bytes de registros montados em lotes (inclui cópias e cabeçalhos)
+    uint32_t paginas_gravadas;          // páginas programadas
+    uint32_t setores_apagados;          // apagamentos
+    uint32_t lotes;                     // lotes confirmados
+    uint32_t descartados;               // lotes sem confirmação encontrados na inicialização
+} KvEstatisticas;
+
+// reconstrói o índice numa única passada pelo setor mais recente; false se não havia dados válidos
+bool kv_iniciar(const KvFlash *flash);
+
+int kv_ler(uint8_t chave, void *dados, size_t tamanho); // tamanho do valor (copiado até 'tamanho') ou -1
+bool kv_escrever(uint8_t chave, const void *dados, size_t tamanho, uint32_t agora); // agenda; false se inválido
+bool kv_manter(uint32_t agora);         // um passo da gravação em segundo plano; true se ainda há trabalho
+uint32_t kv_espera(uint32_t agora);     // ms até o próximo passo (UINT32_MAX se nada pendente)
+bool kv_sincronizar(uint32_t agora);    // grava tudo o que está pendente antes de retornar
+const KvEstatisticas *kv_estatisticas(void);
+
+#endif
@@ -0,0 +1,91 @@
+// Log binário diferido - drenagem e formatação
+// Modo texto (padrão): formata cada entrada com printf usando a tabela de eventos.
+// Modo binário (LOG_SAIDA_BINARIA): envia as entradas cruas, decodificadas no host por tools/decodificar_log.py.
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"             // stdio_usb_connected
+#include "log_binario.h"
+
+log_entrada_t log_anel[LOG_TAMANHO_ANEL]; // anel de entradas
+volatile uint32_t log_cabeca = 0;       // próxima posição de escrita (contador livre)
+static uint32_t log_cauda = 0;          // próxima posição de leitura
+static uint32_t log_perdidas = 0;       // entradas sobrescritas antes da drenagem
+
+#ifndef LOG_SAIDA_BINARIA
+static uint32_t log_perdidas_avisadas = 0; // perdas já reportadas na saída de texto
+
+// textos de formatação indexados pelo evento
+static const char *const log_formatos[EV_TOTAL] = {
+#define LOG_EVENTO_FORMATO(id, fmt) fmt,
+    LOG_EVENTOS(LOG_EVENTO_FORMATO)
+#undef LOG_EVENTO_FORMATO
+};
+static const char log_letras_nivel[4] = {'E', 'W', 'I', 'D'}; // letra exibida para cada nível
+#endif
+
+// envia uma entrada para a saída
+static void log_emitir(const log_entrada_t *e) {
+#ifdef LOG_SAIDA_BINARIA
+    const uint8_t *bytes = (const uint8_t *)e;
+    putchar_raw(0xA5);                  // bytes de sincronismo do quadro
+    putchar_raw(0x5A);
+    for (size_t i = 0; i < sizeof(*e); i++) {
+        putchar_raw(bytes[i]);          // sem tradução CR/LF
+    }
+#else
+    uint16_t id = e->evento & 0x3FFF;   // identificador sem o nível
+    printf("[%lu.%06lu] %c ", (unsigned long)(e->tempo_us / 1000000), (unsigned long)(e->tempo_us % 1000000),
+           log_letras_nivel[e->evento >> 14]);
+    if (id < EV_TOTAL) {
+        printf(log_formatos[id], (int)e->arg[0], (int)e->arg[1], (int)e->arg[2], (int)e->arg[3]);
+    } else {
+        printf("evento desconhecido %u", id);
+    }
+    putchar('\n');
+#endif
+}
+
+// drena entradas pendentes
+uint32_t log_drenar(uint32_t maximo) {
+    if (!stdio_usb_connected()) {       // sem host lendo o CDC: não bloqueia, deixa o anel sobrescrever
+        return 0;
+    }
+    uint32_t processadas = 0;
+    while (processadas < maximo && log_cauda != log_cabeca) {
+        uint32_t pendentes = log_cabeca - log_cauda;
+        if (pendentes > LOG_TAMANHO_ANEL) { // produtor deu a volta no anel
+            log_perdidas += pendentes - LOG_TAMANHO_ANEL;
+            log_cauda = log_cabeca - LOG_TAMANHO_ANEL;
+        }
+        const log_entrada_t *origem = &log_anel[log_cauda & (LOG_TAMANHO_ANEL - 1)];
+        uint16_t esperado = (uint16_t)(log_cauda + 1);
+        if (origem->seq != esperado) {
+            if (log_cabeca - log_cauda > LOG_TAMANHO_ANEL) continue; // sobrescrita: recalcula a cauda
+            break;                      // entrada ainda sendo escrita (IRQ interrompida)
+        }
+        log_entrada_t copia = *origem;  // copia antes de formatar (printf é lento)
+        __dmb();
+        if (origem->seq != esperado) {  // sobrescrita durante a cópia
+            log_perdidas++;
+            log_cauda++;
+            continue;
+        }
+        log_emitir(&copia);
+        log_cauda++;
+        processadas++;
+    }
+#ifndef LOG_SAIDA_BINARIA
+    if (log_perdidas != log_perdidas_avisadas) { // reporta novas perdas uma única vez
+        printf("[log] %lu entradas sobrescritas\n", (unsigned long)log_perdidas);
+        log_perdidas_avisadas = log_perdidas;
+    }
+#endif
+    return processadas;
+}
+
+// total de entradas perdidas
+uint32_t log_sobrescritas(void) {
+    uint32_t pendentes = log_cabeca - log_cauda;
+    return log_perdidas + (pendentes > LOG_TAMANHO_ANEL ? pendentes - LOG_TAMANHO_ANEL : 0);
+}
@@ -0,0 +1,93 @@
+// Log binário diferido
+// Grava entradas compactas (timestamp, evento, 4 argumentos) em um anel de tamanho fixo.
+// A formatação só acontece em log_drenar(), chamada no tempo ocioso do loop principal.
+// Os argumentos são int32_t: valores de 32 bits sem sinal acima de INT32_MAX saem negativos e os
+// de 64 bits (ex.: time_us_64) precisam ser reduzidos pelo chamador (ms, KB, x 100 us).
+
+#ifndef LOG_BINARIO_H
+#define LOG_BINARIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/sync.h"              // save_and_disable_interrupts / __dmb
+#include "hardware/timer.h"             // time_us_32
+#include "log_eventos.h"                // tabela de eventos
+
+// níveis de log (filtrados em tempo de compilação)
+#define LOG_NIVEL_ERRO  0
+#define LOG_NIVEL_AVISO 1
+#define LOG_NIVEL_INFO  2
+#define LOG_NIVEL_DEBUG 3
+
+#ifndef LOG_NIVEL
+#define LOG_NIVEL LOG_NIVEL_INFO        // nível padrão: descarta apenas DEBUG
+#endif
+
+#ifndef LOG_TAMANHO_ANEL
+#define LOG_TAMANHO_ANEL 256            // número de entradas no anel (potência de 2)
+#endif
+
+#if (LOG_TAMANHO_ANEL & (LOG_TAMANHO_ANEL - 1)) != 0
+#error "LOG_TAMANHO_ANEL deve ser potência de 2"
+#endif
+
+// entrada do anel: 24 bytes
+typedef struct {
+    uint32_t tempo_us;                  // timestamp em microssegundos desde o boot
+    uint16_t evento;                    // nível (2 bits altos) e identificador do evento
+    volatile uint16_t seq;              // número de sequência, escrito por último (marca entrada completa)
+    int32_t arg[4];                     // argumentos do evento
+} log_entrada_t;
+
+// estado do anel (exposto apenas para o registro inline)
+extern log_entrada_t log_anel[LOG_TAMANHO_ANEL];
+extern volatile uint32_t log_cabeca;
+
+// registra uma entrada; seguro em IRQ (callbacks do lwIP) e no loop principal
+static inline void log_registrar(uint16_t nivel, uint16_t evento, int32_t a, int32_t b, int32_t c, int32_t d) {
+    uint32_t irq = save_and_disable_interrupts(); // o M0+ não tem CAS: reserva o índice com IRQs desligadas
+    uint32_t i = log_cabeca++;
+    restore_interrupts(irq);
+    log_entrada_t *e = &log_anel[i & (LOG_TAMANHO_ANEL - 1)];
+    e->tempo_us = time_us_32();
+    e->evento = (uint16_t)((nivel << 14) | evento);
+    e->arg[0] = a;
+    e->arg[1] = b;
+    e->arg[2] = c;
+    e->arg[3] = d;
+    __dmb();                            // garante que os dados estejam visíveis antes da sequência
+    e->seq = (uint16_t)(i + 1);
+}
+
+// macros de registro; abaixo do nível configurado viram nada
+#define LOG_ARGS_(ev, a, b, c, d, ...) (uint16_t)(ev), (int32_t)(a), (int32_t)(b), (int32_t)(c), (int32_t)(d)
+#define LOG_(nivel, ...) log_registrar((nivel), LOG_ARGS_(__VA_ARGS__, 0, 0, 0, 0))
+
+#if LOG_NIVEL >= LOG_NIVEL_ERRO
+#define LOG_ERRO(...) LOG_(LOG_NIVEL_ERRO, __VA_ARGS__)
+#else
+#define LOG_ERRO(...) ((void)0)
+#endif
+#if LOG_NIVEL >= LOG_NIVEL_AVISO
+#define LOG_AVISO(...) LOG_(LOG_NIVEL_AVISO, __VA_ARGS__)
+#else
+#define LOG_AVISO(...) ((void)0)
+#endif
+#if LOG_NIVEL >= LOG_NIVEL_INFO
+#define LOG_INFO(...) LOG_(LOG_NIVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+#if LOG_NIVEL >= LOG_NIVEL_DEBUG
+#define LOG_DEBUG(...) LOG_(LOG_NIVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+// formata (ou envia em binário) até 'maximo' entradas pendentes; retorna quantas processou
+uint32_t log_drenar(uint32_t maximo);
+
+// total de entradas sobrescritas antes de serem drenadas
+uint32_t log_sobrescritas(void);
+
+#endif
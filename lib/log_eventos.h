@@ -0,0 +1,61 @@
+// Tabela de eventos do log binário
+// Cada entrada: identificador e texto de formatação (até 4 argumentos inteiros %d, de 32 bits)
+// Usada pelo firmware para formatar no tempo ocioso e por tools/decodificar_log.py no host
+
+#ifndef LOG_EVENTOS_H
+#define LOG_EVENTOS_H
+
+#define LOG_EVENTOS(X) \
+    X(EV_BOTAO_JOYSTICK_COR,  "Botão Joystick: cor alterada para %d") \
+    X(EV_JOYSTICK_COMODO,     "Joystick: cômodo alterado para %d (passo %d)") \
+    X(EV_JOYSTICK_BRILHO,     "Joystick: brilho %d publicado (última latência %d x 100 us)") \
+    X(EV_BOTAO_A_PRESSIONADO, "Botão A: pressionado") \
+    X(EV_BOTAO_A_LONGO,       "Botão A: LEDs do cômodo desligados (pressão longa)") \
+    X(EV_BOTAO_A_COMODO,      "Botão A: cômodo alterado para %d") \
+    X(EV_BOTAO_B_ALARME,      "Botão B: alarme desligado") \
+    X(EV_EMERGENCIA_ATIVADA,  "Emergência ativada: temperatura %d centésimos de °C") \
+    X(EV_ALARME_CONFIRMADO,   "Alarme: emergência %d confirmada pelo broker (detecção -> PUBACK %d x 100 us, reenvios %d)") \
+    X(EV_ALARME_REENVIO,      "Alarme: sem PUBACK (erro %d), reenviando (reenvios %d)") \
+    X(EV_MQTT_CONECTANDO,     "Conectando ao broker MQTT (erro %d)") \
+    X(EV_MQTT_CONECTADO,      "Conectado ao broker MQTT em %d ms (sessão TLS oferecida: %d), heap %d B, pico do mbedTLS %d B") \
+    X(EV_MQTT_INSCRITO,       "Inscrito em %d tópicos") \
+    X(EV_MQTT_FALHA_CONEXAO,  "Falha na conexão MQTT: %d") \
+    X(EV_MQTT_TOPICO,         "Mensagem recebida no tópico %d (%d bytes)") \
+    X(EV_MQTT_PAYLOAD,        "Payload recebido: %d bytes, flags %d") \
+    X(EV_MQTT_PAYLOAD_GRANDE, "Payload descartado: %d bytes excede o buffer") \
+    X(EV_COMANDO,             "Comando %d aplicado (origem %d): cor=%d, cômodo=%d") \
+    X(EV_COMANDO_INVALIDO,    "Comando %d com valor inválido (origem %d, valor %d)") \
+    X(EV_MQTT_DESCONECTADO,   "Não conectado ao broker, pulando publicação %d") \
+    X(EV_MQTT_RECUSADA,       "Publicação recusada pelo lwIP (erro %d), máscara de estados pendentes %d") \
+    X(EV_SENSOR_LOTE,         "Sensores: lote com %d leituras (%d bytes)") \
+    X(EV_REGRA_DISPARADA,     "Regra %d disparada: ação %d, valor %d centésimos") \
+    X(EV_REGRAS_CARREGADAS,   "Regras: %d carregadas (-1 = inválidas, mantidas as anteriores)") \
+    X(EV_KV_INICIADO,         "Flash KV: dados válidos=%d, %d lotes lidos, %d descartados, estado restaurado=%d") \
+    X(EV_CONFIG_ALTERADA,     "Configuração %d gravada (-1 = inválida); vale após reiniciar") \
+    X(EV_CENA,                "Cena aplicada (origem %d): LED=%d, cor=%d, cômodo=%d") \
+    X(EV_CENA_INVALIDA,       "Cena inválida (origem %d, %d bytes): nada aplicado") \
+    X(EV_CENA_DEFINIDA,       "Cena %d (-1 inválida, 0 gravada, 1 removida); %d cenas gravadas") \
+    X(EV_OTA_INICIADA,        "OTA: estado %d no boot (0 inativa, 1 em teste, 3 revertida), firmware de %d KB") \
+    X(EV_OTA_RECEBIDA,        "OTA: %d KB verificados em %d décimos de s (%d décimos de KB/s), RAM %d bytes; trocando slots") \
+    X(EV_OTA_CONFIRMADA,      "OTA: imagem nova de %d KB confirmada") \
+    X(EV_OTA_FALHA,           "OTA: falha na etapa %d (0 início, 1 bloco, 2 verificação), em %d KB") \
+    X(EV_HISTORICO_PEDIDO,    "Histórico: série %d, nível %d, %d intervalos pedidos, resposta de %d bytes") \
+    X(EV_PUB_ESTADOS,         "Estados publicados: LED=%d, Cor=%d, Cômodo=%d, Emergência=%d") \
+    X(EV_ENERGIA_MODO_PM,     "CYW43 em modo de energia %d (0 = desempenho, 1 = economia, 2 = agressivo)") \
+    X(EV_ENERGIA_CICLO,       "Ciclo ativo: %d centésimos de %%") \
+    X(EV_ENERGIA_DISPLAY,     "OLED em estado %d (0 = normal, 1 = escuro, 2 = apagado)") \
+    X(EV_UDP_LOTE,            "UDP: lote seq %d com %d comandos, %d aceitos") \
+    X(EV_UDP_DUPLICADO,       "UDP: seq %d repetida, reenviando resposta") \
+    X(EV_UDP_ANTIGO,          "UDP: seq %d anterior à última (%d), lote ignorado") \
+    X(EV_UDP_INVALIDO,        "UDP: datagrama inválido (%d bytes)") \
+    X(EV_GATEWAY_PUBLICADO,   "Gateway: consolidado com %d nós (%d online), %d bytes")
+
+// enumeração gerada a partir da tabela
+typedef enum {
+#define LOG_EVENTO_ENUM(id, fmt) id,
+    LOG_EVENTOS(LOG_EVENTO_ENUM)
+#undef LOG_EVENTO_ENUM
+    EV_TOTAL
+} log_evento_t;
+
+#endif
@@ -0,0 +1,294 @@
+// Atualização de firmware pela rede em dois slots (A/B)
+
+#include <string.h>
+#include "ota.h"
+
+#define OTA_MAGICO   0x3241544Fu        // "OTA2"
+#define OTA_REGISTRO_MAX 256            // maior página suportada para os registros
+
+// registro de metadados (um por página; mesmo layout no host e no RP2040, ambos little-endian)
+typedef struct {
+    uint32_t magico;
+    uint32_t sequencia;                 // o maior válido é o estado atual
+    uint32_t estado;                    // OtaEstado
+    uint32_t tamanho_novo;              // imagem que foi para A na troca
+    uint32_t tamanho_anterior;          // imagem que foi para B (volta na reversão)
+    uint32_t tentativas;                // reinícios em teste
+    uint32_t troca_setores;             // setores trocados (cobre a maior das duas imagens)
+    uint32_t troca_passo;               // OTA_TROCANDO: etapa em andamento (setor * 3 + etapa)
+    uint32_t troca_destino;             // estado gravado ao fim da troca (em teste ou revertida)
+    uint8_t sha256[SHA256_TAMANHO];     // resumo da imagem nova
+    uint8_t verificacao[8];             // início do SHA-256 dos campos acima (página incompleta = inválida)
+} OtaRegistro;
+
+static const OtaFlash *flash;
+static uint32_t tamanho_execucao;       // imagem em execução (vai para B na troca)
+static OtaRegistro atual;               // último registro válido
+static uint32_t setor_meta;             // setor de metadados com o registro atual (0 ou 1)
+static uint32_t proxima_pagina;         // próxima página livre nesse setor
+
+// recepção: só o setor em montagem fica em RAM; a troca usa o mesmo buffer para copiar um setor
+static uint8_t rascunho[OTA_SETOR_MAX];
+static Sha256 resumo;
+static uint8_t esperado[SHA256_TAMANHO];
+static uint32_t tamanho, recebidos, inicio_ms;
+static bool recebendo;
+
+static bool troca_agendada;
+static uint32_t troca_em;
+static bool em_teste;
+static uint32_t teste_inicio;
+
+static OtaEstatisticas estatisticas;
+
+static void ota_verificacao(const OtaRegistro *r, uint8_t saida[8]) {
+    uint8_t h[SHA256_TAMANHO];
+    Sha256 ctx;
+    sha256_iniciar(&ctx);
+    sha256_atualizar(&ctx, r, offsetof(OtaRegistro, verificacao));
+    sha256_finalizar(&ctx, h);
+    memcpy(saida, h, 8);
+}
+
+static bool ota_apagado(const uint8_t *dados, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        if (dados[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+// procura o registro de maior sequência nos dois setores de metadados e a primeira página livre
+// do setor que o contém
+static void ota_ler_meta(void) {
+    uint32_t paginas = flash->tamanho_setor / flash->tamanho_pagina;
+    uint32_t livre[2];
+    memset(&atual, 0, sizeof(atual));
+    atual.estado = OTA_INATIVA;
+    setor_meta = 0;
+    for (uint32_t s = 0; s < 2; s++) {
+        const uint8_t *meta = flash->mapa(flash->meta + s * flash->tamanho_setor);
+        livre[s] = paginas;
+        for (uint32_t p = 0; p < paginas; p++) {
+            const uint8_t *pagina = meta + p * flash->tamanho_pagina;
+            if (ota_apagado(pagina, sizeof(OtaRegistro))) { // registros são anexados em ordem: o resto está livre
+                livre[s] = p;
+                break;
+            }
+            OtaRegistro r;
+            uint8_t verificacao[8];
+            memcpy(&r, pagina, sizeof(r));
+            ota_verificacao(&r, verificacao);
+            if (r.magico != OTA_MAGICO || memcmp(verificacao, r.verificacao, 8) != 0) continue; // gravação interrompida
+            if (atual.magico != OTA_MAGICO || r.sequencia > atual.sequencia) {
+                atual = r;
+                setor_meta = s;
+            }
+        }
+    }
+    proxima_pagina = livre[setor_meta];
+}
+
+// anexa um registro com o novo estado. Com o setor cheio, o registro vai para a página 0 do outro
+// e só depois o cheio é apagado: uma queda em qualquer ponto deixa um registro válido na flash
+static bool ota_gravar_meta(OtaEstado estado) {
+    atual.magico = OTA_MAGICO;
+    atual.sequencia++;
+    atual.estado = estado;
+    ota_verificacao(&atual, atual.verificacao);
+    uint8_t pagina[OTA_REGISTRO_MAX];
+    memset(pagina, 0xFF, flash->tamanho_pagina);
+    memcpy(pagina, &atual, sizeof(atual));
+    if (proxima_pagina < flash->tamanho_setor / flash->tamanho_pagina) {
+        return flash->gravar(flash->meta + setor_meta * flash->tamanho_setor + proxima_pagina++ * flash->tamanho_pagina,
+                             pagina, flash->tamanho_pagina);
+    }
+    uint32_t cheio = flash->meta + setor_meta * flash->tamanho_setor;
+    uint32_t outro = flash->meta + (setor_meta ^ 1) * flash->tamanho_setor;
+    // normalmente já apagado; sobra de uma rotação interrompida antes de apagar o antigo
+    if (!ota_apagado(flash->mapa(outro), flash->tamanho_setor) && !flash->apagar(outro)) return false;
+    if (!flash->gravar(outro, pagina, flash->tamanho_pagina)) return false;
+    setor_meta ^= 1;
+    proxima_pagina = 1;
+    flash->apagar(cheio);               // se falhar, é apagado na próxima rotação
+    return true;
+}
+
+// registra a troca de A e B cobrindo a maior das duas imagens e reinicia: o estágio de boot a executa
+static void ota_trocar(OtaEstado destino) {
+    uint32_t n = atual.tamanho_novo > atual.tamanho_anterior ? atual.tamanho_novo : atual.tamanho_anterior;
+    atual.troca_setores = (n + flash->tamanho_setor - 1) / flash->tamanho_setor;
+    atual.troca_passo = 0;
+    atual.troca_destino = destino;
+    if (ota_gravar_meta(OTA_TROCANDO)) flash->reiniciar(); // no RP2040 não retorna
+}
+
+static void ota_reverter(void) {
+    em_teste = false;
+    ota_trocar(OTA_REVERTIDA);
+}
+
+// copia um setor passando pela RAM (a origem pode não ser legível enquanto a flash grava)
+static bool ota_copiar_setor(uint32_t origem, uint32_t destino) {
+    memcpy(rascunho, flash->mapa(origem), flash->tamanho_setor);
+    return flash->apagar(destino) && flash->gravar(destino, rascunho, flash->tamanho_setor);
+}
+
+// Cada setor i é trocado em três etapas: B[i] -> rascunho, A[i] -> B[i], rascunho -> A[i]. O passo
+// em andamento é registrado antes de cada etapa, e cada uma só apaga um setor cujo conteúdo já tem
+// cópia em outro lugar: após uma queda, refazer a etapa registrada dá o mesmo resultado
+bool ota_retomar(const OtaFlash *f) {
+    flash = f;
+    ota_ler_meta();
+    if (atual.estado != OTA_TROCANDO) return true;
+    if (flash->tamanho_setor > OTA_SETOR_MAX) return false;
+    while (atual.troca_passo < 3 * atual.troca_setores) {
+        uint32_t d = atual.troca_passo / 3 * flash->tamanho_setor;
+        bool ok;
+        switch (atual.troca_passo % 3) {
+            case 0: ok = ota_copiar_setor(flash->slot_b + d, flash->rascunho); break;
+            case 1: ok = ota_copiar_setor(flash->slot_a + d, flash->slot_b + d); break;
+            default: ok = ota_copiar_setor(flash->rascunho, flash->slot_a + d); break;
+        }
+        if (!ok) return false;
+        if (++atual.troca_passo < 3 * atual.troca_setores && !ota_gravar_meta(OTA_TROCANDO)) return false;
+    }
+    return ota_gravar_meta((OtaEstado)atual.troca_destino);
+}
+
+OtaEstado ota_iniciar(const OtaFlash *f, uint32_t tamanho_atual, uint32_t agora) {
+    flash = f;
+    tamanho_execucao = tamanho_atual;
+    recebendo = troca_agendada = em_teste = false;
+    estatisticas.ram = sizeof(rascunho) + sizeof(resumo);
+    ota_ler_meta();
+    switch (atual.estado) {
+        case OTA_EM_TESTE:              // reinício sem confirmação
+            if (++atual.tentativas > OTA_TENTATIVAS_MAX) {
+                ota_reverter();         // no RP2040 não retorna
+                return OTA_REVERTIDA;
+            }
+            ota_gravar_meta(OTA_EM_TESTE);
+            em_teste = true;
+            teste_inicio = agora;
+            return OTA_EM_TESTE;
+        case OTA_REVERTIDA:             // informa uma vez e volta ao repouso
+            ota_gravar_meta(OTA_INATIVA);
+            return OTA_REVERTIDA;
+        case OTA_TROCANDO:              // o estágio de boot não terminou a troca: tenta de novo
+            flash->reiniciar();         // no RP2040 não retorna
+            return OTA_TROCANDO;
+        default:
+            return OTA_INATIVA;
+    }
+}
+
+bool ota_comecar(uint32_t n, const uint8_t sha256[SHA256_TAMANHO], uint32_t agora) {
+    if (!flash || n == 0 || n > flash->tamanho_slot || tamanho_execucao > flash->tamanho_slot) return false;
+    if (em_teste || troca_agendada) return false; // a imagem atual ainda não foi confirmada
+    if (flash->tamanho_setor > OTA_SETOR_MAX) return false;
+    sha256_iniciar(&resumo);
+    memcpy(esperado, sha256, SHA256_TAMANHO);
+    tamanho = n;
+    recebidos = 0;
+    inicio_ms = agora;
+    estatisticas.setores = 0;
+    recebendo = true;
+    return true;
+}
+
+// grava o setor montado (o último é completado com 0xFF)
+static bool ota_gravar_setor(void) {
+    uint32_t usados = recebidos % flash->tamanho_setor;
+    uint32_t inicio = recebidos - (usados ? usados : flash->tamanho_setor);
+    if (usados) memset(rascunho + usados, 0xFF, flash->tamanho_setor - usados);
+    if (!flash->apagar(flash->slot_b + inicio)) return false;
+    if (!flash->gravar(flash->slot_b + inicio, rascunho, flash->tamanho_setor)) return false;
+    estatisticas.setores++;
+    return true;
+}
+
+int32_t ota_bloco(uint32_t deslocamento, const uint8_t *dados, size_t n) {
+    if (!recebendo) return -1;
+    if (deslocamento > recebidos || deslocamento + n <= recebidos) return (int32_t)recebidos; // lacuna ou repetido
+    uint32_t pular = recebidos - deslocamento;
+    dados += pular;
+    n -= pular;
+    if (n > tamanho - recebidos) {      // maior que o anunciado
+        recebendo = false;
+        return -1;
+    }
+    while (n) {
+        uint32_t no_setor = recebidos % flash->tamanho_setor;
+        uint32_t parte = flash->tamanho_setor - no_setor;
+        if (parte > n) parte = (uint32_t)n;
+        memcpy(rascunho + no_setor, dados, parte);
+        sha256_atualizar(&resumo, dados, parte);
+        recebidos += parte;
+        dados += parte;
+        n -= parte;
+        if ((recebidos % flash->tamanho_setor == 0 || recebidos == tamanho) && !ota_gravar_setor()) {
+            recebendo = false;
+            return -1;
+        }
+    }
+    return (int32_t)recebidos;
+}
+
+bool ota_concluir(uint32_t agora) {
+    if (!recebendo || recebidos != tamanho) return false;
+    recebendo = false;
+    uint8_t calculado[SHA256_TAMANHO];
+    sha256_finalizar(&resumo, calculado);
+    if (memcmp(calculado, esperado, SHA256_TAMANHO) != 0) return false; // dados recebidos corrompidos
+    sha256_iniciar(&resumo);            // relê o slot B: confirma o que ficou gravado
+    sha256_atualizar(&resumo, flash->mapa(flash->slot_b), tamanho);
+    sha256_finalizar(&resumo, calculado);
+    if (memcmp(calculado, esperado, SHA256_TAMANHO) != 0) return false;
+    estatisticas.bytes = tamanho;
+    estatisticas.duracao_ms = agora - inicio_ms;
+    troca_agendada = true;
+    troca_em = agora;
+    return true;
+}
+
+bool ota_confirmar(void) {
+    if (!em_teste) return false;
+    em_teste = false;
+    return ota_gravar_meta(OTA_CONFIRMADA);
+}
+
+bool ota_em_teste(void) {
+    return em_teste;
+}
+
+void ota_manter(uint32_t agora) {
+    if (troca_agendada && agora - troca_em >= OTA_ATRASO_TROCA_MS) {
+        troca_agendada = false;
+        atual.tamanho_novo = tamanho;
+        atual.tamanho_anterior = tamanho_execucao;
+        atual.tentativas = 0;
+        memcpy(atual.sha256, esperado, SHA256_TAMANHO);
+        ota_trocar(OTA_EM_TESTE);
+    }
+    if (em_teste && agora - teste_inicio >= OTA_PRAZO_CONFIRMACAO_MS) {
+        ota_reverter();
+    }
+}
+
+uint32_t ota_espera(uint32_t agora) {
+    uint32_t espera = UINT32_MAX;
+    if (troca_agendada) {
+        uint32_t decorrido = agora - troca_em;
+        espera = decorrido >= OTA_ATRASO_TROCA_MS ? 0 : OTA_ATRASO_TROCA_MS - decorrido;
+    }
+    if (em_teste) {
+        uint32_t decorrido = agora - teste_inicio;
+        uint32_t prazo = decorrido >= OTA_PRAZO_CONFIRMACAO_MS ? 0 : OTA_PRAZO_CONFIRMACAO_MS - decorrido;
+        if (prazo < espera) espera = prazo;
+    }
+    return espera;
+}
+
+const OtaEstatisticas *ota_estatisticas(void) {
+    return &estatisticas;
+}
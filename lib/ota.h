@@ -0,0 +1,82 @@
+// Atualização de firmware pela rede em dois slots (A/B)
+//
+// A imagem chega em blocos e é gravada no slot B setor a setor, sem guardar a imagem em RAM
+// (só o setor em montagem). Ao final o SHA-256 é conferido sobre os dados recebidos e sobre o que
+// ficou gravado; então a troca de A e B é registrada e o painel reinicia. O estágio de boot, fora
+// dos slots, executa a troca com ota_retomar() e salta para a imagem nova em A, com a anterior
+// guardada em B. Enquanto a nova não chamar ota_confirmar(), cada reinício
+// conta uma tentativa; após OTA_TENTATIVAS_MAX reinícios ou OTA_PRAZO_CONFIRMACAO_MS sem
+// confirmação, a troca é desfeita.
+//
+// O estado da troca fica em dois setores de metadados que se alternam (um registro por página, o
+// de maior sequência vale): quando um enche, o registro seguinte vai para o outro antes de o
+// primeiro ser apagado, de modo que sempre há um registro válido na flash.
+// A troca passa por um setor de rascunho na flash e registra o progresso nos metadados antes de
+// cada etapa, então uma queda de energia no meio dela só faz o estágio de boot continuar de onde
+// parou no próximo boot.
+// Código C puro (sem SDK): a flash é acessada pelas operações em OtaFlash.
+
+#ifndef OTA_H
+#define OTA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sha256.h"
+
+#define OTA_SETOR_MAX             4096  // maior setor suportado (buffer em RAM)
+#define OTA_BLOCO_MAX             1024  // maior bloco aceito por ota_bloco
+#define OTA_TENTATIVAS_MAX        3     // reinícios sem confirmação antes de reverter
+#define OTA_PRAZO_CONFIRMACAO_MS  120000 // tempo para a imagem nova confirmar saúde
+#define OTA_ATRASO_TROCA_MS       1000  // entre a verificação e a troca (tempo para publicar o status)
+
+typedef struct {
+    uint32_t slot_a;                    // deslocamento do firmware em execução
+    uint32_t slot_b;                    // deslocamento da área de recepção (mesmo tamanho)
+    uint32_t tamanho_slot;
+    uint32_t meta;                      // dois setores de metadados consecutivos
+    uint32_t rascunho;                  // setor de rascunho da troca
+    uint32_t tamanho_setor;             // unidade de apagamento (até OTA_SETOR_MAX)
+    uint32_t tamanho_pagina;            // unidade de gravação
+    const uint8_t *(*mapa)(uint32_t deslocamento); // leitura direta (XIP no RP2040)
+    bool (*apagar)(uint32_t deslocamento); // apaga um setor
+    bool (*gravar)(uint32_t deslocamento, const uint8_t *dados, size_t tamanho); // múltiplo de páginas
+    void (*reiniciar)(void);            // reinicia pelo estágio de boot, que faz a troca; no RP2040 não retorna
+} OtaFlash;
+
+typedef enum {
+    OTA_INATIVA,                        // nenhuma atualização em andamento
+    OTA_EM_TESTE,                       // imagem nova em A aguardando ota_confirmar()
+    OTA_CONFIRMADA,                     // imagem nova confirmada
+    OTA_REVERTIDA,                      // imagem nova rejeitada: a anterior voltou para A
+    OTA_TROCANDO,                       // troca de A e B registrada, feita pelo estágio de boot
+} OtaEstado;
+
+typedef struct {
+    uint32_t bytes;                     // tamanho da última imagem recebida
+    uint32_t duracao_ms;                // do ota_comecar à verificação
+    uint32_t setores;                   // setores gravados no slot B
+    uint32_t ram;                       // bytes de RAM usados pela recepção e pela troca
+} OtaEstatisticas;
+
+// estágio de boot: executa a troca registrada (ou retoma uma interrompida) e grava o estado que
+// ela leva. Retorna false se a flash falhou no meio: A não tem uma imagem inteira e o boot deve
+// tentar de novo
+bool ota_retomar(const OtaFlash *flash);
+
+// lê os metadados; conta uma tentativa se a imagem está em teste (e reverte se esgotou).
+// tamanho_atual: bytes da imagem em execução (guardados para a reversão)
+OtaEstado ota_iniciar(const OtaFlash *flash, uint32_t tamanho_atual, uint32_t agora);
+
+bool ota_comecar(uint32_t tamanho, const uint8_t sha256[SHA256_TAMANHO], uint32_t agora); // nova recepção
+// grava um bloco; retorna o próximo deslocamento esperado (blocos repetidos ou fora de ordem não
+// avançam) ou -1 se a recepção falhou
+int32_t ota_bloco(uint32_t deslocamento, const uint8_t *dados, size_t n);
+bool ota_concluir(uint32_t agora);      // confere o SHA-256 e agenda a troca
+bool ota_confirmar(void);               // imagem em teste está saudável; true se confirmou agora
+bool ota_em_teste(void);
+void ota_manter(uint32_t agora);        // executa a troca agendada e o prazo de confirmação
+uint32_t ota_espera(uint32_t agora);    // ms até o próximo prazo (UINT32_MAX se nenhum)
+const OtaEstatisticas *ota_estatisticas(void);
+
+#endif
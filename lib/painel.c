@@ -0,0 +1,92 @@
+// Estado do painel e tratamento de comandos
+
+#include <stdio.h>
+#include <string.h>
+#include "painel.h"
+
+EstadoPainel painel = {                 // estado inicial: vermelho, quarto 1, desligado, sem emergência
+    .cor = VERMELHO,
+    .comodo = QUARTO_1,
+    .led_ligado = false,
+    .emergencia = false,
+    .brilho = 100,
+};
+
+const char *const painel_nomes_comando[COMANDO_TOTAL] = { "led", "cor", "comodo", "alarme" };
+
+static const char *const nomes_cor[COR_TOTAL] = { "Vermelho", "Verde", "Azul", "Amarelo", "Ciano", "Lilas" };
+static const char *const nomes_comodo[COMODO_TOTAL] = { "Quarto1", "Quarto2", "Cozinha", "Banheiro" };
+
+// procura um nome numa tabela; retorna o índice ou -1
+static int buscar_nome(const char *const *tabela, int total, const char *nome) {
+    for (int i = 0; i < total; i++) {
+        if (strcmp(tabela[i], nome) == 0) return i;
+    }
+    return -1;
+}
+
+int painel_valor_comando(TipoComando tipo, const char *texto) {
+    switch (tipo) {
+        case COMANDO_LED:                  // "On" / "Off"
+            if (strcmp(texto, "On") == 0) return 1;
+            if (strcmp(texto, "Off") == 0) return 0;
+            return -1;
+        case COMANDO_COR:                  // nome da cor
+            return buscar_nome(nomes_cor, COR_TOTAL, texto);
+        case COMANDO_COMODO:               // nome do cômodo
+            return buscar_nome(nomes_comodo, COMODO_TOTAL, texto);
+        case COMANDO_ALARME:               // apenas "Off" (a emergência só é ativada pela temperatura)
+            return strcmp(texto, "Off") == 0 ? 0 : -1;
+        default:
+            return -1;
+    }
+}
+
+bool painel_aplicar_valor(TipoComando tipo, int valor) {
+    switch (tipo) {
+        case COMANDO_LED:
+            if (valor != 0 && valor != 1) return false;
+            painel.led_ligado = valor == 1;
+            return true;
+        case COMANDO_COR:
+            if (valor < 0 || valor >= COR_TOTAL) return false;
+            painel.cor = (Cor)valor;
+            return true;
+        case COMANDO_COMODO:               // selecionar um cômodo também liga os LEDs
+            if (valor < 0 || valor >= COMODO_TOTAL) return false;
+            painel.comodo = (Comodo)valor;
+            painel.led_ligado = true;
+            return true;
+        case COMANDO_ALARME:
+            if (valor != 0) return false;
+            painel.emergencia = false;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool painel_aplicar_comando(TipoComando tipo, const char *valor) {
+    return painel_aplicar_valor(tipo, painel_valor_comando(tipo, valor));
+}
+
+TipoComando painel_comando_por_nome(const char *nome) {
+    int indice = buscar_nome(painel_nomes_comando, COMANDO_TOTAL, nome);
+    return indice < 0 ? COMANDO_TOTAL : (TipoComando)indice;
+}
+
+const char *painel_nome_cor(Cor cor) {
+    return cor < COR_TOTAL ? nomes_cor[cor] : "?";
+}
+
+const char *painel_nome_comodo(Comodo comodo) {
+    return comodo < COMODO_TOTAL ? nomes_comodo[comodo] : "?";
+}
+
+size_t painel_estado_json(char *buf, size_t tamanho) {
+    int n = snprintf(buf, tamanho, "{\"led\":%s,\"cor\":\"%s\",\"comodo\":\"%s\",\"emergencia\":%s,\"brilho\":%u}",
+                     painel.led_ligado ? "true" : "false", painel_nome_cor(painel.cor),
+                     painel_nome_comodo(painel.comodo), painel.emergencia ? "true" : "false", painel.brilho);
+    if (n < 0) return 0;
+    return (size_t)n < tamanho ? (size_t)n : tamanho - 1;
+}
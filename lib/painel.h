@@ -0,0 +1,51 @@
+// Estado do painel e tratamento de comandos
+// Código C puro (sem SDK), compartilhado por todos os canais de controle (MQTT, HTTP, ...)
+
+#ifndef PAINEL_H
+#define PAINEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum { VERMELHO, VERDE, AZUL, AMARELO, CIANO, LILAS, COR_TOTAL } Cor; // cores do LED RGB e matriz
+typedef enum { QUARTO_1, QUARTO_2, COZINHA, BANHEIRO, COMODO_TOTAL } Comodo;  // os 4 cômodos controlados
+
+// comandos aceitos pelo painel (mesma ordem dos tópicos casa/comando/*)
+typedef enum { COMANDO_LED, COMANDO_COR, COMANDO_COMODO, COMANDO_ALARME, COMANDO_TOTAL } TipoComando;
+
+// canais de origem de um comando (registrados no log)
+typedef enum { ORIGEM_MQTT, ORIGEM_HTTP, ORIGEM_BOTAO, ORIGEM_UDP, ORIGEM_REGRA } OrigemComando;
+
+typedef struct {
+    Cor cor;                            // cor do LED RGB e do cômodo atual na matriz
+    Comodo comodo;                      // cômodo selecionado
+    bool led_ligado;                    // LED RGB e LEDs do cômodo ligados
+    bool emergencia;                    // modo de emergência (alarme)
+    uint8_t brilho;                     // brilho do LED RGB e do cômodo na matriz (%; joystick)
+} EstadoPainel;
+
+extern EstadoPainel painel;             // estado único do painel
+
+extern const char *const painel_nomes_comando[COMANDO_TOTAL]; // sufixos dos tópicos ("led", "cor", ...)
+
+// converte o valor textual de um comando ("On", "Azul", "Cozinha", ...) no valor numérico; -1 se inválido
+int painel_valor_comando(TipoComando tipo, const char *texto);
+
+// aplica um comando com valor numérico (LED: 0/1, cor/cômodo: índice, alarme: 0 = desligar)
+// retorna true se o valor é válido (estado deve ser publicado)
+bool painel_aplicar_valor(TipoComando tipo, int valor);
+
+// aplica um comando textual; retorna true se o valor foi reconhecido
+bool painel_aplicar_comando(TipoComando tipo, const char *valor);
+
+// procura um comando pelo nome ("led", "cor", "comodo", "alarme"); retorna COMANDO_TOTAL se não existir
+TipoComando painel_comando_por_nome(const char *nome);
+
+const char *painel_nome_cor(Cor cor);         // nome usado nos tópicos ("Vermelho", ...)
+const char *painel_nome_comodo(Comodo comodo); // nome usado nos tópicos ("Quarto1", ...)
+
+// serializa o estado em JSON; retorna o número de caracteres escritos (sem o terminador)
+size_t painel_estado_json(char *buf, size_t tamanho);
+
+#endif
@@ -0,0 +1,225 @@
+// Motor de regras do painel
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "regras.h"
+
+#define REGRAS_TOKENS 12                // maior número de palavras numa regra
+
+typedef enum { REGRA_MAIOR, REGRA_MENOR, REGRA_HORARIO } TipoRegra;
+
+typedef struct {
+    uint8_t tipo;                       // TipoRegra
+    uint8_t sensor;                     // sensor avaliado (limiar)
+    bool ativa;                         // condição satisfeita (aguardando rearme / dentro da janela)
+    uint8_t origem;                     // posição da regra no texto enviado
+    float limite;                       // dispara ao cruzar
+    float rearme;                       // limite deslocado pela histerese
+    uint16_t inicio, fim;               // janela de horário, em minutos do dia
+    RegraAcao acao;
+} Regra;
+
+typedef struct {
+    Regra regras[REGRAS_MAX];           // limiares agrupados por sensor, depois os horários
+    uint8_t total;
+    uint8_t inicio[REGRAS_SENSORES + 1]; // regras do sensor s: [inicio[s], inicio[s + 1])
+} TabelaRegras;
+
+static TabelaRegras tabela;             // regras ativas
+static TabelaRegras nova;               // compilação em andamento
+
+// separa uma linha em palavras (modifica a linha)
+static int regras_tokens(char *linha, char *tokens[REGRAS_TOKENS]) {
+    int n = 0;
+    for (char *p = strtok(linha, " \t\r"); p; p = strtok(NULL, " \t\r")) {
+        if (n == REGRAS_TOKENS) return -1;
+        tokens[n++] = p;
+    }
+    return n;
+}
+
+static bool regras_numero(const char *texto, float *valor) {
+    char *fim;
+    *valor = strtof(texto, &fim);
+    return fim != texto && *fim == '\0';
+}
+
+static bool regras_hora(const char *texto, uint16_t *minuto) {
+    unsigned h, m;
+    char resto;
+    if (sscanf(texto, "%u:%u%c", &h, &m, &resto) != 2 || h > 23 || m > 59) return false;
+    *minuto = (uint16_t)(h * 60 + m);
+    return true;
+}
+
+// interpreta a ação a partir de tokens[0]; retorna NULL ou o motivo do erro
+static const char *regras_acao(char **tokens, int n, RegraAcao *acao) {
+    memset(acao, 0, sizeof(*acao));
+    if (n == 1 && strcmp(tokens[0], "alarme") == 0) {
+        acao->tipo = REGRA_ACAO_ALARME;
+        return NULL;
+    }
+    if (n != 2) return "acao invalida";
+    if (strcmp(tokens[0], "publicar") == 0) {
+        if (strlen(tokens[1]) >= REGRAS_MENSAGEM) return "mensagem longa";
+        acao->tipo = REGRA_ACAO_PUBLICAR;
+        strcpy(acao->mensagem, tokens[1]);
+        return NULL;
+    }
+    TipoComando comando = painel_comando_por_nome(tokens[0]);
+    if (comando == COMANDO_TOTAL || comando == COMANDO_ALARME) return "acao desconhecida";
+    int valor = painel_valor_comando(comando, tokens[1]);
+    if (valor < 0) return "valor invalido";
+    acao->tipo = REGRA_ACAO_COMANDO;
+    acao->comando = (uint8_t)comando;
+    acao->valor = (int16_t)valor;
+    return NULL;
+}
+
+// compila uma linha em 'regra'; retorna NULL ou o motivo do erro
+static const char *regras_linha(char *linha, regras_sensor_t sensor_por_nome, Regra *regra) {
+    char *t[REGRAS_TOKENS];
+    int n = regras_tokens(linha, t);
+    if (n < 0) return "regra longa";
+    memset(regra, 0, sizeof(*regra));
+    if (n >= 6 && strcmp(t[0], "se") == 0) {
+        int s = sensor_por_nome ? sensor_por_nome(t[1]) : -1;
+        if (s < 0 || s >= REGRAS_SENSORES) return "sensor desconhecido";
+        regra->sensor = (uint8_t)s;
+        if (strcmp(t[2], ">") == 0) regra->tipo = REGRA_MAIOR;
+        else if (strcmp(t[2], "<") == 0) regra->tipo = REGRA_MENOR;
+        else return "operador invalido";
+        if (!regras_numero(t[3], &regra->limite)) return "limite invalido";
+        float histerese = 0.0f;
+        int i = 4;
+        if (strcmp(t[i], "histerese") == 0) {
+            if (i + 1 >= n || !regras_numero(t[i + 1], &histerese) || histerese < 0.0f) return "histerese invalida";
+            i += 2;
+        }
+        if (i >= n || strcmp(t[i], "entao") != 0) return "falta 'entao'";
+        regra->rearme = regra->tipo == REGRA_MAIOR ? regra->limite - histerese : regra->limite + histerese;
+        return regras_acao(&t[i + 1], n - i - 1, &regra->acao);
+    }
+    if (n >= 6 && strcmp(t[0], "das") == 0 && strcmp(t[2], "as") == 0 && strcmp(t[4], "entao") == 0) {
+        regra->tipo = REGRA_HORARIO;
+        if (!regras_hora(t[1], &regra->inicio) || !regras_hora(t[3], &regra->fim)) return "horario invalido";
+        if (regra->inicio == regra->fim) return "janela vazia";
+        return regras_acao(&t[5], n - 5, &regra->acao);
+    }
+    return "sintaxe";
+}
+
+// mesma condição de disparo: sensor, comparação e limite (ou janela de horário); histerese e ação podem mudar
+static bool regras_mesma_condicao(const Regra *a, const Regra *b) {
+    if (a->tipo != b->tipo) return false;
+    if (a->tipo == REGRA_HORARIO) return a->inicio == b->inicio && a->fim == b->fim;
+    return a->sensor == b->sensor && a->limite == b->limite;
+}
+
+int regras_carregar(const char *texto, regras_sensor_t sensor_por_nome, char *erro, size_t tamanho_erro) {
+    static char copia[REGRAS_TEXTO_MAX];
+    static Regra lidas[REGRAS_MAX];
+    if (strlen(texto) >= sizeof(copia)) {
+        snprintf(erro, tamanho_erro, "texto longo");
+        return -1;
+    }
+    strcpy(copia, texto);
+
+    // 1) valida e compila cada linha
+    uint8_t total = 0;
+    int numero = 0;
+    char *proxima = copia;
+    while (proxima) {
+        char *linha = proxima;
+        proxima = strpbrk(linha, "\n;");
+        if (proxima) *proxima++ = '\0';
+        numero++;
+        if (strspn(linha, " \t\r") == strlen(linha)) continue; // linha vazia
+        if (total == REGRAS_MAX) {
+            snprintf(erro, tamanho_erro, "linha %d: mais de %d regras", numero, REGRAS_MAX);
+            return -1;
+        }
+        const char *motivo = regras_linha(linha, sensor_por_nome, &lidas[total]);
+        if (motivo) {
+            snprintf(erro, tamanho_erro, "linha %d: %s", numero, motivo);
+            return -1;
+        }
+        lidas[total].origem = total;
+        total++;
+    }
+
+    // 2) agrupa por sensor (ordenação por contagem) e deixa os horários no fim
+    memset(&nova, 0, sizeof(nova));
+    uint8_t contagem[REGRAS_SENSORES + 1] = { 0 };
+    for (uint8_t i = 0; i < total; i++) {
+        contagem[lidas[i].tipo == REGRA_HORARIO ? REGRAS_SENSORES : lidas[i].sensor]++;
+    }
+    for (int s = 0; s < REGRAS_SENSORES; s++) nova.inicio[s + 1] = nova.inicio[s] + contagem[s];
+    uint8_t posicao[REGRAS_SENSORES + 1];
+    memcpy(posicao, nova.inicio, sizeof(posicao));
+    for (uint8_t i = 0; i < total; i++) {
+        uint8_t grupo = lidas[i].tipo == REGRA_HORARIO ? REGRAS_SENSORES : lidas[i].sensor;
+        nova.regras[posicao[grupo]++] = lidas[i];
+    }
+    nova.total = total;
+
+    // 3) regras que continuam iguais mantêm o estado: reenviar o texto não dispara de novo uma condição já
+    //    satisfeita (nem arma uma regra que aguarda o rearme)
+    for (uint8_t i = 0; i < nova.total; i++) {
+        for (uint8_t j = 0; j < tabela.total && !nova.regras[i].ativa; j++) {
+            nova.regras[i].ativa = tabela.regras[j].ativa && regras_mesma_condicao(&nova.regras[i], &tabela.regras[j]);
+        }
+    }
+    tabela = nova;
+    if (tamanho_erro) erro[0] = '\0';
+    return total;
+}
+
+void regras_avaliar(uint8_t sensor, float valor, regras_executar_t executar) {
+    if (sensor >= REGRAS_SENSORES) return;
+    Regra *r = &tabela.regras[tabela.inicio[sensor]];
+    Regra *fim = &tabela.regras[tabela.inicio[sensor + 1]];
+    for (; r < fim; r++) {
+        bool cruzou = r->tipo == REGRA_MAIOR ? valor > r->limite : valor < r->limite;
+        bool rearmou = r->tipo == REGRA_MAIOR ? valor < r->rearme : valor > r->rearme;
+        if (!r->ativa && cruzou) {
+            r->ativa = true;
+            if (executar) executar(r->origem, &r->acao, valor);
+        } else if (r->ativa && rearmou) {
+            r->ativa = false;
+        }
+    }
+}
+
+void regras_relogio(int minuto_do_dia, regras_executar_t executar) {
+    if (minuto_do_dia < 0) return;      // hora do dia ainda desconhecida
+    for (uint8_t i = tabela.inicio[REGRAS_SENSORES]; i < tabela.total; i++) {
+        Regra *r = &tabela.regras[i];
+        bool dentro = r->inicio < r->fim ? minuto_do_dia >= r->inicio && minuto_do_dia < r->fim
+                                         : minuto_do_dia >= r->inicio || minuto_do_dia < r->fim; // janela que cruza a meia-noite
+        if (dentro && !r->ativa && executar) executar(r->origem, &r->acao, (float)minuto_do_dia);
+        r->ativa = dentro;
+    }
+}
+
+uint8_t regras_total(void) {
+    return tabela.total;
+}
+
+uint8_t regras_do_sensor(uint8_t sensor) {
+    return sensor < REGRAS_SENSORES ? tabela.inicio[sensor + 1] - tabela.inicio[sensor] : 0;
+}
+
+float regras_margem(uint8_t sensor, float valor) {
+    float margem = FLT_MAX;
+    if (sensor >= REGRAS_SENSORES) return margem;
+    for (uint8_t i = tabela.inicio[sensor]; i < tabela.inicio[sensor + 1]; i++) {
+        const Regra *r = &tabela.regras[i];
+        float d = (r->ativa ? r->rearme : r->limite) - valor;
+        if (d < 0) d = -d;
+        if (d < margem) margem = d;
+    }
+    return margem;
+}
@@ -0,0 +1,52 @@
+// Motor de regras do painel
+// Regras em texto (enviadas por MQTT) são validadas e compiladas numa tabela plana,
+// agrupada por sensor: cada leitura avalia só as regras daquele sensor, sem interpretar texto.
+// Código C puro (sem SDK), compilado também no host (tools/host) para avaliar traces gravados.
+//
+// Uma regra por linha (ou separadas por ';'):
+//   se <sensor> <|> <limite> [histerese <h>] entao <ação>
+//   das HH:MM as HH:MM entao <ação>
+// Ações: alarme | led On|Off | cor <Cor> | comodo <Cômodo> | publicar <palavra>
+// Regras de limiar disparam ao cruzar o limite e rearmam quando o valor volta além da histerese;
+// regras de horário disparam ao entrar na janela.
+
+#ifndef REGRAS_H
+#define REGRAS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "painel.h"
+
+#define REGRAS_MAX         16           // regras ativas
+#define REGRAS_SENSORES    8            // sensores referenciáveis (índices do registro de sensores)
+#define REGRAS_TEXTO_MAX   512          // maior texto de regras aceito
+#define REGRAS_MENSAGEM    16           // maior palavra de 'publicar'
+
+typedef enum { REGRA_ACAO_COMANDO, REGRA_ACAO_ALARME, REGRA_ACAO_PUBLICAR } TipoAcaoRegra;
+
+typedef struct {
+    uint8_t tipo;                       // TipoAcaoRegra
+    uint8_t comando;                    // REGRA_ACAO_COMANDO: TipoComando
+    int16_t valor;                      // REGRA_ACAO_COMANDO: valor numérico do comando
+    char mensagem[REGRAS_MENSAGEM];     // REGRA_ACAO_PUBLICAR: payload
+} RegraAcao;
+
+typedef void (*regras_executar_t)(uint8_t regra, const RegraAcao *acao, float valor); // executa a ação de uma regra
+typedef int (*regras_sensor_t)(const char *nome);  // nome do sensor -> índice (-1 se não existe)
+
+// valida e compila o texto; só substitui as regras ativas se todas as linhas forem válidas.
+// Uma regra com a mesma condição de uma já disparada (sensor, comparação e limite, ou a mesma janela)
+// continua disparada: não executa a ação de novo ao recarregar.
+// retorna o número de regras ou -1 (com a linha e o motivo em 'erro')
+int regras_carregar(const char *texto, regras_sensor_t sensor_por_nome, char *erro, size_t tamanho_erro);
+
+void regras_avaliar(uint8_t sensor, float valor, regras_executar_t executar); // nova leitura de um sensor
+void regras_relogio(int minuto_do_dia, regras_executar_t executar); // minuto do dia (0-1439) para regras de horário
+uint8_t regras_total(void);             // regras ativas
+uint8_t regras_do_sensor(uint8_t sensor); // regras avaliadas a cada leitura do sensor
+// distância do valor à próxima transição das regras do sensor (limite das armadas, rearme das ativas);
+// FLT_MAX se o sensor não tem regras
+float regras_margem(uint8_t sensor, float valor);
+
+#endif
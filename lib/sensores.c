@@ -0,0 +1,179 @@
+// Registro de sensores e escalonador de leituras
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "sensores.h"
+#include "adc_amostragem.h"
+#include "historico.h"
+#include "log_binario.h"
+
+#define SENSORES_LOTE_MAX 160           // tamanho máximo de um payload de lote
+
+typedef struct {
+    const SensorConfig *config;
+    uint32_t proxima_ms;                // próxima leitura
+    float valor;                        // último valor lido
+    float publicar;                     // valor do próximo lote (leitura ou média do minuto)
+    bool valido;                        // já houve leitura com sucesso
+    bool vencido;                       // lido neste tick, aguardando publicação
+    int8_t serie;                       // série no histórico ou -1
+    bool agregado;                      // minuto fechado aguardando publicação em <tópico>/agregado
+    HistoricoBalde minuto;              // último minuto fechado
+    uint32_t leituras;                  // total de leituras
+    uint64_t custo_total_us;            // soma do custo de leitura + conversão
+    uint32_t custo_max_us;              // pior custo observado
+} Sensor;
+
+static Sensor sensores[SENSORES_MAX];
+static int total_sensores = 0;
+static sensores_observador_t observador = NULL; // recebe todas as leituras
+
+int sensores_registrar(const SensorConfig *config) {
+    if (total_sensores >= SENSORES_MAX) return -1;
+    Sensor *s = &sensores[total_sensores];
+    memset(s, 0, sizeof(*s));
+    s->config = config;
+    s->serie = config->historico ? (int8_t)historico_criar(config->nome) : -1;
+    s->proxima_ms = to_ms_since_boot(get_absolute_time()) + config->periodo_ms;
+    return total_sensores++;
+}
+
+// lê um sensor e contabiliza o custo
+static void sensores_ler(Sensor *s) {
+    const SensorConfig *c = s->config;
+    uint32_t inicio = time_us_32();
+    bool ok;
+    float valor = 0.0f;
+    if (c->tipo == SENSOR_ADC) {
+        float bruto = adc_amostragem_media(c->canal, c->media ? c->media : 1);
+        valor = c->converter ? c->converter(bruto) : bruto;
+        ok = true;
+    } else {
+        ok = c->ler && c->ler(&valor);
+    }
+    uint32_t custo = time_us_32() - inicio;
+    s->custo_total_us += custo;
+    if (custo > s->custo_max_us) s->custo_max_us = custo;
+    s->leituras++;
+    if (!ok) return;
+    s->valor = valor;
+    s->valido = true;
+    if (s->serie < 0) {
+        s->publicar = valor;
+        s->vencido = true;
+    } else if (historico_adicionar(s->serie, (uint32_t)(time_us_64() / 1000000), valor, &s->minuto)) {
+        s->publicar = s->minuto.soma / s->minuto.n; // publica só a média do minuto que fechou
+        s->vencido = true;
+        s->agregado = true;
+    }
+    if (c->ao_ler) c->ao_ler(valor);
+    if (observador) observador((int)(s - sensores), valor);
+}
+
+void sensores_tick(uint32_t agora, sensores_publicar_t publicar) {
+    bool algum = false;
+    for (int i = 0; i < total_sensores; i++) {
+        Sensor *s = &sensores[i];
+        if ((int32_t)(agora - s->proxima_ms) < 0) continue;
+        s->proxima_ms += s->config->periodo_ms;
+        if ((int32_t)(agora - s->proxima_ms) >= 0) s->proxima_ms = agora + s->config->periodo_ms; // atrasado: não acumula
+        sensores_ler(s);
+        algum = true;
+    }
+    if (!algum) return;
+
+    // agrupa por tópico os sensores lidos neste tick: um valor sozinho vai puro, vários vão em JSON
+    char payload[SENSORES_LOTE_MAX];
+    for (int i = 0; i < total_sensores; i++) {
+        if (!sensores[i].vencido) continue;
+        const char *topico = sensores[i].config->topico;
+        int membros = 0;
+        for (int j = i; j < total_sensores; j++) {
+            if (sensores[j].vencido && strcmp(sensores[j].config->topico, topico) == 0) membros++;
+        }
+        size_t n = 0;
+        if (membros == 1) {
+            n = (size_t)snprintf(payload, sizeof(payload), "%.2f", sensores[i].publicar);
+            sensores[i].vencido = false;
+        } else {
+            // membros que não cabem (com o '}') ficam vencidos e saem no próximo lote deste tick
+            membros = 0;
+            payload[n++] = '{';
+            for (int j = i; j < total_sensores; j++) {
+                Sensor *s = &sensores[j];
+                if (!s->vencido || strcmp(s->config->topico, topico) != 0) continue;
+                int m = snprintf(payload + n, sizeof(payload) - n, "%s\"%s\":%.2f", n > 1 ? "," : "",
+                                 s->config->nome, s->publicar);
+                if (m < 0 || (size_t)m >= sizeof(payload) - n - 1) {
+                    if (membros) break;
+                    s->vencido = false;     // não cabe nem sozinho: descartado, senão voltaria a cada lote
+                    continue;
+                }
+                n += (size_t)m;
+                membros++;
+                s->vencido = false;
+            }
+            if (!membros) continue;
+            payload[n++] = '}';
+            payload[n] = '\0';
+        }
+        LOG_DEBUG(EV_SENSOR_LOTE, membros, n);
+        if (publicar) publicar(topico, payload);
+    }
+
+    // agregados completos dos minutos que fecharam
+    for (int i = 0; i < total_sensores; i++) {
+        Sensor *s = &sensores[i];
+        if (!s->agregado) continue;
+        s->agregado = false;
+        char topico[48];
+        snprintf(topico, sizeof(topico), "%s/agregado", s->config->topico);
+        snprintf(payload, sizeof(payload), "{\"min\":%.2f,\"max\":%.2f,\"media\":%.2f,\"n\":%u}",
+                 s->minuto.min, s->minuto.max, s->minuto.soma / s->minuto.n, s->minuto.n);
+        if (publicar) publicar(topico, payload);
+    }
+}
+
+uint32_t sensores_espera(uint32_t agora) {
+    uint32_t espera = UINT32_MAX;
+    for (int i = 0; i < total_sensores; i++) {
+        int32_t restante = (int32_t)(sensores[i].proxima_ms - agora);
+        uint32_t prazo = restante > 0 ? (uint32_t)restante : 0;
+        if (prazo < espera) espera = prazo;
+    }
+    return espera;
+}
+
+float sensores_valor(int indice) {
+    return (indice >= 0 && indice < total_sensores) ? sensores[indice].valor : 0.0f;
+}
+
+int sensores_por_nome(const char *nome) {
+    for (int i = 0; i < total_sensores; i++) {
+        if (strcmp(sensores[i].config->nome, nome) == 0) return i;
+    }
+    return -1;
+}
+
+void sensores_observar(sensores_observador_t novo) {
+    observador = novo;
+}
+
+size_t sensores_diagnostico_json(char *buf, size_t tamanho) {
+    size_t n = 0;
+    if (tamanho < 3) return 0;
+    buf[n++] = '[';
+    for (int i = 0; i < total_sensores && n < tamanho; i++) {
+        const Sensor *s = &sensores[i];
+        uint32_t medio = s->leituras ? (uint32_t)(s->custo_total_us / s->leituras) : 0;
+        int escrito = snprintf(buf + n, tamanho - n, "%s{\"nome\":\"%s\",\"valor\":%.2f,\"leituras\":%lu,\"custo_medio_us\":%lu,\"custo_max_us\":%lu}",
+                               i ? "," : "", s->config->nome, s->valor, (unsigned long)s->leituras,
+                               (unsigned long)medio, (unsigned long)s->custo_max_us);
+        if (escrito < 0 || (size_t)escrito >= tamanho - n) break;
+        n += (size_t)escrito;
+    }
+    if (n + 1 < tamanho) buf[n++] = ']';
+    buf[n] = '\0';
+    return n;
+}
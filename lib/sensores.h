@@ -0,0 +1,44 @@
+// Registro de sensores
+// Cada sensor declara período, rotina de conversão e tópico. Um único escalonador lê os
+// sensores vencidos e publica, por tópico, um lote com todos os que venceram juntos.
+// Sensores com histórico alimentam lib/historico.c a cada leitura e publicam apenas o
+// agregado de cada minuto (média no tópico, mínimo/máximo/contagem em <tópico>/agregado).
+
+#ifndef SENSORES_H
+#define SENSORES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SENSORES_MAX 8                  // sensores registráveis
+
+typedef enum { SENSOR_ADC, SENSOR_I2C } TipoSensor;
+
+typedef struct {
+    const char *nome;                   // chave no lote ("temperatura", "adc0", ...)
+    const char *topico;                 // tópico MQTT do lote
+    TipoSensor tipo;
+    uint8_t canal;                      // SENSOR_ADC: canal do ADC
+    uint8_t media;                      // SENSOR_ADC: amostras na média
+    uint32_t periodo_ms;                // intervalo entre leituras
+    float (*converter)(float bruto);    // SENSOR_ADC: média bruta (0-4095) -> unidade do sensor
+    bool (*ler)(float *valor);          // SENSOR_I2C: leitura completa (no barramento do OLED)
+    void (*ao_ler)(float valor);        // opcional: notificado a cada leitura (ex.: alarme)
+    bool historico;                     // guarda agregados e publica por minuto em vez de cada leitura
+} SensorConfig;
+
+typedef void (*sensores_publicar_t)(const char *topico, const char *payload); // envia um lote
+typedef void (*sensores_observador_t)(int indice, float valor); // recebe todas as leituras (ex.: regras)
+
+int sensores_registrar(const SensorConfig *config); // retorna o índice do sensor ou -1
+void sensores_tick(uint32_t agora, sensores_publicar_t publicar); // lê os vencidos e publica os lotes
+uint32_t sensores_espera(uint32_t agora); // ms até o próximo sensor vencer
+float sensores_valor(int indice);       // último valor lido
+int sensores_por_nome(const char *nome); // índice do sensor ou -1
+void sensores_observar(sensores_observador_t observador); // chamado após cada leitura válida
+
+// diagnóstico em JSON: [{"nome":..,"valor":..,"leituras":..,"custo_medio_us":..,"custo_max_us":..}, ...]
+size_t sensores_diagnostico_json(char *buf, size_t tamanho);
+
+#endif
@@ -0,0 +1,54 @@
+#include "ssd1306.h"
+
+// Controlador SH1106: RAM de 132 colunas (a tela de 128 começa na coluna 2) e só endereçamento
+// por página, então cada página da região é um envio: página, coluna inicial e os dados.
+// Mesmos comandos do SSD1306 para contraste e liga/desliga; a bomba de carga é o conversor DC-DC (0xAD).
+
+#define SH1106_COL_OFFSET 2
+#define SH1106_SET_PAGE 0xB0
+#define SH1106_SET_COL_LOW 0x00
+#define SH1106_SET_COL_HIGH 0x10
+#define SH1106_SET_DCDC 0xAD
+
+static void sh1106_init(ssd1306_t *ssd) {
+  const uint8_t cmds[] = {
+    SET_DISP | 0x00,
+    SET_DISP_CLK_DIV, 0x80,
+    SET_MUX_RATIO, ssd->height - 1,
+    SET_DISP_OFFSET, 0x00,
+    SET_DISP_START_LINE | 0x00,
+    SH1106_SET_DCDC, ssd->external_vcc ? 0x8A : 0x8B,
+    SET_SEG_REMAP | 0x01,
+    SET_COM_OUT_DIR | 0x08,
+    SET_COM_PIN_CFG, ssd->height == 64 ? 0x12 : 0x02,
+    SET_CONTRAST, 0xFF,
+    SET_PRECHARGE, 0x22,
+    SET_VCOM_DESEL, 0x35,
+    SET_ENTIRE_ON,
+    SET_NORM_INV,
+    SET_DISP | 0x01,
+  };
+  ssd1306_commands(ssd, cmds, sizeof(cmds));
+}
+
+static void sh1106_flush(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  uint8_t col = x0 + SH1106_COL_OFFSET;
+  for (uint8_t p = p0; p <= p1; ++p) {
+    const uint8_t posicao[] = { SH1106_SET_PAGE | p, SH1106_SET_COL_LOW | (col & 0x0F), SH1106_SET_COL_HIGH | (col >> 4) };
+    ssd1306_commands(ssd, posicao, sizeof(posicao));
+    ssd->bus->data(ssd, &ssd->ram_buffer[1 + p * ssd->width + x0], x1 - x0 + 1);
+  }
+}
+
+static void sh1106_contrast(ssd1306_t *ssd, uint8_t value) {
+  const uint8_t cmds[] = { SET_CONTRAST, value };
+  ssd1306_commands(ssd, cmds, sizeof(cmds));
+}
+
+static void sh1106_power(ssd1306_t *ssd, bool on) {
+  ssd1306_command(ssd, SET_DISP | (on ? 0x01 : 0x00));
+}
+
+const ssd1306_driver_t sh1106_driver = {
+  "sh1106", sh1106_init, sh1106_flush, sh1106_contrast, sh1106_power
+};
@@ -0,0 +1,23 @@
+// SHA-256 incremental (FIPS 180-4), usado na verificação das imagens de firmware
+// Código C puro (sem SDK): compartilhado com as ferramentas do host.
+
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SHA256_TAMANHO 32               // bytes do resumo
+
+typedef struct {
+    uint32_t h[8];                      // estado intermediário
+    uint64_t total;                     // bytes processados
+    uint8_t bloco[64];                  // bloco parcial
+    uint8_t usados;                     // bytes em 'bloco'
+} Sha256;
+
+void sha256_iniciar(Sha256 *ctx);
+void sha256_atualizar(Sha256 *ctx, const void *dados, size_t n);
+void sha256_finalizar(Sha256 *ctx, uint8_t resumo[SHA256_TAMANHO]);
+
+#endif
@@ -1,75 +1,169 @@
+#include <string.h>
 #include "ssd1306.h"
-#include "font.h"
+#include "fontes_painel.h"
 
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
+// Barramento I2C: um byte de controle antes de cada transação (0x00 = comandos, 0x40 = dados)
+static void i2c_commands(ssd1306_t *ssd, const uint8_t *cmds, size_t n) {
+  uint8_t buf[1 + 32];
+  buf[0] = 0x00;
+  while (n) {
+    size_t parte = n < sizeof(buf) - 1 ? n : sizeof(buf) - 1;
+    memcpy(buf + 1, cmds, parte);
+    i2c_write_blocking(ssd->i2c_port, ssd->address, buf, parte + 1, false);
+    cmds += parte;
+    n -= parte;
+  }
+}
+
+static void i2c_data(ssd1306_t *ssd, uint8_t *data, size_t n) {
+  uint8_t guardado = data[-1];          // o byte antes da região vira o byte de controle, sem copiar a região
+  data[-1] = 0x40;
+  i2c_write_blocking(ssd->i2c_port, ssd->address, data - 1, n + 1, false);
+  data[-1] = guardado;
+}
+
+static const ssd1306_bus_t bus_i2c = { i2c_commands, i2c_data };
+
+// Barramento SPI (4 fios): D/C em nível baixo para comandos, alto para dados; CS ativo em nível baixo
+static void spi_send(ssd1306_t *ssd, bool dados, const uint8_t *buf, size_t n) {
+  gpio_put(ssd->pin_dc, dados);
+  gpio_put(ssd->pin_cs, 0);
+  spi_write_blocking(ssd->spi_port, buf, n);
+  gpio_put(ssd->pin_cs, 1);
+}
+
+static void spi_commands(ssd1306_t *ssd, const uint8_t *cmds, size_t n) {
+  spi_send(ssd, false, cmds, n);
+}
+
+static void spi_data(ssd1306_t *ssd, uint8_t *data, size_t n) {
+  spi_send(ssd, true, data, n);
+}
+
+static const ssd1306_bus_t bus_spi = { spi_commands, spi_data };
+
+static void init_common(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc) {
+  if ((size_t)width * (height / 8U) + 1 > SSD1306_BUFSIZE) // framebuffer estático: no máximo WIDTH x HEIGHT
+    height = (uint8_t)((SSD1306_BUFSIZE - 1) / width * 8);
   ssd->width = width;
   ssd->height = height;
   ssd->pages = height / 8U;
+  ssd->external_vcc = external_vcc;
+  ssd->bufsize = ssd->pages * ssd->width + 1;
+  ssd->driver = &ssd1306_driver;
+  memset(ssd->ram_buffer, 0, sizeof(ssd->ram_buffer));
+}
+
+void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
+  init_common(ssd, width, height, external_vcc);
   ssd->address = address;
   ssd->i2c_port = i2c;
-  ssd->bufsize = ssd->pages * ssd->width + 1;
-  ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
-  ssd->ram_buffer[0] = 0x40;
-  ssd->port_buffer[0] = 0x80;
+  ssd->bus = &bus_i2c;
+}
+
+// SPI já inicializado pelo chamador (spi_init e pinos SCK/MOSI); CS e D/C são GPIOs comuns
+void ssd1306_init_spi(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, spi_inst_t *spi, uint8_t pin_cs, uint8_t pin_dc) {
+  init_common(ssd, width, height, external_vcc);
+  ssd->spi_port = spi;
+  ssd->pin_cs = pin_cs;
+  ssd->pin_dc = pin_dc;
+  ssd->bus = &bus_spi;
+  gpio_init(pin_cs);
+  gpio_set_dir(pin_cs, GPIO_OUT);
+  gpio_put(pin_cs, 1);
+  gpio_init(pin_dc);
+  gpio_set_dir(pin_dc, GPIO_OUT);
+}
+
+void ssd1306_set_driver(ssd1306_t *ssd, const ssd1306_driver_t *driver) {
+  ssd->driver = driver;
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
+  ssd->driver->init(ssd);
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
-  ssd->port_buffer[1] = command;
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->port_buffer,
-    2,
-    false
-  );
+  ssd->bus->commands(ssd, &command, 1);
+}
+
+void ssd1306_commands(ssd1306_t *ssd, const uint8_t *cmds, size_t n) {
+  ssd->bus->commands(ssd, cmds, n);
 }
 
 void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
-    false
-  );
+  ssd->driver->flush(ssd, 0, ssd->width - 1, 0, ssd->pages - 1);
+}
+
+// Envia só o retângulo (x0, y0)-(x1, y1), arredondado para páginas inteiras
+void ssd1306_send_region(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
+  if (x1 >= ssd->width) x1 = ssd->width - 1;
+  if (y1 >= ssd->height) y1 = ssd->height - 1;
+  if (x0 > x1 || y0 > y1)
+    return;
+  ssd->driver->flush(ssd, x0, x1, y0 >> 3, y1 >> 3);
+}
+
+void ssd1306_contrast(ssd1306_t *ssd, uint8_t value) {
+  ssd->driver->contrast(ssd, value);
+}
+
+void ssd1306_power(ssd1306_t *ssd, bool on) {
+  ssd->driver->power(ssd, on);
+}
+
+// Controlador SSD1306: endereçamento horizontal dentro de uma janela, então uma região
+// de largura total sai num único envio (páginas em sequência no framebuffer)
+static void ssd1306_drv_init(ssd1306_t *ssd) {
+  const uint8_t cmds[] = {
+    SET_DISP | 0x00,
+    SET_MEM_ADDR, 0x00,                 // horizontal: coluna, depois página (mesma ordem do framebuffer)
+    SET_DISP_START_LINE | 0x00,
+    SET_SEG_REMAP | 0x01,
+    SET_MUX_RATIO, ssd->height - 1,
+    SET_COM_OUT_DIR | 0x08,
+    SET_DISP_OFFSET, 0x00,
+    SET_COM_PIN_CFG, ssd->height == 64 ? 0x12 : 0x02,
+    SET_DISP_CLK_DIV, 0x80,
+    SET_PRECHARGE, ssd->external_vcc ? 0x22 : 0xF1,
+    SET_VCOM_DESEL, 0x30,
+    SET_CONTRAST, 0xFF,
+    SET_ENTIRE_ON,
+    SET_NORM_INV,
+    SET_CHARGE_PUMP, ssd->external_vcc ? 0x10 : 0x14,
+    SET_DISP | 0x01,
+  };
+  ssd1306_commands(ssd, cmds, sizeof(cmds));
+}
+
+static void ssd1306_drv_flush(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  const uint8_t janela[] = { SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, p0, p1 };
+  ssd1306_commands(ssd, janela, sizeof(janela));
+  if (x0 == 0 && x1 == ssd->width - 1) { // largura total: páginas contíguas
+    ssd->bus->data(ssd, &ssd->ram_buffer[1 + p0 * ssd->width], (size_t)(p1 - p0 + 1) * ssd->width);
+    return;
+  }
+  for (uint8_t p = p0; p <= p1; ++p)    // a janela continua na página seguinte a cada x1
+    ssd->bus->data(ssd, &ssd->ram_buffer[1 + p * ssd->width + x0], x1 - x0 + 1);
+}
+
+static void ssd1306_drv_contrast(ssd1306_t *ssd, uint8_t value) {
+  const uint8_t cmds[] = { SET_CONTRAST, value };
+  ssd1306_commands(ssd, cmds, sizeof(cmds));
 }
 
+static void ssd1306_drv_power(ssd1306_t *ssd, bool on) {
+  ssd1306_command(ssd, SET_DISP | (on ? 0x01 : 0x00));
+}
+
+const ssd1306_driver_t ssd1306_driver = {
+  "ssd1306", ssd1306_drv_init, ssd1306_drv_flush, ssd1306_drv_contrast, ssd1306_drv_power
+};
+
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
-  uint16_t index = (y >> 3) + (x << 3) + 1;
+  if (x >= ssd->width || y >= ssd->height)
+    return;
+  uint16_t index = (y >> 3) * ssd->width + x + 1;
   uint8_t pixel = (y & 0b111);
   if (value)
     ssd->ram_buffer[index] |= (1 << pixel);
@@ -77,24 +171,10 @@ void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
     ssd->ram_buffer[index] &= ~(1 << pixel);
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
-
 void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+  memset(&ssd->ram_buffer[1], value ? 0xFF : 0x00, ssd->bufsize - 1);
 }
 
-
-
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
   for (uint8_t x = left; x < left + width; ++x) {
     ssd1306_pixel(ssd, x, top, value);
@@ -153,48 +233,64 @@ void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value
     ssd1306_pixel(ssd, x, y, value);
 }
 
-// Função para desenhar um caractere
-void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
+// Desenha uma faixa de páginas (glifo ou imagem), descomprimindo direto no framebuffer.
+// Pixels acesos são somados (OR) ao que já está no buffer; com y fora do alinhamento de página,
+// cada byte se divide entre duas páginas. Colunas e páginas fora da tela são lidas e descartadas.
+static void draw_pages(ssd1306_t *ssd, const uint8_t *dados, bool rle, uint8_t largura, uint8_t paginas, uint8_t x, uint8_t y)
 {
-  uint16_t index = 0;
-
-  // Verifica o caractere e calcula o índice correspondente na fonte
-  if (c >= ' ' && c <= '~') // Verifica se o caractere está na faixa ASCII válida
+  FonteLeitor leitor;
+  fonte_leitor_iniciar(&leitor, dados, rle);
+  uint8_t shift = y & 7;
+  for (uint8_t p = 0; p < paginas; ++p)
   {
-    index = (c - ' ') * 8; // Calcula o índice baseado na posição do caractere na tabela ASCII
-  }
-  else
-  {
-    // Caractere inválido, desenha um espaço (ou pode ser tratado de outra forma)
-    index = 0; // Índice 0 corresponde ao caractere "nada" (espaço)
-  }
-
-  // Desenha o caractere na tela
-  for (uint8_t i = 0; i < 8; ++i)
-  {
-    uint8_t line = font[index + i]; // Acessa a linha correspondente do caractere na fonte
-    for (uint8_t j = 0; j < 8; ++j)
+    uint16_t page = (y >> 3) + p;
+    for (uint8_t i = 0; i < largura; ++i)
     {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j)); // Desenha cada pixel do caractere
+      uint8_t byte = fonte_ler(&leitor);
+      uint16_t col = x + i;
+      if (byte == 0 || col >= ssd->width)
+        continue;
+      if (page < ssd->pages)
+        ssd->ram_buffer[1 + page * ssd->width + col] |= byte << shift;
+      if (shift && page + 1 < ssd->pages)
+        ssd->ram_buffer[1 + (page + 1) * ssd->width + col] |= byte >> (8 - shift);
     }
   }
 }
 
-// Função para desenhar uma string
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
+static void draw_glyph(ssd1306_t *ssd, const Fonte *fonte, const FonteGlifo *g, uint8_t x, uint8_t y)
 {
-  while (*str)
+  draw_pages(ssd, fonte->dados + (g->deslocamento & ~FONTE_RLE), g->deslocamento & FONTE_RLE,
+             g->largura, fonte->paginas, x, y);
+}
+
+// Desenha uma string UTF-8 (caracteres Latin-1 da fonte) com larguras proporcionais; devolve o x final
+uint8_t ssd1306_draw_text(ssd1306_t *ssd, const Fonte *fonte, const char *texto, uint8_t x, uint8_t y)
+{
+  uint8_t codigo;
+  while (x < ssd->width && (codigo = fonte_proximo_codigo(&texto)) != 0)
   {
-    ssd1306_draw_char(ssd, *str++, x, y);
-    x += 8;
-    if (x + 8 >= ssd->width)
-    {
-      x = 0;
-      y += 8;
-    }
-    if (y + 8 >= ssd->height)
-    {
-      break;
-    }
+    const FonteGlifo *g = fonte_glifo(fonte, codigo);
+    draw_glyph(ssd, fonte, g, x, y);
+    x = x + g->avanco > ssd->width ? ssd->width : x + g->avanco;
   }
-}
\ No newline at end of file
+  return x;
+}
+
+// Desenha uma imagem 1-bit gerada de assets/ com o canto superior esquerdo em (x, y)
+void ssd1306_draw_image(ssd1306_t *ssd, const Imagem *imagem, uint8_t x, uint8_t y)
+{
+  draw_pages(ssd, imagem->dados, imagem->rle, imagem->largura, imagem->paginas, x, y);
+}
+
+// Função para desenhar um caractere (fonte padrão de 8 linhas)
+void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
+{
+  draw_glyph(ssd, &fonte_painel8, fonte_glifo(&fonte_painel8, (uint8_t)c), x, y);
+}
+
+// Função para desenhar uma string (fonte padrão de 8 linhas)
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
+{
+  ssd1306_draw_text(ssd, &fonte_painel8, str, x, y);
+}
@@ -1,6 +1,11 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "hardware/spi.h"
+#include "fonte.h"
 
 #define WIDTH 128
 #define HEIGHT 64
@@ -25,19 +30,50 @@ typedef enum {
   SET_CHARGE_PUMP = 0x8D
 } ssd1306_command_t;
 
+#define SSD1306_BUFSIZE (WIDTH * HEIGHT / 8 + 1) // byte 0 livre para o byte de controle do I2C
+
+typedef struct ssd1306 ssd1306_t;
+
+// Barramento: como comandos e dados chegam ao controlador
+typedef struct {
+  void (*commands)(ssd1306_t *ssd, const uint8_t *cmds, size_t n);
+  void (*data)(ssd1306_t *ssd, uint8_t *data, size_t n); // data[-1] pode ser usado (e restaurado) como prefixo
+} ssd1306_bus_t;
+
+// Controlador: inicialização e envio de uma região do framebuffer (colunas x0..x1, páginas p0..p1)
 typedef struct {
+  const char *name;
+  void (*init)(ssd1306_t *ssd);
+  void (*flush)(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1);
+  void (*contrast)(ssd1306_t *ssd, uint8_t value);
+  void (*power)(ssd1306_t *ssd, bool on);
+} ssd1306_driver_t;
+
+struct ssd1306 {
   uint8_t width, height, pages, address;
   i2c_inst_t *i2c_port;
+  spi_inst_t *spi_port;
+  uint8_t pin_cs, pin_dc;
   bool external_vcc;
-  uint8_t *ram_buffer;
+  const ssd1306_bus_t *bus;
+  const ssd1306_driver_t *driver;
   size_t bufsize;
-  uint8_t port_buffer[2];
-} ssd1306_t;
+  uint8_t ram_buffer[SSD1306_BUFSIZE]; // páginas em sequência, cada uma com 'width' colunas, a partir do byte 1
+};
+
+extern const ssd1306_driver_t ssd1306_driver; // SSD1306: janela de colunas/páginas, um envio por região
+extern const ssd1306_driver_t sh1106_driver;  // SH1106: RAM de 132 colunas, só modo página
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
+void ssd1306_init_spi(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, spi_inst_t *spi, uint8_t pin_cs, uint8_t pin_dc);
+void ssd1306_set_driver(ssd1306_t *ssd, const ssd1306_driver_t *driver);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
+void ssd1306_commands(ssd1306_t *ssd, const uint8_t *cmds, size_t n);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_send_region(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1);
+void ssd1306_contrast(ssd1306_t *ssd, uint8_t value);
+void ssd1306_power(ssd1306_t *ssd, bool on);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -46,4 +82,8 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
\ No newline at end of file
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+uint8_t ssd1306_draw_text(ssd1306_t *ssd, const Fonte *fonte, const char *texto, uint8_t x, uint8_t y);
+void ssd1306_draw_image(ssd1306_t *ssd, const Imagem *imagem, uint8_t x, uint8_t y);
+
+#endif
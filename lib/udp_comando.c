@@ -0,0 +1,128 @@
+// Canal UDP de comandos
+
+#include <string.h>
+#include "lwip/udp.h"
+#include "lwip/pbuf.h"
+#include "udp_comando.h"
+#include "log_binario.h"
+
+#define UDP_VERSAO        1
+#define UDP_TAM_CABECALHO 6             // magic(2) + versão + n + seq(2)
+#define UDP_TAM_RESPOSTA  10
+#define UDP_CONSULTA      0xFF          // tipo que apenas consulta o estado
+
+typedef struct {
+    ip_addr_t ip;                       // endereço do cliente
+    u16_t porta;                        // porta de origem do cliente
+    u16_t seq;                          // última sequência processada
+    bool valido;                        // entrada em uso
+    uint8_t resposta[UDP_TAM_RESPOSTA]; // resposta enviada para essa sequência
+} ClienteUdp;
+
+static struct udp_pcb *udp_pcb_comando = NULL;
+static udp_executar_t udp_executar = NULL;
+static udp_publicar_t udp_publicar = NULL;
+static ClienteUdp clientes[UDP_COMANDO_CLIENTES]; // tabela de deduplicação
+static uint8_t proximo_cliente = 0;     // substituição circular da tabela
+
+// procura (ou reserva) a entrada do cliente
+static ClienteUdp *buscar_cliente(const ip_addr_t *ip, u16_t porta) {
+    for (int i = 0; i < UDP_COMANDO_CLIENTES; i++) {
+        if (clientes[i].valido && clientes[i].porta == porta && ip_addr_cmp(&clientes[i].ip, ip)) {
+            return &clientes[i];
+        }
+    }
+    ClienteUdp *c = &clientes[proximo_cliente];
+    proximo_cliente = (proximo_cliente + 1) % UDP_COMANDO_CLIENTES;
+    ip_addr_copy(c->ip, *ip);
+    c->porta = porta;
+    c->valido = false;                  // ainda sem sequência registrada
+    return c;
+}
+
+// envia a resposta (10 bytes copiados para um pbuf do pool do lwIP)
+static void enviar_resposta(struct udp_pcb *pcb, const ip_addr_t *ip, u16_t porta, const uint8_t *resposta) {
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, UDP_TAM_RESPOSTA, PBUF_RAM);
+    if (!p) return;
+    memcpy(p->payload, resposta, UDP_TAM_RESPOSTA);
+    udp_sendto(pcb, p, ip, porta);
+    pbuf_free(p);
+}
+
+// resposta com o estado atual do painel
+static void montar_resposta(uint8_t *r, uint8_t aceitos, u16_t seq) {
+    r[0] = 'P';
+    r[1] = 'R';
+    r[2] = UDP_VERSAO;
+    r[3] = aceitos;
+    r[4] = (uint8_t)(seq & 0xFF);
+    r[5] = (uint8_t)(seq >> 8);
+    r[6] = painel.led_ligado;
+    r[7] = (uint8_t)painel.cor;
+    r[8] = (uint8_t)painel.comodo;
+    r[9] = painel.emergencia;
+}
+
+// recepção de datagramas (contexto do lwIP)
+static void udp_recebido_cb(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *ip, u16_t porta) {
+    uint8_t dados[UDP_TAM_CABECALHO + 2 * UDP_COMANDO_MAX_LOTE];
+    u16_t tamanho = pbuf_copy_partial(p, dados, sizeof(dados), 0);
+    u16_t total = p->tot_len;
+    pbuf_free(p);
+
+    if (tamanho < UDP_TAM_CABECALHO || dados[0] != 'P' || dados[1] != 'C' || dados[2] != UDP_VERSAO ||
+        dados[3] > UDP_COMANDO_MAX_LOTE || total != UDP_TAM_CABECALHO + 2 * dados[3]) {
+        LOG_AVISO(EV_UDP_INVALIDO, total);
+        return;
+    }
+    uint8_t n = dados[3];
+    u16_t seq = (u16_t)(dados[4] | (dados[5] << 8));
+
+    ClienteUdp *cliente = buscar_cliente(ip, porta);
+    if (cliente->valido && cliente->seq == seq) { // retransmissão: não reaplica
+        LOG_DEBUG(EV_UDP_DUPLICADO, seq);
+        enviar_resposta(pcb, ip, porta, cliente->resposta);
+        return;
+    }
+    if (cliente->valido && (int16_t)(seq - cliente->seq) < 0) { // atrasado (reordenado): não volta o estado
+        LOG_DEBUG(EV_UDP_ANTIGO, seq, cliente->seq);
+        uint8_t resposta[UDP_TAM_RESPOSTA];
+        montar_resposta(resposta, 0, seq);
+        enviar_resposta(pcb, ip, porta, resposta);
+        return;
+    }
+
+    uint8_t aceitos = 0;
+    bool mudou = false;
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t tipo = dados[UDP_TAM_CABECALHO + 2 * i];
+        uint8_t valor = dados[UDP_TAM_CABECALHO + 2 * i + 1];
+        if (tipo == UDP_CONSULTA) {
+            aceitos |= (uint8_t)(1u << i);
+        } else if (tipo < COMANDO_TOTAL && udp_executar((TipoComando)tipo, valor)) {
+            aceitos |= (uint8_t)(1u << i);
+            mudou = true;
+        }
+    }
+
+    montar_resposta(cliente->resposta, aceitos, seq); // monta a resposta já na tabela de deduplicação
+    cliente->seq = seq;
+    cliente->valido = true;
+    enviar_resposta(pcb, ip, porta, cliente->resposta); // responde antes de publicar no MQTT
+    LOG_DEBUG(EV_UDP_LOTE, seq, n, aceitos);
+
+    if (mudou) udp_publicar();          // mantém o dashboard MQTT em sincronia
+}
+
+void udp_comando_init(udp_executar_t executar, udp_publicar_t publicar) {
+    udp_executar = executar;
+    udp_publicar = publicar;
+    udp_pcb_comando = udp_new_ip_type(IPADDR_TYPE_ANY);
+    if (!udp_pcb_comando) return;
+    if (udp_bind(udp_pcb_comando, IP_ANY_TYPE, UDP_COMANDO_PORTA) != ERR_OK) {
+        udp_remove(udp_pcb_comando);
+        udp_pcb_comando = NULL;
+        return;
+    }
+    udp_recv(udp_pcb_comando, udp_recebido_cb, NULL);
+}
@@ -0,0 +1,30 @@
+// Canal UDP de comandos (caminho rápido, paralelo ao MQTT)
+// Um datagrama carrega um lote de comandos; a resposta leva o estado resultante no mesmo datagrama.
+//
+// Requisição (little-endian):
+//   'P' 'C' | versão (1) | n comandos | seq (u16) | n x [tipo (TipoComando) | valor]
+//   tipo 0xFF = apenas consulta o estado
+// Resposta:
+//   'P' 'R' | versão (1) | aceitos (bit i = comando i aplicado) | seq (u16) | led | cor | cômodo | emergência
+//
+// Números de sequência tornam o lote idempotente: uma seq repetida pelo mesmo cliente recebe
+// a resposta guardada, sem reaplicar os comandos. Uma seq anterior à última (comparação serial, em
+// módulo 2^16) é um datagrama atrasado: responde com aceitos = 0 e o estado atual, sem aplicar, para
+// não voltar o painel a um estado antigo. O cliente deve incrementar a seq a cada lote novo.
+
+#ifndef UDP_COMANDO_H
+#define UDP_COMANDO_H
+
+#include <stdbool.h>
+#include "painel.h"
+
+#define UDP_COMANDO_PORTA     4950      // porta UDP do painel
+#define UDP_COMANDO_MAX_LOTE  8         // comandos por datagrama
+#define UDP_COMANDO_CLIENTES  4         // clientes lembrados para deduplicação
+
+typedef bool (*udp_executar_t)(TipoComando tipo, int valor); // aplica um comando
+typedef void (*udp_publicar_t)(void);                        // publica o estado após um lote
+
+void udp_comando_init(udp_executar_t executar, udp_publicar_t publicar); // abre a porta UDP
+
+#endif
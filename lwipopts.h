@@ -2,7 +2,7 @@
 #define _LWIPOPTS_H
 
 // Need more memory for TLS
-#ifdef MQTT_CERT_INC
+#if defined(MQTT_CERT_INC) || defined(MQTT_TLS)
 #define MEM_SIZE 8000
 #endif
 
@@ -14,7 +14,7 @@
 
 #define MEMP_NUM_SYS_TIMEOUT        (LWIP_NUM_SYS_TIMEOUT_INTERNAL+1)
 
-#ifdef MQTT_CERT_INC
+#if defined(MQTT_CERT_INC) || defined(MQTT_TLS)
 #define LWIP_ALTCP               1
 #define LWIP_ALTCP_TLS           1
 #define LWIP_ALTCP_TLS_MBEDTLS   1
@@ -25,9 +25,24 @@
    or you will get a warning "altcp_tls: TCP_WND is smaller than the RX decrypion buffer, connection RX might stall!" */
 #undef TCP_WND
 #define TCP_WND  16384
-#endif // MQTT_CERT_INC
+#endif // MQTT_CERT_INC || MQTT_TLS
 
 // This defaults to 4
 #define MQTT_REQ_MAX_IN_FLIGHT 5
 
+// Respostas de histórico (até 1 KB) e o consolidado do gateway (até ~1,7 KB, GATEWAY_JSON_MAX) são
+// publicados numa única mensagem; o padrão é 256
+#define MQTT_OUTPUT_RINGBUF_SIZE 2048
+
+// Servidor HTTP local (lib/http_painel.c)
+#define LWIP_HTTPD_CGI              0   // comandos só por POST (um GET não muda o estado)
+#define LWIP_HTTPD_SSI              0
+#define LWIP_HTTPD_CUSTOM_FILES     1   // /estado.json montado em buffer estático
+#define LWIP_HTTPD_DYNAMIC_HEADERS  0   // todos os arquivos já trazem o cabeçalho HTTP
+#define LWIP_HTTPD_SUPPORT_POST     1   // POST /comando.cgi
+#define HTTPD_USE_MEM_POOL          1   // estado das conexões em pool estático (sem heap)
+#define MEMP_NUM_PARALLEL_HTTPD_CONNS 4
+#define MEMP_NUM_TCP_PCB            8   // MQTT + conexões HTTP simultâneas
+#define HTTPD_FSDATA_FILE           "fsdata_painel.c" // gerado por tools/gerar_fsdata.py
+
 #endif
@@ -7,13 +7,44 @@
 #include <stdlib.h>                     // funções padrão
 #include "pico/stdlib.h"                // funções básicas do pico sdk
 #include "hardware/gpio.h"              // controle de GPIOs
+#include "hardware/pwm.h"               // brilho do LED RGB
 #include "hardware/i2c.h"               // comunicação I2C para o display oled
-#include "hardware/adc.h"               // leitura do adc para sensor de temperatura interno
+#include "hardware/spi.h"               // OLED no SPI (opcional)
+#include "hardware/watchdog.h"          // reinício se a imagem em teste travar
 #include "pico/cyw43_arch.h"            // suporte ao módulo Wi-Fi CYW43439 
+#include "pico/unique_id.h"             // ID único da flash: identificação do nó no broker
 #include "lwip/apps/mqtt.h"             // protocolo mqtt para comunicação IOT
+#include "lwip/apps/mqtt_priv.h"        // acesso à conexão altcp do cliente (sessão TLS)
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+#include "lwip/altcp_tls.h"             // TLS via mbedTLS (sessão reaproveitada nas reconexões)
+#include "mbedtls/ssl.h"                // mbedtls_ssl_set_hostname
+#include "mbedtls/platform.h"           // mbedtls_platform_set_calloc_free: heap do mbedTLS medido
+#endif
+#include <malloc.h>                     // mallinfo e malloc_usable_size: RAM usada pelo mbedTLS
 #include "generated/ws2812.pio.h"      // controlar matriz WS2812 via PIO
 #include "lib/ssd1306.h"               // biblioteca para display OLED SSD1306 
+#include "fontes_painel.h"             // fontes e ícones do OLED gerados de assets/ na compilação
+#include "lib/log_binario.h"           // log binário diferido (formatado no tempo ocioso)
+#include "lib/energia.h"               // ociosidade: WFE entre eventos e economia do CYW43
+#include "lib/painel.h"                // estado do painel e comandos compartilhados (MQTT, HTTP)
+#include "lib/http_painel.h"           // servidor HTTP local (status e comandos)
+#include "lib/udp_comando.h"           // canal UDP de comandos em lote (baixa latência)
+#include "lib/adc_amostragem.h"        // ADC em round-robin contínuo via DMA
+#include "lib/joystick.h"              // eixos do joystick: brilho e cômodo
+#include "lib/alarme.h"                // caminho rápido do alarme de temperatura
+#include "lib/fila_mqtt.h"             // classes de prioridade dos pedidos MQTT
+#include "lib/sensores.h"              // registro de sensores e publicação em lote
+#include "lib/historico.h"             // agregados de 1 min, 15 min e 1 h consultáveis via MQTT
+#include "lib/regras.h"                // regras de limiar e horário enviadas por MQTT
+#include "lib/flash_mapa.h"            // regiões da flash (armazenamento chave-valor)
+#include "lib/flash_pico.h"            // apagamento/gravação da flash com o XIP desligado
+#include "lib/kv_flash.h"              // armazenamento chave-valor com desgaste distribuído
+#include "lib/config_painel.h"         // configuração persistente e último estado do painel
+#include "lib/cenas.h"                 // várias mudanças do painel aplicadas de uma vez
+#include "lib/ota.h"                   // atualização de firmware pela rede (slots A/B)
+#include "lib/gateway.h"               // estado consolidado da casa (modo gateway)
 
+// valores de fábrica: usados enquanto não houver configuração gravada na flash (ver casa/config)
 // credenciais Wi-Fi
 #define WIFI_SSID "Apartamento 01"     // ssid (nome) da rede Wi-Fi para conexão
 #define WIFI_PASSWORD "12345678"       // senha da rede Wi-Fi para autenticação
@@ -21,6 +52,40 @@
 // endereço do broker mqtt
 #define MQTT_BROKER_IP "192.168.0.103"  // ip do broker MQTT
 
+// identificação no broker (podem ser sobrescritas com -D na compilação); sem MQTT_CLIENT_ID e
+// MQTT_PREFIXO, o id do cliente e o prefixo dos tópicos vêm do ID único da placa ("painel-<id>" e
+// "casa/<id>"), então várias placas convivem no mesmo broker
+#ifndef MQTT_RAIZ
+#define MQTT_RAIZ "casa"               // primeiro nível de todos os tópicos (o gateway agrega "<raiz>/+/...")
+#endif
+#ifndef MQTT_GATEWAY
+#define MQTT_GATEWAY "0"               // "1": este painel publica o estado consolidado da casa
+#endif
+#ifndef MQTT_USUARIO
+#define MQTT_USUARIO "Vinicius"        // usuário para autenticação no broker
+#endif
+#ifndef MQTT_SENHA
+#define MQTT_SENHA "Vinicius"          // senha para autenticação no broker
+#endif
+#define MQTT_RECONEXAO_MS 5000         // intervalo entre tentativas de reconexão
+#define HISTORICO_RESPOSTA_MAX 1024    // maior resposta de histórico (cabe no buffer de saída do MQTT)
+#define TOPICO_MAX 64                  // maior tópico do nó ("<prefixo>/<sufixo>", prefixo de até CONFIG_PREFIXO_MAX)
+#define TOPICO_GATEWAY_ESTADO MQTT_RAIZ "/gateway/estado" // consolidado da casa, retido (modo gateway)
+#define GATEWAY_PERIODO_MS 1000        // no máximo uma publicação do consolidado por segundo
+#define ESTADOS_PERIODO_MS 30000       // estados são retidos: a republicação só cobre um broker reiniciado
+#define BRILHO_PERIODO_MS 1000         // brilho publicado no máximo uma vez por segundo enquanto o joystick ajusta
+#define OTA_WATCHDOG_MS 8000           // imagem em teste: reinicia (e conta tentativa) se o loop travar
+#define BOTAO_DEBOUNCE_MS 200          // bordas de um botão mais próximas que isso são repique
+
+#ifdef MQTT_CERT_INC
+#include MQTT_CERT_INC                 // certificado da CA do broker (TLS_ROOT_CERT)
+#endif
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+#define MQTT_PORTA LWIP_IANA_PORT_SECURE_MQTT // 8883 com TLS
+#else
+#define MQTT_PORTA LWIP_IANA_PORT_MQTT // 1883 em texto puro
+#endif
+
 // definições de pinos
 #define BUTTON_A 5                     // gpio para botão A (alterna cômodos ou desliga LEDs com pressão longa)
 #define BUTTON_B 6                     // GPIO para Botão B (desliga emergência)
@@ -29,29 +94,55 @@
 #define LED_G 11                       // GPIO do LED RGB verde
 #define LED_B 12                       // GPIO do LED RGB azul
 #define LED_R 13                       // GPIO do LED RGB vermelho
+#define LED_PWM_TOPO 4095              // PWM do LED RGB: 12 bits (~30 kHz a 125 MHz)
 #define I2C_SDA 14                     // GPIO para pino SDA do I2C (OLED)
 #define I2C_SCL 15                     // GPIO para pino SCL do I2C (OLED)  
 #define I2C_PORT i2c1                  // porta I2C usada para o display OLED
 #define OLED_ADDRESS 0x3C              // endereço I2C do display OLED SSD1306
+#ifdef OLED_SPI                        // OLED no SPI (-DOLED_DRIVER=ssd1306_spi ou sh1106_spi)
+#define OLED_SPI_PORT spi0             // porta SPI do OLED
+#define OLED_SPI_HZ (10 * 1000 * 1000) // 10 MHz pedidos (8,9 MHz reais com clk_peri de 125 MHz)
+#define OLED_SCK 18                    // GPIO do clock SPI
+#define OLED_MOSI 19                   // GPIO dos dados SPI
+#define OLED_CS 17                     // GPIO do chip select
+#define OLED_DC 16                     // GPIO de dados/comando
+#define OLED_RST 20                    // GPIO de reset do controlador
+#endif
 #define JOYSTICK 22                    // GPIO para botão do joystick (muda cor)
 #define WIDTH 128                      // largura do display OLED 
 #define HEIGHT 64                      // altura do display OLED 
+#define REGRAS_PADRAO "se temperatura > 40 histerese 1 entao alarme" // regra ativa até o primeiro envio
+#ifdef SENSOR_BH1750
+#define BH1750_ADDRESS 0x23            // sensor de luminosidade opcional no barramento do OLED
+#endif
 
 // variáveis globais
-typedef enum { VERMELHO, VERDE, AZUL, AMARELO, CIANO, LILAS } Cor; // enum para representar cores do LED RGB e matriz
-typedef enum { QUARTO_1, QUARTO_2, COZINHA, BANHEIRO } Comodo;   // enum para representar os 4 cômodos controlados
-static Cor cor_atual = VERMELHO;       // cor inicial do LED RGB e matriz (
-static Comodo comodo_atual = QUARTO_1;// cômodo inicial 
-static bool led_ligado = false;        // estado inicial do LED RGB e matriz (desligado)
-static bool emergencia = false;        // estado inicial do modo de emergência (desativado)
+// (cor, cômodo, LED, emergência e brilho ficam em 'painel', ver lib/painel.c)
 static ssd1306_t disp;                 // estrutura para controlar o display OLED 
-static uint32_t ultima_leitura_temperatura = 0; // timestamp da última leitura de temperatura
 static uint32_t ultimo_botao = 0;      // timestamp da última verificação de botões
 static uint32_t ultima_atualizacao_oled = 0; // timestamp da última atualização do OLED
 static uint32_t ultimo_buzzer = 0;     // timestamp da última alternância do buzzer
+typedef struct {
+    bool pressionado;                   // estado aceito (sem repique)
+    uint32_t borda;                     // timestamp da última mudança aceita
+} BotaoDebounce;
+static BotaoDebounce botao_joystick, botao_a, botao_b; // botões com debounce por timestamp (sem bloquear o loop)
 static uint32_t botao_a_pressao_inicio = 0; // timestamp do início da pressão do botão A
-static bool botao_a_pressionado = false; // estado do botão A 
+static EstadoDisplay estado_display = DISPLAY_NORMAL; // brilho atual do OLED
 static uint32_t ultima_publicacao_estado = 0; // timestamp da última publicação de estados mqtt
+static uint32_t ultima_publicacao_gateway = 0; // timestamp da última publicação do consolidado da casa
+static uint32_t ultima_leitura_adc = 0; // timestamp da última leitura do anel do ADC (alarme e joystick)
+static uint64_t ultima_leitura_adc_us = 0; // o mesmo em µs: base da latência do joystick
+static uint32_t periodo_alarme = ALARME_PERIODO_MS; // próxima leitura do caminho rápido (rápido perto de um limite)
+static uint64_t joystick_acao_us = 0;  // leitura anterior a uma ação do joystick ainda não refletida nas saídas (0: nenhuma)
+static uint32_t ultima_publicacao_brilho = 0; // timestamp da última publicação do brilho
+static uint8_t brilho_publicado = 0;   // brilho publicado por último em <prefixo>/estado/brilho
+static int sensor_temperatura = -1;    // índice do sensor interno (regras avaliadas pelo caminho rápido)
+static volatile bool botoes_evento = false; // borda de botão sinalizada pela IRQ de GPIO
+static bool botoes_ativos = false;     // algum botão pressionado (exige varredura a cada 10ms)
+static float temperatura_atual = 0.0f; // última temperatura lida (usada fora do loop, ex.: HTTP)
+static volatile int32_t relogio_base_s = 0; // segundos do dia no boot (definido por casa/relogio)
+static volatile bool relogio_definido = false; // hora do dia conhecida
 
 // mapeamento da matriz de LEDS
 static const int pixel_map[5][5] = {   // índices dos LEDs na matriz 
@@ -73,26 +164,158 @@ static const int comodos[4][4] = {     // mapeamento dos LEDs para cada cômodo
 // LEDs da cruz central (9 LEDs, brancos fixos)
 static const int cruz[] = {22, 17, 12, 7, 2, 14, 13, 11, 10}; // índices dos LEDs que formam uma cruz no centro
 
+// tópicos do nó, relativos ao prefixo ("<prefixo>/<sufixo>", montados no boot em topicos[]);
+// os inscritos vêm primeiro: comandos na ordem de TipoComando (o índice identifica o tópico no
+// callback de dados e no log), depois os extras na ordem de TopicoExtra
+typedef enum {
+    TOPICO_COMANDO_LED, TOPICO_COMANDO_COR, TOPICO_COMANDO_COMODO, TOPICO_COMANDO_ALARME,
+    TOPICO_HISTORICO_PEDIDO,            // "<série> <1m|15m|1h> [quantidade]"
+    TOPICO_REGRAS,                      // texto das regras (ver lib/regras.h); substitui todas as anteriores
+    TOPICO_RELOGIO,                     // hora do dia "HH:MM" para as regras de horário (da casa: <raiz>/relogio)
+    TOPICO_CONFIG,                      // "nome=valor" gravado na flash (vale após reiniciar)
+    TOPICO_CENA,                        // campos "nome=valor" ou nome de uma cena gravada (ver lib/cenas.h)
+    TOPICO_CENA_DEFINIR,                // "<nome> <campos>" grava a cena; só "<nome>" remove
+    TOPICO_OTA_INICIO,                  // "<tamanho> <sha256 em hex>"
+    TOPICO_OTA_BLOCO,                   // deslocamento (u32 little-endian) + até OTA_BLOCO_MAX bytes
+    TOPICO_OTA_FIM,                     // confere o SHA-256 e troca os slots
+    TOPICO_ESTADO_LED,                  // estados, um bit cada em estados_pendentes (retidos)
+    TOPICO_ESTADO_COR, TOPICO_ESTADO_COMODO,
+    TOPICO_ESTADO_EMERGENCIA,           // classe do alarme: reenviado até o PUBACK (lib/alarme.h)
+    TOPICO_ESTADO_BRILHO,               // % (joystick); fora do lote de publish_states, com taxa limitada
+    TOPICO_HISTORICO_RESPOSTA,          // janela do histórico em JSON
+    TOPICO_REGRAS_STATUS,               // "ok <n>" ou "erro linha <k>: <motivo>"
+    TOPICO_REGRAS_EVENTO,               // payload das ações 'publicar'
+    TOPICO_CONFIG_STATUS,               // "ok <nome>" ou "erro"
+    TOPICO_CENA_STATUS,                 // "ok <nome>", "removida <nome>" ou "erro"
+    TOPICO_OTA_STATUS,                  // "ok <próximo deslocamento>", "verificado ...", "confirmado", "revertido", "erro ..."
+    TOPICO_PAINEL_STATUS,               // "online" ao conectar; "offline" (testamento) quando a conexão cai
+    TOPICO_TOTAL
+} TopicoNo;
+#define TOPICOS_INSCRITOS TOPICO_ESTADO_LED
+#define ESTADOS_TODOS ((1u << (TOPICO_HISTORICO_RESPOSTA - TOPICO_ESTADO_LED)) - 1)
+#define ESTADO_EMERGENCIA (1u << (TOPICO_ESTADO_EMERGENCIA - TOPICO_ESTADO_LED))
+#define ESTADO_BRILHO (1u << (TOPICO_ESTADO_BRILHO - TOPICO_ESTADO_LED))
+#define ESTADOS_ROTINA (ESTADOS_TODOS & ~ESTADO_EMERGENCIA & ~ESTADO_BRILHO) // lote de publish_states
+
+static const char *const sufixos_topico[TOPICO_TOTAL] = {
+    "comando/led", "comando/cor", "comando/comodo", "comando/alarme",
+    "historico/pedido", "regras", "relogio", "config", "comando/cena", "cena/definir", "ota/inicio", "ota/bloco", "ota/fim",
+    "estado/led", "estado/cor", "estado/comodo", "estado/emergencia", "estado/brilho",
+    "historico/resposta", "regras/status", "regras/evento", "config/status", "cena/status", "ota/status", "painel/status",
+};
+static char topicos[TOPICO_TOTAL][TOPICO_MAX]; // tópicos completos do nó
+static const char *prefixo_no = "";    // prefixo dos tópicos do nó (configuração "prefixo")
+
+// filtros do modo gateway, inscritos depois dos tópicos do nó (inclui os do próprio nó)
+static const char *const filtros_gateway[] = {
+    MQTT_RAIZ "/+/estado/+", MQTT_RAIZ "/+/painel/status", MQTT_RAIZ "/+/temperatura"
+};
+#define FILTROS_GATEWAY (sizeof(filtros_gateway) / sizeof(filtros_gateway[0]))
+static bool gateway_ativo = false;     // configuração "gateway=1"
+static uint8_t inscricoes_total = TOPICOS_INSCRITOS; // com os filtros do gateway, se ativo
+
+// tópicos tratados fora da tabela de comandos
+typedef enum { TOPICO_EXTRA_NENHUM, TOPICO_EXTRA_GATEWAY, TOPICO_EXTRA_HISTORICO, TOPICO_EXTRA_REGRAS, TOPICO_EXTRA_RELOGIO,
+               TOPICO_EXTRA_CONFIG, TOPICO_EXTRA_CENA, TOPICO_EXTRA_CENA_DEFINIR, TOPICO_EXTRA_OTA_INICIO, TOPICO_EXTRA_OTA_BLOCO, TOPICO_EXTRA_OTA_FIM } TopicoExtra; // OTA por último
+
 // estrutura para dados MQTT
 typedef struct {                        // estrutura para gerenciar conexão MQTT
     mqtt_client_t *mqtt_client_inst;    // instância do cliente MQTT
     struct mqtt_connect_client_info_t mqtt_client_info; // informações de conexão (id, usuário, senha)
     ip_addr_t mqtt_server_address;      // endereço ip do broker MQTT
-    char topic[32];                     // buffer para armazenar tópico atual
+    TipoComando topico;                 // tópico da mensagem em recepção (COMANDO_TOTAL se desconhecido)
+    TopicoExtra extra;                  // mensagem em recepção em tópico fora da tabela de comandos
+    char gateway_topico[TOPICO_MAX];    // tópico da mensagem de outro nó em recepção (modo gateway)
+    char pedido_historico[32];          // pedido recebido, respondido pelo loop principal
+    volatile bool historico_pendente;   // pedido_historico aguardando resposta
+    char regras_texto[REGRAS_TEXTO_MAX]; // regras recebidas (podem chegar em vários pedaços)
+    uint16_t regras_recebidos;          // bytes já recebidos
+    bool regras_descartar;              // texto maior que o buffer ou anterior ainda pendente
+    volatile bool regras_pendente;      // regras_texto completo, compilado pelo loop principal
+    char pedido_config[CONFIG_VALOR_MAX + 16]; // "nome=valor" recebido, gravado pelo loop principal
+    volatile bool config_pendente;      // pedido_config aguardando gravação
+    char pedido_cena[CONFIG_VALOR_MAX + 16]; // definição de cena recebida, gravada pelo loop principal
+    volatile bool cena_pendente;        // pedido_cena aguardando gravação
+    uint8_t ota_dados[4 + OTA_BLOCO_MAX]; // etapa da atualização recebida (pode chegar em vários pedaços)
+    uint16_t ota_recebidos;             // bytes já recebidos
+    bool ota_descartar;                 // maior que o buffer ou etapa anterior ainda pendente
+    volatile TopicoExtra ota_pendente;  // etapa completa, tratada pelo loop principal
     bool connect_done;                  // flag para indicar conexão bem-sucedida
+    uint8_t inscritos;                  // tópicos já pedidos ao broker nesta conexão
+    uint8_t estados_pendentes;          // tópicos de estado recusados pelo lwIP (fila de pedidos cheia)
+    uint32_t conexoes;                  // conexões aceitas desde o boot
+    uint32_t recusadas;                 // publicações recusadas pelo lwIP (MQTT_REQ_MAX_IN_FLIGHT ou buffer de saída)
+    bool conectando;                    // tentativa de conexão em andamento
+    uint32_t ultima_tentativa;          // timestamp da última tentativa de conexão
+    uint64_t inicio_conexao_us;         // início da tentativa (mede TCP + TLS + CONNECT)
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+    struct altcp_tls_session *sessao_tls; // sessão TLS guardada para retomada (ticket/ID)
+    bool sessao_valida;                 // sessao_tls contém uma sessão negociada
+    bool sessao_oferecida;              // a tentativa atual ofereceu a sessão guardada
+#endif
 } MQTT_CLIENT_DATA_T;
+static MQTT_CLIENT_DATA_T *mqtt_estado = NULL; // cliente MQTT usado para publicar mudanças feitas por outros canais
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+static size_t tls_heap_uso = 0;        // bytes alocados pelo mbedTLS agora (sempre sob o lock do lwIP)
+static size_t tls_heap_pico = 0;       // maior tls_heap_uso desde o início da conexão (handshake incluído)
+#endif
 
 // protótipos de funções
 void inicializar_perifericos(void);     // inicializa GPIOs para LED RGB, botões, e buzzer
-float ler_temperatura(void);            // lê temperatura do sensor interno via ADC
+float ler_temperatura(float bruto);     // converte a média do canal 4 do ADC em °C
 void configurar_led_rgb(Cor cor, bool estado); // configura LED RGB com cor e estado
 void atualizar_matriz(void);            // atualiza matriz WS2812 com base no cômodo, cor e estado
 void atualizar_display(void);           // atualiza display OLED com informações do sistema
 static void mqtt_connection_cb(mqtt_client_t *client, void *arg, mqtt_connection_status_t status); // callback de conexão MQTT
 static void mqtt_incoming_publish_cb(void *arg, const char *topic, u32_t tot_len); // callback para tópico recebido
 static void mqtt_incoming_data_cb(void *arg, const u8_t *data, u16_t len, u8_t flags); // callback para dados recebidos
-static void publish_temperature(MQTT_CLIENT_DATA_T *state); // publica temperatura no tópico MQTT
+static void temperatura_lida(float temperatura); // guarda a temperatura para display e HTTP
+static void executar_regra(uint8_t regra, const RegraAcao *acao, float valor); // ação de uma regra disparada
+static void avaliar_regras(int sensor, float valor); // observador de leituras: avalia as regras do sensor
+static void carregar_regras(MQTT_CLIENT_DATA_T *state); // compila as regras recebidas e responde o status
+static void aplicar_config(MQTT_CLIENT_DATA_T *state, uint32_t agora); // grava "nome=valor" e responde o status
+static void definir_cena(MQTT_CLIENT_DATA_T *state, uint32_t agora); // grava ou remove uma cena e responde o status
+static bool kv_apagar_setor(uint32_t deslocamento); // operações de flash do armazenamento chave-valor
+static bool kv_gravar_pagina(uint32_t deslocamento, const uint8_t *pagina);
+static void tratar_ota(MQTT_CLIENT_DATA_T *state, uint32_t agora); // etapa de atualização recebida
+static void publicar_ota(MQTT_CLIENT_DATA_T *state, const char *status); // responde em casa/ota/status
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+static void *tls_calloc(size_t n, size_t tamanho); // alocação do mbedTLS contada em tls_heap_uso e tls_heap_pico
+static void tls_free(void *p);
+#endif
+static bool ota_apagar_setor(uint32_t deslocamento); // operações de flash da atualização
+static bool ota_gravar(uint32_t deslocamento, const uint8_t *dados, size_t tamanho);
+static void ota_reiniciar(void);
+static float adc_para_volts(float bruto); // converte a média de um canal do ADC em volts
+static void publicar_sensores(const char *topico, const char *payload); // publica um lote de sensores
+static void registrar_sensores(void);   // declara os sensores lidos pelo escalonador
+#ifdef SENSOR_BH1750
+static bool ler_bh1750(float *lux);     // lê o sensor de luminosidade via I2C
+#endif
 static void publish_states(MQTT_CLIENT_DATA_T *state); // publica estados dos periféricos nos tópicos MQTT
+static err_t publicar(MQTT_CLIENT_DATA_T *state, ClasseMqtt classe, const char *topico, const void *dados, size_t n,
+                      bool retido); // QoS 1 na classe de prioridade, conta recusas
+static void mqtt_continuar(MQTT_CLIENT_DATA_T *state); // inscrições e estados que esperavam um pedido livre
+static void mqtt_pedido_cb(void *arg, err_t erro); // resposta do broker: libera um pedido do lwIP
+static void mqtt_telemetria_cb(void *arg, err_t erro); // idem, pedido da classe de telemetria
+static void mqtt_alarme_cb(void *arg, err_t erro); // PUBACK (ou expiração) de estado/emergencia
+static void botoes_irq_cb(uint gpio, uint32_t eventos); // acorda o loop em bordas dos botões
+static bool botao_mudou(BotaoDebounce *botao, bool lido, uint32_t agora); // debounce: true se o estado aceito mudou
+static uint32_t calcular_espera(uint32_t agora); // tempo até o próximo prazo do loop principal
+static bool executar_comando(TipoComando tipo, int valor, OrigemComando origem); // aplica comando de qualquer canal
+static bool executar_cena(const char *texto, OrigemComando origem); // aplica os campos de uma cena de uma vez
+static size_t gerar_status_json(char *buf, size_t tamanho); // estado + diagnóstico para o HTTP
+static bool executar_comando_http(TipoComando tipo, const char *valor); // comando recebido via HTTP
+static bool executar_comando_udp(TipoComando tipo, int valor); // comando recebido via UDP
+static void publicar_estados_local(void); // publica estados após comandos HTTP/UDP
+static void mqtt_conectar(MQTT_CLIENT_DATA_T *state); // inicia (ou reinicia) a conexão com o broker
+static void responder_historico(MQTT_CLIENT_DATA_T *state); // publica a janela de histórico pedida
+static void montar_topicos(const char *prefixo); // tópicos completos do nó
+static bool publicar_gateway(MQTT_CLIENT_DATA_T *state); // publica o consolidado da casa, se mudou
+static void tratar_joystick(MQTT_CLIENT_DATA_T *state, uint32_t agora); // brilho e cômodo pelos eixos do joystick
+static void vigiar_temperatura(uint32_t decorrido); // caminho rápido do alarme: temperatura filtrada nas regras
+static uint32_t periodo_adc(void);      // próxima leitura do anel do ADC (alarme e joystick)
+static void publicar_brilho(MQTT_CLIENT_DATA_T *state); // publica o brilho atual (retido)
 
 // função principal
 int main() {                            // ponto de entrada do programa
@@ -102,8 +325,58 @@ int main() {                            // ponto de entrada do programa
 
     // inicializa periféricos e sensores
     inicializar_perifericos();          // configura GPIOs para LED RGB, botões, e buzzer
-    adc_init();                         // inicializa módulo ADC para leitura de temperatura
-    adc_set_temp_sensor_enabled(true);  // ativa sensor de temperatura interno do RP2040
+
+    // configuração e último estado gravados na flash (uma passada pelo setor mais recente)
+    static KvFlash kv_painel = {
+        .tamanho_setor = FLASH_SETOR, .tamanho_pagina = FLASH_PAGINA, .setores = FLASH_KV_SETORES,
+        .apagar = kv_apagar_setor, .gravar = kv_gravar_pagina,
+    };
+    kv_painel.base = flash_pico_mapa(FLASH_KV_INICIO);
+    bool kv_valido = kv_iniciar(&kv_painel);
+    // identificação do nó: últimos 4 bytes do ID único da flash (os primeiros se repetem entre placas)
+    pico_unique_board_id_t id_placa;
+    pico_get_unique_board_id(&id_placa);
+    char id_no[9];
+    snprintf(id_no, sizeof(id_no), "%02X%02X%02X%02X", id_placa.id[4], id_placa.id[5], id_placa.id[6], id_placa.id[7]);
+    static char client_id_padrao[CONFIG_VALOR_MAX], prefixo_padrao[CONFIG_PREFIXO_MAX + 1];
+#ifdef MQTT_CLIENT_ID
+    snprintf(client_id_padrao, sizeof(client_id_padrao), "%s", MQTT_CLIENT_ID);
+#else
+    snprintf(client_id_padrao, sizeof(client_id_padrao), "painel-%s", id_no);
+#endif
+#ifdef MQTT_PREFIXO
+    snprintf(prefixo_padrao, sizeof(prefixo_padrao), "%s", MQTT_PREFIXO);
+#else
+    snprintf(prefixo_padrao, sizeof(prefixo_padrao), MQTT_RAIZ "/%s", id_no);
+#endif
+    const char *const config_padrao[CONFIG_TOTAL] = {
+        WIFI_SSID, WIFI_PASSWORD, MQTT_BROKER_IP, MQTT_USUARIO, MQTT_SENHA, client_id_padrao, prefixo_padrao, MQTT_GATEWAY
+    };
+    config_carregar(config_padrao);
+    cenas_carregar();
+    montar_topicos(config_valor(CONFIG_PREFIXO));
+    gateway_ativo = strcmp(config_valor(CONFIG_GATEWAY), "1") == 0;
+    if (gateway_ativo) {                // inscreve também os filtros "<raiz>/+/..." dos demais nós
+        gateway_iniciar(MQTT_RAIZ);
+        inscricoes_total = TOPICOS_INSCRITOS + FILTROS_GATEWAY;
+    }
+    printf("Nó %s: cliente MQTT %s, tópicos em %s/%s\n", id_no, config_valor(CONFIG_CLIENT_ID), prefixo_no,
+           gateway_ativo ? " (gateway da casa)" : "");
+    bool restaurado = config_restaurar_painel(); // cor, cômodo, LED e brilho da última execução
+    brilho_publicado = painel.brilho;   // sai retido a cada conexão
+    LOG_INFO(EV_KV_INICIADO, kv_valido, kv_estatisticas()->lotes, kv_estatisticas()->descartados, restaurado);
+
+    // atualização A/B: conta a tentativa se a imagem está em teste (ou desfaz a troca se esgotou)
+    static const OtaFlash ota_painel = {
+        .slot_a = FLASH_SLOT_A, .slot_b = FLASH_SLOT_B, .tamanho_slot = FLASH_OTA_SLOT,
+        .meta = FLASH_OTA_META, .rascunho = FLASH_OTA_RASCUNHO, .tamanho_setor = FLASH_SETOR, .tamanho_pagina = FLASH_PAGINA,
+        .mapa = flash_pico_mapa, .apagar = ota_apagar_setor, .gravar = ota_gravar, .reiniciar = ota_reiniciar,
+    };
+    extern char __flash_binary_end;     // fim da imagem em execução (script de ligação do SDK)
+    uint32_t tamanho_firmware = (uint32_t)((uintptr_t)&__flash_binary_end - (XIP_BASE + FLASH_SLOT_A));
+    OtaEstado ota_boot = ota_iniciar(&ota_painel, tamanho_firmware, to_ms_since_boot(get_absolute_time()));
+    LOG_INFO(EV_OTA_INICIADA, ota_boot, tamanho_firmware / 1024);
+    adc_amostragem_init();              // ADC contínuo via DMA (temperatura interna, eixos do joystick e ADC2)
 
     // inicializa I2C e OLED
     i2c_init(I2C_PORT, 400 * 1000);     // configura I2C a 400kHz para comunicação rápida
@@ -112,10 +385,29 @@ int main() {                            // ponto de entrada do programa
     gpio_pull_up(I2C_SDA);              // habilita pull-up interno para SDA
     gpio_pull_up(I2C_SCL);              // habilita pull-up interno para SCL
     sleep_ms(500);                      // aguarda 500ms para estabilizar I2C
+#ifdef OLED_SPI
+    spi_init(OLED_SPI_PORT, OLED_SPI_HZ); // OLED no SPI; o I2C continua para os sensores
+    gpio_set_function(OLED_SCK, GPIO_FUNC_SPI);
+    gpio_set_function(OLED_MOSI, GPIO_FUNC_SPI);
+    gpio_init(OLED_RST);                // pulso de reset antes da configuração
+    gpio_set_dir(OLED_RST, GPIO_OUT);
+    gpio_put(OLED_RST, 0);
+    sleep_ms(1);
+    gpio_put(OLED_RST, 1);
+    ssd1306_init_spi(&disp, WIDTH, HEIGHT, false, OLED_SPI_PORT, OLED_CS, OLED_DC); // inicializa estrutura do OLED
+#else
     ssd1306_init(&disp, WIDTH, HEIGHT, false, OLED_ADDRESS, I2C_PORT); // inicializa estrutura do OLED
+#endif
+#ifdef OLED_SH1106
+    ssd1306_set_driver(&disp, &sh1106_driver); // módulos com SH1106 (RAM de 132 colunas, modo página)
+#endif
     ssd1306_config(&disp);              // configura parâmetros do display OLED
     ssd1306_fill(&disp, 0);             // limpa o buffer do display
     ssd1306_send_data(&disp);           // envia buffer inicial ao OLED
+    registrar_sensores();               // sensores lidos pelo escalonador (ADC e I2C)
+    char erro_regras[48];
+    regras_carregar(REGRAS_PADRAO, sensores_por_nome, erro_regras, sizeof(erro_regras)); // emergência por temperatura
+    sensores_observar(avaliar_regras);  // cada leitura passa pelas regras do sensor
 
     // inicializa WS2812
     PIO pio = pio0;                     // usa PIO0 para controlar a matriz WS2812
@@ -129,10 +421,12 @@ int main() {                            // ponto de entrada do programa
     }
     cyw43_arch_enable_sta_mode();       // ativa modo estação (cliente Wi-Fi)
     printf("Conectando ao Wi-Fi...\n"); // loga tentativa de conexão
-    if (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK, 20000)) { // tenta conectar com timeout de 20s
+    if (cyw43_arch_wifi_connect_timeout_ms(config_valor(CONFIG_WIFI_SSID), config_valor(CONFIG_WIFI_SENHA), CYW43_AUTH_WPA2_AES_PSK, 20000)) { // tenta conectar com timeout de 20s
         printf("Falha na conexão Wi-Fi\n"); // loga erro se a conexão falhar
+        if (ota_em_teste()) watchdog_reboot(0, 0, 0); // imagem em teste: conta como tentativa falha
         return -1;                      // encerra programa em caso de falha
     }
+    if (ota_em_teste()) watchdog_enable(OTA_WATCHDOG_MS, true); // desligado na confirmação
     printf("Conectado ao Wi-Fi\n");     // confirma conexão bem-sucedida
     if (netif_default) {                // verifica se a interface de rede está ativa
         printf("IP: %s\n", ipaddr_ntoa(&netif_default->ip_addr)); // exibe endereço IP no Serial Monitor
@@ -140,116 +434,219 @@ int main() {                            // ponto de entrada do programa
 
     static MQTT_CLIENT_DATA_T state = { // inicializa estrutura de dados MQTT
         .mqtt_client_info = {           // configura informações de conexão MQTT
-            .client_id = "smart_home",  // id único do cliente MQTT
             .keep_alive = 60,           // intervalo de keep-alive em segundos
-            .client_user = "Vinicius",  // usuário para autenticação no broker
-            .client_pass = "Vinicius"   // senha para autenticação no broker
+            .will_topic = topicos[TOPICO_PAINEL_STATUS], // o broker publica "offline" se o keep-alive vencer
+            .will_msg = "offline",
+            .will_qos = 1,
+            .will_retain = 1,
         }
     };
+    state.mqtt_client_info.client_id = config_valor(CONFIG_CLIENT_ID); // id único do cliente MQTT
+    state.mqtt_client_info.client_user = config_valor(CONFIG_MQTT_USUARIO); // usuário para autenticação no broker
+    state.mqtt_client_info.client_pass = config_valor(CONFIG_MQTT_SENHA); // senha para autenticação no broker
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+    mbedtls_platform_set_calloc_free(tls_calloc, tls_free); // antes da configuração: mede tudo o que o mbedTLS aloca
+#ifdef MQTT_CERT_INC
+    static const uint8_t ca_cert[] = TLS_ROOT_CERT; // CA que assinou o certificado do broker
+    state.mqtt_client_info.tls_config = altcp_tls_create_config_client(ca_cert, sizeof(ca_cert)); // valida o broker
+#else
+    state.mqtt_client_info.tls_config = altcp_tls_create_config_client(NULL, 0); // TLS sem validação (apenas testes)
+#endif
+    state.sessao_tls = altcp_tls_alloc_session(); // espaço para a sessão reaproveitada
+#endif
     state.mqtt_client_inst = mqtt_client_new(); // cria nova instância do cliente MQTT
-    ipaddr_aton(MQTT_BROKER_IP, &state.mqtt_server_address); // converte ip do broker para formato lwip
-    mqtt_client_connect(state.mqtt_client_inst, &state.mqtt_server_address, LWIP_IANA_PORT_MQTT, mqtt_connection_cb, &state, &state.mqtt_client_info); // inicia conexão MQTT
-    mqtt_set_inpub_callback(state.mqtt_client_inst, mqtt_incoming_publish_cb, mqtt_incoming_data_cb, &state); // define callbacks para mensagens MQTT
+    ipaddr_aton(config_valor(CONFIG_BROKER_IP), &state.mqtt_server_address); // converte ip do broker para formato lwip
+    mqtt_conectar(&state);              // inicia conexão MQTT
+    mqtt_estado = &state;               // acesso ao cliente MQTT para os canais locais
+    static const HttpPainelCallbacks http_callbacks = { // integra o servidor HTTP ao painel
+        .gerar_status = gerar_status_json,
+        .executar = executar_comando_http,
+        .publicar = publicar_estados_local,
+    };
+    cyw43_arch_lwip_begin();            // httpd e UDP criam PCBs do lwIP
+    http_painel_init(&http_callbacks);  // inicia servidor HTTP na porta 80
+    udp_comando_init(executar_comando_udp, publicar_estados_local); // canal UDP de baixa latência
+    cyw43_arch_lwip_end();
+    energia_init();                     // inicia medição do ciclo ativo e modo de desempenho do CYW43
+
+    joystick_iniciar(adc_amostragem_media(JOYSTICK_CANAL_X, 32), adc_amostragem_media(JOYSTICK_CANAL_Y, 32)); // centro em repouso
+    alarme_iniciar(ler_temperatura(adc_amostragem_media(ADC_CANAL_TEMPERATURA, 32))); // filtro sem transitório
+    uint32_t assinatura_saidas = UINT32_MAX; // estado refletido por último no LED RGB e na matriz
 
     while (true) {                      // loop principal
         cyw43_arch_poll();              // processa eventos de rede (lwip) para manter MQTT ativo
         uint32_t agora = to_ms_since_boot(get_absolute_time()); // obtém tempo atual em milissegundos
 
-        // verifica botões a cada 10ms
-        if (agora - ultimo_botao >= 10) { // verifica botões a cada 10ms para responsividade
-            static bool botao_joystick_pressionado = false; // estado anterior do joystick
-            static bool botao_b_pressionado = false; // estado anterior do botão B
-
+        // verifica botões a cada 10ms enquanto houver botão pressionado ou borda sinalizada
+        if ((botoes_evento || botoes_ativos) && agora - ultimo_botao >= 10) { // verifica botões a cada 10ms para responsividade
+            botoes_evento = false;            // consome a sinalização da IRQ
             bool estado_joystick = !gpio_get(JOYSTICK); // lê estado do joystick 
             bool estado_botao_a = !gpio_get(BUTTON_A);  // lê estado do botão A 
             bool estado_botao_b = !gpio_get(BUTTON_B);  // lê estado do botão B
 
-            if (estado_joystick && !botao_joystick_pressionado) { // detecta nova pressão do joystick
-                cor_atual = (cor_atual + 1) % 6; // cicla para a próxima cor (0 a 5)
-                printf("Botão Joystick: cor alterada para %d\n", cor_atual); // loga mudança de cor
+            if (botao_mudou(&botao_joystick, estado_joystick, agora) && botao_joystick.pressionado) { // nova pressão do joystick
+                painel.cor = (painel.cor + 1) % 6; // cicla para a próxima cor (0 a 5)
+                LOG_INFO(EV_BOTAO_JOYSTICK_COR, painel.cor); // loga mudança de cor
                 publish_states(&state);     // publica novo estado dos periféricos
-                botao_joystick_pressionado = true; // marca joystick como pressionado
-                sleep_ms(200);              // debounce de 200ms para evitar múltiplas leituras
-            } else if (!estado_joystick) {  // joystick liberado
-                botao_joystick_pressionado = false; // reseta estado do joystick
             }
 
             // botão A: alterna cômodos ou desliga com pressão longa
-            if (estado_botao_a && !botao_a_pressionado) { // detecta nova pressão do botão A
-                botao_a_pressionado = true;    // marca botão A como pressionado
+            bool mudou_a = botao_mudou(&botao_a, estado_botao_a, agora);
+            if (mudou_a && botao_a.pressionado) { // nova pressão do botão A
                 botao_a_pressao_inicio = agora; // registra timestamp do início da pressão
-                printf("Botão A: pressionado\n\n"); // loga ação
-            } else if (estado_botao_a && botao_a_pressionado) { // botão A mantido pressionado
-                if (agora - botao_a_pressao_inicio >= 3000) { // se pressão longa (≥3s)
-                    led_ligado = false;        // desliga LEDs do cômodo
-                    printf("Botão A: LEDs do cômodo desligados (pressão longa)\n\n"); // loga ação
-                    publish_states(&state); // publica novo estado
-                }
-            } else if (!estado_botao_a && botao_a_pressionado) { // botão A liberado
-                if (agora - botao_a_pressao_inicio < 3000) { // se pressão curta (<3s)
-                    comodo_atual = (comodo_atual + 1) % 4; // cicla para o próximo cômodo
-                    led_ligado = true;         // liga LEDs do novo cômodo
-                    printf("Botão A: cômodo alterado para %d\n", comodo_atual); // loga mudança
+                LOG_DEBUG(EV_BOTAO_A_PRESSIONADO); // loga ação
+            } else if (botao_a.pressionado) { // botão A mantido pressionado
+                if (agora - botao_a_pressao_inicio >= 3000 && painel.led_ligado) { // pressão longa (≥3s), uma vez só
+                    painel.led_ligado = false;        // desliga LEDs do cômodo
+                    LOG_INFO(EV_BOTAO_A_LONGO); // loga ação
                     publish_states(&state); // publica novo estado
                 }
-                botao_a_pressionado = false;   // reseta estado do botão A
-                sleep_ms(200);                 // debounce de 200ms
+            } else if (mudou_a && agora - botao_a_pressao_inicio < 3000) { // botão A liberado após pressão curta (<3s)
+                painel.comodo = (painel.comodo + 1) % 4; // cicla para o próximo cômodo
+                painel.led_ligado = true;         // liga LEDs do novo cômodo
+                LOG_INFO(EV_BOTAO_A_COMODO, painel.comodo); // loga mudança
+                publish_states(&state); // publica novo estado
             }
 
             // botão B: desliga emergência
-            if (estado_botao_b && !botao_b_pressionado) { // detecta nova pressão do botão B
-                emergencia = false;            // desativa modo de emergência
-                printf("Botão B: alarme desligado\n\n"); // loga ação
+            if (botao_mudou(&botao_b, estado_botao_b, agora) && botao_b.pressionado) { // nova pressão do botão B
+                painel.emergencia = false;            // desativa modo de emergência
+                LOG_INFO(EV_BOTAO_B_ALARME); // loga ação
                 publish_states(&state);        // publica novo estado
-                botao_b_pressionado = true;    // marca botão B como pressionado
-                sleep_ms(200);                 // debounce de 200ms
-            } else if (!estado_botao_b) {      // botão B liberado
-                botao_b_pressionado = false;   // reseta estado do botão B
             }
 
+            botoes_ativos = estado_joystick || estado_botao_a || estado_botao_b || // mantém a varredura enquanto pressionado
+                            botao_joystick.pressionado || botao_a.pressionado || botao_b.pressionado; // ou até aceitar a soltura
+            if (botoes_ativos) energia_atividade(); // botão conta como atividade do usuário
             ultimo_botao = agora;              // atualiza timestamp da verificação de botões
         }
 
-        // lê temperatura a cada 10000ms
-        if (agora - ultima_leitura_temperatura >= 10000) { // lê temperatura a cada 10s
-            publish_temperature(&state);    // publica temperatura no tópico MQTT
-            float temperatura = ler_temperatura(); // lê temperatura do sensor interno
-            if (temperatura > 40.0f) {      // se temperatura exceder 40°C
-                emergencia = true;          // ativa modo de emergência
-                printf("Emergência ativada: temperatura %.2f°C\n", temperatura); // loga emergência
-                publish_states(&state);     // publica novo estado
+        // leituras do anel do ADC (sem esperar conversão): caminho rápido do alarme e eixos do joystick na
+        // mesma acordada, a cada 10 ms perto de um limite ou com o joystick fora do centro e a cada 50 ms
+        // no repouso; a emergência sobe na mesma volta em que a temperatura filtrada cruza o limite
+        adc_amostragem_manter();            // mantém o DMA do ADC rodando
+        if (agora - ultima_leitura_adc >= periodo_adc()) {
+            vigiar_temperatura(agora - ultima_leitura_adc);
+            tratar_joystick(&state, agora);
+            ultima_leitura_adc = agora;
+            ultima_leitura_adc_us = time_us_64();
+        }
+
+        // lê os sensores vencidos e publica um lote por tópico
+        sensores_tick(agora, publicar_sensores);
+        if (state.historico_pendente) {     // pedido de histórico recebido pelo MQTT
+            responder_historico(&state);
+        }
+        if (state.regras_pendente) {        // novas regras recebidas pelo MQTT
+            carregar_regras(&state);
+        }
+        if (state.config_pendente) {        // configuração recebida pelo MQTT
+            aplicar_config(&state, agora);
+        }
+        if (state.cena_pendente) {          // definição de cena recebida pelo MQTT
+            definir_cena(&state, agora);
+        }
+        if (state.ota_pendente != TOPICO_EXTRA_NENHUM) { // etapa de atualização recebida pelo MQTT
+            tratar_ota(&state, agora);
+        }
+        if (state.connect_done && ota_em_teste() && ota_confirmar()) { // imagem nova chegou ao broker: saudável
+            watchdog_disable();
+            LOG_INFO(EV_OTA_CONFIRMADA, tamanho_firmware / 1024);
+            publicar_ota(&state, "confirmado");
+        }
+        if (state.connect_done && ota_boot == OTA_REVERTIDA) { // avisa uma vez que a imagem anterior voltou
+            publicar_ota(&state, "revertido");
+            ota_boot = OTA_INATIVA;
+        }
+        if (relogio_definido) {             // regras de horário, uma vez por minuto
+            static int ultimo_minuto = -1;
+            int minuto = (int)(((int64_t)relogio_base_s + agora / 1000) / 60 % 1440);
+            if (minuto != ultimo_minuto) {
+                regras_relogio(minuto, executar_regra);
+                ultimo_minuto = minuto;
+            }
+        }
+
+        // ajusta brilho do OLED conforme a ociosidade
+        EstadoDisplay novo_display = energia_estado_display(agora);
+        if (novo_display != estado_display) { // escurece, apaga ou reacende
+            if (novo_display == DISPLAY_APAGADO) {
+                ssd1306_power(&disp, false);  // desliga o painel do OLED
+            } else {
+                if (estado_display == DISPLAY_APAGADO) ssd1306_power(&disp, true); // religa o painel
+                ssd1306_contrast(&disp, novo_display == DISPLAY_ESCURO ? 0x10 : 0xFF); // contraste reduzido ou máximo
+                ultima_atualizacao_oled = agora - 1000; // redesenha já ao reacender
             }
-            ultima_leitura_temperatura = agora; // atualiza timestamp da leitura
+            LOG_INFO(EV_ENERGIA_DISPLAY, novo_display);
+            estado_display = novo_display;
         }
 
-        // atualiza display a cada 1000ms
-        if (agora - ultima_atualizacao_oled >= 1000) { // atualiza OLED a cada 1s
+        // atualiza display a cada 1000ms (apenas com o OLED aceso)
+        if (estado_display != DISPLAY_APAGADO && agora - ultima_atualizacao_oled >= 1000) { // atualiza OLED a cada 1s
             atualizar_display();            // exibe cômodo, temperatura, emergência e ip
             ultima_atualizacao_oled = agora; // atualiza timestamp do OLED
         }
 
         // controla buzzer em emergência
-        if (emergencia && agora - ultimo_buzzer >= 1000) { // se emergência ativa, alterna buzzer a cada 1s
+        if (painel.emergencia && agora - ultimo_buzzer >= 1000) { // se emergência ativa, alterna buzzer a cada 1s
             gpio_put(BUZZER, !gpio_get(BUZZER)); // inverte estado do buzzer (liga/desliga)
             ultimo_buzzer = agora;             // atualiza timestamp do buzzer
-        } else if (!emergencia && gpio_get(BUZZER)) { // se emergência desativada e buzzer ligado
+        } else if (!painel.emergencia && gpio_get(BUZZER)) { // se emergência desativada e buzzer ligado
             gpio_put(BUZZER, 0);               // desliga buzzer
         }
 
-        // atualiza LED RGB e matriz
-        if (!emergencia) {                     // se não estiver em emergência
-            configurar_led_rgb(cor_atual, led_ligado); // configura LED RGB com cor atual e estado
-        } else {                               // em emergência
-            configurar_led_rgb(cor_atual, false); // desliga LED RGB
+        // atualiza LED RGB e matriz apenas quando o estado muda; a cópia sob o lock do lwIP não pega uma cena
+        // (callback MQTT) pela metade. Se o painel mudar depois da cópia, a assinatura difere na próxima volta
+        cyw43_arch_lwip_begin();
+        EstadoPainel saidas = painel;
+        cyw43_arch_lwip_end();
+        uint32_t assinatura = (uint32_t)saidas.cor | ((uint32_t)saidas.comodo << 8) | ((uint32_t)saidas.led_ligado << 16) |
+                              ((uint32_t)saidas.emergencia << 17) | ((uint32_t)saidas.brilho << 24);
+        if (assinatura != assinatura_saidas) {
+            if (!saidas.emergencia) {                     // se não estiver em emergência
+                configurar_led_rgb(saidas.cor, saidas.led_ligado); // configura LED RGB com cor atual e estado
+            } else {                               // em emergência
+                configurar_led_rgb(saidas.cor, false); // desliga LED RGB
+            }
+            atualizar_matriz();                     // atualiza matriz WS2812 (cômodo + cruz)
+            config_salvar_painel(agora);            // último estado volta no próximo boot (gravação agrupada)
+            assinatura_saidas = assinatura;
+        }
+        if (joystick_acao_us) {                     // ação do joystick refletida (ou sem efeito nas saídas)
+            joystick_latencia((uint32_t)(time_us_64() - joystick_acao_us));
+            joystick_acao_us = 0;
+        }
+
+        // brilho ajustado pelo joystick: publicado ao soltar o eixo, no máximo um por BRILHO_PERIODO_MS enquanto ajusta
+        if (painel.brilho != brilho_publicado && state.connect_done &&
+            (!joystick_ativo() || agora - ultima_publicacao_brilho >= BRILHO_PERIODO_MS)) {
+            publicar_brilho(&state);
+            ultima_publicacao_brilho = agora;
         }
-        atualizar_matriz();                     // atualiza matriz WS2812 (cômodo + cruz)
 
-        if (agora - ultima_publicacao_estado >= 5000) { // publica estados a cada 5s
+        if (agora - ultima_publicacao_estado >= ESTADOS_PERIODO_MS) { // republica os estados retidos
+            alarme_republicar();            // emergência também, na classe do alarme
             publish_states(&state);         // publica estados dos periféricos
             ultima_publicacao_estado = agora; // atualiza timestamp da publicação
         }
 
-        sleep_ms(10);                       // delay de 10ms para evitar sobrecarga do loop
+        // gateway: consolidado da casa quando algum nó mudou, no máximo um por GATEWAY_PERIODO_MS
+        if (gateway_ativo && state.connect_done && gateway_pendente() &&
+            agora - ultima_publicacao_gateway >= GATEWAY_PERIODO_MS && publicar_gateway(&state)) {
+            ultima_publicacao_gateway = agora;
+        }
+
+        // reconecta ao broker se a conexão caiu (com TLS, retoma a sessão anterior)
+        if (!state.connect_done && !state.conectando && agora - state.ultima_tentativa >= MQTT_RECONEXAO_MS) {
+            mqtt_conectar(&state);
+        }
+
+        kv_manter(agora);                   // no máximo uma operação de flash por volta do loop
+        ota_manter(agora);                  // troca agendada e prazo de confirmação da imagem em teste
+        watchdog_update();                  // só tem efeito com a imagem em teste
+        energia_atualizar(agora);           // escolhe modo de economia do CYW43 e fecha janela do ciclo ativo
+        bool log_pendente = log_drenar(16) == 16; // formata logs pendentes no tempo ocioso
+        energia_dormir(log_pendente ? 0 : calcular_espera(agora)); // dorme até o próximo prazo ou interrupção
     }
 
     cyw43_arch_deinit();                   // desinicializa wi-fi
@@ -258,15 +655,14 @@ int main() {                            // ponto de entrada do programa
 
 // inicializa periféricos
 void inicializar_perifericos(void) {
-    gpio_init(LED_R);                          // inicializa GPIO do LED vermelho
-    gpio_set_dir(LED_R, GPIO_OUT);             // define como saída
-    gpio_put(LED_R, 0);                        // desliga LED vermelho
-    gpio_init(LED_G);                          // inicializa GPIO do LED verde
-    gpio_set_dir(LED_G, GPIO_OUT);             // define como saída
-    gpio_put(LED_G, 0);                        // desliga LED verde
-    gpio_init(LED_B);                          // inicializa GPIO do LED azul
-    gpio_set_dir(LED_B, GPIO_OUT);             // define como saída
-    gpio_put(LED_B, 0);                        // desliga LED azul
+    static const uint leds[3] = { LED_R, LED_G, LED_B };
+    for (int i = 0; i < 3; i++) {              // LED RGB no PWM (brilho ajustável pelo joystick)
+        uint fatia = pwm_gpio_to_slice_num(leds[i]);
+        gpio_set_function(leds[i], GPIO_FUNC_PWM);
+        pwm_set_wrap(fatia, LED_PWM_TOPO);     // 12 bits
+        pwm_set_gpio_level(leds[i], 0);        // começa desligado
+        pwm_set_enabled(fatia, true);
+    }
     gpio_init(JOYSTICK);                       // inicializa GPIO do joystick
     gpio_set_dir(JOYSTICK, GPIO_IN);           // define como entrada
     gpio_pull_up(JOYSTICK);                    // habilita pull-up interno
@@ -279,15 +675,197 @@ void inicializar_perifericos(void) {
     gpio_init(BUZZER);                         // inicializa GPIO do buzzer
     gpio_set_dir(BUZZER, GPIO_OUT);            // define como saída
     gpio_put(BUZZER, 0);                       // desliga buzzer
+    gpio_set_irq_enabled_with_callback(BUTTON_A, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, botoes_irq_cb); // bordas acordam o núcleo
+    gpio_set_irq_enabled(BUTTON_B, GPIO_IRQ_EDGE_FALL, true); // pressão do botão B
+    gpio_set_irq_enabled(JOYSTICK, GPIO_IRQ_EDGE_FALL, true); // pressão do joystick
+}
+
+// aceita a leitura se difere do estado atual e a última mudança foi há pelo menos BOTAO_DEBOUNCE_MS
+static bool botao_mudou(BotaoDebounce *botao, bool lido, uint32_t agora) {
+    if (lido == botao->pressionado || agora - botao->borda < BOTAO_DEBOUNCE_MS) return false;
+    botao->pressionado = lido;
+    botao->borda = agora;
+    return true;
+}
+
+// IRQ dos botões: apenas sinaliza, a leitura continua no loop principal
+static void botoes_irq_cb(uint gpio, uint32_t eventos) {
+    botoes_evento = true;                      // agenda varredura dos botões
+    energia_atividade();                       // reinicia contagem de ociosidade
+}
+
+// tempo restante até um prazo periódico
+static inline uint32_t restante_ms(uint32_t agora, uint32_t ultimo, uint32_t periodo) {
+    uint32_t decorrido = agora - ultimo;
+    return decorrido >= periodo ? 0 : periodo - decorrido;
+}
+
+// calcula quanto o loop pode dormir: menor prazo entre display, sensores, alarme, publicações, buzzer, botões e joystick
+// (o keep-alive MQTT é tratado pelos timers do lwIP, cuja IRQ também acorda o núcleo)
+static uint32_t calcular_espera(uint32_t agora) {
+    uint32_t espera = sensores_espera(agora); // próxima leitura de sensor
+    uint32_t prazo = restante_ms(agora, ultima_publicacao_estado, ESTADOS_PERIODO_MS); // republicação dos estados
+    if (prazo < espera) espera = prazo;
+    prazo = restante_ms(agora, ultima_leitura_adc, periodo_adc());
+    if (prazo < espera) espera = prazo;        // caminho rápido do alarme e eixos do joystick
+    if (painel.brilho != brilho_publicado) {   // brilho ainda não publicado (joystick fora do centro)
+        prazo = restante_ms(agora, ultima_publicacao_brilho, BRILHO_PERIODO_MS);
+        if (prazo < espera) espera = prazo;
+    }
+    if (gateway_ativo && gateway_pendente()) { // consolidado da casa (mensagens dos nós acordam o núcleo)
+        prazo = restante_ms(agora, ultima_publicacao_gateway, GATEWAY_PERIODO_MS);
+        if (prazo < espera) espera = prazo;
+    }
+    if (estado_display != DISPLAY_APAGADO) {   // redesenho do OLED (apagado, só a atividade o reacende)
+        prazo = restante_ms(agora, ultima_atualizacao_oled, 1000);
+        if (prazo < espera) espera = prazo;
+    }
+    if (painel.emergencia) {                          // alternância do buzzer
+        prazo = restante_ms(agora, ultimo_buzzer, 1000);
+        if (prazo < espera) espera = prazo;
+    }
+    if (mqtt_estado && !mqtt_estado->connect_done && !mqtt_estado->conectando) { // próxima tentativa de reconexão
+        prazo = restante_ms(agora, mqtt_estado->ultima_tentativa, MQTT_RECONEXAO_MS);
+        if (prazo < espera) espera = prazo;
+    }
+    prazo = kv_espera(agora);                  // gravação pendente na flash
+    if (prazo < espera) espera = prazo;
+    prazo = ota_espera(agora);                 // troca agendada ou prazo de confirmação
+    if (prazo < espera) espera = prazo;
+    if (botoes_evento || botoes_ativos) {      // varredura de botões pressionados
+        prazo = restante_ms(agora, ultimo_botao, 10);
+        if (prazo < espera) espera = prazo;
+    }
+    return espera;
 }
 
-// lê temperatura do sensor interno
-float ler_temperatura(void) {
-    adc_select_input(4);                       // seleciona canal 4 do ADC
-    uint16_t valor_bruto = adc_read();         // lê valor bruto (12 bits, 0-4095)
+// converte a média do sensor interno em temperatura
+float ler_temperatura(float bruto) {
     const float fator_conversao = 3.3f / (1 << 12); // fator para converter ADC para tensão (Vref = 3.3V)
-    float temperatura = 27.0f - ((valor_bruto * fator_conversao) - 0.706f) / 0.001721f; // converte para °C (equação do RP2040)
-    return temperatura;                        // retorna temperatura em °C
+    return 27.0f - ((bruto * fator_conversao) - 0.706f) / 0.001721f; // converte para °C (equação do RP2040)
+}
+
+// converte a média de um canal externo em tensão
+static float adc_para_volts(float bruto) {
+    return bruto * 3.3f / (1 << 12);
+}
+
+// chamada a cada leitura de temperatura (a emergência é decidida pelas regras)
+static void temperatura_lida(float temperatura) {
+    temperatura_atual = temperatura;           // guarda para display e HTTP
+}
+
+// observador do registro de sensores (as regras de temperatura ficam com o caminho rápido)
+static void avaliar_regras(int sensor, float valor) {
+    if (sensor == sensor_temperatura) return;
+    regras_avaliar((uint8_t)sensor, valor, executar_regra);
+}
+
+// caminho rápido do alarme: média curta do anel do ADC, filtrada; o período segue a distância ao próximo limite
+static void vigiar_temperatura(uint32_t decorrido) {
+    if (sensor_temperatura < 0) {
+        periodo_alarme = ALARME_PERIODO_REPOUSO_MS;
+        return;
+    }
+    float filtrada = alarme_filtrar(ler_temperatura(adc_amostragem_media(ADC_CANAL_TEMPERATURA, ALARME_MEDIA)), decorrido);
+    regras_avaliar((uint8_t)sensor_temperatura, filtrada, executar_regra);
+    periodo_alarme = alarme_periodo(regras_margem((uint8_t)sensor_temperatura, filtrada));
+}
+
+// menor período entre o alarme e o joystick (os dois leem o anel na mesma acordada)
+static uint32_t periodo_adc(void) {
+    uint32_t periodo = joystick_ativo() ? JOYSTICK_PERIODO_ATIVO_MS : JOYSTICK_PERIODO_MS;
+    return periodo_alarme < periodo ? periodo_alarme : periodo;
+}
+
+// executa a ação de uma regra disparada
+static void executar_regra(uint8_t regra, const RegraAcao *acao, float valor) {
+    LOG_INFO(EV_REGRA_DISPARADA, regra, acao->tipo, (int32_t)(valor * 100.0f));
+    switch (acao->tipo) {
+        case REGRA_ACAO_ALARME:
+            if (painel.emergencia) return;     // já em emergência
+            painel.emergencia = true;          // ativa modo de emergência
+            alarme_detectado(time_us_64());    // mede até o envio e o PUBACK de estado/emergencia
+            energia_atividade();               // acende o OLED durante a emergência
+            LOG_AVISO(EV_EMERGENCIA_ATIVADA, (int32_t)(valor * 100.0f)); // loga emergência
+            break;
+        case REGRA_ACAO_COMANDO:
+            if (!executar_comando((TipoComando)acao->comando, acao->valor, ORIGEM_REGRA)) return;
+            break;
+        case REGRA_ACAO_PUBLICAR:
+            if (mqtt_estado && mqtt_estado->connect_done) {
+                cyw43_arch_lwip_begin();       // regras rodam no loop principal; a fila MQTT é mexida também pelos callbacks
+                publicar(mqtt_estado, MQTT_CLASSE_CONTROLE, topicos[TOPICO_REGRAS_EVENTO], acao->mensagem, strlen(acao->mensagem), false);
+                cyw43_arch_lwip_end();
+            }
+            return;
+        default:
+            return;
+    }
+    if (mqtt_estado) publish_states(mqtt_estado); // publica novo estado
+}
+
+// compila as regras recebidas; se alguma linha for inválida as regras anteriores continuam valendo
+static void carregar_regras(MQTT_CLIENT_DATA_T *state) {
+    char status[64];
+    int total = regras_carregar(state->regras_texto, sensores_por_nome, status + 5, sizeof(status) - 5);
+    state->regras_pendente = false;
+    if (total >= 0) {
+        snprintf(status, sizeof(status), "ok %d", total);
+    } else {
+        memcpy(status, "erro ", 5);            // "erro linha <k>: <motivo>"
+    }
+    LOG_INFO(EV_REGRAS_CARREGADAS, total);
+    if (state->connect_done) {
+        cyw43_arch_lwip_begin();
+        publicar(state, MQTT_CLASSE_CONTROLE, topicos[TOPICO_REGRAS_STATUS], status, strlen(status), false);
+        cyw43_arch_lwip_end();
+    }
+}
+
+#ifdef SENSOR_BH1750
+// lê o BH1750 (modo contínuo de alta resolução, configurado em registrar_sensores)
+static bool ler_bh1750(float *lux) {
+    uint8_t dados[2];
+    if (i2c_read_blocking(I2C_PORT, BH1750_ADDRESS, dados, 2, false) != 2) return false;
+    *lux = (float)((dados[0] << 8) | dados[1]) / 1.2f; // contagem -> lux (datasheet)
+    return true;
+}
+#endif
+
+// sensores do painel: período, conversão e tópico de cada um (relativo ao prefixo do nó)
+static void registrar_sensores(void) {
+    static const SensorConfig temperatura = { // sensor interno do RP2040 (mesmo tópico de antes)
+        .nome = "temperatura", .topico = "temperatura", .tipo = SENSOR_ADC,
+        .canal = ADC_CANAL_TEMPERATURA, .media = 32, .periodo_ms = 1000, // 60 amostras por minuto
+        .converter = ler_temperatura, .ao_ler = temperatura_lida, .historico = true,
+    };
+    static const SensorConfig adc2 = {         // entrada analógica externa (GPIO 28); ADC0 e ADC1 são os eixos do joystick
+        .nome = "adc2", .topico = "sensores/adc", .tipo = SENSOR_ADC, .canal = 2, .media = 16, .periodo_ms = 5000, .converter = adc_para_volts,
+    };
+    sensor_temperatura = sensores_registrar(&temperatura);
+    sensores_registrar(&adc2);
+#ifdef SENSOR_BH1750
+    const uint8_t modo_continuo = 0x10;        // medição contínua, 1 lx de resolução
+    i2c_write_blocking(I2C_PORT, BH1750_ADDRESS, &modo_continuo, 1, false);
+    static const SensorConfig luz = {
+        .nome = "luz", .topico = "sensores/luz", .tipo = SENSOR_I2C, .periodo_ms = 5000, .ler = ler_bh1750,
+    };
+    sensores_registrar(&luz);
+#endif
+}
+
+// envia um lote de sensores (um tópico, uma mensagem)
+static void publicar_sensores(const char *topico, const char *payload) {
+    if (!mqtt_estado || !mqtt_estado->connect_done) { // se não conectado ao broker
+        LOG_DEBUG(EV_MQTT_DESCONECTADO, 0); // loga aviso
+        return;
+    }
+    char completo[TOPICO_MAX];
+    snprintf(completo, sizeof(completo), "%s/%s", prefixo_no, topico);
+    cyw43_arch_lwip_begin();            // chamado pelo loop principal: o cliente MQTT também é usado pelos callbacks
+    publicar(mqtt_estado, MQTT_CLASSE_TELEMETRIA, completo, payload, strlen(payload), false);
+    cyw43_arch_lwip_end();
 }
 
 // configura LED RGB
@@ -301,37 +879,47 @@ void configurar_led_rgb(Cor cor, bool estado) {
             case AMARELO: r = 32; g = 32; break; // amarelo
             case CIANO: g = 32; b = 32; break; // ciano
             case LILAS: r = 32; b = 32; break; // lilás
+            default: break;                   // COR_TOTAL não é uma cor
         }
     }
-    gpio_put(LED_R, r > 0);                    // liga/desliga vermelho
-    gpio_put(LED_G, g > 0);                    // liga/desliga verde
-    gpio_put(LED_B, b > 0);                    // liga/desliga azul
+    uint16_t nivel = (uint16_t)((uint32_t)painel.brilho * painel.brilho * LED_PWM_TOPO / 10000); // gama 2: passos uniformes à vista
+    pwm_set_gpio_level(LED_R, r ? nivel : 0);  // liga/desliga vermelho
+    pwm_set_gpio_level(LED_G, g ? nivel : 0);  // liga/desliga verde
+    pwm_set_gpio_level(LED_B, b ? nivel : 0);  // liga/desliga azul
+}
+
+// intensidade de um canal da matriz com o brilho do painel (um canal aceso não chega a apagar)
+static uint8_t com_brilho(uint8_t valor) {
+    uint8_t v = (uint8_t)(valor * painel.brilho / 100);
+    return valor && !v ? 1 : v;
 }
 
 // atualiza matriz de LEDs WS2812
 void atualizar_matriz(void) {
     uint32_t pixels[25] = {0};                 // inicializa array de 25 LEDs como apagados
-    // configura cruz branca (RGB 10, 10, 10)
+    // configura cruz branca (RGB 10, 10, 10 no brilho máximo)
+    uint8_t branco = com_brilho(10);
     for (int i = 0; i < 9; i++) {             // itera pelos 9 LEDs da cruz
-        pixels[cruz[i]] = ((uint32_t)(10) << 8) | ((uint32_t)(10) << 16) | (uint32_t)(10); // define cor branca
+        pixels[cruz[i]] = ((uint32_t)(branco) << 8) | ((uint32_t)(branco) << 16) | (uint32_t)(branco); // define cor branca
     }
     // configura LEDs do cômodo atual
-    if (emergencia) {                          // se emergência ativa
+    if (painel.emergencia) {                          // se emergência ativa (sempre no brilho máximo)
         for (int i = 0; i < 4; i++) {         // itera pelos 4 LEDs do cômodo
-            pixels[comodos[comodo_atual][i]] = ((uint32_t)(32) << 8) | ((uint32_t)(0) << 16) | (uint32_t)(0); // define cor vermelha
+            pixels[comodos[painel.comodo][i]] = ((uint32_t)(32) << 8) | ((uint32_t)(0) << 16) | (uint32_t)(0); // define cor vermelha
         }
-    } else if (led_ligado) {                   // se LEDs ligados e sem emergência
+    } else if (painel.led_ligado) {                   // se LEDs ligados e sem emergência
         uint8_t r = 0, g = 0, b = 0;          // inicializa componentes RGB
-        switch (cor_atual) {                   // define valores RGB com base na cor atual
+        switch (painel.cor) {                   // define valores RGB com base na cor atual
             case VERMELHO: r = 32; break;     // vermelho
             case VERDE: g = 32; break;         // verde
             case AZUL: b = 32; break;          // azul
             case AMARELO: r = 32; g = 32; break; // amarelo
             case CIANO: g = 32; b = 32; break; // ciano
             case LILAS: r = 32; b = 32; break; // lilás
+            default: break;                   // COR_TOTAL não é uma cor
         }
         for (int i = 0; i < 4; i++) {         // itera pelos 4 LEDs do cômodo
-            pixels[comodos[comodo_atual][i]] = ((uint32_t)(r) << 8) | ((uint32_t)(g) << 16) | (uint32_t)(b); // define cor
+            pixels[comodos[painel.comodo][i]] = ((uint32_t)com_brilho(r) << 8) | ((uint32_t)com_brilho(g) << 16) | (uint32_t)com_brilho(b); // define cor
         }
     }
     // envia dados para a matriz WS2812
@@ -342,119 +930,545 @@ void atualizar_matriz(void) {
 
 // atualiza display OLED
 void atualizar_display(void) {
-    char temp_str[20];                        // buffer para string do cômodo/temperatura
+    static const Imagem *const icones[COMODO_TOTAL] = { &icone_quarto, &icone_quarto, &icone_cozinha, &icone_banheiro };
+    static const char *const nomes[COMODO_TOTAL] = { "Quarto 1", "Quarto 2", "Cozinha", "Banheiro" };
+    char temp_str[20];                        // buffer para string da temperatura
     char ip_str[16];                          // buffer para string do endereço IP
     ssd1306_fill(&disp, 0);                   // limpa o buffer do display
-    snprintf(temp_str, sizeof(temp_str), "%s", // formata nome do cômodo atual
-             comodo_atual == QUARTO_1 ? "QUARTO 1" :
-             comodo_atual == QUARTO_2 ? "QUARTO 2" :
-             comodo_atual == COZINHA ? "COZINHA" : "BANHEIRO");
-    ssd1306_draw_string(&disp, temp_str, 20, 2); // exibe cômodo na linha 1
-    snprintf(temp_str, sizeof(temp_str), "TEMP: %.1fC", ler_temperatura()); // formata temperatura
-    ssd1306_draw_string(&disp, temp_str, 20, 18); // exibe temperatura na linha 2
-    ssd1306_draw_string(&disp, emergencia ? "EMERGENCIA: ON" : "EMERGENCIA: OFF", 2, 34); // exibe estado da emergência na linha 3
+    ssd1306_draw_image(&disp, icones[painel.comodo], 0, 0); // ícone do cômodo atual
+    ssd1306_draw_text(&disp, &fonte_painel8, nomes[painel.comodo], 20, 4); // nome do cômodo na linha 1
+    if (painel.emergencia) ssd1306_draw_image(&disp, &icone_alerta, WIDTH - 16, 0); // alerta no canto
+    snprintf(temp_str, sizeof(temp_str), "%.1f°C", temperatura_atual); // formata temperatura
+    ssd1306_draw_text(&disp, &fonte_digitos16, temp_str, // temperatura em dígitos grandes, centralizada
+                      (WIDTH - fonte_largura_texto(&fonte_digitos16, temp_str)) / 2, 20);
+    ssd1306_draw_text(&disp, &fonte_painel8, painel.emergencia ? "Emergência: ON" : "Emergência: OFF", 2, 42); // estado da emergência
     snprintf(ip_str, sizeof(ip_str), "%s", netif_default ? ipaddr_ntoa(&netif_default->ip_addr) : "N/A"); // formata endereço IP
-    ssd1306_draw_string(&disp, ip_str, 6, 50); // exibe IP na linha 4
+    ssd1306_draw_text(&disp, &fonte_painel8, ip_str, 2, 54); // exibe IP na última linha
     ssd1306_send_data(&disp);                 // envia buffer ao display OLED
 }
 
 // callback de conexão MQTT
 static void mqtt_connection_cb(mqtt_client_t *client, void *arg, mqtt_connection_status_t status) { // gerencia conexão MQTT
     MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)arg; // converte argumento para estrutura MQTT
+    state->conectando = false;             // tentativa encerrada (com sucesso ou não)
     if (status == MQTT_CONNECT_ACCEPTED) { // se conexão bem-sucedida
-        printf("Conectado ao broker MQTT com sucesso\n"); // loga sucesso
+        uint32_t tempo_ms = (uint32_t)((time_us_64() - state->inicio_conexao_us) / 1000); // TCP + TLS + CONNECT
+        struct mallinfo memoria = mallinfo(); // heap em uso após o handshake (a arena só cresce: não é o pico)
+        bool oferecida = false;
+        size_t pico_tls = 0;
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+        oferecida = state->sessao_oferecida;
+        pico_tls = tls_heap_pico;          // pico do mbedTLS nesta conexão: handshake completo x retomado
+        if (altcp_tls_get_session(client->conn, state->sessao_tls) == ERR_OK) { // guarda a sessão para a próxima reconexão
+            state->sessao_valida = true;
+        }
+#endif
+        LOG_INFO(EV_MQTT_CONECTADO, tempo_ms, oferecida, memoria.uordblks, pico_tls); // loga sucesso e custo
         state->connect_done = true;        // marca conexão como concluída
-        mqtt_subscribe(state->mqtt_client_inst, "casa/comando/led", 1, NULL, state); // inscreve no tópico de led
-        mqtt_subscribe(state->mqtt_client_inst, "casa/comando/cor", 1, NULL, state); // inscreve no tópico de cor
-        mqtt_subscribe(state->mqtt_client_inst, "casa/comando/comodo", 1, NULL, state); // inscreve no tópico de cômodo
-        mqtt_subscribe(state->mqtt_client_inst, "casa/comando/alarme", 1, NULL, state); // inscreve no tópico de alarme
-        printf("Inscrito nos tópicos de comando\n"); // loga inscrição
-        publish_states(state);             // publica estados iniciais
-    } else {                               // se conexão falhou
-        printf("Falha na conexão MQTT: %d\n", status); // loga erro
+        state->conexoes++;
+        state->inscritos = 0;              // connect zerou os pedidos do lwIP: inscreve tudo de novo
+        state->estados_pendentes = ESTADO_BRILHO; // o brilho sai retido a cada conexão, depois dos demais estados
+        fila_mqtt_iniciar(MQTT_REQ_MAX_IN_FLIGHT); // nenhum pedido em voo
+        alarme_conexao();                  // emergência republicada, na frente das inscrições (pedido reservado)
+        publicar(state, MQTT_CLASSE_CONTROLE, topicos[TOPICO_PAINEL_STATUS], "online", 6, true); // substitui o "offline" retido
+        publish_states(state);             // inscrições (comandos, histórico, regras, relógio, configuração, OTA, gateway), depois os estados
+    } else {                               // se conexão falhou ou caiu
+        state->connect_done = false;       // loop principal agenda a reconexão
+        LOG_ERRO(EV_MQTT_FALHA_CONEXAO, status); // loga erro
     }
 }
 
 // callback para tópico recebido
 static void mqtt_incoming_publish_cb(void *arg, const char *topic, uint32_t tot_len) { // processa tópico MQTT recebido
     MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)arg; // converte argumento para estado
-    strncpy(state->topic, topic, sizeof(state->topic)); // copia tópico para buffer
-    printf("Mensagem recebida no tópico: %s\n", topic); // loga tópico recebido
+    state->topico = COMANDO_TOTAL;        // resolve o tópico uma vez, antes dos dados
+    state->extra = TOPICO_EXTRA_NENHUM;
+    for (int i = 0; i < TOPICOS_INSCRITOS; i++) {
+        if (strcmp(topic, topicos[i]) != 0) continue;
+        if (i <= TOPICO_COMANDO_ALARME) state->topico = (TipoComando)i;
+        else state->extra = (TopicoExtra)(TOPICO_EXTRA_HISTORICO + i - TOPICO_HISTORICO_PEDIDO);
+        break;
+    }
+    if (gateway_ativo && state->topico == COMANDO_TOTAL && state->extra == TOPICO_EXTRA_NENHUM &&
+        strlen(topic) < sizeof(state->gateway_topico)) { // o resto vem dos filtros do gateway
+        strcpy(state->gateway_topico, topic);
+        state->extra = TOPICO_EXTRA_GATEWAY;
+    }
+    if (state->extra == TOPICO_EXTRA_REGRAS) { // texto novo: descarta se não couber ou se o anterior não foi compilado
+        state->regras_recebidos = 0;
+        state->regras_descartar = state->regras_pendente || tot_len >= REGRAS_TEXTO_MAX;
+        if (state->regras_descartar) LOG_AVISO(EV_MQTT_PAYLOAD_GRANDE, tot_len);
+    }
+    if (state->extra >= TOPICO_EXTRA_OTA_INICIO) { // o remetente espera a resposta antes da próxima etapa
+        state->ota_recebidos = 0;
+        state->ota_descartar = state->ota_pendente != TOPICO_EXTRA_NENHUM || tot_len > sizeof(state->ota_dados);
+        if (state->ota_descartar) LOG_AVISO(EV_MQTT_PAYLOAD_GRANDE, tot_len);
+    }
+    LOG_DEBUG(EV_MQTT_TOPICO, state->topico, tot_len); // loga tópico recebido
 }
 
 // callback para dados recebidos
 static void mqtt_incoming_data_cb(void *arg, const uint8_t *data, uint16_t len, uint8_t flags) { // processa dados MQTT
     MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)arg; // converte argumento para estado
-    char payload[32];                     // buffer para payload
-    strncpy(payload, (const char*)data, len); // copia dados para buffer
+    if (state->extra == TOPICO_EXTRA_REGRAS) { // regras podem chegar em vários pedaços
+        if (state->regras_descartar) return;
+        memcpy(state->regras_texto + state->regras_recebidos, data, len); // tamanho total já verificado
+        state->regras_recebidos += len;
+        if (flags & MQTT_DATA_FLAG_LAST) {
+            state->regras_texto[state->regras_recebidos] = '\0';
+            state->regras_pendente = true; // compilado no loop principal
+        }
+        return;
+    }
+    if (state->extra >= TOPICO_EXTRA_OTA_INICIO) { // blocos binários, gravados na flash pelo loop principal
+        if (state->ota_descartar) return;
+        memcpy(state->ota_dados + state->ota_recebidos, data, len); // tamanho total já verificado
+        state->ota_recebidos += len;
+        if (flags & MQTT_DATA_FLAG_LAST) state->ota_pendente = state->extra;
+        return;
+    }
+    char payload[CONFIG_VALOR_MAX + 16];  // buffer para payload (o maior é "nome=valor" de casa/config)
+    if (len >= sizeof(payload)) {         // payload maior que o buffer: descarta
+        LOG_AVISO(EV_MQTT_PAYLOAD_GRANDE, len);
+        return;
+    }
+    memcpy(payload, data, len);           // copia dados para buffer
     payload[len] = '\0';                  // adiciona terminador nulo
-    printf("Payload recebido: %s\n", payload); // loga payload
-
-    if (strcmp(state->topic, "casa/comando/led") == 0) { // se tópico for de comando de led
-        if (strcmp(payload, "On") == 0) {     // se comando for ligar
-            led_ligado = true;                // ativa led
-            printf("LED ligado via MQTT\n");  // loga ação
-        } else if (strcmp(payload, "Off") == 0) { // se comando for desligar
-            led_ligado = false;               // desativa led
-            printf("LED desligado via MQTT\n"); // loga ação
-        }
-        publish_states(state);               // publica novo estado
-    } else if (strcmp(state->topic, "casa/comando/cor") == 0) { // se tópico for de cor
-        if (strcmp(payload, "Vermelho") == 0) cor_atual = VERMELHO; // define vermelho
-        else if (strcmp(payload, "Verde") == 0) cor_atual = VERDE; // define verde
-        else if (strcmp(payload, "Azul") == 0) cor_atual = AZUL; // define azul
-        else if (strcmp(payload, "Amarelo") == 0) cor_atual = AMARELO; // define amarelo
-        else if (strcmp(payload, "Ciano") == 0) cor_atual = CIANO; // define ciano
-        else if (strcmp(payload, "Lilas") == 0) cor_atual = LILAS; // define lilás
-        printf("Cor alterada para %d via MQTT\n", cor_atual); // loga mudança
-        publish_states(state);               // publica novo estado
-    } else if (strcmp(state->topic, "casa/comando/comodo") == 0) { // se tópico for de cômodo
-        if (strcmp(payload, "Quarto1") == 0) { comodo_atual = QUARTO_1; led_ligado = true; } // quarto 1
-        else if (strcmp(payload, "Quarto2") == 0) { comodo_atual = QUARTO_2; led_ligado = true; } // quarto 2
-        else if (strcmp(payload, "Cozinha") == 0) { comodo_atual = COZINHA; led_ligado = true; } // cozinha
-        else if (strcmp(payload, "Banheiro") == 0) { comodo_atual = BANHEIRO; led_ligado = true; } // banheiro
-        printf("Cômodo alterado para %d via MQTT\n", comodo_atual); // loga mudança
-        publish_states(state);               // publica novo estado
-    } else if (strcmp(state->topic, "casa/comando/alarme") == 0) { // se tópico for de alarme
-        if (strcmp(payload, "Off") == 0) {   // se comando for desligar alarme
-            emergencia = false;              // desativa emergência
-            printf("Alarme desligado via MQTT\n"); // loga ação
-            publish_states(state);           // publica novo estado
-        }
-    }
-}
-
-// publica temperatura
-static void publish_temperature(MQTT_CLIENT_DATA_T *state) { // publica temperatura no tópico MQTT
-    if (!state->connect_done) {           // se não conectado ao broker
-        printf("Não conectado ao broker, pulando publicação de temperatura\n"); // loga aviso
-        return;                           // sai da função
+    LOG_DEBUG(EV_MQTT_PAYLOAD, len, flags); // loga payload
+
+    if (state->extra == TOPICO_EXTRA_GATEWAY) { // estado de um nó; o loop principal lê a tabela com o lwIP travado
+        gateway_receber(state->gateway_topico, payload);
+        return;
+    }
+    if (state->extra == TOPICO_EXTRA_RELOGIO) { // "HH:MM": alinha o relógio das regras de horário
+        unsigned horas, minutos;
+        if (sscanf(payload, "%u:%u", &horas, &minutos) == 2 && horas < 24 && minutos < 60) {
+            relogio_base_s = (int32_t)(horas * 3600 + minutos * 60) - (int32_t)(to_ms_since_boot(get_absolute_time()) / 1000);
+            if (relogio_base_s < 0) relogio_base_s += 86400 * ((-relogio_base_s) / 86400 + 1);
+            relogio_definido = true;
+        }
+        return;
+    }
+    if (state->extra == TOPICO_EXTRA_CONFIG) { // a flash só é acessada pelo loop principal
+        if (!state->config_pendente) {
+            memcpy(state->pedido_config, payload, len + 1);
+            state->config_pendente = true;
+        }
+        return;
+    }
+    if (state->extra == TOPICO_EXTRA_CENA) { // todos os campos de uma vez: um lote de estados
+        if (executar_cena(payload, ORIGEM_MQTT)) publish_states(state);
+        return;
+    }
+    if (state->extra == TOPICO_EXTRA_CENA_DEFINIR) { // gravada na flash pelo loop principal
+        if (!state->cena_pendente) {
+            memcpy(state->pedido_cena, payload, len + 1);
+            state->cena_pendente = true;
+        }
+        return;
+    }
+    if (state->extra == TOPICO_EXTRA_HISTORICO) { // a resposta é montada no loop principal, fora do contexto do lwIP
+        if (!state->historico_pendente) {
+            memcpy(state->pedido_historico, payload, len + 1);
+            state->historico_pendente = true;
+        }
+        return;
     }
-    float temp = ler_temperatura();       // lê temperatura atual
-    char temp_str[16];                    // buffer para string da temperatura
-    snprintf(temp_str, sizeof(temp_str), "%.2f", temp); // formata temperatura com 2 casas decimais
-    printf("Publicando temperatura: %s°C no tópico casa/temperatura\n", temp_str); // loga publicação
-    mqtt_publish(state->mqtt_client_inst, "casa/temperatura", temp_str, strlen(temp_str), 1, 0, NULL, state); // publica no tópico
+    if (state->topico < COMANDO_TOTAL && // aplica e publica novo estado
+        executar_comando(state->topico, painel_valor_comando(state->topico, payload), ORIGEM_MQTT)) {
+        publish_states(state);
+    }
+}
+
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+// alocações do mbedTLS (todas sob o lock do lwIP): o mallinfo não dá o pico, só a arena, que nunca encolhe
+static void *tls_calloc(size_t n, size_t tamanho) {
+    void *p = calloc(n, tamanho);
+    if (p) {
+        tls_heap_uso += malloc_usable_size(p);
+        if (tls_heap_uso > tls_heap_pico) tls_heap_pico = tls_heap_uso;
+    }
+    return p;
+}
+
+static void tls_free(void *p) {
+    if (p) tls_heap_uso -= malloc_usable_size(p);
+    free(p);
+}
+#endif
+
+// inicia conexão com o broker; com TLS, oferece a sessão da conexão anterior (handshake abreviado)
+static void mqtt_conectar(MQTT_CLIENT_DATA_T *state) {
+    state->ultima_tentativa = to_ms_since_boot(get_absolute_time());
+    state->inicio_conexao_us = time_us_64();
+    cyw43_arch_lwip_begin();               // connect e set_session precisam ocorrer antes do handshake
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+    tls_heap_pico = tls_heap_uso;          // o pico da conexão conta a partir do contexto TLS novo
+#endif
+    err_t erro = mqtt_client_connect(state->mqtt_client_inst, &state->mqtt_server_address, MQTT_PORTA,
+                                     mqtt_connection_cb, state, &state->mqtt_client_info);
+    mqtt_set_inpub_callback(state->mqtt_client_inst, mqtt_incoming_publish_cb, mqtt_incoming_data_cb, state); // connect zera o cliente: registra callbacks de novo
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+    state->sessao_oferecida = false;
+    if (erro == ERR_OK) {
+#ifdef MQTT_TLS_HOSTNAME
+        mbedtls_ssl_set_hostname(altcp_tls_context(state->mqtt_client_inst->conn), MQTT_TLS_HOSTNAME); // SNI e verificação do nome
+#endif
+        if (state->sessao_valida) {        // retomada por ticket/ID: pula a troca de chaves e a verificação do certificado
+            state->sessao_oferecida = altcp_tls_set_session(state->mqtt_client_inst->conn, state->sessao_tls) == ERR_OK;
+        }
+    }
+#endif
+    cyw43_arch_lwip_end();
+    state->conectando = erro == ERR_OK;
+    LOG_INFO(EV_MQTT_CONECTANDO, erro);
+}
+
+// aplica um comando vindo de qualquer canal (MQTT, HTTP, UDP) e registra no log
+static bool executar_comando(TipoComando tipo, int valor, OrigemComando origem) {
+    if (!painel_aplicar_valor(tipo, valor)) { // valor não reconhecido
+        LOG_AVISO(EV_COMANDO_INVALIDO, tipo, origem, valor);
+        return false;
+    }
+    LOG_INFO(EV_COMANDO, tipo, origem, painel.cor, painel.comodo); // loga mudança
+    energia_atividade();                  // comando remoto conta como atividade
+    return true;
+}
+
+// aplica uma cena (campos ou nome de uma cena gravada) e registra no log
+static bool executar_cena(const char *texto, OrigemComando origem) {
+    Cena cena;
+    if (!cenas_resolver(texto, &cena)) {  // nada é aplicado se um campo é inválido
+        LOG_AVISO(EV_CENA_INVALIDA, origem, (int)strlen(texto));
+        return false;
+    }
+    cenas_aplicar(&cena);
+    LOG_INFO(EV_CENA, origem, painel.led_ligado, painel.cor, painel.comodo);
+    energia_atividade();
+    return true;
+}
+
+// comando recebido pelo servidor HTTP (contexto do lwIP)
+static bool executar_comando_http(TipoComando tipo, const char *valor) {
+    return executar_comando(tipo, painel_valor_comando(tipo, valor), ORIGEM_HTTP);
+}
+
+// comando recebido pelo canal UDP (contexto do lwIP)
+static bool executar_comando_udp(TipoComando tipo, int valor) {
+    return executar_comando(tipo, valor, ORIGEM_UDP);
+}
+
+// publica estados após um lote de comandos HTTP ou UDP
+static void publicar_estados_local(void) {
+    if (mqtt_estado) publish_states(mqtt_estado);
+}
+
+// estado do painel acrescido de diagnóstico (temperatura, ciclo ativo, log, uptime, custo dos sensores)
+static size_t gerar_status_json(char *buf, size_t tamanho) {
+    size_t n = painel_estado_json(buf, tamanho); // {"led":...,"emergencia":...}
+    if (n == 0 || n + 1 >= tamanho) return n;
+    n--;                                  // sobrescreve o '}' final
+    const JoystickEstatisticas *joystick = joystick_estatisticas();
+    const AlarmeEstatisticas *alarme = alarme_estatisticas();
+    const FilaMqttEstatisticas *fila = fila_mqtt_estatisticas();
+    int extra = snprintf(buf + n, tamanho - n, ",\"temperatura\":%.2f,\"ciclo_ativo\":%u,\"log_perdidas\":%lu,\"uptime_s\":%lu,"
+                         "\"mqtt_conexoes\":%lu,\"mqtt_recusadas\":%lu,\"prefixo\":\"%s\",\"gateway_nos\":%d,"
+                         "\"joystick\":{\"x\":%d,\"y\":%d,\"acoes\":%lu,\"latencia_us\":%lu,\"latencia_max_us\":%lu,\"latencia_media_us\":%lu},"
+                         "\"alarme\":{\"filtrada\":%.2f,\"deteccoes\":%lu,\"reenvios\":%lu,\"envio_us\":%lu,\"envio_max_us\":%lu,"
+                         "\"confirmacao_us\":%lu,\"confirmacao_max_us\":%lu},\"mqtt_adiados\":[%lu,%lu,%lu],\"sensores\":",
+                         temperatura_atual, energia_ciclo_ativo(), (unsigned long)log_sobrescritas(),
+                         (unsigned long)(to_ms_since_boot(get_absolute_time()) / 1000),
+                         (unsigned long)(mqtt_estado ? mqtt_estado->conexoes : 0),
+                         (unsigned long)(mqtt_estado ? mqtt_estado->recusadas : 0), prefixo_no,
+                         gateway_ativo ? gateway_estatisticas()->nos : -1, joystick->x, joystick->y,
+                         (unsigned long)joystick->acoes, (unsigned long)joystick->latencia_us,
+                         (unsigned long)joystick->latencia_max_us,
+                         (unsigned long)(joystick->medidas ? joystick->latencia_soma_us / joystick->medidas : 0),
+                         alarme->filtrada, (unsigned long)alarme->deteccoes, (unsigned long)alarme->reenvios,
+                         (unsigned long)alarme->envio_us, (unsigned long)alarme->envio_max_us,
+                         (unsigned long)alarme->confirmacao_us, (unsigned long)alarme->confirmacao_max_us,
+                         (unsigned long)fila->adiados[MQTT_CLASSE_ALARME], (unsigned long)fila->adiados[MQTT_CLASSE_CONTROLE],
+                         (unsigned long)fila->adiados[MQTT_CLASSE_TELEMETRIA]);
+    if (extra < 0 || (size_t)extra >= tamanho - n) return n;
+    n += (size_t)extra;
+    n += sensores_diagnostico_json(buf + n, tamanho - n); // [{"nome":...,"custo_medio_us":...}, ...]
+    if (n + 1 >= tamanho) return n;
+    buf[n++] = '}';
+    buf[n] = '\0';
+    return n;
+}
+
+// grava um item de configuração recebido em <prefixo>/config (o valor não é ecoado: pode ser senha)
+static void aplicar_config(MQTT_CLIENT_DATA_T *state, uint32_t agora) {
+    int chave = config_definir(state->pedido_config, agora);
+    state->config_pendente = false;
+    char status[40];
+    if (chave >= 0) {
+        snprintf(status, sizeof(status), "ok %s", config_nome((ChaveConfig)chave));
+    } else {
+        snprintf(status, sizeof(status), "erro");
+    }
+    LOG_INFO(EV_CONFIG_ALTERADA, chave);
+    if (state->connect_done) {
+        cyw43_arch_lwip_begin();
+        publicar(state, MQTT_CLASSE_CONTROLE, topicos[TOPICO_CONFIG_STATUS], status, strlen(status), false);
+        cyw43_arch_lwip_end();
+    }
+}
+
+// grava ou remove uma cena recebida em <prefixo>/cena/definir
+static void definir_cena(MQTT_CLIENT_DATA_T *state, uint32_t agora) {
+    char nome[CENA_NOME_MAX] = "", status[32];
+    cyw43_arch_lwip_begin();            // a tabela de cenas também é lida pelo callback de <prefixo>/comando/cena
+    ResultadoCena resultado = cenas_definir(state->pedido_cena, agora, nome);
+    cyw43_arch_lwip_end();
+    state->cena_pendente = false;
+    if (resultado == CENA_INVALIDA) {
+        snprintf(status, sizeof(status), "erro");
+    } else {
+        snprintf(status, sizeof(status), "%s %s", resultado == CENA_GRAVADA ? "ok" : "removida", nome);
+    }
+    LOG_INFO(EV_CENA_DEFINIDA, resultado, cenas_total());
+    if (state->connect_done) {
+        cyw43_arch_lwip_begin();
+        publicar(state, MQTT_CLASSE_CONTROLE, topicos[TOPICO_CENA_STATUS], status, strlen(status), false);
+        cyw43_arch_lwip_end();
+    }
+}
+
+// operações de flash do armazenamento chave-valor (deslocamentos relativos à sua região)
+static bool kv_apagar_setor(uint32_t deslocamento) {
+    return flash_pico_apagar(FLASH_KV_INICIO + deslocamento, FLASH_SETOR);
+}
+
+static bool kv_gravar_pagina(uint32_t deslocamento, const uint8_t *pagina) {
+    return flash_pico_gravar(FLASH_KV_INICIO + deslocamento, pagina, FLASH_PAGINA);
+}
+
+// trata uma etapa da atualização; cada resposta libera o remetente para a próxima (controle de fluxo)
+static void tratar_ota(MQTT_CLIENT_DATA_T *state, uint32_t agora) {
+    char status[64];
+    const uint8_t *dados = state->ota_dados;
+    uint16_t n = state->ota_recebidos;
+    if (state->ota_pendente == TOPICO_EXTRA_OTA_INICIO) { // "<tamanho> <sha256 em hex>"
+        char texto[96], hex[2 * SHA256_TAMANHO + 1];
+        unsigned long tamanho;
+        uint8_t sha[SHA256_TAMANHO];
+        memcpy(texto, dados, n < sizeof(texto) ? n : sizeof(texto) - 1);
+        texto[n < sizeof(texto) ? n : sizeof(texto) - 1] = '\0';
+        bool ok = sscanf(texto, "%lu %64s", &tamanho, hex) == 2 && strlen(hex) == 2 * SHA256_TAMANHO;
+        for (int i = 0; ok && i < SHA256_TAMANHO; i++) ok = sscanf(hex + 2 * i, "%2hhx", &sha[i]) == 1;
+        ok = ok && ota_comecar(tamanho, sha, agora);
+        snprintf(status, sizeof(status), ok ? "ok 0" : "erro inicio");
+        if (!ok) LOG_ERRO(EV_OTA_FALHA, 0, tamanho / 1024);
+    } else if (state->ota_pendente == TOPICO_EXTRA_OTA_BLOCO) { // grava o setor quando completa
+        uint32_t deslocamento = n > 4 ? dados[0] | dados[1] << 8 | dados[2] << 16 | (uint32_t)dados[3] << 24 : 0;
+        int32_t proximo = n > 4 ? ota_bloco(deslocamento, dados + 4, n - 4) : -1;
+        if (proximo >= 0) {
+            snprintf(status, sizeof(status), "ok %ld", (long)proximo);
+        } else {
+            snprintf(status, sizeof(status), "erro bloco");
+            LOG_ERRO(EV_OTA_FALHA, 1, deslocamento / 1024);
+        }
+    } else if (ota_concluir(agora)) {   // fim: SHA-256 confere; troca em OTA_ATRASO_TROCA_MS
+        const OtaEstatisticas *est = ota_estatisticas();
+        uint32_t ram = est->ram + sizeof(state->ota_dados);
+        uint32_t vazao = (uint32_t)((uint64_t)est->bytes * 10000 / 1024 / (est->duracao_ms ? est->duracao_ms : 1)); // décimos de KB/s
+        snprintf(status, sizeof(status), "verificado %lu bytes %lu.%lu KB/s ram %lu", (unsigned long)est->bytes,
+                 (unsigned long)(vazao / 10), (unsigned long)(vazao % 10), (unsigned long)ram);
+        LOG_INFO(EV_OTA_RECEBIDA, est->bytes / 1024, est->duracao_ms / 100, vazao, ram);
+    } else {
+        snprintf(status, sizeof(status), "erro verificacao");
+        LOG_ERRO(EV_OTA_FALHA, 2, 0);
+    }
+    state->ota_pendente = TOPICO_EXTRA_NENHUM; // libera a recepção da próxima etapa
+    publicar_ota(state, status);
+}
+
+static void publicar_ota(MQTT_CLIENT_DATA_T *state, const char *status) {
+    if (!state->connect_done) return;
+    cyw43_arch_lwip_begin();
+    publicar(state, MQTT_CLASSE_CONTROLE, topicos[TOPICO_OTA_STATUS], status, strlen(status), false);
+    cyw43_arch_lwip_end();
+}
+
+// operações de flash da atualização (deslocamentos absolutos)
+static bool ota_apagar_setor(uint32_t deslocamento) {
+    return flash_pico_apagar(deslocamento, FLASH_SETOR);
+}
+
+static bool ota_gravar(uint32_t deslocamento, const uint8_t *dados, size_t tamanho) {
+    return flash_pico_gravar(deslocamento, dados, tamanho);
+}
+
+// troca registrada: grava o que o armazenamento chave-valor tem pendente e reinicia (não retorna);
+// o estágio de boot faz a troca com o watchdog desligado (ela leva mais que OTA_WATCHDOG_MS)
+static void ota_reiniciar(void) {
+    kv_sincronizar(to_ms_since_boot(get_absolute_time()));
+    watchdog_reboot(0, 0, 0);
+    while (true) {
+        tight_loop_contents();
+    }
+}
+
+// responde um pedido "<série> <1m|15m|1h> [quantidade]" com a janela do histórico em uma mensagem
+static void responder_historico(MQTT_CLIENT_DATA_T *state) {
+    static char resposta[HISTORICO_RESPOSTA_MAX];
+    char nome[16], resolucao[4];
+    unsigned quantidade = 0;
+    int campos = sscanf(state->pedido_historico, "%15s %3s %u", nome, resolucao, &quantidade);
+    state->historico_pendente = false;
+    int serie = campos >= 2 ? historico_por_nome(nome) : -1;
+    int nivel = campos >= 2 ? historico_nivel_por_nome(resolucao) : -1;
+    size_t n = 0;
+    if (serie >= 0 && nivel >= 0) {
+        n = historico_json(serie, nivel, (uint16_t)MIN(quantidade, UINT16_MAX), resposta, sizeof(resposta));
+    }
+    if (n == 0) {                         // série ou resolução desconhecida
+        n = (size_t)snprintf(resposta, sizeof(resposta), "{\"erro\":\"pedido invalido\"}");
+    }
+    LOG_INFO(EV_HISTORICO_PEDIDO, serie, nivel, quantidade, n);
+    if (!state->connect_done) return;
+    cyw43_arch_lwip_begin();
+    publicar(state, MQTT_CLASSE_CONTROLE, topicos[TOPICO_HISTORICO_RESPOSTA], resposta, n, false);
+    cyw43_arch_lwip_end();
+}
+
+// publica com QoS 1 na classe de prioridade; sem pedido para a classe (lib/fila_mqtt.h) ou livre
+// no lwIP a mensagem é recusada (ERR_MEM)
+static err_t publicar(MQTT_CLIENT_DATA_T *state, ClasseMqtt classe, const char *topico, const void *dados, size_t n,
+                      bool retido) {
+    static const mqtt_request_cb_t retornos[MQTT_CLASSES] = { mqtt_alarme_cb, mqtt_pedido_cb, mqtt_telemetria_cb };
+    if (!fila_mqtt_pode(classe)) return ERR_MEM;
+    err_t erro = mqtt_publish(state->mqtt_client_inst, topico, dados, (u16_t)n, 1, retido, retornos[classe], state);
+    if (erro != ERR_OK) {
+        state->recusadas++;
+        LOG_DEBUG(EV_MQTT_RECUSADA, erro, state->estados_pendentes);
+        return erro;
+    }
+    fila_mqtt_enviado(classe);
+    return ERR_OK;
+}
+
+// o lwIP aceita até MQTT_REQ_MAX_IN_FLIGHT pedidos sem resposta (inscrições e publicações QoS 1):
+// o que não coube segue aqui, a cada SUBACK/PUBACK, em vez de se perder; a emergência vem antes
+// de tudo (inclusive das inscrições) e as classes mais urgentes seguram a telemetria enquanto esperam
+static void mqtt_continuar(MQTT_CLIENT_DATA_T *state) {
+    if (!state->connect_done) return;
+    cyw43_arch_lwip_begin();               // também chamado pelo loop principal
+    bool emergencia = painel.emergencia;
+    if (alarme_pendente(emergencia)) {
+        const char *valor = emergencia ? "LIGADA" : "DESLIGADA";
+        if (publicar(state, MQTT_CLASSE_ALARME, topicos[TOPICO_ESTADO_EMERGENCIA], valor, strlen(valor), true) == ERR_OK) {
+            alarme_enviado(emergencia, time_us_64());
+        }
+    }
+    fila_mqtt_pendente(MQTT_CLASSE_ALARME, alarme_pendente(emergencia));
+    while (state->inscritos < inscricoes_total && fila_mqtt_pode(MQTT_CLASSE_CONTROLE)) {
+        const char *topico = state->inscritos < TOPICOS_INSCRITOS ? topicos[state->inscritos] :
+                             filtros_gateway[state->inscritos - TOPICOS_INSCRITOS];
+        if (mqtt_subscribe(state->mqtt_client_inst, topico, 1, mqtt_pedido_cb, state) != ERR_OK) break;
+        fila_mqtt_enviado(MQTT_CLASSE_CONTROLE);
+        if (++state->inscritos == inscricoes_total) LOG_INFO(EV_MQTT_INSCRITO, inscricoes_total); // loga inscrição
+    }
+    if (state->inscritos == inscricoes_total) { // comandos antes dos estados: um eco sem inscrição não serve
+        const char *cor = painel_nome_cor(painel.cor);
+        const char *comodo = painel_nome_comodo(painel.comodo);
+        char brilho[4];
+        snprintf(brilho, sizeof(brilho), "%u", painel.brilho);
+        const char *valores[] = {              // a emergência (bit nunca pendente aqui) sai na classe do alarme
+            painel.led_ligado ? "LIGADO" : "DESLIGADO", cor, comodo, "", brilho
+        };
+        for (unsigned i = 0; i < sizeof(valores) / sizeof(valores[0]) && state->estados_pendentes; i++) {
+            if (!(state->estados_pendentes & (1u << i))) continue;
+            if (publicar(state, MQTT_CLASSE_CONTROLE, topicos[TOPICO_ESTADO_LED + i], valores[i], strlen(valores[i]), true) != ERR_OK) break;
+            state->estados_pendentes &= ~(1u << i); // valor lido agora: estados que mudaram na espera saem atualizados
+        }
+    }
+    fila_mqtt_pendente(MQTT_CLASSE_CONTROLE, state->inscritos < inscricoes_total || state->estados_pendentes);
+    cyw43_arch_lwip_end();
+}
+
+// SUBACK ou PUBACK (ou expiração do pedido): há pedido livre no lwIP
+static void mqtt_pedido_cb(void *arg, err_t erro) {
+    (void)erro;
+    fila_mqtt_concluido(MQTT_CLASSE_CONTROLE);
+    mqtt_continuar((MQTT_CLIENT_DATA_T*)arg);
+}
+
+static void mqtt_telemetria_cb(void *arg, err_t erro) {
+    (void)erro;
+    fila_mqtt_concluido(MQTT_CLASSE_TELEMETRIA);
+    mqtt_continuar((MQTT_CLIENT_DATA_T*)arg);
+}
+
+// PUBACK de estado/emergencia; sem ele (expiração) o valor do momento é reenviado já
+static void mqtt_alarme_cb(void *arg, err_t erro) {
+    fila_mqtt_concluido(MQTT_CLASSE_ALARME);
+    alarme_resultado(erro == ERR_OK, time_us_64());
+    if (erro == ERR_OK) {
+        const AlarmeEstatisticas *alarme = alarme_estatisticas();
+        LOG_INFO(EV_ALARME_CONFIRMADO, painel.emergencia, alarme->confirmacao_us / 100, alarme->reenvios);
+    } else {
+        LOG_AVISO(EV_ALARME_REENVIO, erro, alarme_estatisticas()->reenvios);
+    }
+    mqtt_continuar((MQTT_CLIENT_DATA_T*)arg);
 }
 
 // publica estados dos periféricos
 static void publish_states(MQTT_CLIENT_DATA_T *state) { // publica estados dos periféricos
     if (!state->connect_done) {           // se não conectado ao broker
-        printf("Não conectado ao broker, pulando publicação de estados\n"); // loga aviso
+        LOG_DEBUG(EV_MQTT_DESCONECTADO, 1); // loga aviso
         return;                           // sai da função
     }
-    mqtt_publish(state->mqtt_client_inst, "casa/estado/led", led_ligado ? "LIGADO" : "DESLIGADO", strlen(led_ligado ? "LIGADO" : "DESLIGADO"), 1, 0, NULL, state); // publica estado do led
-    const char* cor = cor_atual == VERMELHO ? "Vermelho" : // define nome da cor atual
-                      cor_atual == VERDE ? "Verde" :
-                      cor_atual == AZUL ? "Azul" :
-                      cor_atual == AMARELO ? "Amarelo" :
-                      cor_atual == CIANO ? "Ciano" : "Lilas";
-    mqtt_publish(state->mqtt_client_inst, "casa/estado/cor", cor, strlen(cor), 1, 0, NULL, state); // publica cor atual
-    const char* comodo = comodo_atual == QUARTO_1 ? "Quarto1" : // define nome do cômodo atual
-                         comodo_atual == QUARTO_2 ? "Quarto2" :
-                         comodo_atual == COZINHA ? "Cozinha" : "Banheiro";
-    mqtt_publish(state->mqtt_client_inst, "casa/estado/comodo", comodo, strlen(comodo), 1, 0, NULL, state); // publica cômodo atual
-    mqtt_publish(state->mqtt_client_inst, "casa/estado/emergencia", emergencia ? "LIGADA" : "DESLIGADA", strlen(emergencia ? "LIGADA" : "DESLIGADA"), 1, 0, NULL, state); // publica estado da emergência
-    printf("Estados publicados: LED=%s, Cor=%s, Cômodo=%s, Emergência=%s\n", // loga estados publicados
-           led_ligado ? "LIGADO" : "DESLIGADO", cor, comodo, emergencia ? "LIGADA" : "DESLIGADA");
-}
\ No newline at end of file
+    state->estados_pendentes |= ESTADOS_ROTINA; // led, cor e cômodo (emergência e brilho têm caminho próprio)
+    mqtt_continuar(state);                // publica o que couber; o resto sai a cada PUBACK
+    LOG_INFO(EV_PUB_ESTADOS, painel.led_ligado, painel.cor, painel.comodo, painel.emergencia); // loga estados publicados
+}
+
+// tópicos completos do nó; o relógio é um só para a casa
+static void montar_topicos(const char *prefixo) {
+    prefixo_no = prefixo;
+    for (int t = 0; t < TOPICO_TOTAL; t++) snprintf(topicos[t], TOPICO_MAX, "%s/%s", prefixo, sufixos_topico[t]);
+    snprintf(topicos[TOPICO_RELOGIO], TOPICO_MAX, MQTT_RAIZ "/relogio");
+}
+
+// publica o consolidado da casa (retido, para o dashboard que acabou de se inscrever); true se saiu
+static bool publicar_gateway(MQTT_CLIENT_DATA_T *state) {
+    static char consolidado[GATEWAY_JSON_MAX];
+    cyw43_arch_lwip_begin();               // a tabela é atualizada pelo callback de dados do MQTT
+    size_t n = gateway_json(consolidado, sizeof(consolidado));
+    bool publicado = n > 0 && publicar(state, MQTT_CLASSE_TELEMETRIA, TOPICO_GATEWAY_ESTADO, consolidado, n, true) == ERR_OK;
+    if (publicado) gateway_publicado();
+    cyw43_arch_lwip_end();
+    if (publicado) LOG_DEBUG(EV_GATEWAY_PUBLICADO, gateway_estatisticas()->nos, gateway_estatisticas()->online, n);
+    return publicado;
+}
+
+// eixos do joystick: brilho (X) e cômodo (Y); o LED RGB e a matriz são atualizados na mesma volta do loop
+static void tratar_joystick(MQTT_CLIENT_DATA_T *state, uint32_t agora) {
+    JoystickAcao acao;
+    if (!joystick_atualizar(adc_amostragem_media(JOYSTICK_CANAL_X, JOYSTICK_MEDIA),
+                            adc_amostragem_media(JOYSTICK_CANAL_Y, JOYSTICK_MEDIA), agora, painel.brilho, &acao)) {
+        return;
+    }
+    // a deflexão ainda não aparecia na leitura anterior: mede dela até as saídas refletirem a ação, o que
+    // inclui o período de leitura e a janela da média (limite superior do atraso que o usuário sente)
+    if (!joystick_acao_us) joystick_acao_us = ultima_leitura_adc_us ? ultima_leitura_adc_us : time_us_64();
+    energia_atividade();                   // joystick conta como atividade do usuário
+    painel.brilho = acao.brilho;           // publicado à parte (publicar_brilho), não a cada passo
+    if (acao.comodo) {                     // como o botão A: próximo (ou anterior) cômodo, LEDs ligados
+        painel.comodo = (Comodo)((painel.comodo + COMODO_TOTAL + acao.comodo) % COMODO_TOTAL);
+        painel.led_ligado = true;
+        LOG_INFO(EV_JOYSTICK_COMODO, painel.comodo, acao.comodo);
+        publish_states(state);
+    }
+}
+
+// publica o brilho (retido); sai depois dos estados pendentes, que têm a vez na fila de pedidos do lwIP
+static void publicar_brilho(MQTT_CLIENT_DATA_T *state) {
+    state->estados_pendentes |= ESTADO_BRILHO;
+    mqtt_continuar(state);
+    brilho_publicado = painel.brilho;
+    LOG_DEBUG(EV_JOYSTICK_BRILHO, painel.brilho, joystick_estatisticas()->latencia_us / 100);
+}
@@ -3,4 +3,43 @@
 
 #include "mbedtls_config_examples_common.h"
 
+// Ajustes do painel: apenas cliente TLS 1.2 com ECDHE + AES-GCM e retomada de sessão
+
+// retomada por ticket (RFC 5077); a retomada por ID de sessão não precisa de opção extra
+#define MBEDTLS_SSL_SESSION_TICKETS
+
+// alocação por mbedtls_platform_set_calloc_free: o painel mede o pico de heap do handshake
+#define MBEDTLS_PLATFORM_MEMORY
+
+// o painel é só cliente: remove o código de servidor
+#undef MBEDTLS_SSL_SRV_C
+
+// curvas: P-256/P-384 (certificados usuais) e X25519 (troca de chaves mais rápida)
+#undef MBEDTLS_ECP_DP_SECP192R1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP224R1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP521R1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP192K1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP224K1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP256K1_ENABLED
+#undef MBEDTLS_ECP_DP_BP256R1_ENABLED
+#undef MBEDTLS_ECP_DP_BP384R1_ENABLED
+#undef MBEDTLS_ECP_DP_BP512R1_ENABLED
+
+// suites oferecidas ao broker (as primeiras são as mais baratas no RP2040)
+#define MBEDTLS_KEY_EXCHANGE_ECDHE_RSA_ENABLED
+#define MBEDTLS_SSL_CIPHERSUITES \
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256, \
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256, \
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384, \
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384
+
+// RAM: janela menor nas multiplicações de curva e MPI (mais lento, bem menos heap no handshake)
+#define MBEDTLS_ECP_WINDOW_SIZE        2
+#define MBEDTLS_ECP_FIXED_POINT_OPTIM  0
+#define MBEDTLS_MPI_WINDOW_SIZE        2
+
+// buffer de entrada continua em 16 KB: o altcp do lwIP não expõe a negociação de max_fragment_length,
+// então o broker pode mandar registros completos; a saída (MQTT, mensagens curtas) fica em 2 KB
+#define MBEDTLS_SSL_IN_CONTENT_LEN     16384
+
 #endif
\ No newline at end of file
@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+# Teste de carga do servidor HTTP do painel com curl.
+# Mede requisições por segundo e latência (média, p50, p95, p99, máx).
+#
+# Uso: tools/carga_http.sh <ip_do_painel> [requisicoes] [paralelas] [caminho] [corpo]
+#   tools/carga_http.sh 192.168.0.50 500 4 /estado.json
+#   tools/carga_http.sh 192.168.0.50 200 2 /comando.cgi "cor=Azul"    # com corpo: POST
+
+set -euo pipefail
+
+IP=${1:?"informe o IP do painel"}
+TOTAL=${2:-500}
+PARALELAS=${3:-4}
+CAMINHO=${4:-/estado.json}
+CORPO=${5:-}
+URL="http://${IP}${CAMINHO}"
+DADOS=()
+if [ -n "$CORPO" ]; then DADOS=(--data "$CORPO"); fi
+TEMPOS=$(mktemp)
+trap 'rm -f "$TEMPOS"' EXIT
+
+echo "Carga: ${TOTAL} requisições, ${PARALELAS} em paralelo -> ${URL}"
+INICIO=$(date +%s.%N)
+seq "$TOTAL" | xargs -P "$PARALELAS" -I{} \
+    curl -s -o /dev/null --compressed ${DADOS[@]+"${DADOS[@]}"} -w '%{http_code} %{time_total}\n' "$URL" >> "$TEMPOS" || true
+FIM=$(date +%s.%N)
+
+sort -k2 -n "$TEMPOS" | awk -v inicio="$INICIO" -v fim="$FIM" '
+    function percentil(p,   i) { i = int(NR * p); return t[i > 0 ? i : 1] }
+    { t[NR] = $2 * 1000; soma += t[NR]; if ($1 != 200) erros++ }
+    END {
+        duracao = fim - inicio
+        if (NR == 0) { print "nenhuma resposta"; exit 1 }
+        printf "respostas: %d (erros: %d) em %.2f s -> %.1f req/s\n", NR, erros, duracao, NR / duracao
+        printf "latência (ms): média %.1f | p50 %.1f | p95 %.1f | p99 %.1f | máx %.1f\n",
+               soma / NR, percentil(0.50), percentil(0.95), percentil(0.99), t[NR]
+    }'
@@ -0,0 +1,208 @@
+#!/usr/bin/env python3
+"""Soak de vários painéis no mesmo broker: N instâncias de painel_sim (tools/host) em tempo real, cada
+uma com seu ID de placa (nó casa/<ID>), a primeira também como gateway (prefixo gateway=1).
+
+Comanda cor e cômodo de cada nó a uma taxa fixa por nó, observa casa/# e confere o consolidado em
+casa/gateway/estado. Resultados:
+    por nó       mensagens/s publicadas pelo nó e latência comando -> eco em <nó>/estado/cor
+    gateway      publicações/s, tamanho médio e máximo, atraso comando -> consolidado com o valor novo
+    consolidado  ao fim, "nos" e "online" iguais a N e cor/cômodo de cada nó iguais ao último comando
+Requer paho-mqtt e um broker local (ex.: mosquitto -p 1883).
+
+Exemplos:
+    # 12 painéis por 2 minutos, 2 comandos/s em cada um
+    python3 tools/casa_soak.py localhost --sim build-host/painel_sim --nos 12 --taxa 2 --duracao 120
+
+    # gateway sob rajada: 4 painéis, 20 comandos/s em cada
+    python3 tools/casa_soak.py localhost --sim build-host/painel_sim --nos 4 --taxa 20 --duracao 30
+"""
+
+import argparse
+import collections
+import json
+import subprocess
+import sys
+import threading
+import time
+
+from mqtt_carga import RAIZ, VALORES, novo_cliente, percentil
+
+TOPICO_GATEWAY = f"{RAIZ}/gateway/estado"
+ID_BASE = 0xE6614104A0000000            # últimos 4 bytes viram o nome do nó: A0000001, A0000002, ...
+BOOT = 3.0                              # segundos até o painel simulado conectar (Wi-Fi simulado + CONNACK)
+
+
+class Observador:
+    """Tudo o que chega em casa/#; chamado pela thread do paho e pela de envio."""
+
+    def __init__(self, nos):
+        self.trava = threading.Lock()
+        self.nos = nos
+        self.publicadas = collections.Counter()     # nó -> mensagens
+        self.pendentes = {no: collections.deque() for no in nos}  # (t, cor) ainda não ecoados
+        self.pendentes_gateway = {no: collections.deque() for no in nos}
+        self.eco, self.atraso_gateway = [], []
+        self.gateway_n, self.gateway_bytes, self.gateway_max = 0, 0, 0
+        self.consolidado = None
+
+    def comando(self, no, cor, t):
+        with self.trava:
+            self.pendentes[no].append((t, cor))
+            self.pendentes_gateway[no].append((t, cor))
+
+    @staticmethod
+    def casar(fila, valor, t, latencias):
+        """Remove da fila até o comando com 'valor' (os anteriores foram agrupados no mesmo eco)."""
+        for i, (_, v) in enumerate(fila):
+            if v == valor:
+                for _ in range(i):
+                    fila.popleft()
+                latencias.append(t - fila.popleft()[0])
+                return
+
+    def receber(self, topico, payload, retido):
+        agora = time.perf_counter()
+        with self.trava:
+            if topico == TOPICO_GATEWAY:
+                if retido:
+                    return
+                self.gateway_n += 1
+                self.gateway_bytes += len(payload)
+                self.gateway_max = max(self.gateway_max, len(payload))
+                self.consolidado = json.loads(payload)
+                for no, estado in self.consolidado.get("paineis", {}).items():
+                    if no in self.pendentes_gateway and "cor" in estado:
+                        self.casar(self.pendentes_gateway[no], estado["cor"], agora, self.atraso_gateway)
+                return
+            partes = topico.split("/")
+            if len(partes) < 3 or partes[1] not in self.pendentes or partes[2] == "comando":
+                return
+            if not retido:
+                self.publicadas[partes[1]] += 1
+            if partes[2:] == ["estado", "cor"]:
+                self.casar(self.pendentes[partes[1]], payload.decode(errors="replace"), agora, self.eco)
+
+
+def iniciar_nos(args, nos):
+    processos = []
+    for i, no in enumerate(nos):
+        comando = [args.sim, "--broker", f"{args.broker}:{args.porta}", "--duracao", str(args.duracao + BOOT + args.dreno + 2),
+                   "--id", f"{ID_BASE + i + 1:X}"]
+        if i == 0:
+            comando += ["--config", "gateway=1"]
+        processos.append(subprocess.Popen(comando, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True))
+    return processos
+
+
+def comandar(cliente, args, nos, observador):
+    """Cor e cômodo alternados, taxa fixa por nó, nós intercalados (laço aberto)."""
+    ultimo = {no: {} for no in nos}
+    intervalo = 1.0 / (args.taxa * len(nos))
+    inicio = time.perf_counter()
+    i = 0
+    while time.perf_counter() - inicio < args.duracao:
+        alvo = inicio + i * intervalo
+        if alvo > time.perf_counter():
+            time.sleep(alvo - time.perf_counter())
+        no = nos[i % len(nos)]
+        rodada = i // len(nos)
+        comando = "cor" if rodada % 2 == 0 else "comodo"
+        valor = VALORES[comando][(rodada // 2 + i) % len(VALORES[comando])]
+        if comando == "cor":
+            observador.comando(no, valor, time.perf_counter())
+        cliente.publish(f"{RAIZ}/{no}/comando/{comando}", valor, qos=1)
+        ultimo[no][comando] = valor
+        i += 1
+    return i, time.perf_counter() - inicio, ultimo
+
+
+def conferir(consolidado, nos, ultimo):
+    erros = []
+    if consolidado is None:
+        return ["nenhum consolidado publicado"]
+    if consolidado.get("nos") != len(nos) or consolidado.get("online") != len(nos):
+        erros.append(f"nos {consolidado.get('nos')} online {consolidado.get('online')} (esperado {len(nos)})")
+    paineis = consolidado.get("paineis", {})
+    for no in nos:
+        estado = paineis.get(no)
+        if estado is None:
+            erros.append(f"{no}: ausente")
+            continue
+        for campo, valor in ultimo[no].items():
+            if estado.get(campo) != valor:
+                erros.append(f"{no}: {campo} {estado.get(campo)} (último comando {valor})")
+    return erros
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("broker")
+    parser.add_argument("--porta", type=int, default=1883)
+    parser.add_argument("--sim", default="build-host/painel_sim", help="executável do painel_sim")
+    parser.add_argument("--nos", type=int, default=12, help="painéis simulados (o primeiro é o gateway)")
+    parser.add_argument("--taxa", type=float, default=2.0, help="comandos por segundo em cada nó")
+    parser.add_argument("--duracao", type=float, default=60.0, help="segundos de carga")
+    parser.add_argument("--dreno", type=float, default=3.0, help="segundos esperando ecos após o último envio")
+    args = parser.parse_args()
+    try:
+        import paho.mqtt.client as mqtt
+    except ImportError:
+        raise SystemExit("instale paho-mqtt")
+
+    nos = [f"{(ID_BASE + i + 1) & 0xFFFFFFFF:08X}" for i in range(args.nos)]
+    observador = Observador(nos)
+    cliente = novo_cliente(mqtt, f"casa-soak-{time.time_ns() % 100000}")
+    cliente.on_connect = lambda c, _dados, _flags, rc: rc == 0 and c.subscribe(f"{RAIZ}/#", qos=1)
+    cliente.on_message = lambda _c, _dados, msg: observador.receber(msg.topic, msg.payload, msg.retain)
+    cliente.max_inflight_messages_set(1000)
+    cliente.connect(args.broker, args.porta, keepalive=30)
+    cliente.loop_start()
+
+    processos = iniciar_nos(args, nos)
+    try:
+        time.sleep(BOOT)
+        print(f"{args.nos} painéis ({nos[0]} é o gateway), {args.taxa:g} comandos/s em cada, {args.duracao:g} s",
+              flush=True)
+        with observador.trava:
+            publicadas_antes = observador.publicadas.copy()
+            gateway_antes = observador.gateway_n
+        enviados, duracao, ultimo = comandar(cliente, args, nos, observador)
+        time.sleep(args.dreno)
+    except KeyboardInterrupt:
+        print("\ninterrompido")
+        for p in processos:
+            p.terminate()
+        return 1
+    finally:
+        cliente.loop_stop()
+        cliente.disconnect()
+
+    with observador.trava:
+        print(f"enviados {enviados} comandos em {duracao:.1f} s ({enviados / duracao:.1f}/s)")
+        eco = sorted(observador.eco)
+        print(f"  eco <nó>/estado/cor (ms): p50 {percentil(eco, 0.5) * 1000:.1f} | p99 {percentil(eco, 0.99) * 1000:.1f}"
+              f" | {len(eco)} confirmados")
+        taxas = [(observador.publicadas[no] - publicadas_antes[no]) / duracao for no in nos]
+        print(f"  mensagens/s por nó: mín {min(taxas):.1f} | média {sum(taxas) / len(taxas):.1f} | máx {max(taxas):.1f}")
+        n = observador.gateway_n - gateway_antes
+        atraso = sorted(observador.atraso_gateway)
+        print(f"gateway: {n / duracao:.2f} publicações/s, {observador.gateway_bytes / max(observador.gateway_n, 1):.0f} "
+              f"bytes em média (máx {observador.gateway_max}); atraso comando -> consolidado p50 "
+              f"{percentil(atraso, 0.5) * 1000:.0f} ms p99 {percentil(atraso, 0.99) * 1000:.0f} ms")
+        erros = conferir(observador.consolidado, nos, ultimo)
+    print("consolidado: " + ("ok" if not erros else f"{len(erros)} divergências"))
+    for erro in erros:
+        print(f"  {erro}")
+
+    recusados = 0
+    for p in processos:
+        saida, _ = p.communicate()
+        for linha in saida.splitlines():
+            if linha.startswith("mqtt:"):
+                recusados += int(linha.split(" mensagens recebidas, ")[1].split()[0])
+    print(f"painéis: {recusados} pedidos recusados no total (MQTT_REQ_MAX_IN_FLIGHT)")
+    return 1 if erros else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""Cena x sequência de comandos: mesma mudança de cômodo, cor e LED feita de três formas contra um
+painel_sim (tools/host) em tempo real, um processo por modo:
+    comandos  <nó>/comando/comodo, /cor e /led publicados em seguida (o que os clientes fazem hoje)
+    cena      um <nó>/comando/cena com os três campos
+    preset    um <nó>/comando/cena com o nome de uma cena gravada antes em <nó>/cena/definir
+Por mudança: publicações no fio (comandos enviados + publicações do nó, fora sensores), estados
+intermediários vistos em <nó>/estado/* (valor diferente do alvo), quadros da matriz e escritas no PWM
+do LED (do --saida do painel_sim) e a latência do primeiro envio até led/cor/comodo baterem com o alvo.
+Requer paho-mqtt e um broker local (ex.: mosquitto -p 1883).
+
+Exemplos:
+    # 40 mudanças em cada modo, uma a cada 0,5 s
+    python3 tools/cena_bench.py localhost --sim build-host/painel_sim --mudancas 40
+
+    # rajada: mudanças a cada 50 ms
+    python3 tools/cena_bench.py localhost --sim build-host/painel_sim --intervalo 0.05
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+from mqtt_carga import RAIZ, VALORES, novo_cliente, percentil
+
+ID_BASE = 0xE6614104C0000000            # um nó por modo: C0000001, C0000002, ...
+BOOT = 3.0                              # segundos até o painel simulado conectar
+MODOS = ("comandos", "cena", "preset")
+ESTADOS = {"led": {"LIGADO": "On", "DESLIGADO": "Off"}}  # payload de estado -> valor de comando
+CICLO = 8                               # alvos distintos (cabem nas CENAS_MAX de lib/cenas.h)
+
+
+def alvo(i):
+    """Cômodo, cor e LED mudam todos de uma mudança para a seguinte (e da partida Quarto1/Vermelho/Off)."""
+    i = (i + 1) % CICLO
+    return {"comodo": VALORES["comodo"][i % 4], "cor": VALORES["cor"][i % 6], "led": VALORES["led"][i % 2]}
+
+
+def campos(valores):
+    return " ".join(f"{k}={v}" for k, v in valores.items())
+
+
+class Observador:
+    """Tudo o que o nó publica; chamado pela thread do paho e pela de envio."""
+
+    def __init__(self, no):
+        self.trava = threading.Lock()
+        self.no = no
+        self.estado = {}
+        self.alvo, self.enviado = None, 0.0
+        self.publicadas, self.intermediarios = 0, 0
+        self.latencias = []
+        self.online = None                  # instante do "online" (alinha o relógio do painel_sim)
+        self.status = threading.Event()
+
+    def mudanca(self, valores, t):
+        with self.trava:
+            self.alvo, self.enviado = valores, t
+
+    def receber(self, topico, payload, retido):
+        agora = time.perf_counter()
+        partes = topico.split("/")
+        if len(partes) < 3 or partes[1] != self.no or partes[2] in ("comando", "sensores"):
+            return
+        valor = payload.decode(errors="replace")
+        with self.trava:
+            if partes[2:] == ["painel", "status"] and valor == "online":
+                self.online = agora
+            if partes[2:] == ["cena", "status"]:
+                self.status.set()
+            if retido or self.alvo is None:
+                return
+            self.publicadas += 1
+            if partes[2] != "estado" or partes[3] not in self.alvo:
+                return
+            campo = partes[3]
+            self.estado[campo] = ESTADOS.get(campo, {}).get(valor, valor)
+            if self.estado[campo] != self.alvo[campo]:
+                self.intermediarios += 1
+            elif self.enviado and all(self.estado.get(k) == v for k, v in self.alvo.items()):
+                self.latencias.append(agora - self.enviado)
+                self.enviado = 0.0          # só a primeira vez que o estado bate
+
+
+def contar_saidas(caminho, desde_ms):
+    """Quadros da matriz e escritas no PWM do LED após o início das mudanças (relógio do painel_sim)."""
+    quadros = pwm = 0
+    with open(caminho) as arquivo:
+        for linha in arquivo:
+            partes = linha.split()
+            if len(partes) < 2 or float(partes[0]) < desde_ms:
+                continue
+            quadros += partes[1] == "matriz"
+            pwm += partes[1] == "pwm"
+    return quadros, pwm
+
+
+def medir(args, mqtt, modo, indice):
+    id_placa = ID_BASE + indice + 1
+    no = f"{id_placa & 0xFFFFFFFF:08X}"
+    prefixo = f"{RAIZ}/{no}"
+    observador = Observador(no)
+    cliente = novo_cliente(mqtt, f"cena-bench-{time.time_ns() % 100000}")
+    cliente.on_connect = lambda c, _dados, _flags, rc: rc == 0 and c.subscribe(f"{prefixo}/#", qos=1)
+    cliente.on_message = lambda _c, _dados, msg: observador.receber(msg.topic, msg.payload, msg.retain)
+    cliente.max_inflight_messages_set(1000)
+    cliente.connect(args.broker, args.porta, keepalive=30)
+    cliente.loop_start()
+
+    saida = tempfile.NamedTemporaryFile(prefix="cena_bench_", suffix=".txt", delete=False).name
+    duracao = BOOT + 1.0 + args.mudancas * args.intervalo + args.dreno + (CICLO * 0.2 if modo == "preset" else 0)
+    processo = subprocess.Popen([args.sim, "--broker", f"{args.broker}:{args.porta}", "--duracao", str(duracao + 1),
+                                 "--id", f"{id_placa:X}", "--saida", saida],
+                                stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, text=True)
+    try:
+        time.sleep(BOOT)
+        if modo == "preset":            # grava as cenas antes de medir (a gravação não entra na conta)
+            for i in range(CICLO):
+                observador.status.clear()
+                cliente.publish(f"{prefixo}/cena/definir", f"b{i} {campos(alvo(i))}", qos=1)
+                if not observador.status.wait(2.0):
+                    raise SystemExit(f"{no}: sem resposta em cena/status")
+        time.sleep(1.0)
+        inicio = time.perf_counter()
+        for i in range(args.mudancas):
+            momento = inicio + i * args.intervalo
+            if momento > time.perf_counter():
+                time.sleep(momento - time.perf_counter())
+            valores = alvo(i)
+            observador.mudanca(valores, time.perf_counter())
+            if modo == "comandos":
+                for comando in ("comodo", "cor", "led"):  # selecionar o cômodo liga o LED: led por último
+                    cliente.publish(f"{prefixo}/comando/{comando}", valores[comando], qos=1)
+            elif modo == "cena":
+                cliente.publish(f"{prefixo}/comando/cena", campos(valores), qos=1)
+            else:
+                cliente.publish(f"{prefixo}/comando/cena", f"b{i % CICLO}", qos=1)
+        time.sleep(args.dreno)
+    finally:
+        cliente.loop_stop()
+        cliente.disconnect()
+        processo.communicate()
+
+    with observador.trava:
+        if observador.online is None:
+            raise SystemExit(f"{no}: painel_sim não conectou ao broker")
+        # o "pronto" do painel_sim (t = 0 no --saida) precede o "online" em menos de 1 ms
+        quadros, pwm = contar_saidas(saida, (inicio - observador.online) * 1000)
+        os.unlink(saida)
+        enviados = args.mudancas * (3 if modo == "comandos" else 1)
+        return {
+            "modo": modo, "fio": (enviados + observador.publicadas) / args.mudancas, "enviados": enviados / args.mudancas,
+            "publicadas": observador.publicadas / args.mudancas,
+            "intermediarios": observador.intermediarios / args.mudancas, "quadros": quadros / args.mudancas,
+            "pwm": pwm / args.mudancas, "latencias": sorted(observador.latencias),
+        }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("broker")
+    parser.add_argument("--porta", type=int, default=1883)
+    parser.add_argument("--sim", default="build-host/painel_sim", help="executável do painel_sim")
+    parser.add_argument("--mudancas", type=int, default=20, help="mudanças em cada modo")
+    parser.add_argument("--intervalo", type=float, default=0.5, help="segundos entre mudanças")
+    parser.add_argument("--dreno", type=float, default=1.0, help="segundos esperando ecos após a última mudança")
+    parser.add_argument("--modos", default=",".join(MODOS), help="subconjunto de " + ",".join(MODOS))
+    args = parser.parse_args()
+    try:
+        import paho.mqtt.client as mqtt
+    except ImportError:
+        raise SystemExit("instale paho-mqtt")
+
+    modos = args.modos.split(",")
+    print(f"{args.mudancas} mudanças de cômodo, cor e LED por modo, uma a cada {args.intervalo:g} s")
+    print(f"{'modo':<10}{'no fio':>8}{'enviadas':>10}{'do nó':>8}{'interm.':>9}{'quadros':>9}{'pwm':>6}"
+          f"{'p50 (ms)':>10}{'p99 (ms)':>10}{'ok':>5}")
+    falhas = 0
+    for indice, modo in enumerate(modos):
+        if modo not in MODOS:
+            raise SystemExit(f"modo desconhecido: {modo}")
+        r = medir(args, mqtt, modo, indice)
+        lat = r["latencias"]
+        falhas += len(lat) != args.mudancas
+        print(f"{modo:<10}{r['fio']:>8.2f}{r['enviados']:>10.2f}{r['publicadas']:>8.2f}{r['intermediarios']:>9.2f}"
+              f"{r['quadros']:>9.2f}{r['pwm']:>6.2f}{percentil(lat, 0.5) * 1000:>10.1f}{percentil(lat, 0.99) * 1000:>10.1f}"
+              f"{len(lat):>5}", flush=True)
+    print("(por mudança; 'ok' = mudanças cujo estado final bateu com o alvo)")
+    return 1 if falhas else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""Decodifica o log binário do painel (firmware compilado com -DLOG_SAIDA_BINARIA=ON).
+
+Lê os quadros da porta serial USB (ou de um arquivo capturado) e formata cada
+entrada com os textos de lib/log_eventos.h, sem custo de formatação no firmware.
+
+Uso:
+    python3 tools/decodificar_log.py /dev/ttyACM0
+    python3 tools/decodificar_log.py captura.bin
+"""
+
+import os
+import re
+import struct
+import sys
+
+SINC = b"\xa5\x5a"                        # bytes de sincronismo de cada quadro
+ENTRADA = struct.Struct("<IHH4i")         # tempo_us, evento, seq, 4 argumentos (int32)
+NIVEIS = "EWID"
+
+
+def carregar_eventos(caminho):
+    """Extrai (identificador, formato) da X-macro LOG_EVENTOS, na ordem do enum."""
+    texto = open(caminho, encoding="utf-8").read()
+    return re.findall(r'X\((EV_\w+),\s*"((?:[^"\\]|\\.)*)"\)', texto)
+
+
+def abrir_fonte(caminho):
+    if caminho.startswith("/dev/"):
+        import serial                     # pyserial, só necessário para leitura ao vivo
+        return serial.Serial(caminho, 115200, timeout=1)
+    return open(caminho, "rb")
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 1
+    raiz = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    eventos = carregar_eventos(os.path.join(raiz, "lib", "log_eventos.h"))
+    fonte = abrir_fonte(sys.argv[1])
+    buffer = b""
+    seq_anterior = None
+    while True:
+        bloco = fonte.read(256)
+        if not bloco:
+            if fonte.__class__.__name__ == "Serial":
+                continue
+            break
+        buffer += bloco
+        while True:
+            inicio = buffer.find(SINC)
+            if inicio < 0:                # mantém o último byte: pode ser metade do sincronismo
+                buffer = buffer[-1:]
+                break
+            if len(buffer) - inicio < 2 + ENTRADA.size:
+                buffer = buffer[inicio:]  # quadro incompleto: espera mais dados
+                break
+            quadro = buffer[inicio + 2:inicio + 2 + ENTRADA.size]
+            buffer = buffer[inicio + 2 + ENTRADA.size:]
+            tempo_us, evento, seq, *args = ENTRADA.unpack(quadro)
+            if seq_anterior is not None and (seq - seq_anterior) & 0xFFFF != 1:
+                print(f"[log] {((seq - seq_anterior - 1) & 0xFFFF)} entradas perdidas")
+            seq_anterior = seq
+            nivel, ident = NIVEIS[evento >> 14], evento & 0x3FFF
+            if ident < len(eventos):
+                nome, formato = eventos[ident]
+                mensagem = formato.replace("%d", "{}").format(*args[:formato.count("%d")]).replace("%%", "%")
+            else:
+                mensagem = f"evento desconhecido {ident}"
+            print(f"[{tempo_us // 1000000}.{tempo_us % 1000000:06d}] {nivel} {mensagem}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,310 @@
+#!/usr/bin/env python3
+"""Converte as fontes BDF e imagens 1-bit de assets/ nos recursos do OLED em flash.
+
+Cada glifo/imagem vira faixas de páginas (byte = uma coluna de 8 linhas, bit 0 em cima;
+página a página), o formato da RAM do SSD1306, opcionalmente comprimidas com RLE
+(estilo PackBits, só quando fica menor). As fontes ganham tabelas de faixas de
+códigos Latin-1 e larguras proporcionais (DWIDTH do BDF). Formato em lib/fonte.h.
+
+A lista de recursos (assets/lista.txt) tem uma linha por recurso:
+    fonte   <nome> <arquivo.bdf> [codigos=32-126,176,...] [rle]
+    imagem  <nome> <arquivo.pbm> [rle]
+
+Uso: python3 tools/gerar_fontes.py <lista.txt> <saida.c> <saida.h>
+"""
+
+import os
+import sys
+
+FONTE_RLE = 0x8000
+
+
+def rle(dados):
+    """PackBits: 0x00-0x7F = n+1 literais; 0x80-0xFF = próximo byte (n & 0x7F) + 2 vezes."""
+    saida = bytearray()
+    literais = bytearray()
+    i = 0
+    while i < len(dados):
+        j = i
+        while j + 1 < len(dados) and dados[j + 1] == dados[i] and j - i < 128:
+            j += 1
+        repeticao = j - i + 1
+        if repeticao >= 3 or (repeticao == 2 and not literais):
+            if literais:
+                saida += bytes([len(literais) - 1]) + literais
+                literais = bytearray()
+            saida += bytes([0x80 | (repeticao - 2), dados[i]])
+            i = j + 1
+        else:
+            literais.append(dados[i])
+            if len(literais) == 128:
+                saida += bytes([127]) + literais
+                literais = bytearray()
+            i += 1
+    if literais:
+        saida += bytes([len(literais) - 1]) + literais
+    return bytes(saida)
+
+
+def faixas_paginas(pixels, largura, altura):
+    """Matriz de pixels [linha][coluna] -> bytes página a página, cada página com todas as colunas."""
+    dados = bytearray()
+    for p in range((altura + 7) // 8):
+        for x in range(largura):
+            byte = 0
+            for bit in range(8):
+                y = p * 8 + bit
+                if y < altura and pixels[y][x]:
+                    byte |= 1 << bit
+            dados.append(byte)
+    return bytes(dados)
+
+
+def ler_bdf(caminho):
+    """Devolve (altura, {código: (pixels, largura, avanço)})."""
+    glifos = {}
+    ascendente = descendente = None
+    caixa = None
+    with open(caminho, encoding="latin-1") as f:
+        linhas = iter(f.read().splitlines())
+    for linha in linhas:
+        campos = linha.split()
+        if not campos:
+            continue
+        if campos[0] == "FONTBOUNDINGBOX":
+            caixa = [int(v) for v in campos[1:5]]
+        elif campos[0] == "FONT_ASCENT":
+            ascendente = int(campos[1])
+        elif campos[0] == "FONT_DESCENT":
+            descendente = int(campos[1])
+        elif campos[0] == "STARTCHAR":
+            codigo, avanco, bbx, bitmap = None, 0, [0, 0, 0, 0], []
+            for linha in linhas:
+                campos = linha.split()
+                if not campos:
+                    continue
+                if campos[0] == "ENCODING":
+                    codigo = int(campos[1])
+                elif campos[0] == "DWIDTH":
+                    avanco = int(campos[1])
+                elif campos[0] == "BBX":
+                    bbx = [int(v) for v in campos[1:5]]
+                elif campos[0] == "BITMAP":
+                    for linha in linhas:
+                        if linha.strip() == "ENDCHAR":
+                            break
+                        bitmap.append(int(linha.strip(), 16) if linha.strip() else 0)
+                    break
+            glifos[codigo] = (avanco, bbx, bitmap)
+    if caixa is None:
+        raise ValueError(f"{caminho}: sem FONTBOUNDINGBOX")
+    if ascendente is None:
+        ascendente = caixa[1] + caixa[3]
+    if descendente is None:
+        descendente = -caixa[3]
+    altura = ascendente + descendente
+    resultado = {}
+    for codigo, (avanco, (w, h, xo, yo), bitmap) in glifos.items():
+        if codigo is None or not 0 <= codigo <= 255:
+            continue
+        largura = max(0, xo) + w
+        pixels = [[0] * largura for _ in range(altura)]
+        bits_linha = (w + 7) // 8 * 8
+        topo = ascendente - (yo + h)
+        for r, valor in enumerate(bitmap[:h]):
+            y = topo + r
+            if not 0 <= y < altura:
+                continue
+            for c in range(w):
+                if valor >> (bits_linha - 1 - c) & 1:
+                    x = xo + c
+                    if x >= 0:
+                        pixels[y][x] = 1
+        resultado[codigo] = (pixels, largura, avanco)
+    return altura, resultado
+
+
+def ler_pbm(caminho):
+    """PBM P1 (texto) ou P4 (binário); devolve (pixels, largura, altura)."""
+    dados = open(caminho, "rb").read()
+    i = 0
+
+    def token():
+        nonlocal i
+        while True:
+            while i < len(dados) and dados[i:i + 1].isspace():
+                i += 1
+            if dados[i:i + 1] == b"#":
+                while i < len(dados) and dados[i:i + 1] != b"\n":
+                    i += 1
+                continue
+            break
+        inicio = i
+        while i < len(dados) and not dados[i:i + 1].isspace() and dados[i:i + 1] != b"#":
+            i += 1
+        return dados[inicio:i].decode()
+
+    tipo, largura, altura = token(), int(token()), int(token())
+    if tipo == "P4":
+        i += 1                          # um espaço separa o cabeçalho do raster
+        por_linha = (largura + 7) // 8
+        pixels = [[dados[i + y * por_linha + x // 8] >> (7 - x % 8) & 1 for x in range(largura)]
+                  for y in range(altura)]
+    elif tipo == "P1":
+        bits = [int(c) for c in dados[i:].decode() if c in "01"]
+        if len(bits) < largura * altura:
+            raise ValueError(f"{caminho}: raster incompleto")
+        pixels = [bits[y * largura:(y + 1) * largura] for y in range(altura)]
+    else:
+        raise ValueError(f"{caminho}: formato {tipo} não suportado (use P1 ou P4)")
+    return pixels, largura, altura
+
+
+def ler_codigos(texto):
+    codigos = set()
+    for parte in texto.split(","):
+        inicio, _, fim = parte.partition("-")
+        codigos.update(range(int(inicio), int(fim or inicio) + 1))
+    return codigos
+
+
+def bytes_c(dados):
+    linhas = []
+    for i in range(0, len(dados), 16):
+        linhas.append("    " + ", ".join(f"0x{b:02x}" for b in dados[i:i + 16]) + ",")
+    return "\n".join(linhas)
+
+
+def empacotar(bruto, comprimir):
+    if comprimir:
+        comprimido = rle(bruto)
+        if len(comprimido) < len(bruto):
+            return comprimido, True
+    return bruto, False
+
+
+def gerar_fonte(nome, caminho, opcoes, partes):
+    altura, glifos = ler_bdf(caminho)
+    if "codigos" in opcoes:
+        pedidos = ler_codigos(opcoes["codigos"])
+        faltando = sorted(pedidos - glifos.keys())
+        if faltando:
+            raise ValueError(f"{caminho}: sem glifo para os códigos {faltando}")
+        glifos = {c: g for c, g in glifos.items() if c in pedidos}
+    if not glifos:
+        raise ValueError(f"{caminho}: nenhum glifo selecionado")
+    paginas = (altura + 7) // 8
+    codigos = sorted(glifos)
+    faixas = []
+    for c in codigos:
+        if faixas and faixas[-1][1] == c - 1:
+            faixas[-1][1] = c
+        else:
+            faixas.append([c, c, codigos.index(c)])
+    dados = bytearray()
+    tabela = []
+    bruto_total = 0
+    for c in codigos:
+        pixels, largura, avanco = glifos[c]
+        bruto = faixas_paginas(pixels, largura, altura)
+        bruto_total += len(bruto)
+        empacotado, comprimido = empacotar(bruto, "rle" in opcoes)
+        if len(dados) >= FONTE_RLE:
+            raise ValueError(f"{caminho}: dados passam de {FONTE_RLE} bytes")
+        tabela.append((c, len(dados) | (FONTE_RLE if comprimido else 0), largura, avanco))
+        dados += empacotado
+    substituto = codigos.index(ord("?")) if ord("?") in glifos else 0
+
+    partes.append(f"// {nome}: {os.path.basename(caminho)}, {len(codigos)} glifos de {altura} linhas, "
+                  f"{len(dados)} bytes de páginas ({bruto_total} sem compressão)")
+    partes.append(f"static const uint8_t {nome}_dados[] = {{")
+    partes.append(bytes_c(dados))
+    partes.append("};")
+    partes.append(f"static const FonteFaixa {nome}_faixas[] = {{")
+    for primeiro, ultimo, glifo in faixas:
+        partes.append(f"    {{ {primeiro}, {ultimo}, {glifo} }},")
+    partes.append("};")
+    partes.append(f"static const FonteGlifo {nome}_glifos[] = {{")
+    for c, deslocamento, largura, avanco in tabela:
+        rotulo = chr(c) if c > 32 and c != ord("\\") else str(c)  # "\\" no fim do comentário C emendaria a linha seguinte
+        partes.append(f"    {{ 0x{deslocamento:04x}, {largura}, {avanco} }}, // {rotulo}")
+    partes.append("};")
+    partes.append(f"const Fonte {nome} = {{ {altura}, {paginas}, {len(faixas)}, {len(codigos)}, {substituto}, "
+                  f"sizeof({nome}_dados), {nome}_faixas, {nome}_glifos, {nome}_dados }};")
+    partes.append("")
+    ocupacao = len(dados) + 3 * len(faixas) + 4 * len(codigos)
+    return f"{nome}: {len(codigos)} glifos, {ocupacao} bytes (páginas {len(dados)}/{bruto_total})"
+
+
+def gerar_imagem(nome, caminho, opcoes, partes):
+    pixels, largura, altura = ler_pbm(caminho)
+    if largura > 255 or altura > 255:
+        raise ValueError(f"{caminho}: imagem maior que 255x255")
+    bruto = faixas_paginas(pixels, largura, altura)
+    dados, comprimido = empacotar(bruto, "rle" in opcoes)
+    partes.append(f"// {nome}: {os.path.basename(caminho)}, {largura}x{altura}, "
+                  f"{len(dados)} bytes ({len(bruto)} sem compressão)")
+    partes.append(f"static const uint8_t {nome}_dados[] = {{")
+    partes.append(bytes_c(dados))
+    partes.append("};")
+    partes.append(f"const Imagem {nome} = {{ {largura}, {altura}, {(altura + 7) // 8}, "
+                  f"{'true' if comprimido else 'false'}, sizeof({nome}_dados), {nome}_dados }};")
+    partes.append("")
+    return f"{nome}: {largura}x{altura}, {len(dados)} bytes ({len(bruto)} sem compressão)"
+
+
+def main():
+    if len(sys.argv) != 4:
+        print(__doc__)
+        return 1
+    lista, saida_c, saida_h = sys.argv[1:]
+    base = os.path.dirname(os.path.abspath(lista))
+    nome_h = os.path.basename(saida_h)
+    partes = ["// Gerado por tools/gerar_fontes.py a partir de assets/ - não editar",
+              f'#include "{nome_h}"',
+              ""]
+    declaracoes = []
+    resumo = []
+    with open(lista, encoding="utf-8") as f:
+        for numero, linha in enumerate(f, 1):
+            linha = linha.split("#", 1)[0].split()
+            if not linha:
+                continue
+            if len(linha) < 3:
+                print(f"{lista}:{numero}: esperado '<tipo> <nome> <arquivo> [opções]'", file=sys.stderr)
+                return 1
+            tipo, nome, arquivo = linha[:3]
+            opcoes = dict(o.partition("=")[::2] for o in linha[3:])
+            caminho = os.path.join(base, arquivo)
+            try:
+                if tipo == "fonte":
+                    resumo.append(gerar_fonte(nome, caminho, opcoes, partes))
+                    declaracoes.append(f"extern const Fonte {nome};")
+                elif tipo == "imagem":
+                    resumo.append(gerar_imagem(nome, caminho, opcoes, partes))
+                    declaracoes.append(f"extern const Imagem {nome};")
+                else:
+                    print(f"{lista}:{numero}: tipo desconhecido '{tipo}'", file=sys.stderr)
+                    return 1
+            except (OSError, ValueError) as erro:
+                print(f"{lista}:{numero}: {erro}", file=sys.stderr)
+                return 1
+
+    guarda = "".join(c if c.isalnum() else "_" for c in nome_h).upper()
+    cabecalho = ["// Gerado por tools/gerar_fontes.py a partir de assets/ - não editar",
+                 f"#ifndef {guarda}",
+                 f"#define {guarda}",
+                 "",
+                 '#include "fonte.h"',
+                 ""] + declaracoes + ["", "#endif", ""]
+    for caminho, conteudo in ((saida_c, "\n".join(partes)), (saida_h, "\n".join(cabecalho))):
+        os.makedirs(os.path.dirname(os.path.abspath(caminho)), exist_ok=True)
+        with open(caminho, "w", encoding="utf-8") as f:
+            f.write(conteudo)
+    for linha in resumo:
+        print(f"fontes: {linha}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""Gera a imagem de sistema de arquivos (fsdata) do httpd do lwIP a partir de web/.
+
+Cada arquivo de texto é comprimido com gzip e recebe o cabeçalho HTTP completo
+(Content-Encoding: gzip, Content-Length), marcado como persistente: o httpd
+envia direto da flash, sem montar cabeçalhos nem copiar os dados.
+
+Só a versão comprimida vai para a flash e o httpd do lwIP não vê o Accept-Encoding
+dos GETs: clientes sem suporte a gzip (todo navegador tem; no curl, --compressed)
+não são suportados.
+
+Uso: python3 tools/gerar_fsdata.py <diretorio_web> <saida.c>
+"""
+
+import gzip
+import os
+import sys
+
+TIPOS = {
+    ".html": "text/html; charset=utf-8",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+}
+COMPRIMIR = {".html", ".css", ".js", ".json", ".svg"}
+
+
+def identificador(nome):
+    return "".join(c if c.isalnum() else "_" for c in nome)
+
+
+def montar_arquivo(caminho, nome_url):
+    extensao = os.path.splitext(caminho)[1].lower()
+    conteudo = open(caminho, "rb").read()
+    cabecalho = ["HTTP/1.0 404 File not found" if nome_url == "/404.html" else "HTTP/1.0 200 OK",
+                 "Server: painel-casa",
+                 f"Content-Type: {TIPOS.get(extensao, 'application/octet-stream')}"]
+    if extensao in COMPRIMIR:
+        comprimido = gzip.compress(conteudo, compresslevel=9, mtime=0)
+        if len(comprimido) < len(conteudo):
+            conteudo = comprimido
+            cabecalho.append("Content-Encoding: gzip")
+    cabecalho.append(f"Content-Length: {len(conteudo)}")
+    cabecalho.append("Cache-Control: max-age=3600")
+    return ("\r\n".join(cabecalho) + "\r\n\r\n").encode() + conteudo
+
+
+def bytes_c(dados):
+    linhas = []
+    for i in range(0, len(dados), 16):
+        linhas.append(", ".join(f"0x{b:02x}" for b in dados[i:i + 16]) + ",")
+    return "\n".join(linhas)
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        return 1
+    raiz, saida = sys.argv[1], sys.argv[2]
+    arquivos = []
+    for pasta, _, nomes in os.walk(raiz):
+        for nome in sorted(nomes):
+            caminho = os.path.join(pasta, nome)
+            arquivos.append(("/" + os.path.relpath(caminho, raiz).replace(os.sep, "/"), caminho))
+    arquivos.sort()
+
+    partes = ['// Gerado por tools/gerar_fsdata.py - não editar',
+              '#include "lwip/apps/fs.h"',
+              '#include "lwip/def.h"',
+              '',
+              '#define file_NULL (struct fsdata_file *) NULL',
+              '#ifndef FSDATA_ALIGN_PRE',
+              '#define FSDATA_ALIGN_PRE',
+              '#endif',
+              '#ifndef FSDATA_ALIGN_POST',
+              '#define FSDATA_ALIGN_POST',
+              '#endif',
+              '']
+    anterior = "file_NULL"
+    total = 0
+    for nome_url, caminho in arquivos:
+        ident = identificador(nome_url)
+        nome = nome_url.encode() + b"\0"
+        dados = montar_arquivo(caminho, nome_url)
+        total += len(dados)
+        partes.append(f"static const unsigned char FSDATA_ALIGN_PRE data_{ident}[] FSDATA_ALIGN_POST = {{")
+        partes.append(f"/* {nome_url} ({len(nome)} bytes) */")
+        partes.append(bytes_c(nome))
+        partes.append(f"/* cabeçalho HTTP + conteúdo ({len(dados)} bytes) */")
+        partes.append(bytes_c(dados))
+        partes.append("};")
+        partes.append("")
+        partes.append(f"const struct fsdata_file file_{ident}[] = {{ {{")
+        partes.append(f"    {anterior},")
+        partes.append(f"    data_{ident},")
+        partes.append(f"    data_{ident} + {len(nome)},")
+        partes.append(f"    sizeof(data_{ident}) - {len(nome)},")
+        partes.append("    FS_FILE_FLAGS_HEADER_INCLUDED | FS_FILE_FLAGS_HEADER_PERSISTENT,")
+        partes.append("} };")
+        partes.append("")
+        anterior = f"file_{ident}"
+    partes.append(f"#define FS_ROOT {anterior}")
+    partes.append(f"#define FS_NUMFILES {len(arquivos)}")
+    partes.append("")
+    os.makedirs(os.path.dirname(os.path.abspath(saida)), exist_ok=True)
+    with open(saida, "w") as f:
+        f.write("\n".join(partes))
+    print(f"fsdata: {len(arquivos)} arquivos, {total} bytes na flash")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,123 @@
+// Tempo de envio do framebuffer do OLED por controlador e barramento, com transportes simulados
+// (tools/host/oled_mock.c): bytes e transações no barramento, tempo estimado e quadros/s, além de
+// conferir que a RAM do controlador emulado ficou igual ao framebuffer depois de cada envio.
+//
+// Uso: display_bench [iterações]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ssd1306.h"
+#include "fontes_painel.h"
+#include "oled_mock.h"
+
+#define I2C_HZ 400000                   // main.c: i2c_init(I2C_PORT, 400 * 1000)
+#define SPI_HZ 8928571                  // 10 MHz pedidos: 125 MHz / 14 é a taxa mais próxima abaixo
+
+typedef struct {
+    const char *nome;
+    MockControlador controlador;
+    const ssd1306_driver_t *driver;
+    bool spi;
+} Backend;
+
+static const Backend backends[] = {
+    { "SSD1306 I2C 400 kHz", MOCK_SSD1306, &ssd1306_driver, false },
+    { "SSD1306 SPI 8,9 MHz", MOCK_SSD1306, &ssd1306_driver, true },
+    { "SH1106 I2C 400 kHz",  MOCK_SH1106,  &sh1106_driver,  false },
+    { "SH1106 SPI 8,9 MHz",  MOCK_SH1106,  &sh1106_driver,  true },
+};
+#define TOTAL_BACKENDS (int)(sizeof(backends) / sizeof(backends[0]))
+
+typedef struct {
+    const char *nome;
+    uint8_t x0, y0, x1, y1;
+} Regiao;
+
+static const Regiao regioes[] = {
+    { "tela inteira",         0, 0, 127, 63 },
+    { "temperatura (88x16)", 20, 20, 107, 35 }, // dígitos grandes de atualizar_display()
+    { "linha do IP (128x8)",  0, 56, 127, 63 },
+};
+#define TOTAL_REGIOES (int)(sizeof(regioes) / sizeof(regioes[0]))
+
+static double agora_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static void desenhar(ssd1306_t *disp) { // mesma composição de atualizar_display() em main.c
+    ssd1306_fill(disp, 0);
+    ssd1306_draw_image(disp, &icone_cozinha, 0, 0);
+    ssd1306_draw_text(disp, &fonte_painel8, "Cozinha", 20, 4);
+    ssd1306_draw_text(disp, &fonte_digitos16, "23.5°C", (WIDTH - fonte_largura_texto(&fonte_digitos16, "23.5°C")) / 2, 20);
+    ssd1306_draw_text(disp, &fonte_painel8, "Emergência: OFF", 2, 42);
+    ssd1306_draw_text(disp, &fonte_painel8, "192.168.100.45", 2, 54);
+}
+
+// driver anterior: endereçamento vertical, um comando por transação (0x80 + comando) e a tela inteira
+static void legado_send_data(ssd1306_t *disp) {
+    const uint8_t cmds[] = { SET_COL_ADDR, 0, WIDTH - 1, SET_PAGE_ADDR, 0, HEIGHT / 8 - 1 };
+    for (size_t i = 0; i < sizeof(cmds); i++) {
+        uint8_t buf[2] = { 0x80, cmds[i] };
+        i2c_write_blocking(i2c1, 0x3C, buf, 2, false);
+    }
+    disp->ram_buffer[0] = 0x40;
+    i2c_write_blocking(i2c1, 0x3C, disp->ram_buffer, disp->bufsize, false);
+}
+
+int main(int argc, char **argv) {
+    long iteracoes = argc > 1 ? strtol(argv[1], NULL, 10) : 20000;
+    if (iteracoes <= 0) {
+        fprintf(stderr, "uso: %s [iterações]\n", argv[0]);
+        return 1;
+    }
+    static ssd1306_t disp;
+    bool falhou = false;
+
+    printf("%-22s %-21s %6s %6s %10s %8s %10s  %s\n", "back end", "região", "trans.", "bytes", "barramento", "quadros/s",
+           "CPU (host)", "RAM do controlador"); // "ã" ocupa 2 bytes: coluna de 21 para alinhar as 20 de baixo
+    mock_oled_reiniciar(MOCK_SSD1306, I2C_HZ, SPI_HZ);
+    ssd1306_init(&disp, WIDTH, HEIGHT, false, 0x3C, i2c1);
+    desenhar(&disp);
+    legado_send_data(&disp);
+    const MockBarramento *b = mock_oled_barramento();
+    printf("%-22s %-20s %6lu %6lu %7.0f us %8.1f %10s  %s\n", "SSD1306 I2C (anterior)", "tela inteira", b->transacoes, b->bytes,
+           b->us, 1e6 / b->us, "-", "-");
+
+    for (int i = 0; i < TOTAL_BACKENDS; i++) {
+        const Backend *be = &backends[i];
+        mock_oled_reiniciar(be->controlador, I2C_HZ, SPI_HZ);
+        if (be->spi) ssd1306_init_spi(&disp, WIDTH, HEIGHT, false, spi0, MOCK_PINO_CS, MOCK_PINO_DC);
+        else ssd1306_init(&disp, WIDTH, HEIGHT, false, 0x3C, i2c1);
+        ssd1306_set_driver(&disp, be->driver);
+        ssd1306_config(&disp);
+        for (int r = 0; r < TOTAL_REGIOES; r++) {
+            const Regiao *rg = &regioes[r];
+            ssd1306_fill(&disp, 0);     // RAM do controlador igual ao framebuffer antes de enviar a região
+            ssd1306_send_data(&disp);
+            desenhar(&disp);
+            mock_oled_zerar_contadores();
+            ssd1306_send_region(&disp, rg->x0, rg->y0, rg->x1, rg->y1);
+            MockBarramento envio = *mock_oled_barramento();
+            if (r > 0) {                // fora da região o controlador ainda tem a tela vazia
+                for (int y = 0; y < HEIGHT; y++) {
+                    for (int x = 0; x < WIDTH; x++) {
+                        if (x < rg->x0 || x > rg->x1 || y / 8 < rg->y0 / 8 || y / 8 > rg->y1 / 8) ssd1306_pixel(&disp, x, y, false);
+                    }
+                }
+            }
+            bool confere = mock_oled_confere(&disp);
+            falhou |= !confere;
+            desenhar(&disp);
+            double inicio = agora_ns();
+            for (long k = 0; k < iteracoes; k++) ssd1306_send_region(&disp, rg->x0, rg->y0, rg->x1, rg->y1);
+            double cpu_ns = (agora_ns() - inicio) / iteracoes;
+            printf("%-22s %-20s %6lu %6lu %7.0f us %8.1f %7.0f ns  %s\n", r == 0 ? be->nome : "", rg->nome, envio.transacoes,
+                   envio.bytes, envio.us, 1e6 / envio.us, cpu_ns, confere ? "ok" : "DIFERENTE");
+        }
+    }
+    return falhou ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+// Compara as fontes geradas de assets/ (lib/fonte.h, desenhadas por lib/ssd1306.c) com a fonte 8x8
+// original (fonte_legada.h, desenhada pixel a pixel): ocupação na flash/RAM e tempo por string.
+//
+// Uso: fonte_bench [iterações] [--mostrar]
+//   --mostrar  imprime a tela do painel (atualizar_display) desenhada com as fontes novas
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ssd1306.h"
+#include "fontes_painel.h"
+#include "fonte_legada.h"
+
+// desenho original de lib/ssd1306.c: 64 chamadas a ssd1306_pixel por caractere, avanço fixo de 8
+static void legado_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y) {
+    uint16_t index = (c >= ' ' && c <= '~') ? (c - ' ') * 8 : 0;
+    for (uint8_t i = 0; i < 8; ++i) {
+        uint8_t line = font[index + i];
+        for (uint8_t j = 0; j < 8; ++j) ssd1306_pixel(ssd, x + i, y + j, line & (1 << j));
+    }
+}
+
+static void legado_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y) {
+    while (*str) {
+        legado_draw_char(ssd, *str++, x, y);
+        x += 8;
+        if (x + 8 >= ssd->width) {
+            x = 0;
+            y += 8;
+        }
+        if (y + 8 >= ssd->height) break;
+    }
+}
+
+typedef struct {
+    const char *texto;
+    const Fonte *fonte;                 // NULL: fonte legada
+    uint8_t x, y;
+} Caso;
+
+static const Caso casos[] = {
+    { "QUARTO 1",              NULL,             20, 2 },
+    { "QUARTO 1",              &fonte_painel8,   20, 2 },
+    { "Quarto 1",              &fonte_painel8,   20, 0 },
+    { "TEMP: 23.5C",           NULL,             20, 18 },
+    { "TEMP: 23.5C",           &fonte_painel8,   20, 18 },
+    { "23.5°C",                &fonte_digitos16, 30, 16 },
+    { "23.5°C",                &fonte_digitos16, 30, 20 },
+    { "EMERGENCIA: OFF",       NULL,             2, 34 },
+    { "EMERGENCIA: OFF",       &fonte_painel8,   2, 34 },
+    { "Emergência: OFF",       &fonte_painel8,   2, 34 },
+    { "192.168.100.45",        NULL,             6, 50 },
+    { "192.168.100.45",        &fonte_painel8,   6, 50 },
+    { "192.168.100.45",        &fonte_painel8,   6, 48 },
+};
+#define TOTAL_CASOS (int)(sizeof(casos) / sizeof(casos[0]))
+
+static double agora_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static size_t ocupacao_fonte(const Fonte *f) {
+    return sizeof(Fonte) + f->num_faixas * sizeof(FonteFaixa) + f->num_glifos * sizeof(FonteGlifo) + f->tamanho_dados;
+}
+
+static size_t ocupacao_imagem(const Imagem *img) {
+    return sizeof(Imagem) + img->tamanho_dados;
+}
+
+static int largura_utf8(const char *texto) { // caracteres, não bytes (alinhamento das colunas)
+    int n = 0;
+    for (; *texto; texto++) n += (*texto & 0xC0) != 0x80;
+    return n;
+}
+
+static void mostrar(ssd1306_t *ssd) {
+    for (int y = 0; y < ssd->height; y++) {
+        for (int x = 0; x < ssd->width; x++) putchar(ssd->ram_buffer[1 + y / 8 * ssd->width + x] >> (y % 8) & 1 ? '#' : '.');
+        putchar('\n');
+    }
+}
+
+int main(int argc, char **argv) {
+    long iteracoes = 200000;
+    bool exibir = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mostrar") == 0) exibir = true;
+        else if ((iteracoes = strtol(argv[i], NULL, 10)) <= 0) {
+            fprintf(stderr, "uso: %s [iterações] [--mostrar]\n", argv[0]);
+            return 1;
+        }
+    }
+    static ssd1306_t disp;
+    ssd1306_init(&disp, WIDTH, HEIGHT, false, 0x3C, NULL);
+
+    printf("Ocupação (bytes)\n");
+    printf("  %-18s %5zu  flash + RAM (tabela 8x8 não const, 95 glifos ASCII)\n", "legada", sizeof(font));
+    const Fonte *fontes[] = { &fonte_painel8, &fonte_digitos16 };
+    const char *nomes_fontes[] = { "fonte_painel8", "fonte_digitos16" };
+    size_t total = 0;
+    for (int i = 0; i < 2; i++) {
+        const Fonte *f = fontes[i];
+        size_t n = ocupacao_fonte(f);
+        total += n;
+        printf("  %-18s %5zu  flash (%u glifos de %u linhas, %u faixas; páginas %u, índice %zu)\n", nomes_fontes[i], n,
+               f->num_glifos, f->altura, f->num_faixas, f->tamanho_dados,
+               f->num_faixas * sizeof(FonteFaixa) + f->num_glifos * sizeof(FonteGlifo));
+    }
+    const Imagem *icones[] = { &icone_quarto, &icone_cozinha, &icone_banheiro, &icone_alerta };
+    size_t bytes_icones = 0, brutos_icones = 0;
+    for (int i = 0; i < 4; i++) {
+        bytes_icones += ocupacao_imagem(icones[i]);
+        brutos_icones += sizeof(Imagem) + icones[i]->largura * icones[i]->paginas;
+    }
+    total += bytes_icones;
+    printf("  %-18s %5zu  flash (4 ícones 16x16; %zu sem RLE)\n", "ícones", bytes_icones, brutos_icones);
+    printf("  %-18s %5zu  flash, 0 RAM\n", "total novo", total);
+
+    printf("\nTempo por string (%ld iterações, ns no host)\n", iteracoes);
+    const Caso *referencia = NULL;      // último caso da fonte legada: base de comparação para o mesmo texto
+    double referencia_ns = 0;
+    for (int c = 0; c < TOTAL_CASOS; c++) {
+        const Caso *k = &casos[c];
+        double inicio = agora_ns();
+        for (long i = 0; i < iteracoes; i++) {
+            if (k->fonte) ssd1306_draw_text(&disp, k->fonte, k->texto, k->x, k->y);
+            else legado_draw_string(&disp, k->texto, k->x, k->y);
+        }
+        double ns = (agora_ns() - inicio) / iteracoes;
+        const char *nome = k->fonte == NULL ? "legada" : k->fonte == &fonte_painel8 ? "painel8" : "digitos16";
+        printf("  %s%*s %-9s y=%-2u %8.1f ns", k->texto, 24 - largura_utf8(k->texto), "", nome, k->y, ns);
+        if (!k->fonte) {
+            referencia = k;
+            referencia_ns = ns;
+            printf("  (referência)");
+        } else if (referencia && strcmp(referencia->texto, k->texto) == 0) {
+            printf("  (%.1fx mais rápido que a legada)", referencia_ns / ns);
+        }
+        putchar('\n');
+    }
+    double inicio = agora_ns();
+    for (long i = 0; i < iteracoes; i++) ssd1306_draw_image(&disp, &icone_banheiro, 0, 0);
+    printf("  %s%*s %-9s y=0  %8.1f ns\n", "ícone 16x16 (RLE)", 24 - largura_utf8("ícone 16x16 (RLE)"), "", "imagem", (agora_ns() - inicio) / iteracoes);
+    inicio = agora_ns();
+    for (long i = 0; i < iteracoes / 10; i++) ssd1306_fill(&disp, 0);
+    printf("  %-24s %-9s      %8.1f ns\n", "ssd1306_fill (tela)", "", (agora_ns() - inicio) / (iteracoes / 10));
+
+    if (exibir) {                       // mesma composição de atualizar_display() em main.c
+        ssd1306_fill(&disp, 0);
+        ssd1306_draw_image(&disp, &icone_banheiro, 0, 0);
+        ssd1306_draw_text(&disp, &fonte_painel8, "Banheiro", 20, 4);
+        ssd1306_draw_image(&disp, &icone_alerta, WIDTH - 16, 0);
+        ssd1306_draw_text(&disp, &fonte_digitos16, "23.5°C", (WIDTH - fonte_largura_texto(&fonte_digitos16, "23.5°C")) / 2, 20);
+        ssd1306_draw_text(&disp, &fonte_painel8, "Emergência: ON", 2, 42);
+        ssd1306_draw_text(&disp, &fonte_painel8, "192.168.100.45", 2, 54);
+        putchar('\n');
+        mostrar(&disp);
+    }
+    return 0;
+}
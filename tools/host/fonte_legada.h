@@ -1,3 +1,4 @@
+// Fonte 8x8 monoespaçada original do OLED (era lib/font.h, em RAM), mantida só como referência do fonte_bench
 static uint8_t font[] = {
 
 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //  
@@ -0,0 +1,196 @@
+// Simulação do armazenamento chave-valor (lib/kv_flash.c) com flash emulada.
+//
+// Uso: kv_sim [cortes] [semente]
+//   1) quedas de energia: interrompe apagamentos e gravações em pontos aleatórios (a operação
+//      interrompida deixa a página/setor parcialmente alterado), reinicia e verifica que cada
+//      chave voltou com um valor completo, não mais antigo que o último confirmado, e que
+//      chaves gravadas juntas continuam consistentes entre si;
+//   2) amplificação de escrita: 30 dias de mudanças de estado do painel (média de uma a cada 5 min,
+//      com rajadas), com e sem o agrupamento.
+// Retorna 1 se alguma verificação falhar.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kv_flash.h"
+#include "flash_mapa.h"
+
+#define SETORES FLASH_KV_SETORES
+#define CHAVES 10                       // chaves exercitadas
+#define PAR_A 8                         // chaves sempre gravadas juntas (ex.: SSID e senha)
+#define PAR_B 9
+#define CICLOS_APAGAMENTO 100000        // resistência típica da flash por setor
+
+static uint8_t memoria[SETORES * FLASH_SETOR];
+static uint32_t apagamentos[SETORES];
+static long operacoes_ate_corte = -1;   // < 0: sem corte programado
+static bool desligado = false;
+
+static uint32_t aleatorio(uint32_t n) {
+    return (uint32_t)rand() % n;
+}
+
+// operação interrompida: parte dos bytes muda, parte não
+static bool sim_cortar(void) {
+    if (operacoes_ate_corte < 0) return false;
+    if (operacoes_ate_corte-- > 0) return false;
+    desligado = true;
+    return true;
+}
+
+static bool sim_apagar(uint32_t deslocamento) {
+    if (desligado) return false;
+    uint8_t *s = memoria + deslocamento;
+    if (sim_cortar()) {                 // apagamento interrompido: setor com bits aleatórios
+        for (uint32_t i = 0; i < FLASH_SETOR; i++) {
+            if (aleatorio(2)) s[i] = 0xFF;
+            else s[i] |= (uint8_t)rand();
+        }
+        return false;
+    }
+    memset(s, 0xFF, FLASH_SETOR);
+    apagamentos[deslocamento / FLASH_SETOR]++;
+    return true;
+}
+
+static bool sim_gravar(uint32_t deslocamento, const uint8_t *pagina) {
+    if (desligado) return false;
+    uint32_t n = FLASH_PAGINA;
+    bool cortado = sim_cortar();
+    if (cortado) n = aleatorio(FLASH_PAGINA); // só um prefixo da página chega a ser programado
+    for (uint32_t i = 0; i < n; i++) memoria[deslocamento + i] &= pagina[i]; // NOR: bits só vão de 1 para 0
+    if (cortado && n < FLASH_PAGINA) memoria[deslocamento + n] &= pagina[n] | (uint8_t)rand(); // byte em andamento
+    return !cortado;
+}
+
+static const KvFlash flash_sim = {
+    .base = memoria, .tamanho_setor = FLASH_SETOR, .tamanho_pagina = FLASH_PAGINA, .setores = SETORES,
+    .apagar = sim_apagar, .gravar = sim_gravar,
+};
+
+// valor determinístico da geração g da chave k: [k, g (4 bytes), conteúdo...]
+static uint8_t valor_gerado(uint8_t k, uint32_t g, uint8_t *v) {
+    uint8_t n = k < 4 ? 3 : (uint8_t)(5 + (k * 7 + g * 13) % (KV_VALOR_MAX - 5)); // estado curto ou texto
+    if (n < 5) n = 5;
+    v[0] = k;
+    memcpy(v + 1, &g, 4);
+    for (uint8_t i = 5; i < n; i++) v[i] = (uint8_t)(k * 31 + g * 17 + i);
+    return n;
+}
+
+// geração guardada num valor lido (ou -1 se não bate com nenhum valor gerado)
+static long geracao_lida(uint8_t k) {
+    uint8_t v[KV_VALOR_MAX], esperado[KV_VALOR_MAX];
+    int n = kv_ler(k, v, sizeof(v));
+    if (n < 0) return 0;                // ausente = geração 0
+    if (v[0] != k) return -1;
+    if (k < 4) return n == 3 ? (long)(v[1] | (v[2] << 8)) : -1; // estado curto
+    uint32_t g;
+    if (n < 5) return -1;
+    memcpy(&g, v + 1, 4);
+    if (n != valor_gerado(k, g, esperado) || memcmp(v, esperado, (size_t)n) != 0) return -1;
+    return (long)g;
+}
+
+static void escrever(uint8_t k, uint32_t g, uint32_t agora) {
+    uint8_t v[KV_VALOR_MAX];
+    uint8_t n = valor_gerado(k, g, v);
+    if (k < 4) {                        // estado curto: 3 bytes com a geração em 16 bits
+        v[1] = (uint8_t)g;
+        v[2] = (uint8_t)(g >> 8);
+        n = 3;
+    }
+    kv_escrever(k, v, n, agora);
+}
+
+static int testar_cortes(int cortes) {
+    memset(memoria, 0xFF, sizeof(memoria));
+    kv_iniciar(&flash_sim);
+    uint32_t ultima[CHAVES] = { 0 };    // última geração escrita
+    uint32_t confirmada[CHAVES] = { 0 }; // geração garantida na flash (nada pendente desde então)
+    uint32_t agora = 0;
+    int falhas = 0, descartados = 0;
+    for (int corte = 0; corte < cortes; corte++) {
+        operacoes_ate_corte = aleatorio(60);
+        while (!desligado) {
+            agora += aleatorio(1500);
+            if (aleatorio(3) == 0) {    // mudança de estado frequente
+                uint8_t k = (uint8_t)aleatorio(4);
+                if (ultima[k] < 0xFFFF) escrever(k, ++ultima[k], agora);
+            }
+            if (aleatorio(20) == 0) {   // configuração rara, às vezes em par
+                uint8_t k = (uint8_t)(4 + aleatorio(CHAVES - 4));
+                if (k == PAR_A || k == PAR_B) {
+                    uint32_t g = (ultima[PAR_A] > ultima[PAR_B] ? ultima[PAR_A] : ultima[PAR_B]) + 1;
+                    escrever(PAR_A, ultima[PAR_A] = g, agora);
+                    escrever(PAR_B, ultima[PAR_B] = g, agora);
+                } else {
+                    escrever(k, ++ultima[k], agora);
+                }
+            }
+            kv_manter(agora);
+            if (!desligado && kv_espera(agora) == UINT32_MAX) memcpy(confirmada, ultima, sizeof(ultima));
+        }
+        // queda de energia: reinicia e verifica
+        desligado = false;
+        operacoes_ate_corte = -1;
+        kv_iniciar(&flash_sim);
+        descartados += (int)kv_estatisticas()->descartados;
+        for (uint8_t k = 0; k < CHAVES; k++) {
+            long g = geracao_lida(k);
+            if (g < 0 || (uint32_t)g < confirmada[k] || (uint32_t)g > ultima[k]) {
+                printf("  falha no corte %d: chave %u voltou com geração %ld (confirmada %u, última %u)\n",
+                       corte, k, g, confirmada[k], ultima[k]);
+                falhas++;
+            } else {
+                ultima[k] = confirmada[k] = (uint32_t)g; // o que não voltou foi perdido antes de confirmar
+            }
+        }
+        if (geracao_lida(PAR_A) != geracao_lida(PAR_B)) {
+            printf("  falha no corte %d: par gravado junto voltou inconsistente\n", corte);
+            falhas++;
+        }
+    }
+    printf("Quedas de energia: %d cortes, %d lotes interrompidos descartados, %d falhas\n", cortes, descartados, falhas);
+    return falhas;
+}
+
+// 30 dias com o estado do painel mudando em média a cada 'intervalo_medio' s (um terço em rajadas)
+static void medir_amplificacao(bool agrupar, uint32_t intervalo_medio) {
+    memset(memoria, 0xFF, sizeof(memoria));
+    memset(apagamentos, 0, sizeof(apagamentos));
+    kv_iniciar(&flash_sim);
+    uint32_t agora = 0, g = 0, proxima_mudanca = 0;
+    const uint32_t fim = 30u * 24 * 3600 * 1000;
+    while (agora < fim) {
+        if (agora >= proxima_mudanca) { // mudança de estado; às vezes em rajada (ex.: botão apertado várias vezes)
+            escrever((uint8_t)aleatorio(4), ++g & 0xFFFF, agora);
+            proxima_mudanca = agora + (aleatorio(3) == 0 ? 100 + aleatorio(400) : 1 + aleatorio(2 * intervalo_medio * 1000));
+            if (!agrupar) kv_sincronizar(agora);
+        }
+        kv_manter(agora);
+        uint32_t espera = kv_espera(agora); // o loop do painel dorme até o próximo prazo
+        if (espera == 0) espera = 1;        // um passo de gravação por volta do loop
+        agora += espera < proxima_mudanca - agora ? espera : proxima_mudanca - agora;
+    }
+    kv_sincronizar(agora);
+    const KvEstatisticas *e = kv_estatisticas();
+    uint32_t max_apagamentos = 0;
+    for (int i = 0; i < SETORES; i++) if (apagamentos[i] > max_apagamentos) max_apagamentos = apagamentos[i];
+    double gravados = (double)e->paginas_gravadas * FLASH_PAGINA;
+    printf("%-14s %8u B pedidos, %6u lotes, %7u páginas, WA %.1fx (lotes %.1fx), apagamentos/setor %u..%u, vida ~%.0f anos\n",
+           agrupar ? "com agrupamento" : "sem agrupamento", e->bytes_pedidos, e->lotes, e->paginas_gravadas,
+           gravados / e->bytes_pedidos, (double)e->bytes_lotes / e->bytes_pedidos,
+           apagamentos[SETORES - 1], max_apagamentos,
+           max_apagamentos ? CICLOS_APAGAMENTO / (max_apagamentos * 12.0) : 0.0);
+}
+
+int main(int argc, char **argv) {
+    int cortes = argc > 1 ? atoi(argv[1]) : 2000;
+    srand(argc > 2 ? (unsigned)atoi(argv[2]) : 1);
+    int falhas = testar_cortes(cortes);
+    printf("Amplificação de escrita (30 dias, estado de 3 bytes):\n");
+    medir_amplificacao(true, 300);
+    medir_amplificacao(false, 300);
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,155 @@
+#include <string.h>
+#include "oled_mock.h"
+
+#define RAM_COLUNAS 132                 // SH1106; o SSD1306 usa as 128 primeiras
+#define RAM_PAGINAS 8
+#define SH1106_COL_OFFSET 2
+
+struct i2c_inst { int numero; };
+static struct i2c_inst i2c_instancias[2] = { { 0 }, { 1 } };
+i2c_inst_t *const i2c0 = &i2c_instancias[0];
+i2c_inst_t *const i2c1 = &i2c_instancias[1];
+struct spi_inst { int numero; };
+static struct spi_inst spi_instancias[2] = { { 0 }, { 1 } };
+spi_inst_t *const spi0 = &spi_instancias[0];
+spi_inst_t *const spi1 = &spi_instancias[1];
+
+static struct {
+    MockControlador tipo;
+    uint32_t i2c_hz, spi_hz;
+    uint8_t ram[RAM_PAGINAS][RAM_COLUNAS];
+    uint8_t modo;                       // SSD1306: 0 horizontal, 1 vertical, 2 página
+    uint8_t coluna_inicio, coluna_fim, pagina_inicio, pagina_fim;
+    uint8_t coluna, pagina;
+    uint8_t comando, faltam, recebidos, argumentos[2];
+    bool gpio[32];
+    MockBarramento barramento;
+} mock;
+
+void mock_oled_reiniciar(MockControlador controlador, uint32_t i2c_hz, uint32_t spi_hz) {
+    memset(&mock, 0, sizeof(mock));
+    mock.tipo = controlador;
+    mock.i2c_hz = i2c_hz;
+    mock.spi_hz = spi_hz;
+    mock.modo = 2;                      // padrão dos dois controladores após o reset
+    mock.coluna_fim = 127;
+    mock.pagina_fim = RAM_PAGINAS - 1;
+}
+
+void mock_oled_zerar_contadores(void) {
+    memset(&mock.barramento, 0, sizeof(mock.barramento));
+}
+
+const MockBarramento *mock_oled_barramento(void) {
+    return &mock.barramento;
+}
+
+bool mock_oled_confere(const ssd1306_t *ssd) {
+    uint8_t deslocamento = mock.tipo == MOCK_SH1106 ? SH1106_COL_OFFSET : 0;
+    for (uint8_t p = 0; p < ssd->pages; p++) {
+        if (memcmp(&mock.ram[p][deslocamento], &ssd->ram_buffer[1 + p * ssd->width], ssd->width) != 0) return false;
+    }
+    return true;
+}
+
+static void aplicar(uint8_t comando, const uint8_t *a) {
+    switch (comando) {
+        case 0x20: mock.modo = a[0] & 0x03; break;
+        case 0x21:
+            mock.coluna_inicio = mock.coluna = a[0] & 0x7F;
+            mock.coluna_fim = a[1] & 0x7F;
+            break;
+        case 0x22:
+            mock.pagina_inicio = mock.pagina = a[0] & 0x07;
+            mock.pagina_fim = a[1] & 0x07;
+            break;
+        default: break;
+    }
+}
+
+static void comando(uint8_t b) {
+    if (mock.faltam) {
+        mock.argumentos[mock.recebidos++] = b;
+        if (--mock.faltam == 0) aplicar(mock.comando, mock.argumentos);
+        return;
+    }
+    if (b <= 0x0F) {                    // modo página: nibble baixo da coluna
+        mock.coluna = (mock.coluna & 0xF0) | b;
+        return;
+    }
+    if (b >= 0x10 && b <= 0x1F) {       // nibble alto
+        mock.coluna = (uint8_t)((b & 0x0F) << 4 | (mock.coluna & 0x0F));
+        return;
+    }
+    if (b >= 0xB0 && b <= 0xB7) {
+        mock.pagina = b & 0x07;
+        return;
+    }
+    bool ssd1306 = mock.tipo == MOCK_SSD1306;
+    switch (b) {
+        case 0x21: case 0x22: mock.faltam = ssd1306 ? 2 : 0; break; // sem janela no SH1106
+        case 0x20: case 0x8D: mock.faltam = ssd1306 ? 1 : 0; break;
+        case 0xAD: mock.faltam = ssd1306 ? 0 : 1; break;
+        case 0x81: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB: mock.faltam = 1; break;
+        default: return;
+    }
+    mock.comando = b;
+    mock.recebidos = 0;
+}
+
+static void dado(uint8_t b) {
+    if (mock.tipo == MOCK_SH1106) {     // só modo página: a coluna para no fim da RAM
+        if (mock.coluna < RAM_COLUNAS) mock.ram[mock.pagina][mock.coluna++] = b;
+        return;
+    }
+    mock.ram[mock.pagina][mock.coluna] = b;
+    if (mock.modo == 1) {
+        if (mock.pagina++ >= mock.pagina_fim) {
+            mock.pagina = mock.pagina_inicio;
+            if (mock.coluna++ >= mock.coluna_fim) mock.coluna = mock.coluna_inicio;
+        }
+    } else if (mock.modo == 2) {
+        if (mock.coluna < 127) mock.coluna++;
+    } else if (mock.coluna++ >= mock.coluna_fim) {
+        mock.coluna = mock.coluna_inicio;
+        if (mock.pagina++ >= mock.pagina_fim) mock.pagina = mock.pagina_inicio;
+    }
+}
+
+// I2C: endereço + bytes, 9 bits cada, mais início e fim (~1 bit)
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t endereco, const uint8_t *dados, size_t n, bool sem_stop) {
+    (void)i2c; (void)endereco; (void)sem_stop;
+    mock.barramento.transacoes++;
+    mock.barramento.bytes += n;
+    mock.barramento.us += ((n + 1) * 9 + 1) * 1e6 / mock.i2c_hz;
+    for (size_t i = 0; i < n;) {        // byte de controle: Co (bit 7) = só o próximo byte; D/C (bit 6) = dados
+        uint8_t controle = dados[i++];
+        size_t fim = controle & 0x80 ? (i < n ? i + 1 : i) : n;
+        for (; i < fim; i++) {
+            if (controle & 0x40) dado(dados[i]);
+            else comando(dados[i]);
+        }
+    }
+    return (int)n;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *dados, size_t n) {
+    (void)spi;
+    mock.barramento.bytes += n;
+    mock.barramento.us += n * 8 * 1e6 / mock.spi_hz;
+    if (mock.gpio[MOCK_PINO_CS]) return (int)n; // controlador não selecionado
+    for (size_t i = 0; i < n; i++) {
+        if (mock.gpio[MOCK_PINO_DC]) dado(dados[i]);
+        else comando(dados[i]);
+    }
+    return (int)n;
+}
+
+void gpio_init(uint gpio) { mock.gpio[gpio & 31] = false; }
+
+void gpio_set_dir(uint gpio, bool saida) { (void)gpio; (void)saida; }
+
+void gpio_put(uint gpio, bool valor) {
+    if (gpio == MOCK_PINO_CS && !valor && mock.gpio[MOCK_PINO_CS]) mock.barramento.transacoes++; // descida do CS
+    mock.gpio[gpio & 31] = valor;
+}
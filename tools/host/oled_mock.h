@@ -0,0 +1,33 @@
+// Transportes simulados dos benchmarks do OLED (fonte_bench, display_bench)
+//
+// i2c_write_blocking, spi_write_blocking e os GPIOs de CS/D/C são implementados aqui: os bytes
+// vão para um controlador emulado (SSD1306 com endereçamento horizontal/vertical/página, ou SH1106
+// com RAM de 132 colunas em modo página) e cada transação é contada para estimar o tempo no barramento.
+
+#ifndef OLED_MOCK_H
+#define OLED_MOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ssd1306.h"
+
+#define MOCK_PINO_CS 17                 // pinos a passar para ssd1306_init_spi
+#define MOCK_PINO_DC 16
+
+typedef enum { MOCK_SSD1306, MOCK_SH1106 } MockControlador;
+
+typedef struct {
+    unsigned long transacoes;           // transações I2C (endereço + bytes) ou janelas de CS no SPI
+    unsigned long bytes;                // bytes no barramento, sem o endereço I2C
+    double us;                          // tempo estimado no barramento
+} MockBarramento;
+
+// Apaga a RAM emulada e os contadores; i2c_hz/spi_hz são as taxas do barramento no modelo de tempo
+void mock_oled_reiniciar(MockControlador controlador, uint32_t i2c_hz, uint32_t spi_hz);
+void mock_oled_zerar_contadores(void);
+const MockBarramento *mock_oled_barramento(void);
+
+// true se a parte visível da RAM emulada é igual ao framebuffer
+bool mock_oled_confere(const ssd1306_t *ssd);
+
+#endif
@@ -0,0 +1,355 @@
+// Simulação da atualização A/B (lib/ota.c) com flash emulada.
+//
+// Uso: ota_sim [cortes] [semente]
+//   1) SHA-256 contra os vetores do FIPS 180-4;
+//   2) recepção em blocos de tamanho aleatório com repetições e lacunas, verificação, troca pelo
+//      estágio de boot, confirmação; imagem corrompida; reversão por reinícios e por prazo sem
+//      confirmação;
+//   3) quedas de energia em pontos aleatórios da recepção e da gravação dos metadados: o
+//      firmware em A nunca pode mudar sem uma troca completa; quedas em cada operação da rotação
+//      dos dois setores de metadados (inclusive logo após apagar): o registro em teste ou
+//      revertido nunca se perde;
+//   4) quedas de energia no setor k da troca (atualização e reversão): o boot seguinte termina a
+//      troca de onde parou e A e B ficam com as duas imagens inteiras;
+//   5) vazão estimada no RP2040 (tempos típicos da flash W25Q16 + ida e volta pelo broker) e RAM.
+// Cada "boot" roda ota_retomar() antes de ota_iniciar(), como o estágio de boot no RP2040.
+// Retorna 1 se alguma verificação falhar.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ota.h"
+#include "flash_mapa.h"
+
+#define APAGAR_MS   45.0                // apagamento típico de um setor de 4 KB
+#define GRAVAR_MS   0.4                 // programação típica de uma página de 256 bytes
+
+static uint8_t memoria[PICO_FLASH_SIZE_BYTES];
+static long operacoes_ate_corte = -1;   // < 0: sem corte programado
+static bool desligado = false;
+static bool reiniciou = false;          // reiniciar() foi chamada (troca registrada)
+static uint32_t apagamentos, paginas;
+static int falhas = 0;
+
+static uint32_t aleatorio(uint32_t n) {
+    return (uint32_t)rand() % n;
+}
+
+static bool sim_cortar(void) {
+    if (operacoes_ate_corte < 0) return false;
+    if (operacoes_ate_corte-- > 0) return false;
+    desligado = true;
+    return true;
+}
+
+static const uint8_t *sim_mapa(uint32_t deslocamento) {
+    return memoria + deslocamento;
+}
+
+static bool sim_apagar(uint32_t deslocamento) {
+    if (desligado) return false;
+    if (sim_cortar()) {                 // apagamento interrompido: setor com bits aleatórios
+        for (uint32_t i = 0; i < FLASH_SETOR; i++) memoria[deslocamento + i] |= (uint8_t)rand();
+        return false;
+    }
+    memset(memoria + deslocamento, 0xFF, FLASH_SETOR);
+    apagamentos++;
+    return true;
+}
+
+static bool sim_gravar(uint32_t deslocamento, const uint8_t *dados, size_t n) {
+    if (desligado) return false;
+    size_t gravar = n;
+    bool cortado = sim_cortar();
+    if (cortado) gravar = aleatorio((uint32_t)n); // só um prefixo chega a ser programado
+    for (size_t i = 0; i < gravar; i++) memoria[deslocamento + i] &= dados[i]; // NOR: bits só vão de 1 para 0
+    paginas += (uint32_t)(gravar / FLASH_PAGINA);
+    return !cortado;
+}
+
+static void sim_reiniciar(void) {
+    reiniciou = true;                   // o chamador segue; o teste "liga" o painel de novo
+}
+
+static const OtaFlash flash = {
+    .slot_a = FLASH_SLOT_A, .slot_b = FLASH_SLOT_B, .tamanho_slot = FLASH_OTA_SLOT,
+    .meta = FLASH_OTA_META, .rascunho = FLASH_OTA_RASCUNHO, .tamanho_setor = FLASH_SETOR, .tamanho_pagina = FLASH_PAGINA,
+    .mapa = sim_mapa, .apagar = sim_apagar, .gravar = sim_gravar, .reiniciar = sim_reiniciar,
+};
+
+static void verificar(bool condicao, const char *descricao) {
+    if (!condicao) {
+        printf("FALHA: %s\n", descricao);
+        falhas++;
+    }
+}
+
+static void gerar_imagem(uint8_t *img, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) img[i] = (uint8_t)rand();
+}
+
+static void resumir(const uint8_t *img, uint32_t n, uint8_t saida[SHA256_TAMANHO]) {
+    Sha256 ctx;
+    sha256_iniciar(&ctx);
+    sha256_atualizar(&ctx, img, n);
+    sha256_finalizar(&ctx, saida);
+}
+
+// "liga" o painel: reinicia a flash simulada após um corte, passa pelo estágio de boot (troca
+// pendente) e lê os metadados; corte >= 0 desliga de novo na operação de flash de número 'corte'
+// feita durante o boot. OTA_TROCANDO: o corte parou o estágio de boot no meio da troca
+static OtaEstado ligar_com_corte(uint32_t tamanho_atual, uint32_t agora, long corte) {
+    desligado = false;
+    operacoes_ate_corte = corte;
+    reiniciou = false;
+    if (!ota_retomar(&flash)) return OTA_TROCANDO;
+    OtaEstado estado = ota_iniciar(&flash, tamanho_atual, agora);
+    operacoes_ate_corte = -1;           // um corte além das operações do boot não fica armado
+    return estado;
+}
+
+static OtaEstado ligar(uint32_t tamanho_atual, uint32_t agora) {
+    return ligar_com_corte(tamanho_atual, agora, -1);
+}
+
+// ocupa as páginas livres dos setores de metadados em uso com lixo (registro inválido): o próximo
+// registro força a rotação, e o outro setor precisa ser apagado antes de recebê-lo
+static void encher_meta(void) {
+    for (uint32_t s = 0; s < 2; s++) {
+        uint8_t *setor = memoria + FLASH_OTA_META + s * FLASH_SETOR;
+        for (uint32_t p = 0; p < FLASH_SETOR; p += FLASH_PAGINA) {
+            bool apagada = true;
+            for (uint32_t i = 0; i < FLASH_PAGINA && apagada; i++) apagada = setor[p + i] == 0xFF;
+            if (apagada) memset(setor + p, 0, FLASH_PAGINA);
+        }
+    }
+}
+
+// envia a imagem como o remetente faria: blocos de tamanho variável, repetições e lacunas
+// ocasionais, sempre retomando do deslocamento confirmado. Retorna false se a recepção falhou.
+static bool enviar(const uint8_t *img, uint32_t n, const uint8_t sha[SHA256_TAMANHO], uint32_t agora, uint32_t *blocos) {
+    if (!ota_comecar(n, sha, agora)) return false;
+    uint32_t confirmado = 0;
+    *blocos = 0;
+    while (confirmado < n) {
+        uint32_t desloc = confirmado;
+        uint32_t sorteio = aleatorio(100);
+        if (sorteio < 3 && confirmado > 0) desloc = confirmado - aleatorio(confirmado < 512 ? confirmado : 512); // repetido
+        else if (sorteio < 5) desloc = confirmado + 1 + aleatorio(256); // perdido: chega o seguinte
+        uint32_t tam = 1 + aleatorio(OTA_BLOCO_MAX);
+        if (desloc >= n) desloc = confirmado;
+        if (desloc + tam > n) tam = n - desloc;
+        int32_t proximo = ota_bloco(desloc, img + desloc, tam);
+        (*blocos)++;
+        if (proximo < 0) return false;
+        confirmado = (uint32_t)proximo;
+    }
+    return ota_concluir(agora);
+}
+
+static void testar_sha256(void) {
+    static const struct { const char *texto; const char *resumo; } vetores[] = {
+        { "abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+        { "", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+        { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+          "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+    };
+    for (size_t v = 0; v < sizeof(vetores) / sizeof(vetores[0]); v++) {
+        uint8_t r[SHA256_TAMANHO];
+        char hex[2 * SHA256_TAMANHO + 1];
+        resumir((const uint8_t *)vetores[v].texto, (uint32_t)strlen(vetores[v].texto), r);
+        for (int i = 0; i < SHA256_TAMANHO; i++) sprintf(hex + 2 * i, "%02x", r[i]);
+        verificar(strcmp(hex, vetores[v].resumo) == 0, "SHA-256 difere do vetor de teste");
+    }
+    uint8_t grande[100000], r1[SHA256_TAMANHO], r2[SHA256_TAMANHO];
+    gerar_imagem(grande, sizeof(grande));
+    resumir(grande, sizeof(grande), r1);
+    Sha256 ctx;                         // em pedaços de tamanho aleatório: mesmo resultado
+    sha256_iniciar(&ctx);
+    for (uint32_t i = 0; i < sizeof(grande);) {
+        uint32_t n = 1 + aleatorio(200);
+        if (i + n > sizeof(grande)) n = sizeof(grande) - i;
+        sha256_atualizar(&ctx, grande + i, n);
+        i += n;
+    }
+    sha256_finalizar(&ctx, r2);
+    verificar(memcmp(r1, r2, SHA256_TAMANHO) == 0, "SHA-256 incremental difere do contínuo");
+}
+
+int main(int argc, char **argv) {
+    int cortes = argc > 1 ? atoi(argv[1]) : 500;
+    srand(argc > 2 ? (unsigned)atoi(argv[2]) : 1);
+    testar_sha256();
+
+    static uint8_t antiga[400 * 1024], nova[620 * 1024 + 123], sha_nova[SHA256_TAMANHO];
+    gerar_imagem(antiga, sizeof(antiga));
+    gerar_imagem(nova, sizeof(nova));
+    resumir(nova, sizeof(nova), sha_nova);
+    uint32_t blocos;
+
+    // atualização completa com confirmação
+    memset(memoria, 0xFF, sizeof(memoria));
+    memcpy(memoria + FLASH_SLOT_A, antiga, sizeof(antiga));
+    verificar(ligar(sizeof(antiga), 0) == OTA_INATIVA, "flash vazia deveria estar inativa");
+    verificar(enviar(nova, sizeof(nova), sha_nova, 0, &blocos), "recepção falhou");
+    ota_manter(OTA_ATRASO_TROCA_MS - 1);
+    verificar(!reiniciou, "troca antes do atraso");
+    ota_manter(OTA_ATRASO_TROCA_MS);
+    verificar(reiniciou, "troca não registrada");
+    verificar(ligar(sizeof(nova), 0) == OTA_EM_TESTE, "imagem nova deveria estar em teste");
+    verificar(memcmp(memoria + FLASH_SLOT_A, nova, sizeof(nova)) == 0, "slot A não contém a imagem nova");
+    verificar(memcmp(memoria + FLASH_SLOT_B, antiga, sizeof(antiga)) == 0, "slot B não guardou a imagem anterior");
+    uint8_t sha_errado[SHA256_TAMANHO] = { 0 };
+    verificar(!ota_comecar(sizeof(nova), sha_errado, 0), "aceitou nova recepção antes da confirmação");
+    verificar(ota_confirmar(), "confirmação falhou");
+    verificar(ligar(sizeof(nova), 0) == OTA_INATIVA, "após confirmar deveria estar inativa");
+    verificar(memcmp(memoria + FLASH_SLOT_A, nova, sizeof(nova)) == 0, "imagem confirmada mudou");
+    const OtaEstatisticas *est = ota_estatisticas();
+    uint32_t setores = est->setores;
+
+    // imagem corrompida no caminho (SHA-256 confere com a original): rejeitada sem troca
+    static uint8_t corrompida[sizeof(antiga)];
+    memcpy(corrompida, antiga, sizeof(antiga));
+    corrompida[12345] ^= 0x10;
+    uint8_t sha_antiga[SHA256_TAMANHO];
+    resumir(antiga, sizeof(antiga), sha_antiga);
+    verificar(!enviar(corrompida, sizeof(corrompida), sha_antiga, 0, &blocos), "imagem corrompida aceita");
+    ota_manter(10 * OTA_ATRASO_TROCA_MS);
+    verificar(!reiniciou, "troca com imagem corrompida");
+
+    // imagem que não confirma: reverte após OTA_TENTATIVAS_MAX reinícios
+    verificar(enviar(antiga, sizeof(antiga), sha_antiga, 0, &blocos), "recepção da imagem antiga falhou");
+    ota_manter(OTA_ATRASO_TROCA_MS);
+    OtaEstado estado = ligar(sizeof(antiga), 0);
+    int reinicios = 1;
+    verificar(memcmp(memoria + FLASH_SLOT_A, antiga, sizeof(antiga)) == 0, "troca para a antiga falhou");
+    while (estado == OTA_EM_TESTE && reinicios < 10) {
+        estado = ligar(sizeof(antiga), 0);
+        reinicios++;
+    }
+    verificar(estado == OTA_REVERTIDA && reinicios == OTA_TENTATIVAS_MAX + 1, "não reverteu após as tentativas");
+    verificar(ligar(sizeof(nova), 0) == OTA_REVERTIDA, "reversão não informada no reinício");
+    verificar(memcmp(memoria + FLASH_SLOT_A, nova, sizeof(nova)) == 0, "reversão não restaurou a imagem confirmada");
+    verificar(ligar(sizeof(nova), 0) == OTA_INATIVA, "reversão informada mais de uma vez");
+
+    // imagem que roda mas não confirma dentro do prazo
+    verificar(enviar(antiga, sizeof(antiga), sha_antiga, 0, &blocos), "segunda recepção falhou");
+    ota_manter(OTA_ATRASO_TROCA_MS);
+    verificar(ligar(sizeof(antiga), 5000) == OTA_EM_TESTE, "segunda imagem deveria estar em teste");
+    ota_manter(5000 + OTA_PRAZO_CONFIRMACAO_MS - 1);
+    verificar(!reiniciou, "reverteu antes do prazo");
+    ota_manter(5000 + OTA_PRAZO_CONFIRMACAO_MS);
+    verificar(reiniciou, "não reverteu no prazo");
+    verificar(ligar(sizeof(nova), 0) == OTA_REVERTIDA && memcmp(memoria + FLASH_SLOT_A, nova, sizeof(nova)) == 0,
+              "reversão no prazo não restaurou a imagem confirmada");
+
+    // quedas de energia na recepção, na gravação dos metadados e nos reinícios em teste
+    int trocas = 0;
+    for (int c = 0; c < cortes; c++) {
+        bool nova_em_a = memcmp(memoria + FLASH_SLOT_A, nova, sizeof(nova)) == 0;
+        const uint8_t *outra = nova_em_a ? antiga : nova;
+        uint32_t n_outra = nova_em_a ? sizeof(antiga) : sizeof(nova);
+        uint8_t sha_outra[SHA256_TAMANHO];
+        resumir(outra, n_outra, sha_outra);
+        operacoes_ate_corte = aleatorio(340); // a imagem maior usa ~310 operações
+        bool ok = enviar(outra, n_outra, sha_outra, 0, &blocos);
+        if (ok) ota_manter(OTA_ATRASO_TROCA_MS);
+        bool registrou = reiniciou;     // um registro que ficou inteiro apesar do corte também troca
+        estado = ligar(nova_em_a ? sizeof(nova) : sizeof(antiga), 0);
+        bool trocou = memcmp(memoria + FLASH_SLOT_A, outra, n_outra) == 0;
+        verificar(trocou || !registrou, "troca incompleta após corte");
+        if (trocou) {
+            trocas++;
+            operacoes_ate_corte = aleatorio(3); // corte durante o registro de tentativas ou a confirmação
+            if (estado == OTA_EM_TESTE) ota_confirmar();
+            estado = ligar(n_outra, 0);
+            if (estado == OTA_EM_TESTE) verificar(ota_confirmar(), "confirmação após corte falhou");
+            verificar(memcmp(memoria + FLASH_SLOT_A, outra, n_outra) == 0, "imagem mudou sem troca");
+        } else {
+            verificar(estado != OTA_EM_TESTE, "em teste sem troca");
+            verificar(memcmp(memoria + FLASH_SLOT_A, nova_em_a ? nova : antiga, nova_em_a ? sizeof(nova) : sizeof(antiga)) == 0,
+                      "slot A alterado por recepção interrompida");
+        }
+    }
+    printf("Quedas de energia: %d cortes, %d chegaram à troca, %d falhas\n", cortes, trocas, falhas);
+
+    // quedas na rotação dos setores de metadados (apagar o outro, gravar nele, apagar o cheio e
+    // depois disso): o registro em teste e o progresso de uma reversão em andamento sobrevivem
+    int falhas_antes = falhas;
+    for (long corte = 0; corte < 4; corte++) {
+        bool nova_em_a = memcmp(memoria + FLASH_SLOT_A, nova, sizeof(nova)) == 0;
+        const uint8_t *outra = nova_em_a ? antiga : nova;
+        uint32_t n_outra = nova_em_a ? sizeof(antiga) : sizeof(nova);
+        uint32_t n_atual = nova_em_a ? sizeof(nova) : sizeof(antiga);
+        uint8_t sha_outra[SHA256_TAMANHO];
+        resumir(outra, n_outra, sha_outra);
+        verificar(enviar(outra, n_outra, sha_outra, 0, &blocos), "recepção antes da rotação falhou");
+        ota_manter(OTA_ATRASO_TROCA_MS);
+        ligar(n_outra, 0);              // troca e primeira tentativa
+        encher_meta();
+        ligar_com_corte(n_outra, 0, corte); // segunda tentativa: o registro vai para o outro setor
+        verificar(ligar(n_outra, 0) == OTA_EM_TESTE, "registro em teste perdido na rotação");
+        verificar(memcmp(memoria + FLASH_SLOT_A, outra, n_outra) == 0, "imagem em teste mudou na rotação");
+        estado = OTA_EM_TESTE;
+        for (int r = 0; estado == OTA_EM_TESTE && r < 10; r++) estado = ligar(n_outra, 0); // esgota as tentativas
+        verificar(estado == OTA_REVERTIDA, "não reverteu antes da rotação");
+        encher_meta();                  // o registro após a primeira etapa da reversão (2 operações) roda
+        verificar(ligar_com_corte(n_outra, 0, 2 + corte) == OTA_TROCANDO, "reversão não interrompida na rotação");
+        verificar(ligar(n_atual, 0) == OTA_REVERTIDA, "reversão perdida na rotação");
+        verificar(ligar(n_atual, 0) == OTA_INATIVA, "revertido informado sem fim");
+        verificar(memcmp(memoria + FLASH_SLOT_A, nova_em_a ? nova : antiga, n_atual) == 0, "reversão incompleta após a rotação");
+    }
+    printf("Quedas na rotação dos metadados: %d falhas\n", falhas - falhas_antes);
+
+    // quedas em qualquer setor da troca (no estágio de boot), às vezes de novo na retomada: o boot
+    // seguinte continua de onde parou; metade das rodadas repete o teste na reversão
+    falhas_antes = falhas;
+    int retomadas = 0;
+    for (int c = 0; c < cortes / 10; c++) {
+        bool nova_em_a = memcmp(memoria + FLASH_SLOT_A, nova, sizeof(nova)) == 0;
+        const uint8_t *atual = nova_em_a ? nova : antiga;
+        const uint8_t *outra = nova_em_a ? antiga : nova;
+        uint32_t n_atual = nova_em_a ? sizeof(nova) : sizeof(antiga);
+        uint32_t n_outra = nova_em_a ? sizeof(antiga) : sizeof(nova);
+        uint32_t setores_troca = (sizeof(nova) + FLASH_SETOR - 1) / FLASH_SETOR; // a maior das duas
+        uint8_t sha_outra[SHA256_TAMANHO];
+        resumir(outra, n_outra, sha_outra);
+        verificar(enviar(outra, n_outra, sha_outra, 0, &blocos), "recepção antes da troca falhou");
+        ota_manter(OTA_ATRASO_TROCA_MS);
+        // ~9 operações por setor: 3 etapas de apagar + gravar, cada uma com seu registro
+        estado = ligar_com_corte(n_outra, 0, (long)aleatorio(setores_troca) * 9 + aleatorio(9));
+        if (estado == OTA_TROCANDO && aleatorio(2)) estado = ligar_com_corte(n_outra, 0, aleatorio(setores_troca * 9));
+        retomadas += estado == OTA_TROCANDO;
+        if (desligado) estado = ligar(n_outra, 0); // o corte pode cair já depois da troca, no boot do firmware
+        verificar(estado == OTA_EM_TESTE, "troca retomada não chegou ao teste");
+        verificar(memcmp(memoria + FLASH_SLOT_A, outra, n_outra) == 0, "slot A incompleto após a troca retomada");
+        verificar(memcmp(memoria + FLASH_SLOT_B, atual, n_atual) == 0, "slot B incompleto após a troca retomada");
+        if (c % 2 == 0) {
+            verificar(ota_confirmar(), "confirmação após a troca retomada falhou");
+            continue;
+        }
+        for (int r = 0; estado == OTA_EM_TESTE && r < 10; r++) estado = ligar(n_outra, 0); // esgota as tentativas
+        estado = ligar_com_corte(n_atual, 0, (long)aleatorio(setores_troca) * 9 + aleatorio(9));
+        retomadas += estado == OTA_TROCANDO;
+        if (desligado) estado = ligar(n_atual, 0);
+        verificar(estado == OTA_REVERTIDA, "reversão retomada não foi informada");
+        verificar(memcmp(memoria + FLASH_SLOT_A, atual, n_atual) == 0, "slot A incompleto após a reversão retomada");
+        ligar(n_atual, 0);
+    }
+    printf("Quedas na troca: %d trocas, %d retomadas no boot seguinte, %d falhas\n", cortes / 10, retomadas,
+           falhas - falhas_antes);
+
+    // vazão estimada: envio com confirmação bloco a bloco + tempo de flash
+    double flash_ms = setores * (APAGAR_MS + (FLASH_SETOR / FLASH_PAGINA) * GRAVAR_MS);
+    uint32_t n_blocos = (sizeof(nova) + OTA_BLOCO_MAX - 1) / OTA_BLOCO_MAX;
+    printf("Imagem de %zu KB: %u setores gravados, %.1f s só de flash (%.1f KB/s)\n", sizeof(nova) / 1024,
+           setores, flash_ms / 1000, sizeof(nova) / 1024.0 / (flash_ms / 1000));
+    const double rtts[] = { 2, 8, 20 };
+    for (size_t i = 0; i < sizeof(rtts) / sizeof(rtts[0]); i++) {
+        double total_ms = flash_ms + n_blocos * rtts[i];
+        printf("  ida e volta pelo broker de %4.0f ms por bloco de %d bytes: %.1f KB/s\n", rtts[i],
+               OTA_BLOCO_MAX, sizeof(nova) / 1024.0 / (total_ms / 1000));
+    }
+    printf("RAM da atualização: %u bytes (setor em montagem, também usado na troca, + SHA-256)\n", est->ram);
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,726 @@
+// Simulador do painel no host: roda o main.c do firmware sobre o SDK simulado (tools/host/sim),
+// com relógio virtual, alimentado por um traço de entradas gravado ou escrito à mão.
+// Grava cada publicação MQTT, quadro da matriz WS2812, quadro do OLED e mudança do LED RGB com o
+// instante virtual e mede a latência de cada entrada até a primeira mudança de cada saída.
+// Mesma entrada e mesmo firmware: mesma saída, byte a byte (nenhum relógio real é consultado).
+// Com --broker o firmware roda em tempo real contra um broker MQTT de verdade (carga e soak com
+// tools/mqtt_carga.py, como se fosse a placa); o traço passa a ser opcional.
+//
+// Uso: painel_sim <traço> [--saida arquivo] [--quadros dir] [--terminal] [--log] [--cauda ms]
+//      painel_sim --broker host[:porta] [traço] [--duracao s] [...]
+//   --saida     linha do tempo das entradas e saídas (para comparar versões com diff)
+//   --quadros   grava cada quadro novo: matriz_<us>.ppm (5x5 ampliada) e oled_<us>.pbm (128x64)
+//   --terminal  desenha cada quadro novo no terminal (cores ANSI e meios-blocos)
+//   --log       formata o log binário do firmware na saída de erro (como com o USB conectado)
+//   --cauda     tempo simulado após a última entrada (padrão 3000 ms)
+//   --broker    modo ao vivo: relógio de parede e broker real (Ctrl-C encerra e imprime o relatório)
+//   --duracao   ao vivo: encerra após s segundos (sem traço, o padrão é rodar até o Ctrl-C)
+//   --id        ID único da flash em hexadecimal (vários painéis no mesmo broker: nós casa/<ID>)
+//   --config    nome=valor gravado na flash antes do boot, como por <prefixo>/config (repetível)
+//
+// Traço: uma entrada por linha, '#' no início comenta
+//   <ms> botao A|B|J 1|0          pressiona (1) ou solta (0) o botão A, B ou do joystick
+//   <ms> mqtt <tópico> [payload]  mensagem do broker (o resto da linha; "\n" vira quebra de linha);
+//                                 "~/" no início do tópico é o prefixo do nó ("~/comando/cor")
+//   <ms> temperatura <°C>         sensor interno (canal 4 do ADC)
+//   <ms> adc <0-2> <volts>        entradas analógicas externas (0: eixo Y e 1: eixo X do joystick, 1,65 V no centro)
+//   <ms> http <comando> <valor>   como /comando.cgi?<comando>=<valor>
+//   <ms> udp <comando> <valor>    lote UDP de um comando
+//   <ms> broker 0|1               queda e volta do broker
+//   <ms> fim                      encerra a simulação (senão: última entrada + cauda)
+// Os tempos contam da primeira volta do loop principal (boot concluído; o broker aceita a
+// conexão SIM_BROKER_RTT_US depois). Também aceita o que mosquitto_sub grava com
+// -F '%U %t %p' (segundos desde 1970 e tópico sem a palavra mqtt): o traço é deslocado para
+// começar em 1 s.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <unistd.h>
+#include "sim.h"
+#include "painel.h"
+#include "config_painel.h"
+#include "alarme.h"
+#include "fila_mqtt.h"
+#include "kv_flash.h"
+#include "flash_mapa.h"
+#include "flash_pico.h"
+
+#define PINO_BOTAO_A   5                // pinos de main.c
+#define PINO_BOTAO_B   6
+#define PINO_JOYSTICK  22
+#define PINO_LED_G     11
+#define PINO_LED_B     12
+#define PINO_LED_R     13
+#define PINO_BUZZER    10
+#define INICIO_GRAVADO_US 1000000       // traço do mosquitto_sub: primeira mensagem 1 s após o boot
+#define MATRIZ_GANHO   8                // brilho da matriz no desenho (o firmware usa até 32 de 255)
+#define PUBLICACOES_MAX 64              // tópicos lembrados para detectar mudança de conteúdo
+#define CONFIGS_MAX    8                // --config por execução
+
+int painel_main();                      // main() do firmware (compilado com -Dmain=painel_main)
+
+typedef enum {
+    ENTRADA_BOTAO, ENTRADA_MQTT, ENTRADA_TEMPERATURA, ENTRADA_ADC, ENTRADA_HTTP, ENTRADA_UDP,
+    ENTRADA_BROKER, ENTRADA_FIM, ENTRADA_TOTAL
+} TipoEntrada;
+static const char *const nomes_entrada[ENTRADA_TOTAL] = {
+    "botao", "mqtt", "temperatura", "adc", "http", "udp", "broker", "fim"
+};
+
+typedef enum { SAIDA_MATRIZ, SAIDA_LED, SAIDA_ESTADO, SAIDA_OLED, SAIDA_RESPOSTA, SAIDA_TOTAL } TipoSaida;
+static const char *const nomes_saida[SAIDA_TOTAL] = { "matriz", "led", "estado", "oled", "resposta" };
+
+typedef struct {
+    uint64_t tempo_us;                  // relativo ao boot concluído
+    TipoEntrada tipo;
+    int inteiro;                        // pino, canal, comando ou broker disponível
+    float real;                         // °C ou volts
+    char *topico;                       // tópico (mqtt) ou valor (http, udp)
+    uint8_t *payload;
+    size_t n;
+    char *linha;                        // texto original (relatório)
+    int64_t latencia_us[SAIDA_TOTAL];   // -1: a saída não mudou
+} Entrada;
+
+static Entrada *entradas;
+static size_t n_entradas;
+static uint64_t fim_relativo_us;
+
+static FILE *relatorio;                 // stdout original (o stdout do firmware é desviado)
+static FILE *saida_tempo;               // --saida
+static const char *dir_quadros;         // --quadros
+static bool terminal;                   // --terminal
+static const char *configs[CONFIGS_MAX]; // --config
+static int n_configs;
+static jmp_buf fim_simulacao;
+
+static uint64_t pronto_us;
+static bool iniciado;
+static const char *reinicio;
+
+// atribuição das saídas: uma mudança do estado do painel pertence à última entrada entregue antes
+// dela; uma saída pertence à entrada que mudou o estado (ou à última entrada, se o estado não mudou
+// desde a saída anterior do mesmo tipo, ex.: temperatura no OLED; respostas são sempre da última)
+static int ultima = -1;                 // última entrada entregue
+static int causa = -1;                  // entrada que causou a última mudança do estado
+static EstadoPainel visto;
+static bool mudou_desde[SAIDA_TOTAL];   // estado mudou desde a última saída deste tipo
+static uint64_t lote_us[SAIDA_TOTAL];   // saídas no mesmo instante formam um lote (ex.: 4 publicações)
+static int lote_entrada[SAIDA_TOTAL];
+
+static uint32_t quadro_matriz[SIM_MATRIZ_PIXELS]; // ordem da tela (linha a linha), 0x00RRGGBB
+static bool matriz_recebida;
+static uint8_t quadro_oled[SIM_OLED_LARGURA * SIM_OLED_PAGINAS];
+static bool oled_ligado;
+static uint8_t oled_contraste;
+static bool oled_recebido;
+
+static struct { char topico[64]; uint8_t *dados; size_t n; } publicadas[PUBLICACOES_MAX];
+static int n_publicadas;
+static unsigned long total_publicacoes, total_estado, total_matriz, total_oled;
+
+// ---------------------------------------------------------------------------------------------
+// leitura do traço
+
+static char *duplicar(const char *s, size_t n) {
+    char *d = malloc(n + 1);
+    if (!d) abort();
+    memcpy(d, s, n);
+    d[n] = '\0';
+    return d;
+}
+
+static char *proximo_campo(char **cursor) {
+    char *s = *cursor;
+    while (*s == ' ' || *s == '\t') s++;
+    if (!*s) return NULL;
+    char *fim = s;
+    while (*fim && *fim != ' ' && *fim != '\t') fim++;
+    if (*fim) *fim++ = '\0';
+    *cursor = fim;
+    return s;
+}
+
+// payload do resto da linha ("\n" vira quebra de linha)
+static void ler_payload(Entrada *e, const char *resto) {
+    size_t n = strlen(resto);
+    e->payload = malloc(n + 1);
+    if (!e->payload) abort();
+    size_t j = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (resto[i] == '\\' && resto[i + 1] == 'n') {
+            e->payload[j++] = '\n';
+            i++;
+        } else {
+            e->payload[j++] = (uint8_t)resto[i];
+        }
+    }
+    e->n = j;
+}
+
+static bool ler_linha(char *linha, Entrada *e, bool *em_segundos, double *origem, int numero) {
+    char original[160];
+    snprintf(original, sizeof(original), "%s", linha);
+    char *cursor = linha;
+    char *tempo = proximo_campo(&cursor);
+    char *tipo = proximo_campo(&cursor);
+    if (!tempo) return false;
+    char *fim_numero;
+    double t = strtod(tempo, &fim_numero);
+    if (*fim_numero || !tipo) {
+        fprintf(stderr, "linha %d: esperado '<ms> <tipo> ...'\n", numero);
+        exit(2);
+    }
+    if (n_entradas == 0 && strchr(tempo, '.') && t >= 1e9) { // gravado pelo mosquitto_sub
+        *em_segundos = true;
+        *origem = t;
+    }
+    double us = *em_segundos ? (t - *origem) * 1e6 + INICIO_GRAVADO_US : t * 1000.0;
+    memset(e, 0, sizeof(*e));
+    e->tempo_us = us > 0 ? (uint64_t)(us + 0.5) : 0;
+    for (int k = 0; k < SAIDA_TOTAL; k++) e->latencia_us[k] = -1;
+    e->tipo = ENTRADA_TOTAL;
+    for (int i = 0; i < ENTRADA_TOTAL; i++) {
+        if (strcmp(tipo, nomes_entrada[i]) == 0) e->tipo = (TipoEntrada)i;
+    }
+    if (e->tipo == ENTRADA_TOTAL && strchr(tipo, '/')) { // "<tempo> <tópico> <payload>"
+        e->tipo = ENTRADA_MQTT;
+        e->topico = duplicar(tipo, strlen(tipo));
+        ler_payload(e, *cursor == ' ' ? cursor + 1 : cursor);
+    } else if (e->tipo == ENTRADA_MQTT) {
+        char *topico = proximo_campo(&cursor);
+        if (!topico) goto invalida;
+        e->topico = duplicar(topico, strlen(topico));
+        ler_payload(e, cursor);
+    } else {
+        char *a = proximo_campo(&cursor);
+        char *b = proximo_campo(&cursor);
+        switch (e->tipo) {
+            case ENTRADA_BOTAO:
+                if (!a || !b) goto invalida;
+                e->inteiro = strcmp(a, "A") == 0 ? PINO_BOTAO_A : strcmp(a, "B") == 0 ? PINO_BOTAO_B :
+                             strcmp(a, "J") == 0 ? PINO_JOYSTICK : -1;
+                if (e->inteiro < 0) goto invalida;
+                e->real = (float)atoi(b);
+                break;
+            case ENTRADA_TEMPERATURA:
+                if (!a) goto invalida;
+                e->real = strtof(a, NULL);
+                break;
+            case ENTRADA_ADC:
+                if (!a || !b || atoi(a) < 0 || atoi(a) > 2) goto invalida;
+                e->inteiro = atoi(a);
+                e->real = strtof(b, NULL);
+                break;
+            case ENTRADA_HTTP:
+            case ENTRADA_UDP:
+                if (!a || !b || painel_comando_por_nome(a) == COMANDO_TOTAL) goto invalida;
+                e->inteiro = painel_comando_por_nome(a);
+                e->topico = duplicar(b, strlen(b));
+                break;
+            case ENTRADA_BROKER:
+                if (!a) goto invalida;
+                e->inteiro = atoi(a);
+                break;
+            case ENTRADA_FIM:
+                break;
+            default:
+                goto invalida;
+        }
+    }
+    e->linha = duplicar(original + (tipo - linha), strlen(original + (tipo - linha)));
+    return true;
+invalida:
+    fprintf(stderr, "linha %d: entrada inválida: %s\n", numero, original);
+    exit(2);
+}
+
+static void carregar_traco(const char *caminho) {
+    FILE *f = fopen(caminho, "r");
+    if (!f) {
+        perror(caminho);
+        exit(2);
+    }
+    char *linha = NULL;
+    size_t capacidade = 0, alocadas = 0;
+    bool em_segundos = false, fim_explicito = false;
+    double origem = 0;
+    int numero = 0;
+    ssize_t n;
+    while ((n = getline(&linha, &capacidade, f)) >= 0) {
+        numero++;
+        while (n > 0 && (linha[n - 1] == '\n' || linha[n - 1] == '\r')) linha[--n] = '\0';
+        if (linha[0] == '#') continue;
+        if (n_entradas == alocadas) {
+            alocadas = alocadas ? 2 * alocadas : 64;
+            entradas = realloc(entradas, alocadas * sizeof(*entradas));
+            if (!entradas) abort();
+        }
+        Entrada *e = &entradas[n_entradas];
+        if (!ler_linha(linha, e, &em_segundos, &origem, numero)) continue;
+        if (n_entradas && e->tempo_us < entradas[n_entradas - 1].tempo_us) {
+            fprintf(stderr, "linha %d: tempo fora de ordem\n", numero);
+            exit(2);
+        }
+        if (e->tipo == ENTRADA_FIM) {
+            fim_relativo_us = e->tempo_us;
+            fim_explicito = true;
+            break;
+        }
+        n_entradas++;
+    }
+    free(linha);
+    fclose(f);
+    if (!fim_explicito) fim_relativo_us = (n_entradas ? entradas[n_entradas - 1].tempo_us : 0) + fim_relativo_us;
+}
+
+// ---------------------------------------------------------------------------------------------
+// linha do tempo (--saida)
+
+// instante da linha do tempo: desde o boot concluído (antes dele, desde o reset)
+static int64_t us_relativo(void) {
+    return (int64_t)(sim_agora_us() - pronto_us);
+}
+
+static double ms_relativo(void) {
+    return us_relativo() / 1000.0;
+}
+
+static void registrar(const char *formato, const char *texto, const uint8_t *dados, size_t n) {
+    if (!saida_tempo) return;
+    fprintf(saida_tempo, "%12.3f %s%s", ms_relativo(), formato, texto);
+    if (dados) {                        // payload: texto com escapes, truncado
+        fputc(' ', saida_tempo);
+        size_t mostrar = n > 200 ? 200 : n;
+        for (size_t i = 0; i < mostrar; i++) {
+            if (dados[i] == '\n') fputs("\\n", saida_tempo);
+            else if (dados[i] < 0x20 || dados[i] == 0x7F) fprintf(saida_tempo, "\\x%02x", dados[i]);
+            else fputc(dados[i], saida_tempo);
+        }
+        if (mostrar < n) fprintf(saida_tempo, "...(%zu bytes)", n);
+    }
+    fputc('\n', saida_tempo);
+}
+
+// ---------------------------------------------------------------------------------------------
+// atribuição de latências
+
+static void verificar_painel(void) {
+    if (painel.cor == visto.cor && painel.comodo == visto.comodo && painel.led_ligado == visto.led_ligado &&
+        painel.emergencia == visto.emergencia) return;
+    visto = painel;
+    causa = ultima;
+    for (int k = 0; k < SAIDA_TOTAL; k++) mudou_desde[k] = true;
+}
+
+// uma saída do tipo k; 'mudou' se o que o usuário vê (ou o broker guarda) mudou
+static void saida(TipoSaida k, bool mudou) {
+    uint64_t agora = sim_agora_us();
+    if (!iniciado) return;              // saídas do boot
+    verificar_painel();
+    if (agora != lote_us[k]) {
+        lote_us[k] = agora;
+        lote_entrada[k] = mudou_desde[k] && k != SAIDA_RESPOSTA ? causa : ultima; // respostas não dependem do estado
+        mudou_desde[k] = false;
+    }
+    if (!mudou || lote_entrada[k] < 0) return;
+    Entrada *e = &entradas[lote_entrada[k]];
+    if (e->latencia_us[k] < 0) e->latencia_us[k] = (int64_t)(agora - pronto_us - e->tempo_us);
+}
+
+// "~/comando/cor" -> "<prefixo>/comando/cor"; o prefixo só é conhecido depois do boot
+static const char *topico_no(const char *topico) {
+    static char expandido[CONFIG_PREFIXO_MAX + 128];
+    if (strncmp(topico, "~/", 2) != 0) return topico;
+    snprintf(expandido, sizeof(expandido), "%s/%s", config_valor(CONFIG_PREFIXO), topico + 2);
+    return expandido;
+}
+
+static void entregar(void *arg) {
+    Entrada *e = arg;
+    verificar_painel();                 // mudanças até aqui pertencem à entrada anterior
+    ultima = (int)(e - entradas);
+    registrar("entrada ", e->linha, NULL, 0);
+    bool aceita = true;
+    switch (e->tipo) {
+        case ENTRADA_BOTAO: sim_gpio_entrada((unsigned)e->inteiro, e->real == 0); break; // ativo em nível baixo
+        case ENTRADA_MQTT: aceita = sim_mqtt_entregar(topico_no(e->topico), e->payload, e->n); break;
+        case ENTRADA_TEMPERATURA: // inverso de ler_temperatura() de main.c
+            sim_adc_definir(4, (0.706f - (e->real - 27.0f) * 0.001721f) * 4096.0f / 3.3f);
+            break;
+        case ENTRADA_ADC: sim_adc_definir((uint8_t)e->inteiro, e->real * 4096.0f / 3.3f); break;
+        case ENTRADA_HTTP: aceita = sim_http_comando(e->inteiro, e->topico); break;
+        case ENTRADA_UDP:
+            aceita = sim_udp_comando(e->inteiro, painel_valor_comando((TipoComando)e->inteiro, e->topico));
+            break;
+        case ENTRADA_BROKER: sim_broker_disponivel(e->inteiro != 0); break;
+        default: break;
+    }
+    if (!aceita) registrar("recusada ", e->linha, NULL, 0);
+    verificar_painel();                 // comandos MQTT, HTTP e UDP mudam o estado na própria IRQ
+}
+
+// ---------------------------------------------------------------------------------------------
+// ganchos do SDK simulado
+
+void sim_ao_pronto(void) {
+    pronto_us = sim_agora_us();
+    iniciado = true;
+    registrar("pronto", "", NULL, 0);
+    visto = painel;
+    for (int k = 0; k < SAIDA_TOTAL; k++) {
+        lote_us[k] = UINT64_MAX;
+        lote_entrada[k] = -1;
+    }
+    for (size_t i = 0; i < n_entradas; i++) sim_agendar(pronto_us + entradas[i].tempo_us, entregar, &entradas[i]);
+    sim_definir_fim(pronto_us + fim_relativo_us);
+}
+
+static bool publicacao_mudou(const char *topico, const uint8_t *dados, size_t n) {
+    int i = 0;
+    while (i < n_publicadas && strcmp(publicadas[i].topico, topico) != 0) i++;
+    if (i == n_publicadas) {
+        if (n_publicadas == PUBLICACOES_MAX) return true;
+        snprintf(publicadas[i].topico, sizeof(publicadas[i].topico), "%s", topico);
+        n_publicadas++;
+    } else if (publicadas[i].n == n && memcmp(publicadas[i].dados, dados, n) == 0) {
+        return false;
+    }
+    free(publicadas[i].dados);
+    publicadas[i].dados = malloc(n ? n : 1);
+    if (!publicadas[i].dados) abort();
+    memcpy(publicadas[i].dados, dados, n);
+    publicadas[i].n = n;
+    return true;
+}
+
+void sim_ao_publicar(const char *topico, const uint8_t *dados, size_t n, bool retido) {
+    (void)retido;
+    registrar("pub ", topico, dados, n);
+    total_publicacoes++;
+    bool mudou = publicacao_mudou(topico, dados, n);
+    const char *prefixo = config_valor(CONFIG_PREFIXO);
+    size_t p = strlen(prefixo);
+    if (strncmp(topico, prefixo, p) == 0 && strncmp(topico + p, "/estado/", 8) == 0) {
+        total_estado++;
+        saida(SAIDA_ESTADO, mudou);
+    } else {                            // respostas a pedidos contam sempre; telemetria só quando muda
+        size_t t = strlen(topico);
+        bool resposta = (t > 7 && strcmp(topico + t - 7, "/status") == 0) ||
+                        (t > 9 && strcmp(topico + t - 9, "/resposta") == 0);
+        saida(SAIDA_RESPOSTA, mudou || resposta);
+    }
+}
+
+static void desenhar_matriz(FILE *f) {
+    for (int linha = 0; linha < 5; linha++) {
+        for (int coluna = 0; coluna < 5; coluna++) {
+            uint32_t p = quadro_matriz[linha * 5 + coluna];
+            unsigned r = (p >> 16 & 0xFF) * MATRIZ_GANHO, g = (p >> 8 & 0xFF) * MATRIZ_GANHO, b = (p & 0xFF) * MATRIZ_GANHO;
+            fprintf(f, "\x1b[38;2;%u;%u;%um██", r > 255 ? 255 : r, g > 255 ? 255 : g, b > 255 ? 255 : b);
+        }
+        fputs("\x1b[0m\n", f);
+    }
+}
+
+static bool oled_aceso(int x, int y) {
+    return oled_ligado && (quadro_oled[(y / 8) * SIM_OLED_LARGURA + x] >> (y % 8) & 1);
+}
+
+static void desenhar_oled(FILE *f) {
+    static const char *const blocos[4] = { " ", "▀", "▄", "█" }; // cima, baixo, ambos
+    for (int y = 0; y < SIM_OLED_PAGINAS * 8; y += 2) {
+        for (int x = 0; x < SIM_OLED_LARGURA; x++) fputs(blocos[oled_aceso(x, y) | oled_aceso(x, y + 1) << 1], f);
+        fputc('\n', f);
+    }
+}
+
+static FILE *abrir_quadro(const char *prefixo, const char *extensao) {
+    char caminho[512];
+    snprintf(caminho, sizeof(caminho), "%s/%s_%s%010lld.%s", dir_quadros, prefixo, iniciado ? "" : "boot_",
+             (long long)us_relativo(), extensao);
+    FILE *f = fopen(caminho, "wb");
+    if (!f) perror(caminho);
+    return f;
+}
+
+void sim_ao_quadro_matriz(const uint32_t grb[SIM_MATRIZ_PIXELS]) {
+    uint32_t quadro[SIM_MATRIZ_PIXELS];
+    for (int linha = 0; linha < 5; linha++) {   // mesma disposição de pixel_map em main.c (zigue-zague)
+        int de_baixo = 4 - linha;
+        for (int coluna = 0; coluna < 5; coluna++) {
+            uint32_t p = grb[de_baixo * 5 + (de_baixo % 2 ? coluna : 4 - coluna)];
+            quadro[linha * 5 + coluna] = (p >> 8 & 0xFF) << 16 | (p >> 16 & 0xFF) << 8 | (p & 0xFF);
+        }
+    }
+    bool mudou = !matriz_recebida || memcmp(quadro, quadro_matriz, sizeof(quadro)) != 0;
+    saida(SAIDA_MATRIZ, mudou);
+    if (!mudou) return;
+    memcpy(quadro_matriz, quadro, sizeof(quadro));
+    matriz_recebida = true;
+    total_matriz++;
+    char texto[SIM_MATRIZ_PIXELS * 7 + 1];
+    for (int i = 0; i < SIM_MATRIZ_PIXELS; i++) snprintf(texto + 7 * i, 8, " %06x", (unsigned)quadro[i]);
+    registrar("matriz", texto, NULL, 0);
+    if (terminal) {
+        fprintf(relatorio, "matriz em %.3f ms\n", ms_relativo());
+        desenhar_matriz(relatorio);
+    }
+    if (dir_quadros) {                  // PPM: cada LED em 16x16 pixels com borda escura
+        FILE *f = abrir_quadro("matriz", "ppm");
+        if (!f) return;
+        fprintf(f, "P6\n80 80\n255\n");
+        for (int y = 0; y < 80; y++) {
+            for (int x = 0; x < 80; x++) {
+                uint32_t p = quadro[(y / 16) * 5 + x / 16];
+                bool borda = x % 16 < 2 || y % 16 < 2;
+                for (int c = 16; c >= 0; c -= 8) {
+                    unsigned v = borda ? 0 : (p >> c & 0xFF) * MATRIZ_GANHO;
+                    fputc(v > 255 ? 255 : (int)v, f);
+                }
+            }
+        }
+        fclose(f);
+    }
+}
+
+void sim_ao_quadro_oled(const uint8_t gram[SIM_OLED_LARGURA * SIM_OLED_PAGINAS], bool ligado, uint8_t contraste) {
+    bool mudou = !oled_recebido || ligado != oled_ligado ||
+                 (ligado && (contraste != oled_contraste || memcmp(gram, quadro_oled, sizeof(quadro_oled)) != 0));
+    saida(SAIDA_OLED, mudou);
+    memcpy(quadro_oled, gram, sizeof(quadro_oled));
+    oled_ligado = ligado;
+    oled_contraste = contraste;
+    oled_recebido = true;
+    if (!mudou) return;
+    total_oled++;
+    uint32_t crc = 0xFFFFFFFFu;         // identifica o conteúdo na linha do tempo
+    for (size_t i = 0; i < sizeof(quadro_oled); i++) {
+        crc ^= quadro_oled[i];
+        for (int b = 0; b < 8; b++) crc = crc >> 1 ^ (0xEDB88320u & -(crc & 1));
+    }
+    char texto[48];
+    snprintf(texto, sizeof(texto), " %08x %s %u", (unsigned)~crc, ligado ? "ligado" : "desligado", contraste);
+    registrar("oled", texto, NULL, 0);
+    if (terminal) {
+        fprintf(relatorio, "oled em %.3f ms (%s, contraste %u)\n", ms_relativo(), ligado ? "ligado" : "desligado", contraste);
+        desenhar_oled(relatorio);
+    }
+    if (dir_quadros) {                  // PBM binário: 1 = pixel aceso
+        FILE *f = abrir_quadro("oled", "pbm");
+        if (!f) return;
+        fprintf(f, "P4\n%d %d\n", SIM_OLED_LARGURA, SIM_OLED_PAGINAS * 8);
+        for (int y = 0; y < SIM_OLED_PAGINAS * 8; y++) {
+            for (int x = 0; x < SIM_OLED_LARGURA; x += 8) {
+                uint8_t byte = 0;
+                for (int b = 0; b < 8; b++) byte |= (uint8_t)(oled_aceso(x + b, y) << (7 - b));
+                fputc(byte, f);
+            }
+        }
+        fclose(f);
+    }
+}
+
+void sim_ao_gpio(unsigned pino, bool nivel) {
+    char texto[32];
+    snprintf(texto, sizeof(texto), " %u %d", pino, nivel);
+    registrar(pino == PINO_BUZZER ? "buzzer" : "gpio", texto, NULL, 0);
+    if (pino == PINO_LED_R || pino == PINO_LED_G || pino == PINO_LED_B) saida(SAIDA_LED, true);
+}
+
+void sim_ao_pwm(unsigned pino, uint16_t nivel) {
+    char texto[32];
+    snprintf(texto, sizeof(texto), " %u %u", pino, nivel);
+    registrar("pwm", texto, NULL, 0);
+    if (pino == PINO_LED_R || pino == PINO_LED_G || pino == PINO_LED_B) saida(SAIDA_LED, true);
+}
+
+void sim_ao_reinicio(const char *motivo) {
+    registrar("reinicio ", motivo, NULL, 0);
+    reinicio = motivo;
+}
+
+void sim_terminar(void) {
+    longjmp(fim_simulacao, 1);
+}
+
+// ---------------------------------------------------------------------------------------------
+// relatório
+
+static int comparar_i64(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void imprimir_relatorio(const char *traco, const char *broker) {
+    double duracao_s = (double)(sim_agora_us() - pronto_us) / 1e6;
+    if (broker) {
+        fprintf(relatorio, "ao vivo contra %s: %zu entradas do traço, boot em %.1f ms, %.1f s após o boot\n", broker,
+                n_entradas, pronto_us / 1000.0, duracao_s);
+    } else {
+        fprintf(relatorio, "traço %s: %zu entradas, boot em %.1f ms, %.1f s simulados após o boot\n", traco, n_entradas,
+                pronto_us / 1000.0, duracao_s);
+    }
+    fprintf(relatorio, "saídas: %lu publicações (%lu em %s/estado), %lu quadros da matriz, %lu do OLED\n",
+            total_publicacoes, total_estado, config_valor(CONFIG_PREFIXO), total_matriz, total_oled);
+    const SimMqttContadores *mqtt = sim_mqtt_contadores();
+    fprintf(relatorio, "mqtt: %lu conexões, %lu quedas, %lu mensagens recebidas, %lu pedidos recusados "
+            "(MQTT_REQ_MAX_IN_FLIGHT)\n", mqtt->conexoes, mqtt->quedas, mqtt->recebidas, mqtt->recusados);
+    const AlarmeEstatisticas *alarme = alarme_estatisticas();
+    const FilaMqttEstatisticas *fila = fila_mqtt_estatisticas();
+    fprintf(relatorio, "alarme: %lu detecções, detecção -> envio %.3f ms (máx %.3f), -> PUBACK %.3f ms (máx %.3f), "
+            "%lu reenvios; pedidos adiados por classe (alarme/controle/telemetria) %lu/%lu/%lu\n",
+            (unsigned long)alarme->deteccoes, alarme->envio_us / 1000.0, alarme->envio_max_us / 1000.0,
+            alarme->confirmacao_us / 1000.0, alarme->confirmacao_max_us / 1000.0, (unsigned long)alarme->reenvios,
+            (unsigned long)fila->adiados[MQTT_CLASSE_ALARME], (unsigned long)fila->adiados[MQTT_CLASSE_CONTROLE],
+            (unsigned long)fila->adiados[MQTT_CLASSE_TELEMETRIA]);
+    if (reinicio) fprintf(relatorio, "o firmware reiniciaria (%s): a simulação parou aí\n", reinicio);
+    if (!n_entradas) return;            // ao vivo sem traço: só os totais
+    fprintf(relatorio, "\nlatência até a primeira mudança de cada saída (ms; '-' = não mudou)\n");
+    fprintf(relatorio, "%10s  %-38s", "t (ms)", "entrada");
+    for (int k = 0; k < SAIDA_TOTAL; k++) fprintf(relatorio, " %9s", nomes_saida[k]);
+    fputc('\n', relatorio);
+    for (size_t i = 0; i < n_entradas; i++) {
+        const Entrada *e = &entradas[i];
+        fprintf(relatorio, "%10.1f  %-38.38s", e->tempo_us / 1000.0, e->linha);
+        for (int k = 0; k < SAIDA_TOTAL; k++) {
+            if (e->latencia_us[k] < 0) fprintf(relatorio, " %9s", "-");
+            else fprintf(relatorio, " %9.3f", e->latencia_us[k] / 1000.0);
+        }
+        fputc('\n', relatorio);
+    }
+
+    fprintf(relatorio, "\npor tipo de entrada: n / mediana / p95 / máximo (ms)\n");
+    int64_t *valores = malloc((n_entradas ? n_entradas : 1) * sizeof(*valores));
+    if (!valores) abort();
+    for (int t = 0; t < ENTRADA_TOTAL; t++) {
+        bool cabecalho = false;
+        for (int k = 0; k < SAIDA_TOTAL; k++) {
+            size_t n = 0;
+            for (size_t i = 0; i < n_entradas; i++) {
+                if (entradas[i].tipo == (TipoEntrada)t && entradas[i].latencia_us[k] >= 0) valores[n++] = entradas[i].latencia_us[k];
+            }
+            if (!n) continue;
+            qsort(valores, n, sizeof(*valores), comparar_i64);
+            size_t p95 = (n * 95 + 99) / 100 - 1; // posição mais próxima
+            if (!cabecalho) fprintf(relatorio, "  %s\n", nomes_entrada[t]);
+            cabecalho = true;
+            fprintf(relatorio, "    %-9s %4zu / %9.3f / %9.3f / %9.3f\n", nomes_saida[k], n, valores[n / 2] / 1000.0,
+                    valores[p95] / 1000.0, valores[n - 1] / 1000.0);
+        }
+    }
+    free(valores);
+    if (matriz_recebida) {
+        fprintf(relatorio, "\nmatriz final:\n");
+        desenhar_matriz(relatorio);
+    }
+    if (oled_recebido && terminal) {
+        fprintf(relatorio, "\noled final:\n");
+        desenhar_oled(relatorio);
+    }
+}
+
+static void interromper(int sinal) {
+    (void)sinal;
+    sim_interromper();
+}
+
+// --config: grava na flash simulada pelo mesmo armazenamento que o firmware lê no boot
+static bool kv_apagar(uint32_t deslocamento) {
+    return flash_pico_apagar(FLASH_KV_INICIO + deslocamento, FLASH_SETOR);
+}
+
+static bool kv_gravar(uint32_t deslocamento, const uint8_t *pagina) {
+    return flash_pico_gravar(FLASH_KV_INICIO + deslocamento, pagina, FLASH_PAGINA);
+}
+
+static bool gravar_config(void) {
+    static KvFlash kv = {
+        .tamanho_setor = FLASH_SETOR, .tamanho_pagina = FLASH_PAGINA, .setores = FLASH_KV_SETORES,
+        .apagar = kv_apagar, .gravar = kv_gravar,
+    };
+    kv.base = flash_pico_mapa(FLASH_KV_INICIO);
+    kv_iniciar(&kv);
+    for (int i = 0; i < n_configs; i++) {
+        if (config_definir(configs[i], 0) < 0) {
+            fprintf(stderr, "--config %s: nome ou valor inválido\n", configs[i]);
+            return false;
+        }
+    }
+    return kv_sincronizar(0);
+}
+
+int main(int argc, char **argv) {
+    static const char *traco, *caminho_saida, *broker; // static: lidos depois do longjmp de sim_terminar()
+    double duracao_s = 0;
+    fim_relativo_us = 3000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--saida") == 0 && i + 1 < argc) caminho_saida = argv[++i];
+        else if (strcmp(argv[i], "--broker") == 0 && i + 1 < argc) broker = argv[++i];
+        else if (strcmp(argv[i], "--duracao") == 0 && i + 1 < argc) duracao_s = atof(argv[++i]);
+        else if (strcmp(argv[i], "--quadros") == 0 && i + 1 < argc) dir_quadros = argv[++i];
+        else if (strcmp(argv[i], "--cauda") == 0 && i + 1 < argc) fim_relativo_us = strtoull(argv[++i], NULL, 10) * 1000;
+        else if (strcmp(argv[i], "--terminal") == 0) terminal = true;
+        else if (strcmp(argv[i], "--log") == 0) sim_log_usb = true;
+        else if (strcmp(argv[i], "--id") == 0 && i + 1 < argc) sim_definir_id_placa(strtoull(argv[++i], NULL, 16));
+        else if (strcmp(argv[i], "--config") == 0 && i + 1 < argc && n_configs < CONFIGS_MAX) configs[n_configs++] = argv[++i];
+        else if (argv[i][0] != '-' && !traco) traco = argv[i];
+        else {
+            traco = NULL;
+            broker = NULL;
+            break;
+        }
+    }
+    if (!traco && !broker) {
+        fprintf(stderr, "uso: %s <traço> [--saida arquivo] [--quadros dir] [--terminal] [--log] [--cauda ms]\n"
+                "     %s --broker host[:porta] [traço] [--duracao s] [...]\n"
+                "     [--id hex] [--config nome=valor]...\n", argv[0], argv[0]);
+        return 2;
+    }
+    if (n_configs && !gravar_config()) return 2;
+    if (traco) carregar_traco(traco);
+    if (broker) {                       // ao vivo: o fim vem do traço, de --duracao ou do Ctrl-C
+        char host[256];
+        unsigned porta = 1883;
+        snprintf(host, sizeof(host), "%s", broker);
+        char *dois_pontos = strrchr(host, ':');
+        if (dois_pontos) {
+            *dois_pontos = '\0';
+            porta = (unsigned)atoi(dois_pontos + 1);
+        }
+        if (!sim_ao_vivo(host, (uint16_t)porta)) {
+            fprintf(stderr, "%s: endereço não encontrado\n", host);
+            return 2;
+        }
+        if (duracao_s > 0) fim_relativo_us = (uint64_t)(duracao_s * 1e6);
+        else if (!traco) fim_relativo_us = UINT64_MAX / 2;
+        signal(SIGINT, interromper);
+        signal(SIGTERM, interromper);
+    }
+    if (caminho_saida && !(saida_tempo = fopen(caminho_saida, "w"))) {
+        perror(caminho_saida);
+        return 2;
+    }
+
+    // o printf do firmware (e o log, com --log) vai para a saída de erro; o relatório fica no stdout
+    fflush(stdout);
+    relatorio = fdopen(dup(STDOUT_FILENO), "w");
+    if (!relatorio || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+        perror("stdout");
+        return 2;
+    }
+    if (!sim_log_usb && !freopen("/dev/null", "w", stdout)) return 2;
+
+    if (setjmp(fim_simulacao) == 0) {
+        painel_main();
+        fprintf(relatorio, "o firmware saiu do main() em %.3f ms\n", sim_agora_us() / 1000.0);
+    }
+    fflush(stdout);
+    imprimir_relatorio(traco, broker);
+    if (saida_tempo) fclose(saida_tempo);
+    fclose(relatorio);
+    return 0;
+}
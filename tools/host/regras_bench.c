@@ -0,0 +1,156 @@
+// Avalia regras (lib/regras.c) contra um trace de sensores e mede regras avaliadas por segundo.
+//
+// Uso: regras_bench <arquivo_de_regras> [trace.csv]
+//   trace: linhas "segundos,sensor,valor" (ex.: 3600,temperatura,37.50); sem trace, gera 24 h
+//   sintéticas de temperatura a 1 Hz (ciclo diário de 18 a 42 °C com ruído).
+// Gravar um trace do painel: mosquitto_sub -h <broker> -t casa/temperatura |
+//   while read v; do echo "$(date +%s),temperatura,$v"; done > trace.csv
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "regras.h"
+
+#define TRACE_MAX 2000000               // amostras carregadas
+#define DISPAROS_EXIBIDOS 20            // disparos listados na primeira passada
+
+typedef struct {
+    uint32_t segundos;
+    uint8_t sensor;
+    float valor;
+} Amostra;
+
+// mesma ordem de registrar_sensores() em main.c
+static const char *const nomes_sensor[] = { "temperatura", "adc0", "adc1", "adc2", "luz" };
+#define TOTAL_SENSORES (int)(sizeof(nomes_sensor) / sizeof(nomes_sensor[0]))
+
+static Amostra *trace;
+static size_t total_amostras;
+static unsigned long disparos[REGRAS_MAX];
+static unsigned long total_disparos;
+static bool listar = true;
+static uint32_t segundos_atual;
+
+static int sensor_por_nome(const char *nome) {
+    for (int i = 0; i < TOTAL_SENSORES; i++) {
+        if (strcmp(nomes_sensor[i], nome) == 0) return i;
+    }
+    return -1;
+}
+
+static void executar(uint8_t regra, const RegraAcao *acao, float valor) {
+    disparos[regra]++;
+    total_disparos++;
+    if (!listar || total_disparos > DISPAROS_EXIBIDOS) return;
+    printf("  t=%02u:%02u:%02u regra %u (valor %.2f): ", segundos_atual / 3600 % 24, segundos_atual / 60 % 60,
+           segundos_atual % 60, regra, valor);
+    switch (acao->tipo) {
+        case REGRA_ACAO_ALARME:   printf("alarme\n"); break;
+        case REGRA_ACAO_PUBLICAR: printf("publicar %s\n", acao->mensagem); break;
+        default:                  printf("%s = %d\n", painel_nomes_comando[acao->comando], acao->valor); break;
+    }
+}
+
+static char *ler_arquivo(const char *caminho) {
+    FILE *f = fopen(caminho, "rb");
+    if (!f) return NULL;
+    static char texto[REGRAS_TEXTO_MAX];
+    size_t n = fread(texto, 1, sizeof(texto) - 1, f);
+    fclose(f);
+    texto[n] = '\0';
+    return texto;
+}
+
+static bool carregar_trace(const char *caminho) {
+    FILE *f = fopen(caminho, "r");
+    if (!f) return false;
+    char linha[128], nome[32];
+    unsigned long segundos;
+    float valor;
+    while (total_amostras < TRACE_MAX && fgets(linha, sizeof(linha), f)) {
+        if (sscanf(linha, "%lu,%31[^,],%f", &segundos, nome, &valor) != 3) continue;
+        int s = sensor_por_nome(nome);
+        if (s < 0) continue;
+        trace[total_amostras++] = (Amostra){ (uint32_t)segundos, (uint8_t)s, valor };
+    }
+    fclose(f);
+    return true;
+}
+
+static void gerar_trace(void) {
+    srand(1);
+    for (uint32_t t = 0; t < 86400; t++) {
+        float ruido = ((float)rand() / RAND_MAX - 0.5f) * 0.4f;
+        float valor = 30.0f + 12.0f * sinf(((float)t - 9 * 3600.0f) * 2.0f * 3.14159265f / 86400.0f) + ruido; // pico às 15 h
+        trace[total_amostras++] = (Amostra){ t, 0, valor };
+    }
+}
+
+// uma passada pelo trace; retorna o número de regras avaliadas
+static uint64_t passada(void) {
+    uint64_t avaliadas = 0;
+    int minuto = -1;
+    for (size_t i = 0; i < total_amostras; i++) {
+        const Amostra *a = &trace[i];
+        segundos_atual = a->segundos;
+        int m = (int)(a->segundos / 60 % 1440);
+        if (m != minuto) {
+            regras_relogio(m, executar);
+            minuto = m;
+        }
+        regras_avaliar(a->sensor, a->valor, executar);
+        avaliadas += regras_do_sensor(a->sensor);
+    }
+    return avaliadas;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "uso: %s <arquivo_de_regras> [trace.csv]\n", argv[0]);
+        return 2;
+    }
+    const char *texto = ler_arquivo(argv[1]);
+    if (!texto) {
+        perror(argv[1]);
+        return 1;
+    }
+    char erro[64];
+    int total = regras_carregar(texto, sensor_por_nome, erro, sizeof(erro));
+    if (total < 0) {
+        fprintf(stderr, "regras inválidas: %s\n", erro);
+        return 1;
+    }
+
+    trace = malloc(sizeof(Amostra) * TRACE_MAX);
+    if (argc > 2 ? !carregar_trace(argv[2]) : (gerar_trace(), false)) {
+        perror(argv[2]);
+        return 1;
+    }
+    if (total_amostras == 0) {
+        fprintf(stderr, "trace sem amostras reconhecidas\n");
+        return 1;
+    }
+
+    printf("%d regras, %zu amostras (%s)\nDisparos:\n", total, total_amostras, argc > 2 ? argv[2] : "trace sintético");
+    passada();                          // primeira passada: lista disparos
+    for (int i = 0; i < total; i++) printf("  regra %d: %lu disparos\n", i, disparos[i]);
+
+    listar = false;
+    struct timespec inicio, fim;
+    uint64_t avaliadas = 0, amostras = 0;
+    double decorrido = 0.0;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    while (decorrido < 1.0) {           // repete o trace por pelo menos 1 s
+        regras_carregar(texto, sensor_por_nome, erro, sizeof(erro)); // estado inicial a cada passada
+        avaliadas += passada();
+        amostras += total_amostras;
+        clock_gettime(CLOCK_MONOTONIC, &fim);
+        decorrido = (double)(fim.tv_sec - inicio.tv_sec) + (double)(fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    }
+    printf("Desempenho: %.1f M amostras/s, %.1f M regras avaliadas/s, %.1f ns por amostra\n",
+           amostras / decorrido / 1e6, avaliadas / decorrido / 1e6, decorrido * 1e9 / amostras);
+    free(trace);
+    return 0;
+}
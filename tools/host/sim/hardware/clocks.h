@@ -0,0 +1,11 @@
+// SDK simulado: clock do sistema fixo em 125 MHz
+#ifndef SIM_HARDWARE_CLOCKS_H
+#define SIM_HARDWARE_CLOCKS_H
+
+#include <stdint.h>
+
+enum clock_index { clk_sys = 5 };
+
+static inline uint32_t clock_get_hz(enum clock_index clock) { (void)clock; return 125000000; }
+
+#endif
@@ -0,0 +1,29 @@
+// SDK simulado: GPIOs com nível guardado em memória; bordas de entrada vêm do traço
+#ifndef SIM_HARDWARE_GPIO_H
+#define SIM_HARDWARE_GPIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef unsigned int uint;
+
+#define GPIO_OUT 1
+#define GPIO_IN  0
+#define GPIO_IRQ_LEVEL_LOW  0x1u
+#define GPIO_IRQ_LEVEL_HIGH 0x2u
+#define GPIO_IRQ_EDGE_FALL  0x4u
+#define GPIO_IRQ_EDGE_RISE  0x8u
+
+enum gpio_function { GPIO_FUNC_SPI = 1, GPIO_FUNC_UART = 2, GPIO_FUNC_I2C = 3, GPIO_FUNC_PWM = 4, GPIO_FUNC_PIO0 = 6, GPIO_FUNC_SIO = 5 };
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t eventos);
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool saida);
+void gpio_put(uint gpio, bool valor);
+bool gpio_get(uint gpio);
+void gpio_pull_up(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function funcao);
+void gpio_set_irq_enabled(uint gpio, uint32_t eventos, bool habilitado);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t eventos, bool habilitado, gpio_irq_callback_t callback);
+
+#endif
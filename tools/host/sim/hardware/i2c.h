@@ -0,0 +1,18 @@
+// SDK simulado: barramento I2C com o SSD1306 emulado (tempo de 400 kHz cobrado no relógio virtual)
+#ifndef SIM_HARDWARE_I2C_H
+#define SIM_HARDWARE_I2C_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "hardware/gpio.h"
+
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t *const i2c0;
+extern i2c_inst_t *const i2c1;
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t endereco, const uint8_t *dados, size_t n, bool sem_stop);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t endereco, uint8_t *dados, size_t n, bool sem_stop);
+
+#endif
@@ -0,0 +1,47 @@
+// SDK simulado: PIO0/SM0 alimenta a matriz WS2812 emulada (quadro a cada 25 palavras);
+// a configuração da máquina de estados (usada por generated/ws2812.pio.h) não tem efeito
+#ifndef SIM_HARDWARE_PIO_H
+#define SIM_HARDWARE_PIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/gpio.h"
+
+typedef struct pio_hw pio_hw_t;
+typedef pio_hw_t *PIO;
+extern PIO const pio0;
+
+typedef struct pio_program {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+    uint8_t pio_version;
+} pio_program_t;
+
+typedef struct { uint32_t clkdiv; } pio_sm_config;
+enum pio_fifo_join { PIO_FIFO_JOIN_NONE = 0, PIO_FIFO_JOIN_TX = 1, PIO_FIFO_JOIN_RX = 2 };
+
+static inline pio_sm_config pio_get_default_sm_config(void) { pio_sm_config c = { 0 }; return c; }
+static inline void sm_config_set_wrap(pio_sm_config *c, uint inicio, uint fim) { (void)c; (void)inicio; (void)fim; }
+static inline void sm_config_set_sideset(pio_sm_config *c, uint bits, bool opcional, bool pindirs) {
+    (void)c; (void)bits; (void)opcional; (void)pindirs;
+}
+static inline void sm_config_set_sideset_pins(pio_sm_config *c, uint pino) { (void)c; (void)pino; }
+static inline void sm_config_set_out_shift(pio_sm_config *c, bool direita, bool autopull, uint limite) {
+    (void)c; (void)direita; (void)autopull; (void)limite;
+}
+static inline void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join juncao) { (void)c; (void)juncao; }
+static inline void sm_config_set_clkdiv(pio_sm_config *c, float divisor) { c->clkdiv = (uint32_t)(divisor * 256); }
+static inline void pio_gpio_init(PIO pio, uint pino) { (void)pio; (void)pino; }
+static inline int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pino, uint n, bool saida) {
+    (void)pio; (void)sm; (void)pino; (void)n; (void)saida; return 0;
+}
+static inline int pio_sm_init(PIO pio, uint sm, uint offset, const pio_sm_config *c) {
+    (void)pio; (void)sm; (void)offset; (void)c; return 0;
+}
+static inline void pio_sm_set_enabled(PIO pio, uint sm, bool habilitada) { (void)pio; (void)sm; (void)habilitada; }
+
+uint pio_add_program(PIO pio, const pio_program_t *programa);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t dado);
+
+#endif
@@ -0,0 +1,14 @@
+// SDK simulado: PWM (só o nível de cada pino importa: mudanças vão para sim_ao_pwm)
+#ifndef SIM_HARDWARE_PWM_H
+#define SIM_HARDWARE_PWM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/gpio.h"
+
+static inline uint pwm_gpio_to_slice_num(uint gpio) { return (gpio >> 1) & 7u; }
+static inline void pwm_set_wrap(uint fatia, uint16_t topo) { (void)fatia; (void)topo; }
+static inline void pwm_set_enabled(uint fatia, bool habilitado) { (void)fatia; (void)habilitado; }
+void pwm_set_gpio_level(uint gpio, uint16_t nivel);
+
+#endif
@@ -0,0 +1,16 @@
+// SDK simulado: SPI só de escrita; o tempo de cada transferência avança o relógio virtual
+#ifndef SIM_HARDWARE_SPI_H
+#define SIM_HARDWARE_SPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/gpio.h"
+
+typedef struct spi_inst spi_inst_t;
+extern spi_inst_t *const spi0;
+extern spi_inst_t *const spi1;
+
+uint spi_init(spi_inst_t *spi, uint baudrate);
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *dados, size_t n);
+
+#endif
@@ -0,0 +1,11 @@
+// SDK simulado: núcleo único, interrupções entregues só nos pontos de espera
+#ifndef SIM_HARDWARE_SYNC_H
+#define SIM_HARDWARE_SYNC_H
+
+#include <stdint.h>
+
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t estado) { (void)estado; }
+static inline void __dmb(void) {}
+
+#endif
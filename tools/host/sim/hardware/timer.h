@@ -0,0 +1,10 @@
+// SDK simulado: timer do RP2040 = relógio virtual do simulador
+#ifndef SIM_HARDWARE_TIMER_H
+#define SIM_HARDWARE_TIMER_H
+
+#include <stdint.h>
+
+uint64_t time_us_64(void);
+static inline uint32_t time_us_32(void) { return (uint32_t)time_us_64(); }
+
+#endif
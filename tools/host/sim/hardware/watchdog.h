@@ -0,0 +1,13 @@
+// SDK simulado: o watchdog não dispara (o simulador termina antes de qualquer reinício)
+#ifndef SIM_HARDWARE_WATCHDOG_H
+#define SIM_HARDWARE_WATCHDOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+static inline void watchdog_enable(uint32_t ms, bool pausar_debug) { (void)ms; (void)pausar_debug; }
+static inline void watchdog_disable(void) {}
+static inline void watchdog_update(void) {}
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t atraso_ms);
+
+#endif
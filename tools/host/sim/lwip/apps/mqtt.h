@@ -0,0 +1,66 @@
+// SDK simulado: cliente MQTT do lwIP ligado ao broker do simulador ou, no modo ao vivo, a um broker real
+// (mensagens do traço entram pelos callbacks de publicação; publicações saem gravadas com o tempo virtual)
+#ifndef SIM_LWIP_MQTT_H
+#define SIM_LWIP_MQTT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LWIP_ALTCP 0
+#define LWIP_IANA_PORT_MQTT 1883
+
+typedef uint8_t u8_t;
+typedef uint16_t u16_t;
+typedef uint32_t u32_t;
+typedef int8_t err_t;
+#define ERR_OK       0
+#define ERR_MEM      (-1)
+#define ERR_TIMEOUT  (-3)
+#define ERR_CONN     (-11)
+
+#define MQTT_REQ_MAX_IN_FLIGHT 5        // mesmo valor de lwipopts.h: pedidos sem resposta aceitos pelo cliente
+
+typedef struct { uint32_t addr; } ip_addr_t;
+struct netif { ip_addr_t ip_addr; };
+extern struct netif *netif_default;
+int ipaddr_aton(const char *texto, ip_addr_t *ip);
+char *ipaddr_ntoa(const ip_addr_t *ip);
+
+typedef struct mqtt_client_s mqtt_client_t;
+
+typedef enum {
+    MQTT_CONNECT_ACCEPTED = 0,
+    MQTT_CONNECT_REFUSED_PROTOCOL_VERSION = 1,
+    MQTT_CONNECT_DISCONNECTED = 256,
+    MQTT_CONNECT_TIMEOUT = 257,
+} mqtt_connection_status_t;
+
+enum { MQTT_DATA_FLAG_LAST = 1 };
+
+struct mqtt_connect_client_info_t {
+    const char *client_id;
+    const char *client_user;
+    const char *client_pass;
+    u16_t keep_alive;
+    const char *will_topic;
+    const char *will_msg;
+    u8_t will_qos;
+    u8_t will_retain;
+};
+
+typedef void (*mqtt_connection_cb_t)(mqtt_client_t *client, void *arg, mqtt_connection_status_t status);
+typedef void (*mqtt_incoming_publish_cb_t)(void *arg, const char *topic, u32_t tot_len);
+typedef void (*mqtt_incoming_data_cb_t)(void *arg, const u8_t *data, u16_t len, u8_t flags);
+typedef void (*mqtt_request_cb_t)(void *arg, err_t err);
+
+mqtt_client_t *mqtt_client_new(void);
+err_t mqtt_client_connect(mqtt_client_t *client, const ip_addr_t *ip, u16_t porta, mqtt_connection_cb_t cb,
+                          void *arg, const struct mqtt_connect_client_info_t *info);
+void mqtt_set_inpub_callback(mqtt_client_t *client, mqtt_incoming_publish_cb_t pub_cb,
+                             mqtt_incoming_data_cb_t data_cb, void *arg);
+err_t mqtt_sub_unsub(mqtt_client_t *client, const char *topico, u8_t qos, mqtt_request_cb_t cb, void *arg, u8_t sub);
+#define mqtt_subscribe(client, topic, qos, cb, arg) mqtt_sub_unsub(client, topic, qos, cb, arg, 1)
+err_t mqtt_publish(mqtt_client_t *client, const char *topico, const void *payload, u16_t n, u8_t qos, u8_t retain,
+                   mqtt_request_cb_t cb, void *arg);
+
+#endif
@@ -0,0 +1,7 @@
+// SDK simulado: sem TLS (client->conn não é usado)
+#ifndef SIM_LWIP_MQTT_PRIV_H
+#define SIM_LWIP_MQTT_PRIV_H
+
+#include "lwip/apps/mqtt.h"
+
+#endif
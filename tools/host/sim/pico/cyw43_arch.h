@@ -0,0 +1,25 @@
+// SDK simulado: CYW43 sempre conectado; a rede é o broker simulado (lwip/apps/mqtt.h)
+#ifndef SIM_PICO_CYW43_ARCH_H
+#define SIM_PICO_CYW43_ARCH_H
+
+#include <stdint.h>
+#include "lwip/apps/mqtt.h"
+
+#define CYW43_AUTH_WPA2_AES_PSK 0x00400004
+#define CYW43_PERFORMANCE_PM    0xa11140
+#define CYW43_DEFAULT_PM        0xa11142
+#define CYW43_AGGRESSIVE_PM     0xa11c82
+
+typedef struct { int itf; } cyw43_t;
+extern cyw43_t cyw43_state;
+
+int cyw43_arch_init(void);
+void cyw43_arch_deinit(void);
+void cyw43_arch_enable_sta_mode(void);
+int cyw43_arch_wifi_connect_timeout_ms(const char *ssid, const char *senha, uint32_t auth, uint32_t timeout_ms);
+void cyw43_arch_poll(void);             // uma volta do loop principal (custo fixo de CPU)
+static inline void cyw43_arch_lwip_begin(void) {}
+static inline void cyw43_arch_lwip_end(void) {}
+int cyw43_wifi_pm(cyw43_t *self, uint32_t modo);
+
+#endif
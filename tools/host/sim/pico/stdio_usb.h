@@ -0,0 +1,9 @@
+// SDK simulado: o "host lendo o CDC" é a opção --log do simulador
+#ifndef SIM_PICO_STDIO_USB_H
+#define SIM_PICO_STDIO_USB_H
+
+#include <stdbool.h>
+
+bool stdio_usb_connected(void);
+
+#endif
@@ -0,0 +1,35 @@
+// SDK simulado (tools/host/painel_sim): subconjunto de pico/stdlib.h usado pelo painel,
+// com relógio virtual em vez do timer do RP2040
+#ifndef SIM_PICO_STDLIB_H
+#define SIM_PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "hardware/gpio.h"
+#include "hardware/timer.h"
+
+#ifndef MIN
+#define MIN(a, b) ((b) < (a) ? (b) : (a))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) < (b) ? (b) : (a))
+#endif
+
+// a imagem "em execução" tem SIM_FIRMWARE_BYTES (main.c mede pelo símbolo do script de ligação)
+#define SIM_FIRMWARE_BYTES (300u * 1024u)
+extern char __flash_binary_end;
+#define XIP_BASE ((uintptr_t)&__flash_binary_end - SIM_FIRMWARE_BYTES)
+
+typedef uint64_t absolute_time_t;       // microssegundos do relógio virtual
+
+absolute_time_t get_absolute_time(void);
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+bool best_effort_wfe_or_timeout(absolute_time_t prazo); // dorme até o prazo ou o próximo evento
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+bool stdio_init_all(void);
+static inline void tight_loop_contents(void) {}
+
+#endif
@@ -0,0 +1,15 @@
+// SDK simulado: o ID da flash vem de --id (um por painel no mesmo broker)
+#ifndef SIM_PICO_UNIQUE_ID_H
+#define SIM_PICO_UNIQUE_ID_H
+
+#include <stdint.h>
+
+#define PICO_UNIQUE_BOARD_ID_SIZE_BYTES 8
+
+typedef struct {
+    uint8_t id[PICO_UNIQUE_BOARD_ID_SIZE_BYTES];
+} pico_unique_board_id_t;
+
+void pico_get_unique_board_id(pico_unique_board_id_t *id_out);
+
+#endif
@@ -0,0 +1,74 @@
+// Núcleo do simulador do painel: relógio virtual, fila de eventos e periféricos emulados
+//
+// sim_sdk.c implementa o SDK do Pico sobre um relógio virtual em microssegundos. O tempo só
+// avança quando o firmware espera (sleep_ms, WFE) ou faz E/S bloqueante (I2C, PIO, flash), e
+// cada volta do loop principal custa SIM_CUSTO_VOLTA_US. Os eventos agendados (entradas do
+// traço, respostas do broker) são entregues nesses avanços, no instante marcado, como IRQs.
+// As saídas (publicações, quadros da matriz e do OLED, GPIOs) são repassadas aos ganchos sim_ao_*,
+// implementados pelo programa que conduz a simulação (tools/host/painel_sim.c).
+//
+// No modo ao vivo (sim_ao_vivo) o relógio segue o relógio de parede e o cliente MQTT fala com um
+// broker real por TCP: cada avanço espera de verdade, atendendo o socket, e o que chega vira IRQ
+// no instante em que chegou. Serve para carga e soak contra o mesmo broker usado pela placa.
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SIM_CUSTO_VOLTA_US    20        // CPU de uma volta do loop principal
+#define SIM_WS2812_PIXEL_US   30        // 24 bits a 800 kHz
+#define SIM_FLASH_APAGAR_US   45000     // apagamento de setor (típico da W25Q16)
+#define SIM_FLASH_PAGINA_US   400       // programação de página
+#define SIM_BROKER_RTT_US     2000      // CONNECT -> CONNACK
+#define SIM_MQTT_PEDACO       512       // payload entregue em pedaços (como os pbufs do lwIP)
+#define SIM_MATRIZ_PIXELS     25
+#define SIM_OLED_LARGURA      128
+#define SIM_OLED_PAGINAS      8
+
+typedef void (*SimAcao)(void *arg);
+
+extern bool sim_log_usb;                // stdio_usb_connected(): o log do firmware é formatado
+
+// relógio e fila de eventos
+uint64_t sim_agora_us(void);
+void sim_agendar(uint64_t quando_us, SimAcao acao, void *arg); // mesmo instante: ordem de agendamento
+void sim_avancar_ate(uint64_t alvo_us, bool interrupcoes); // entrega os eventos vencidos se interrupcoes
+void sim_definir_fim(uint64_t fim_us);  // sim_terminar() é chamado ao alcançar o fim
+
+// entradas (chamadas pelas ações agendadas)
+void sim_gpio_entrada(unsigned pino, bool nivel); // nível do pino; bordas disparam a IRQ
+void sim_adc_definir(uint8_t canal, float bruto); // valor médio lido do canal (0-4095)
+bool sim_mqtt_entregar(const char *topico, const uint8_t *dados, size_t n); // false se não inscrito
+void sim_broker_disponivel(bool disponivel); // queda/volta do broker
+bool sim_http_comando(int tipo, const char *valor); // como /comando.cgi
+bool sim_udp_comando(int tipo, int valor); // como um lote de um comando
+void sim_definir_id_placa(uint64_t id); // pico_get_unique_board_id() (antes do boot)
+
+// modo ao vivo (chamar antes do main() do firmware)
+bool sim_ao_vivo(const char *host, uint16_t porta); // false se o endereço não resolve
+void sim_interromper(void);             // seguro num tratador de sinal: sim_terminar() na próxima espera
+
+// cliente MQTT: pedidos sem resposta limitados a MQTT_REQ_MAX_IN_FLIGHT, como no lwIP
+typedef struct {
+    unsigned long conexoes;             // CONNACK aceitos
+    unsigned long quedas;               // conexões perdidas (broker, keep-alive, socket)
+    unsigned long publicacoes;          // PUBLISH aceitos pelo cliente
+    unsigned long recusados;            // publicações e inscrições recusadas com ERR_MEM
+    unsigned long recebidas;            // mensagens entregues ao firmware
+} SimMqttContadores;
+const SimMqttContadores *sim_mqtt_contadores(void);
+
+// ganchos implementados pelo condutor da simulação
+void sim_ao_pronto(void);               // primeira volta do loop principal
+void sim_ao_publicar(const char *topico, const uint8_t *dados, size_t n, bool retido);
+void sim_ao_quadro_matriz(const uint32_t grb[SIM_MATRIZ_PIXELS]); // ordem da cadeia, 0x00GGRRBB
+void sim_ao_quadro_oled(const uint8_t gram[SIM_OLED_LARGURA * SIM_OLED_PAGINAS], bool ligado, uint8_t contraste);
+void sim_ao_gpio(unsigned pino, bool nivel); // mudança de uma saída
+void sim_ao_pwm(unsigned pino, uint16_t nivel); // mudança do nível PWM de um pino
+void sim_ao_reinicio(const char *motivo); // troca de slots ou watchdog: o boot seguinte não é simulado
+void sim_terminar(void);                // não retorna
+
+#endif
@@ -0,0 +1,1002 @@
+// SDK do Pico simulado sobre um relógio virtual ou, ao vivo, o relógio de parede (ver sim.h)
+// Substitui também os módulos de lib/ que falam direto com o hardware: amostragem do ADC,
+// flash, servidor HTTP e canal UDP.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "sim.h"
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "pico/unique_id.h"
+#include "pico/cyw43_arch.h"
+#include "hardware/gpio.h"
+#include "hardware/i2c.h"
+#include "hardware/spi.h"
+#include "hardware/pio.h"
+#include "hardware/watchdog.h"
+#include "lwip/apps/mqtt.h"
+#include "adc_amostragem.h"
+#include "flash_mapa.h"
+#include "flash_pico.h"
+#include "http_painel.h"
+#include "udp_comando.h"
+
+#define SIM_GPIOS      30
+#define SIM_OLED_ENDERECO 0x3C
+#define SIM_INSCRICOES 16
+
+bool sim_log_usb = false;
+
+// ---------------------------------------------------------------------------------------------
+// relógio virtual e fila de eventos (heap mínimo por instante, desempate pela ordem de agendamento)
+
+typedef struct {
+    uint64_t quando;
+    uint64_t ordem;
+    SimAcao acao;
+    void *arg;
+} SimEvento;
+
+static uint64_t agora_us;
+static uint64_t fim_us = UINT64_MAX;
+static SimEvento *fila;
+static size_t fila_n, fila_capacidade;
+static uint64_t fila_ordem;
+static bool ao_vivo;                    // relógio de parede e broker real (sim_ao_vivo)
+static uint64_t rede_esperar(uint64_t ate_us);
+
+static bool evento_antes(const SimEvento *a, const SimEvento *b) {
+    return a->quando != b->quando ? a->quando < b->quando : a->ordem < b->ordem;
+}
+
+void sim_agendar(uint64_t quando_us, SimAcao acao, void *arg) {
+    if (fila_n == fila_capacidade) {
+        fila_capacidade = fila_capacidade ? 2 * fila_capacidade : 64;
+        fila = realloc(fila, fila_capacidade * sizeof(*fila));
+        if (!fila) abort();
+    }
+    size_t i = fila_n++;
+    fila[i] = (SimEvento){ quando_us, fila_ordem++, acao, arg };
+    while (i > 0 && evento_antes(&fila[i], &fila[(i - 1) / 2])) { // sobe
+        SimEvento t = fila[i];
+        fila[i] = fila[(i - 1) / 2];
+        fila[(i - 1) / 2] = t;
+        i = (i - 1) / 2;
+    }
+}
+
+static SimEvento retirar_evento(void) {
+    SimEvento primeiro = fila[0];
+    fila[0] = fila[--fila_n];
+    for (size_t i = 0;;) {              // desce
+        size_t menor = i, e = 2 * i + 1, d = 2 * i + 2;
+        if (e < fila_n && evento_antes(&fila[e], &fila[menor])) menor = e;
+        if (d < fila_n && evento_antes(&fila[d], &fila[menor])) menor = d;
+        if (menor == i) break;
+        SimEvento t = fila[i];
+        fila[i] = fila[menor];
+        fila[menor] = t;
+        i = menor;
+    }
+    return primeiro;
+}
+
+uint64_t sim_agora_us(void) {
+    return agora_us;
+}
+
+void sim_definir_fim(uint64_t fim) {
+    fim_us = fim;
+}
+
+// avança o relógio; com interrupções, cada evento vencido roda no seu instante (como uma IRQ).
+// Sem interrupções (flash com o XIP desligado), os eventos esperam o próximo avanço.
+// Ao vivo, o alvo é alcançado no relógio de parede e o que chega do broker no caminho é entregue.
+void sim_avancar_ate(uint64_t alvo_us, bool interrupcoes) {
+    uint64_t ate;
+    do {
+        ate = ao_vivo ? rede_esperar(alvo_us) : alvo_us;
+        while (interrupcoes && fila_n && fila[0].quando <= ate) {
+            SimEvento e = retirar_evento();
+            if (e.quando > agora_us) agora_us = e.quando;
+            if (agora_us >= fim_us) sim_terminar();
+            e.acao(e.arg);
+        }
+        if (ate > agora_us) agora_us = ate;
+        if (agora_us >= fim_us) sim_terminar();
+    } while (ate < alvo_us);
+}
+
+// ---------------------------------------------------------------------------------------------
+// tempo
+
+absolute_time_t get_absolute_time(void) {
+    return agora_us;
+}
+
+uint64_t time_us_64(void) {
+    return agora_us;
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return agora_us + (uint64_t)ms * 1000;
+}
+
+bool best_effort_wfe_or_timeout(absolute_time_t prazo) {
+    while (ao_vivo && !(fila_n && fila[0].quando <= prazo)) { // ao vivo: dorme até o prazo ou até o broker mandar algo
+        if (rede_esperar(prazo) >= prazo) break;
+    }
+    if (fila_n && fila[0].quando <= prazo) { // acorda com a próxima interrupção
+        sim_avancar_ate(fila[0].quando, true);
+        return false;
+    }
+    sim_avancar_ate(prazo, true);
+    return true;
+}
+
+void sleep_ms(uint32_t ms) {
+    sim_avancar_ate(agora_us + (uint64_t)ms * 1000, true);
+}
+
+void sleep_us(uint64_t us) {
+    sim_avancar_ate(agora_us + us, true);
+}
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+bool stdio_usb_connected(void) {
+    return sim_log_usb;
+}
+
+// ---------------------------------------------------------------------------------------------
+// GPIO (entradas com pull-up ficam em 1 até o traço pressionar o botão)
+
+static bool gpio_nivel[SIM_GPIOS];
+static bool gpio_saida[SIM_GPIOS];
+static uint32_t gpio_irq[SIM_GPIOS];
+static gpio_irq_callback_t gpio_callback;
+
+void gpio_init(uint gpio) {
+    if (gpio >= SIM_GPIOS) return;
+    gpio_nivel[gpio] = false;
+    gpio_saida[gpio] = false;
+}
+
+void gpio_set_dir(uint gpio, bool saida) {
+    if (gpio < SIM_GPIOS) gpio_saida[gpio] = saida;
+}
+
+void gpio_put(uint gpio, bool valor) {
+    if (gpio >= SIM_GPIOS || gpio_nivel[gpio] == valor) return;
+    gpio_nivel[gpio] = valor;
+    if (gpio_saida[gpio]) sim_ao_gpio(gpio, valor);
+}
+
+bool gpio_get(uint gpio) {
+    return gpio < SIM_GPIOS && gpio_nivel[gpio];
+}
+
+void gpio_pull_up(uint gpio) {
+    if (gpio < SIM_GPIOS && !gpio_saida[gpio]) gpio_nivel[gpio] = true;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function funcao) {
+    (void)gpio;
+    (void)funcao;
+}
+
+static uint16_t pwm_nivel[SIM_GPIOS];
+
+void pwm_set_gpio_level(uint gpio, uint16_t nivel) {
+    if (gpio >= SIM_GPIOS || pwm_nivel[gpio] == nivel) return;
+    pwm_nivel[gpio] = nivel;
+    sim_ao_pwm(gpio, nivel);
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t eventos, bool habilitado) {
+    if (gpio >= SIM_GPIOS) return;
+    if (habilitado) gpio_irq[gpio] |= eventos;
+    else gpio_irq[gpio] &= ~eventos;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t eventos, bool habilitado, gpio_irq_callback_t callback) {
+    gpio_callback = callback;
+    gpio_set_irq_enabled(gpio, eventos, habilitado);
+}
+
+void sim_gpio_entrada(unsigned pino, bool nivel) {
+    if (pino >= SIM_GPIOS || gpio_nivel[pino] == nivel) return;
+    gpio_nivel[pino] = nivel;
+    uint32_t borda = nivel ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    if ((gpio_irq[pino] & borda) && gpio_callback) gpio_callback(pino, borda);
+}
+
+// ---------------------------------------------------------------------------------------------
+// I2C com um SSD1306 em 0x3C: comandos e GRAM emulados (modos de endereçamento horizontal,
+// vertical e por página), um quadro a cada escrita que muda o que aparece na tela
+
+struct i2c_inst { uint baudrate; };
+static struct i2c_inst i2c_instancias[2] = { { 100000 }, { 100000 } };
+i2c_inst_t *const i2c0 = &i2c_instancias[0];
+i2c_inst_t *const i2c1 = &i2c_instancias[1];
+
+static struct {
+    uint8_t gram[SIM_OLED_LARGURA * SIM_OLED_PAGINAS];
+    bool ligado;
+    uint8_t contraste;
+    uint8_t modo;                       // 0 horizontal, 1 vertical, 2 página
+    uint8_t coluna_inicio, coluna_fim, pagina_inicio, pagina_fim;
+    uint8_t coluna, pagina;
+    uint8_t comando;                    // comando aguardando argumentos
+    uint8_t faltam;
+    uint8_t argumentos[2];
+    uint8_t recebidos;
+} oled = { .contraste = 0x7F, .modo = 2, .coluna_fim = SIM_OLED_LARGURA - 1, .pagina_fim = SIM_OLED_PAGINAS - 1 };
+
+static void oled_aplicar(uint8_t comando, const uint8_t *a) {
+    switch (comando) {
+        case 0x20: oled.modo = a[0] & 0x03; break;
+        case 0x21:
+            oled.coluna_inicio = oled.coluna = a[0] & 0x7F;
+            oled.coluna_fim = a[1] & 0x7F;
+            break;
+        case 0x22:
+            oled.pagina_inicio = oled.pagina = a[0] & 0x07;
+            oled.pagina_fim = a[1] & 0x07;
+            break;
+        case 0x81: oled.contraste = a[0]; break;
+        default: break;                 // multiplex, clock, pré-carga, bomba de carga: sem efeito na imagem
+    }
+}
+
+static void oled_comando(uint8_t b) {
+    if (oled.faltam) {
+        oled.argumentos[oled.recebidos++] = b;
+        if (--oled.faltam == 0) oled_aplicar(oled.comando, oled.argumentos);
+        return;
+    }
+    switch (b) {
+        case 0xAE: case 0xAF: oled.ligado = b & 1; return;
+        case 0x21: case 0x22: oled.faltam = 2; break;
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            oled.faltam = 1;
+            break;
+        default: return;
+    }
+    oled.comando = b;
+    oled.recebidos = 0;
+}
+
+static void oled_dado(uint8_t b) {
+    oled.gram[oled.pagina * SIM_OLED_LARGURA + oled.coluna] = b;
+    if (oled.modo == 1) {               // vertical: desce a página, depois a coluna
+        if (oled.pagina++ >= oled.pagina_fim) {
+            oled.pagina = oled.pagina_inicio;
+            if (oled.coluna++ >= oled.coluna_fim) oled.coluna = oled.coluna_inicio;
+        }
+    } else if (oled.coluna++ >= oled.coluna_fim) {
+        oled.coluna = oled.coluna_inicio;
+        if (oled.modo == 0 && oled.pagina++ >= oled.pagina_fim) oled.pagina = oled.pagina_inicio;
+    }
+}
+
+// byte de controle: Co (bit 7) = só o próximo byte; D/C (bit 6) = dados da GRAM
+static void oled_escrever(const uint8_t *dados, size_t n) {
+    bool ligado = oled.ligado;
+    uint8_t contraste = oled.contraste;
+    bool gram = false;
+    for (size_t i = 0; i < n;) {
+        uint8_t controle = dados[i++];
+        size_t fim = controle & 0x80 ? (i < n ? i + 1 : i) : n;
+        for (; i < fim; i++) {
+            if (controle & 0x40) {
+                oled_dado(dados[i]);
+                gram = true;
+            } else {
+                oled_comando(dados[i]);
+            }
+        }
+    }
+    if (gram || ligado != oled.ligado || contraste != oled.contraste) {
+        sim_ao_quadro_oled(oled.gram, oled.ligado, oled.contraste);
+    }
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+static void i2c_transferir(i2c_inst_t *i2c, size_t n) { // endereço + n bytes, 9 bits cada
+    sim_avancar_ate(agora_us + (uint64_t)(n + 1) * 9 * 1000000 / i2c->baudrate, true);
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t endereco, const uint8_t *dados, size_t n, bool sem_stop) {
+    (void)sem_stop;
+    i2c_transferir(i2c, endereco == SIM_OLED_ENDERECO ? n : 0);
+    if (endereco != SIM_OLED_ENDERECO) return -2; // PICO_ERROR_GENERIC: sem ACK
+    oled_escrever(dados, n);
+    return (int)n;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t endereco, uint8_t *dados, size_t n, bool sem_stop) {
+    (void)endereco;
+    (void)dados;
+    (void)n;
+    (void)sem_stop;
+    i2c_transferir(i2c, 0);
+    return -2;
+}
+
+// SPI: só o tempo no barramento (o OLED emulado está no I2C; -DOLED_DRIVER=ssd1306_spi não aparece nos quadros)
+struct spi_inst { uint baudrate; };
+static struct spi_inst spi_instancias[2] = { { 1000000 }, { 1000000 } };
+spi_inst_t *const spi0 = &spi_instancias[0];
+spi_inst_t *const spi1 = &spi_instancias[1];
+
+uint spi_init(spi_inst_t *spi, uint baudrate) {
+    spi->baudrate = baudrate;
+    return baudrate;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *dados, size_t n) {
+    (void)dados;
+    sim_avancar_ate(agora_us + (uint64_t)n * 8 * 1000000 / spi->baudrate, true);
+    return (int)n;
+}
+
+// ---------------------------------------------------------------------------------------------
+// PIO: cada palavra é um pixel GRB (24 bits altos) da cadeia de 25 WS2812
+
+struct pio_hw { int unused; };
+static struct pio_hw pio_instancia;
+PIO const pio0 = &pio_instancia;
+
+static uint32_t matriz[SIM_MATRIZ_PIXELS];
+static int matriz_n;
+
+uint pio_add_program(PIO pio, const pio_program_t *programa) {
+    (void)pio;
+    (void)programa;
+    return 0;
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t dado) {
+    (void)pio;
+    (void)sm;
+    sim_avancar_ate(agora_us + SIM_WS2812_PIXEL_US, true);
+    matriz[matriz_n++] = dado >> 8;
+    if (matriz_n == SIM_MATRIZ_PIXELS) { // pausa de reset: a cadeia mostra o quadro
+        matriz_n = 0;
+        sim_ao_quadro_matriz(matriz);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// watchdog e CYW43
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t atraso_ms) {
+    (void)pc;
+    (void)sp;
+    (void)atraso_ms;
+    sim_ao_reinicio("watchdog");
+    sim_terminar();
+}
+
+cyw43_t cyw43_state;
+static bool pronto;
+
+int cyw43_arch_init(void) {
+    return 0;
+}
+
+void cyw43_arch_deinit(void) {
+}
+
+void cyw43_arch_enable_sta_mode(void) {
+}
+
+int cyw43_arch_wifi_connect_timeout_ms(const char *ssid, const char *senha, uint32_t auth, uint32_t timeout_ms) {
+    (void)ssid;
+    (void)senha;
+    (void)auth;
+    (void)timeout_ms;
+    return 0;
+}
+
+void cyw43_arch_poll(void) {
+    if (!pronto) {                      // primeira volta do loop principal: boot concluído
+        pronto = true;
+        sim_ao_pronto();
+    }
+    sim_avancar_ate(agora_us + SIM_CUSTO_VOLTA_US, true);
+}
+
+int cyw43_wifi_pm(cyw43_t *self, uint32_t modo) {
+    (void)self;
+    (void)modo;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------------
+// broker MQTT: aceita a conexão após SIM_BROKER_RTT_US, entrega mensagens inscritas e grava as
+// publicações; cada inscrição e publicação ocupa um dos MQTT_REQ_MAX_IN_FLIGHT pedidos do cliente
+// até o SUBACK/PUBACK, um RTT depois (como no lwIP, sem pedido livre a chamada falha com ERR_MEM).
+// No modo ao vivo o mesmo cliente fala MQTT 3.1.1 com um broker real por TCP.
+
+static struct netif interface = { { 0x9600A8C0 } }; // 192.168.0.150
+struct netif *netif_default = &interface;
+
+int ipaddr_aton(const char *texto, ip_addr_t *ip) {
+    unsigned a, b, c, d;
+    if (sscanf(texto, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255) return 0;
+    ip->addr = a | b << 8 | c << 16 | (uint32_t)d << 24;
+    return 1;
+}
+
+char *ipaddr_ntoa(const ip_addr_t *ip) {
+    static char texto[16];
+    snprintf(texto, sizeof(texto), "%u.%u.%u.%u", (unsigned)(ip->addr & 0xFF), (unsigned)(ip->addr >> 8 & 0xFF),
+             (unsigned)(ip->addr >> 16 & 0xFF), (unsigned)(ip->addr >> 24));
+    return texto;
+}
+
+typedef enum { MQTT_SIM_DESCONECTADO, MQTT_SIM_CONECTANDO, MQTT_SIM_CONECTADO } MqttSimEstado;
+
+typedef struct {
+    u16_t id;                           // 0: livre
+    mqtt_request_cb_t cb;
+    void *arg;
+} MqttSimPedido;
+
+struct mqtt_client_s {
+    MqttSimEstado estado;
+    mqtt_connection_cb_t conexao_cb;
+    void *conexao_arg;
+    mqtt_incoming_publish_cb_t publicacao_cb;
+    mqtt_incoming_data_cb_t dados_cb;
+    void *entrada_arg;
+    char inscricoes[SIM_INSCRICOES][64];
+    int n_inscricoes;
+    MqttSimPedido pedidos[MQTT_REQ_MAX_IN_FLIGHT];
+    u16_t keep_alive;
+};
+
+static struct mqtt_client_s cliente;
+static bool broker_disponivel = true;
+static u16_t proximo_id;                // identificador de pacote (sobrevive às reconexões)
+static SimMqttContadores contadores;
+
+const SimMqttContadores *sim_mqtt_contadores(void) {
+    return &contadores;
+}
+
+mqtt_client_t *mqtt_client_new(void) {
+    return &cliente;
+}
+
+static void mqtt_perder_conexao(mqtt_connection_status_t motivo);
+static void conexao_perdida(void *arg);
+
+// reserva um pedido; 0 se todos estão esperando resposta
+static u16_t pedido_reservar(mqtt_client_t *c, mqtt_request_cb_t cb, void *arg) {
+    for (int i = 0; i < MQTT_REQ_MAX_IN_FLIGHT; i++) {
+        if (c->pedidos[i].id) continue;
+        if (++proximo_id == 0) proximo_id = 1;
+        c->pedidos[i] = (MqttSimPedido){ proximo_id, cb, arg };
+        return proximo_id;
+    }
+    contadores.recusados++;
+    return 0;
+}
+
+// SUBACK/PUBACK: libera o pedido e avisa quem o fez (como mqtt_take_request + cb do lwIP)
+static void pedido_concluir(u16_t id) {
+    for (int i = 0; i < MQTT_REQ_MAX_IN_FLIGHT; i++) {
+        if (cliente.pedidos[i].id != id) continue;
+        MqttSimPedido p = cliente.pedidos[i];
+        cliente.pedidos[i].id = 0;
+        if (p.cb) p.cb(p.arg, ERR_OK);
+        return;
+    }
+}
+
+static void pedido_respondido(void *arg) {  // broker simulado: resposta um RTT depois
+    if (cliente.estado == MQTT_SIM_CONECTADO) pedido_concluir((u16_t)(uintptr_t)arg);
+}
+
+// ---- transporte TCP do modo ao vivo ----
+
+static struct sockaddr_storage broker_endereco;
+static socklen_t broker_endereco_n;
+static int rede = -1;                   // socket do broker real
+static uint8_t *entrada;                // bytes recebidos ainda não processados
+static size_t entrada_n, entrada_capacidade;
+static uint64_t ultimo_envio_us, ultima_recepcao_us;
+static uint64_t parede_inicio_ns;
+static volatile sig_atomic_t interrompido;
+
+static uint64_t parede_us(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec - parede_inicio_ns) / 1000;
+}
+
+bool sim_ao_vivo(const char *host, uint16_t porta) {
+    char servico[8];
+    struct addrinfo dicas = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM }, *resultado;
+    snprintf(servico, sizeof(servico), "%u", porta);
+    if (getaddrinfo(host, servico, &dicas, &resultado) != 0) return false;
+    memcpy(&broker_endereco, resultado->ai_addr, resultado->ai_addrlen);
+    broker_endereco_n = resultado->ai_addrlen;
+    freeaddrinfo(resultado);
+    ao_vivo = true;
+    parede_inicio_ns = 0;
+    parede_inicio_ns = parede_us() * 1000; // relógio virtual e de parede começam juntos
+    agora_us = 0;
+    signal(SIGPIPE, SIG_IGN);
+    return true;
+}
+
+void sim_interromper(void) {
+    interrompido = 1;
+}
+
+static void rede_fechar(void) {
+    if (rede >= 0) close(rede);
+    rede = -1;
+    entrada_n = 0;
+}
+
+static bool rede_enviar(const uint8_t *dados, size_t n) {
+    while (n) {
+        ssize_t enviado = send(rede, dados, n, 0);
+        if (enviado <= 0) return false;
+        dados += enviado;
+        n -= (size_t)enviado;
+    }
+    ultimo_envio_us = parede_us();
+    return true;
+}
+
+// monta e envia um pacote: cabeçalho fixo, comprimento restante (1 a 4 bytes) e corpo
+static bool rede_pacote(uint8_t tipo, const uint8_t *corpo, size_t n) {
+    if (rede < 0) return false;
+    uint8_t *pacote = malloc(n + 5);
+    if (!pacote) abort();
+    size_t k = 0, resto = n;
+    pacote[k++] = tipo;
+    do {
+        pacote[k] = resto & 0x7F;
+        resto >>= 7;
+        pacote[k++] |= resto ? 0x80 : 0;
+    } while (resto);
+    memcpy(pacote + k, corpo, n);
+    bool ok = rede_enviar(pacote, k + n);
+    free(pacote);
+    if (!ok) {                          // o lwIP avisa a queda depois, pelo callback de erro do TCP
+        rede_fechar();
+        sim_agendar(agora_us, conexao_perdida, (void *)(uintptr_t)MQTT_CONNECT_DISCONNECTED);
+    }
+    return ok;
+}
+
+static size_t campo(uint8_t *destino, const void *dados, size_t n) { // cadeia com 2 bytes de comprimento
+    destino[0] = (uint8_t)(n >> 8);
+    destino[1] = (uint8_t)n;
+    memcpy(destino + 2, dados, n);
+    return n + 2;
+}
+
+static bool rede_conectar(const struct mqtt_connect_client_info_t *info) {
+    rede = socket(broker_endereco.ss_family, SOCK_STREAM, 0);
+    if (rede < 0 || connect(rede, (struct sockaddr *)&broker_endereco, broker_endereco_n) != 0) {
+        rede_fechar();
+        return false;
+    }
+    int um = 1;
+    setsockopt(rede, IPPROTO_TCP, TCP_NODELAY, &um, sizeof(um)); // como o lwIP: sem Nagle no MQTT
+    const char *id = info->client_id ? info->client_id : "";
+    size_t n = 10 + 2 + strlen(id);
+    uint8_t opcoes = 0x02;              // sessão limpa
+    if (info->will_topic) {
+        opcoes |= 0x04 | (uint8_t)(info->will_qos << 3) | (info->will_retain ? 0x20 : 0);
+        n += 4 + strlen(info->will_topic) + strlen(info->will_msg);
+    }
+    if (info->client_user && info->client_user[0]) {
+        opcoes |= 0x80;
+        n += 2 + strlen(info->client_user);
+        if (info->client_pass) {
+            opcoes |= 0x40;
+            n += 2 + strlen(info->client_pass);
+        }
+    }
+    uint8_t *corpo = malloc(n);
+    if (!corpo) abort();
+    size_t k = campo(corpo, "MQTT", 4);
+    corpo[k++] = 4;                     // MQTT 3.1.1
+    corpo[k++] = opcoes;
+    corpo[k++] = (uint8_t)(info->keep_alive >> 8);
+    corpo[k++] = (uint8_t)info->keep_alive;
+    k += campo(corpo + k, id, strlen(id));
+    if (opcoes & 0x04) {
+        k += campo(corpo + k, info->will_topic, strlen(info->will_topic));
+        k += campo(corpo + k, info->will_msg, strlen(info->will_msg));
+    }
+    if (opcoes & 0x80) k += campo(corpo + k, info->client_user, strlen(info->client_user));
+    if (opcoes & 0x40) k += campo(corpo + k, info->client_pass, strlen(info->client_pass));
+    ultima_recepcao_us = parede_us();
+    bool ok = rede_pacote(0x10, corpo, k);
+    free(corpo);
+    return ok;
+}
+
+// ---- cliente (mesma interface do lwIP) ----
+
+static void mqtt_concluir_conexao(void *arg) {
+    mqtt_client_t *c = arg;
+    if (c->estado != MQTT_SIM_CONECTANDO) return;
+    c->estado = broker_disponivel ? MQTT_SIM_CONECTADO : MQTT_SIM_DESCONECTADO;
+    if (broker_disponivel) contadores.conexoes++;
+    c->conexao_cb(c, c->conexao_arg, broker_disponivel ? MQTT_CONNECT_ACCEPTED : MQTT_CONNECT_DISCONNECTED);
+}
+
+static void mqtt_recusar_conexao(void *arg) {  // ao vivo: TCP recusado ou CONNACK com erro
+    mqtt_client_t *c = arg;
+    if (c->estado != MQTT_SIM_CONECTANDO) return;
+    c->estado = MQTT_SIM_DESCONECTADO;
+    c->conexao_cb(c, c->conexao_arg, MQTT_CONNECT_DISCONNECTED);
+}
+
+// queda da conexão: os pedidos pendentes são descartados sem callback (mqtt_close do lwIP)
+static void mqtt_perder_conexao(mqtt_connection_status_t motivo) {
+    rede_fechar();
+    if (cliente.estado == MQTT_SIM_DESCONECTADO) return;
+    bool conectado = cliente.estado == MQTT_SIM_CONECTADO;
+    cliente.estado = MQTT_SIM_DESCONECTADO;
+    memset(cliente.pedidos, 0, sizeof(cliente.pedidos));
+    if (conectado) contadores.quedas++;
+    cliente.conexao_cb(&cliente, cliente.conexao_arg, motivo);
+}
+
+err_t mqtt_client_connect(mqtt_client_t *c, const ip_addr_t *ip, u16_t porta, mqtt_connection_cb_t cb,
+                          void *arg, const struct mqtt_connect_client_info_t *info) {
+    (void)ip;
+    (void)porta;
+    if (c->estado != MQTT_SIM_DESCONECTADO) return -10; // ERR_ISCONN
+    memset(c, 0, sizeof(*c));           // como no lwIP: connect zera o cliente
+    c->estado = MQTT_SIM_CONECTANDO;
+    c->conexao_cb = cb;
+    c->conexao_arg = arg;
+    c->keep_alive = info->keep_alive;
+    if (!ao_vivo) {
+        sim_agendar(agora_us + SIM_BROKER_RTT_US, mqtt_concluir_conexao, c);
+    } else if (!broker_disponivel || !rede_conectar(info)) { // o lwIP avisa a falha do TCP pelo callback
+        sim_agendar(agora_us, mqtt_recusar_conexao, c);
+    }
+    return ERR_OK;
+}
+
+void mqtt_set_inpub_callback(mqtt_client_t *c, mqtt_incoming_publish_cb_t pub_cb, mqtt_incoming_data_cb_t data_cb, void *arg) {
+    c->publicacao_cb = pub_cb;
+    c->dados_cb = data_cb;
+    c->entrada_arg = arg;
+}
+
+err_t mqtt_sub_unsub(mqtt_client_t *c, const char *topico, u8_t qos, mqtt_request_cb_t cb, void *arg, u8_t sub) {
+    if (c->estado != MQTT_SIM_CONECTADO) return ERR_CONN;
+    u16_t id = pedido_reservar(c, cb, arg);
+    if (!id) return ERR_MEM;
+    if (sub && c->n_inscricoes < SIM_INSCRICOES) {
+        snprintf(c->inscricoes[c->n_inscricoes++], sizeof(c->inscricoes[0]), "%s", topico);
+    }
+    if (!ao_vivo) {
+        sim_agendar(agora_us + SIM_BROKER_RTT_US, pedido_respondido, (void *)(uintptr_t)id);
+        return ERR_OK;
+    }
+    size_t n = strlen(topico);
+    uint8_t *corpo = malloc(n + 5);
+    if (!corpo) abort();
+    corpo[0] = (uint8_t)(id >> 8);
+    corpo[1] = (uint8_t)id;
+    campo(corpo + 2, topico, n);
+    corpo[n + 4] = qos;
+    size_t tamanho = sub ? n + 5 : n + 4; // UNSUBSCRIBE não leva QoS
+    rede_pacote(sub ? 0x82 : 0xA2, corpo, tamanho);
+    free(corpo);
+    return ERR_OK;
+}
+
+err_t mqtt_publish(mqtt_client_t *c, const char *topico, const void *payload, u16_t n, u8_t qos, u8_t retain,
+                   mqtt_request_cb_t cb, void *arg) {
+    if (c->estado != MQTT_SIM_CONECTADO) return ERR_CONN;
+    u16_t id = pedido_reservar(c, cb, arg); // QoS 0 também ocupa um pedido até o envio no lwIP
+    if (!id) return ERR_MEM;
+    contadores.publicacoes++;
+    sim_ao_publicar(topico, payload, n, retain);
+    if (!ao_vivo) {
+        sim_agendar(agora_us + SIM_BROKER_RTT_US, pedido_respondido, (void *)(uintptr_t)id);
+        return ERR_OK;
+    }
+    size_t t = strlen(topico);
+    uint8_t *corpo = malloc(t + 4 + n);
+    if (!corpo) abort();
+    size_t k = campo(corpo, topico, t);
+    if (qos) {
+        corpo[k++] = (uint8_t)(id >> 8);
+        corpo[k++] = (uint8_t)id;
+    }
+    memcpy(corpo + k, payload, n);
+    bool enviado = rede_pacote((uint8_t)(0x30 | qos << 1 | (retain ? 1 : 0)), corpo, k + n);
+    free(corpo);
+    if (enviado && !qos) pedido_concluir(id); // sem PUBACK: livre assim que sai
+    return ERR_OK;
+}
+
+// filtro de inscrição com os curingas '+' (um nível) e '#' (o resto)
+static bool filtro_aceita(const char *filtro, const char *topico) {
+    while (*filtro) {
+        if (filtro[0] == '#') return true;
+        if (filtro[0] == '+') {
+            while (*topico && *topico != '/') topico++;
+            filtro++;
+        } else if (*filtro++ != *topico++) {
+            return false;
+        }
+    }
+    return *topico == '\0';
+}
+
+bool sim_mqtt_entregar(const char *topico, const uint8_t *dados, size_t n) {
+    if (cliente.estado != MQTT_SIM_CONECTADO || !cliente.publicacao_cb) return false;
+    bool inscrito = false;
+    for (int i = 0; i < cliente.n_inscricoes && !inscrito; i++) inscrito = filtro_aceita(cliente.inscricoes[i], topico);
+    if (!inscrito) return false;
+    contadores.recebidas++;
+    cliente.publicacao_cb(cliente.entrada_arg, topico, (u32_t)n);
+    size_t enviado = 0;
+    do {                                // pedaços como os pbufs do lwIP; o último leva MQTT_DATA_FLAG_LAST
+        size_t parte = n - enviado > SIM_MQTT_PEDACO ? SIM_MQTT_PEDACO : n - enviado;
+        cliente.dados_cb(cliente.entrada_arg, dados + enviado, (u16_t)parte,
+                         enviado + parte == n ? MQTT_DATA_FLAG_LAST : 0);
+        enviado += parte;
+    } while (enviado < n);
+    return true;
+}
+
+void sim_broker_disponivel(bool disponivel) {
+    broker_disponivel = disponivel;
+    if (!disponivel) mqtt_perder_conexao(MQTT_CONNECT_DISCONNECTED); // ao vivo: derruba o TCP (o broker publica o testamento)
+}
+
+// ---- recepção do modo ao vivo: cada pacote vira uma IRQ no instante em que chegou ----
+
+typedef struct {
+    char *topico;
+    uint8_t *dados;
+    size_t n;
+} MqttSimMensagem;
+
+static void entregar_mensagem(void *arg) {
+    MqttSimMensagem *m = arg;
+    sim_mqtt_entregar(m->topico, m->dados, m->n);
+    free(m->topico);
+    free(m->dados);
+    free(m);
+}
+
+static void conexao_aceita(void *arg) {
+    (void)arg;
+    mqtt_concluir_conexao(&cliente);
+}
+
+static void conexao_recusada(void *arg) {
+    (void)arg;
+    rede_fechar();
+    mqtt_recusar_conexao(&cliente);
+}
+
+static void conexao_perdida(void *arg) {
+    mqtt_perder_conexao((mqtt_connection_status_t)(uintptr_t)arg);
+}
+
+// trata um pacote completo; true se agendou algo para o firmware
+static bool rede_tratar(uint8_t tipo, const uint8_t *corpo, size_t n, uint64_t quando) {
+    switch (tipo >> 4) {
+        case 2:                         // CONNACK
+            sim_agendar(quando, n >= 2 && corpo[1] == 0 ? conexao_aceita : conexao_recusada, NULL);
+            return true;
+        case 3: {                       // PUBLISH
+            if (n < 2) return false;
+            size_t t = (size_t)corpo[0] << 8 | corpo[1], k = 2 + t;
+            uint8_t qos = tipo >> 1 & 3;
+            if (k + (qos ? 2 : 0) > n) return false;
+            MqttSimMensagem *m = malloc(sizeof(*m));
+            if (!m) abort();
+            m->topico = malloc(t + 1);
+            if (!m->topico) abort();
+            memcpy(m->topico, corpo + 2, t);
+            m->topico[t] = '\0';
+            if (qos) {                  // o lwIP responde o PUBACK ao receber
+                rede_pacote(0x40, corpo + k, 2);
+                k += 2;
+            }
+            m->n = n - k;
+            m->dados = malloc(m->n ? m->n : 1);
+            if (!m->dados) abort();
+            memcpy(m->dados, corpo + k, m->n);
+            sim_agendar(quando, entregar_mensagem, m);
+            return true;
+        }
+        case 4: case 9: case 11:        // PUBACK, SUBACK, UNSUBACK
+            if (n < 2) return false;
+            sim_agendar(quando, pedido_respondido, (void *)(uintptr_t)(corpo[0] << 8 | corpo[1]));
+            return true;
+        default:                        // PINGRESP
+            return false;
+    }
+}
+
+static bool rede_receber(uint64_t quando) {
+    if (entrada_capacidade - entrada_n < 4096) {
+        entrada_capacidade = entrada_capacidade ? 2 * entrada_capacidade : 8192;
+        entrada = realloc(entrada, entrada_capacidade);
+        if (!entrada) abort();
+    }
+    ssize_t lidos = recv(rede, entrada + entrada_n, entrada_capacidade - entrada_n, 0);
+    if (lidos <= 0) {
+        rede_fechar();
+        sim_agendar(quando, conexao_perdida, (void *)(uintptr_t)MQTT_CONNECT_DISCONNECTED);
+        return true;
+    }
+    entrada_n += (size_t)lidos;
+    ultima_recepcao_us = quando;
+    bool agendou = false;
+    size_t k = 0;
+    for (;;) {                          // pacotes completos no buffer
+        size_t resto = 0, i = k + 1;
+        int deslocamento = 0;
+        do {
+            if (i >= entrada_n) goto incompleto;
+            resto |= (size_t)(entrada[i] & 0x7F) << deslocamento;
+            deslocamento += 7;
+        } while (entrada[i++] & 0x80);
+        if (entrada_n - i < resto) goto incompleto;
+        agendou |= rede_tratar(entrada[k], entrada + i, resto, quando);
+        k = i + resto;
+    }
+incompleto:
+    memmove(entrada, entrada + k, entrada_n - k);
+    entrada_n -= k;
+    return agendou;
+}
+
+// keep-alive como o mqtt_cyclic_timer do lwIP: PINGREQ após keep_alive sem enviar, queda após
+// 1,5 x keep_alive sem receber nada do broker
+static bool rede_manter(uint64_t agora) {
+    if (rede < 0 || cliente.estado != MQTT_SIM_CONECTADO || !cliente.keep_alive) return false;
+    uint64_t periodo = (uint64_t)cliente.keep_alive * 1000000;
+    if (agora - ultima_recepcao_us >= periodo * 3 / 2) {
+        rede_fechar();
+        sim_agendar(agora, conexao_perdida, (void *)(uintptr_t)MQTT_CONNECT_TIMEOUT);
+        return true;
+    }
+    if (agora - ultimo_envio_us >= periodo) rede_pacote(0xC0, NULL, 0);
+    return false;
+}
+
+// atende o socket até o relógio de parede alcançar ate_us; retorna antes se agendou alguma IRQ
+static uint64_t rede_esperar(uint64_t ate_us) {
+    for (;;) {
+        if (interrompido) sim_terminar();
+        uint64_t agora = parede_us();
+        if (rede_manter(agora)) return agora;
+        if (agora >= ate_us) return agora;
+        uint64_t espera_ms = (ate_us - agora + 999) / 1000;
+        struct pollfd p = { .fd = rede, .events = POLLIN };
+        if (poll(&p, 1, espera_ms > 100 ? 100 : (int)espera_ms) > 0 && rede >= 0 && rede_receber(parede_us())) {
+            return parede_us();
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// módulos de lib/ que dependem do hardware
+
+static float adc_valores[5] = { 2048.0f, 2048.0f, 0, 0, 880.6f }; // canais 0 e 1: joystick no centro; canal 4: ~25 °C
+
+void adc_amostragem_init(void) {
+}
+
+void adc_amostragem_manter(void) {
+}
+
+float adc_amostragem_media(uint8_t canal, uint8_t n) {
+    (void)n;
+    return canal < 5 ? adc_valores[canal] : 0.0f;
+}
+
+void sim_adc_definir(uint8_t canal, float bruto) {
+    if (canal < 5) adc_valores[canal] = bruto;
+}
+
+// flash de 2 MB em RAM (apagada); as operações bloqueiam as interrupções pelo tempo típico
+static uint8_t flash[PICO_FLASH_SIZE_BYTES];
+static bool flash_iniciada;
+
+static void flash_iniciar(void) {
+    if (flash_iniciada) return;
+    memset(flash, 0xFF, sizeof(flash));
+    flash_iniciada = true;
+}
+
+bool flash_pico_apagar(uint32_t deslocamento, size_t tamanho) {
+    if (deslocamento % FLASH_SETOR || tamanho % FLASH_SETOR || deslocamento + tamanho > sizeof(flash)) return false;
+    flash_iniciar();
+    memset(flash + deslocamento, 0xFF, tamanho);
+    sim_avancar_ate(agora_us + tamanho / FLASH_SETOR * SIM_FLASH_APAGAR_US, false);
+    return true;
+}
+
+bool flash_pico_gravar(uint32_t deslocamento, const uint8_t *dados, size_t tamanho) {
+    if (deslocamento % FLASH_PAGINA || tamanho % FLASH_PAGINA || deslocamento + tamanho > sizeof(flash)) return false;
+    flash_iniciar();
+    for (size_t i = 0; i < tamanho; i++) flash[deslocamento + i] &= dados[i]; // NOR: só zera bits
+    sim_avancar_ate(agora_us + tamanho / FLASH_PAGINA * SIM_FLASH_PAGINA_US, false);
+    return true;
+}
+
+const uint8_t *flash_pico_mapa(uint32_t deslocamento) {
+    flash_iniciar();
+    return flash + deslocamento;
+}
+
+char __flash_binary_end;
+
+// ID único da flash (big-endian, como lido da W25Q16); painéis simulados no mesmo broker usam IDs distintos
+static uint64_t id_placa = 0xE6614104032F5A2Bull;
+
+void sim_definir_id_placa(uint64_t id) {
+    id_placa = id;
+}
+
+void pico_get_unique_board_id(pico_unique_board_id_t *id_out) {
+    for (int i = 0; i < PICO_UNIQUE_BOARD_ID_SIZE_BYTES; i++) id_out->id[i] = (uint8_t)(id_placa >> (56 - 8 * i));
+}
+
+// HTTP e UDP: o traço chama os mesmos callbacks que o CGI e o datagrama chamariam
+static const HttpPainelCallbacks *http_callbacks;
+static udp_executar_t udp_executar;
+static udp_publicar_t udp_publicar;
+
+void http_painel_init(const HttpPainelCallbacks *callbacks) {
+    http_callbacks = callbacks;
+}
+
+void udp_comando_init(udp_executar_t executar, udp_publicar_t publicar) {
+    udp_executar = executar;
+    udp_publicar = publicar;
+}
+
+bool sim_http_comando(int tipo, const char *valor) {
+    if (!http_callbacks || !http_callbacks->executar((TipoComando)tipo, valor)) return false;
+    http_callbacks->publicar();
+    return true;
+}
+
+bool sim_udp_comando(int tipo, int valor) {
+    if (!udp_executar || !udp_executar((TipoComando)tipo, valor)) return false;
+    udp_publicar();
+    return true;
+}
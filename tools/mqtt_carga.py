@@ -0,0 +1,353 @@
+#!/usr/bin/env python3
+"""Gerador de carga MQTT e soak do painel: inunda <prefixo>/comando/* e confere os ecos em <prefixo>/estado/*.
+
+Cada comando muda o valor do seu tópico (cores e cômodos são percorridos em ordem; o LED alterna),
+então um eco identifica o comando pendente mais antigo com aquele valor. Resultados:
+    vazão        comandos enviados e ecos confirmados por segundo
+    latência     comando -> eco (p50/p95/p99/máximo), por janela e no total
+    agrupados    comandos superados por um mais novo antes do eco (o painel publica o estado atual,
+                 não cada comando; esperado sob carga, sobretudo com a fila de pedidos do lwIP cheia)
+    perdidos     ao fim, o estado publicado difere do último comando do tópico
+    fora de ordem eco de um valor já superado depois do eco de um comando mais novo
+    reconexões   do painel (<prefixo>/painel/status: "offline" do testamento quando o keep-alive vence,
+                 "online" ao reconectar) e do próprio gerador
+Ninguém mais deve mexer no painel durante a medição (botões, regras, HTTP/UDP).
+O prefixo do painel (casa/<ID da placa>, ou o gravado em prefixo=...) é descoberto pelo status retido
+"online" em casa/+/painel/status; com mais de um painel no broker, escolha com --prefixo.
+
+Exemplos:
+    # soak de 10 minutos na placa, 20 comandos/s em cor e cômodo
+    python3 tools/mqtt_carga.py 192.168.0.103 --taxa 20 --duracao 600 --usuario Vinicius --senha Vinicius \\
+        --painel 192.168.0.50
+
+    # mesmo teste no firmware compilado para o host (tools/host/painel_sim em tempo real)
+    build-host/painel_sim --broker localhost &
+    python3 tools/mqtt_carga.py localhost --taxa 50 --duracao 60
+
+    # rampa 10, 20, ... 200 comandos/s, 15 s cada: onde a latência ou as perdas disparam
+    python3 tools/mqtt_carga.py localhost --rampa 10:200:10 --passo 15
+"""
+
+import argparse
+import collections
+import json
+import sys
+import threading
+import time
+import urllib.request
+
+VALORES = {                             # comando -> valores percorridos (ordem de lib/painel.c)
+    "led": ["On", "Off"],
+    "cor": ["Vermelho", "Verde", "Azul", "Amarelo", "Ciano", "Lilas"],
+    "comodo": ["Quarto1", "Quarto2", "Cozinha", "Banheiro"],
+}
+ECO_LED = {"On": "LIGADO", "Off": "DESLIGADO"}
+RAIZ = "casa"                           # MQTT_RAIZ de main.c: os nós ficam em casa/<nó>/...
+
+
+def efeitos(comando, valor):
+    """Ecos esperados em <prefixo>/estado/*, o do próprio tópico primeiro (selecionar um cômodo também liga
+    o LED: esse eco entra na ordem do tópico led, mas não conta como confirmação do comando)."""
+    if comando == "led":
+        return [("led", ECO_LED[valor])]
+    if comando == "comodo":
+        return [("comodo", valor), ("led", "LIGADO")]
+    return [(comando, valor)]
+
+
+def percentil(ordenados, q):
+    return ordenados[min(len(ordenados) - 1, int(len(ordenados) * q))] if ordenados else float("nan")
+
+
+class Medidor:
+    """Casa ecos com comandos pendentes; chamado pela thread do paho e pela de envio."""
+
+    def __init__(self):
+        self.trava = threading.Lock()
+        self.pendentes = collections.defaultdict(collections.deque)  # estado -> (t, valor, principal)
+        self.ultimo = {}                # estado -> último valor confirmado
+        self.latencias, self.janela = [], []
+        self.enviados = self.confirmados = self.agrupados = self.fora_de_ordem = self.repeticoes = 0
+        self.painel_offline = self.painel_online = self.quedas_gerador = 0
+
+    def enviado(self, comando, valor, t):
+        with self.trava:
+            self.enviados += 1
+            for k, (estado, eco) in enumerate(efeitos(comando, valor)):
+                self.pendentes[estado].append((t, eco, k == 0))
+
+    def eco(self, estado, valor, t):
+        with self.trava:
+            fila = self.pendentes[estado]
+            indice = next((i for i, (_, v, _) in enumerate(fila) if v == valor), None)
+            if indice is None:
+                if self.ultimo.get(estado, valor) == valor:
+                    self.repeticoes += 1  # estado retido, periódico, reconexão ou outro tópico do mesmo lote
+                else:
+                    self.fora_de_ordem += 1
+                self.ultimo.setdefault(estado, valor)
+                return
+            for _ in range(indice):
+                self.agrupados += fila.popleft()[2]
+            enviado, _, principal = fila.popleft()
+            self.ultimo[estado] = valor
+            if principal:
+                self.confirmados += 1
+                self.latencias.append(t - enviado)
+                self.janela.append(t - enviado)
+
+    def status(self, texto, retido):
+        with self.trava:
+            if retido:
+                return                  # valor antigo guardado pelo broker
+            if texto == "offline":
+                self.painel_offline += 1
+            elif texto == "online":
+                self.painel_online += 1
+
+    def fechar_janela(self):
+        with self.trava:
+            janela, self.janela = sorted(self.janela), []
+        return janela
+
+    def encerrar(self):
+        """Pendentes após o dreno: agrupados se o estado final é o do último comando, senão perdidos."""
+        with self.trava:
+            perdidos = 0
+            for estado, fila in self.pendentes.items():
+                if not fila:
+                    continue
+                principais = sum(p for _, _, p in fila)
+                if self.ultimo.get(estado) == fila[-1][1]:
+                    self.agrupados += principais
+                else:
+                    perdidos += 1
+                    self.agrupados += max(principais - 1, 0)
+                fila.clear()
+            return perdidos
+
+
+def novo_cliente(mqtt, id_cliente):
+    if hasattr(mqtt, "CallbackAPIVersion"):     # paho-mqtt 2.x
+        return mqtt.Client(mqtt.CallbackAPIVersion.VERSION1, client_id=id_cliente)
+    return mqtt.Client(client_id=id_cliente)
+
+
+def descobrir_prefixo(mqtt, broker, porta, usuario=None, senha=None, espera=1.0):
+    """Prefixo do único painel online, pelo status retido em casa/+/painel/status (usado também por
+    ota_enviar.py e udp_cliente.py)."""
+    online = []
+    cliente = novo_cliente(mqtt, f"descobrir-{time.time_ns() % 100000}")
+    if usuario:
+        cliente.username_pw_set(usuario, senha)
+
+    def ao_receber(_c, _dados, msg):
+        if msg.payload == b"online":
+            online.append(msg.topic[:-len("/painel/status")])
+
+    cliente.on_message = ao_receber
+    cliente.on_connect = lambda c, _dados, _flags, rc: rc == 0 and c.subscribe(f"{RAIZ}/+/painel/status", qos=1)
+    cliente.connect(broker, porta, keepalive=30)
+    cliente.loop_start()
+    time.sleep(espera)
+    cliente.loop_stop()
+    cliente.disconnect()
+    if len(online) != 1:
+        raise SystemExit(f"{len(online)} painéis online em {RAIZ}/+/painel/status"
+                         f"{': ' + ', '.join(sorted(online)) if online else ''}; escolha um com --prefixo")
+    return online[0]
+
+
+def conectar(mqtt, args, medidor):
+    cliente = novo_cliente(mqtt, f"mqtt-carga-{time.time_ns() % 100000}")
+    if args.usuario:
+        cliente.username_pw_set(args.usuario, args.senha)
+    conectado = threading.Event()
+    topico_status = f"{args.prefixo}/painel/status"
+
+    def ao_conectar(c, _dados, _flags, rc):
+        if rc != 0:
+            return
+        c.subscribe(f"{args.prefixo}/estado/+", qos=args.qos)
+        c.subscribe(topico_status, qos=1)
+        conectado.set()
+
+    def ao_desconectar(_c, _dados, rc):
+        if rc != 0:
+            medidor.quedas_gerador += 1
+
+    def ao_receber(_c, _dados, msg):
+        agora = time.perf_counter()
+        if msg.topic == topico_status:
+            medidor.status(msg.payload.decode(errors="replace"), msg.retain)
+        else:
+            medidor.eco(msg.topic.rsplit("/", 1)[1], msg.payload.decode(errors="replace"), agora)
+
+    cliente.on_connect = ao_conectar
+    cliente.on_disconnect = ao_desconectar
+    cliente.on_message = ao_receber
+    cliente.max_inflight_messages_set(1000)     # a carga é limitada pela taxa, não pelo gerador
+    cliente.max_queued_messages_set(0)
+    cliente.connect(args.broker, args.porta, keepalive=30)
+    cliente.loop_start()
+    if not conectado.wait(5.0):
+        raise SystemExit(f"sem conexão com o broker {args.broker}:{args.porta}")
+    return cliente
+
+
+def diagnostico(ip):
+    """Contadores do firmware em /estado.json (só na placa)."""
+    if not ip:
+        return None
+    try:
+        with urllib.request.urlopen(f"http://{ip}/estado.json", timeout=2) as resposta:
+            return json.load(resposta)
+    except (OSError, ValueError):
+        return None
+
+
+def inundar(cliente, args, medidor, taxa, duracao, indices, relatar):
+    """Envia a taxa constante (laço aberto: atrasos do painel não freiam o gerador)."""
+    topicos = args.topicos
+    inicio = time.perf_counter()
+    proxima_janela = inicio + args.intervalo
+    i = 0
+    while True:
+        alvo = inicio + i / taxa
+        agora = time.perf_counter()
+        if alvo - inicio >= duracao:
+            break
+        if alvo > agora:
+            time.sleep(alvo - agora)
+        comando = topicos[i % len(topicos)]
+        indices[comando] = (indices[comando] + 1) % len(VALORES[comando])
+        valor = VALORES[comando][indices[comando]]
+        medidor.enviado(comando, valor, time.perf_counter())
+        cliente.publish(f"{args.prefixo}/comando/{comando}", valor, qos=args.qos)
+        i += 1
+        if relatar and time.perf_counter() >= proxima_janela:
+            janela = medidor.fechar_janela()
+            print(f"{time.perf_counter() - inicio:7.1f} s  {len(janela) / args.intervalo:7.1f} ecos/s  "
+                  f"p50 {percentil(janela, 0.5) * 1000:7.1f}  p99 {percentil(janela, 0.99) * 1000:7.1f} ms  "
+                  f"agrupados {medidor.agrupados}  fora de ordem {medidor.fora_de_ordem}  "
+                  f"painel offline {medidor.painel_offline}", flush=True)
+            proxima_janela += args.intervalo
+    return i, time.perf_counter() - inicio
+
+
+def aquecer(cliente, args, medidor, indices):
+    """Um comando por tópico e espera os ecos: define o estado de partida."""
+    for comando in args.topicos:
+        valor = VALORES[comando][indices[comando]]
+        medidor.enviado(comando, valor, time.perf_counter())
+        cliente.publish(f"{args.prefixo}/comando/{comando}", valor, qos=1)
+    limite = time.perf_counter() + 5.0
+    while medidor.confirmados < len(args.topicos) and time.perf_counter() < limite:
+        time.sleep(0.05)
+    if medidor.confirmados < len(args.topicos):
+        raise SystemExit("o painel não ecoou o aquecimento: está conectado ao mesmo broker?")
+    medidor.encerrar()
+    medidor.latencias.clear()
+    medidor.fechar_janela()
+    medidor.enviados = medidor.confirmados = medidor.agrupados = medidor.repeticoes = 0
+
+
+def resumo(medidor, enviados, duracao, perdidos):
+    lat = sorted(medidor.latencias)
+    print(f"enviados {enviados} comandos em {duracao:.1f} s ({enviados / duracao:.1f}/s); "
+          f"ecos confirmados {medidor.confirmados} ({medidor.confirmados / duracao:.1f}/s)")
+    if lat:
+        print(f"  latência (ms): p50 {percentil(lat, 0.5) * 1000:.1f} | p95 {percentil(lat, 0.95) * 1000:.1f} | "
+              f"p99 {percentil(lat, 0.99) * 1000:.1f} | máx {lat[-1] * 1000:.1f}")
+    print(f"  agrupados {medidor.agrupados} | perdidos {perdidos} | fora de ordem {medidor.fora_de_ordem} | "
+          f"repetições {medidor.repeticoes}")
+    print(f"  painel: {medidor.painel_offline} offline, {medidor.painel_online} online | "
+          f"quedas do gerador {medidor.quedas_gerador}")
+
+
+def executar(cliente, args, medidor, indices):
+    antes = diagnostico(args.painel)
+    enviados, duracao = inundar(cliente, args, medidor, args.taxa, args.duracao, indices, True)
+    time.sleep(args.dreno)
+    resumo(medidor, enviados, duracao, medidor.encerrar())
+    depois = diagnostico(args.painel)
+    if antes and depois:
+        print(f"  firmware: {depois.get('mqtt_recusadas', 0) - antes.get('mqtt_recusadas', 0)} publicações recusadas "
+              f"pelo lwIP, {depois.get('mqtt_conexoes', 0) - antes.get('mqtt_conexoes', 0)} reconexões, "
+              f"{depois.get('log_perdidas', 0) - antes.get('log_perdidas', 0)} entradas de log perdidas")
+
+
+def rampa(cliente, args, medidor, indices):
+    inicial, final, passo = (float(x) for x in args.rampa.split(":"))
+    print(f"{'taxa':>7} {'ecos/s':>8} {'p50':>8} {'p99':>8} {'máx':>8} {'agrup.':>7} {'perd.':>6} {'ordem':>6} {'offline':>7}")
+    taxa, saturou = inicial, None
+    while taxa <= final:
+        offline = medidor.painel_offline
+        medidor.latencias.clear()
+        medidor.confirmados = medidor.agrupados = medidor.fora_de_ordem = 0
+        _, duracao = inundar(cliente, args, medidor, taxa, args.passo, indices, False)
+        time.sleep(args.dreno)
+        perdidos = medidor.encerrar()
+        lat = sorted(medidor.latencias)
+        p99 = percentil(lat, 0.99) * 1000
+        print(f"{taxa:7.0f} {medidor.confirmados / duracao:8.1f} {percentil(lat, 0.5) * 1000:8.1f} {p99:8.1f} "
+              f"{(lat[-1] * 1000 if lat else float('nan')):8.1f} {medidor.agrupados:7d} {perdidos:6d} "
+              f"{medidor.fora_de_ordem:6d} {medidor.painel_offline - offline:7d}", flush=True)
+        if saturou is None and (perdidos or medidor.fora_de_ordem or medidor.painel_offline > offline or
+                                not lat or p99 > args.limite):
+            saturou = taxa
+        taxa += passo
+    if saturou is None:
+        print(f"sem saturação até {final:.0f} comandos/s (p99 <= {args.limite:.0f} ms, sem perdas)")
+    else:
+        print(f"saturação a partir de {saturou:.0f} comandos/s (p99 > {args.limite:.0f} ms, perda, "
+              f"desordem ou queda)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("broker")
+    parser.add_argument("--porta", type=int, default=1883)
+    parser.add_argument("--usuario")
+    parser.add_argument("--senha")
+    parser.add_argument("--prefixo", help="prefixo dos tópicos do painel (ex.: casa/032F5A2B); padrão: descoberto")
+    parser.add_argument("--topicos", default="cor,comodo", help="comandos inundados, entre led, cor e comodo")
+    parser.add_argument("--taxa", type=float, default=10.0, help="comandos por segundo (todos os tópicos)")
+    parser.add_argument("--duracao", type=float, default=60.0, help="segundos de carga")
+    parser.add_argument("--qos", type=int, choices=(0, 1), default=1)
+    parser.add_argument("--intervalo", type=float, default=10.0, help="segundos entre linhas de progresso")
+    parser.add_argument("--dreno", type=float, default=3.0, help="segundos esperando ecos após o último envio")
+    parser.add_argument("--rampa", metavar="INICIO:FIM:PASSO", help="sobe a taxa em degraus em vez de uma taxa fixa")
+    parser.add_argument("--passo", type=float, default=15.0, help="segundos por degrau da rampa")
+    parser.add_argument("--limite", type=float, default=500.0, help="p99 (ms) acima do qual a rampa satura")
+    parser.add_argument("--painel", metavar="IP", help="lê os contadores do firmware em /estado.json (placa)")
+    args = parser.parse_args()
+    args.topicos = args.topicos.split(",")
+    if any(t not in VALORES for t in args.topicos):
+        raise SystemExit(f"tópicos válidos: {', '.join(VALORES)}")
+    try:
+        import paho.mqtt.client as mqtt
+    except ImportError:
+        raise SystemExit("instale paho-mqtt")
+    if not args.prefixo:
+        args.prefixo = descobrir_prefixo(mqtt, args.broker, args.porta, args.usuario, args.senha)
+        print(f"painel: {args.prefixo}")
+
+    medidor = Medidor()
+    cliente = conectar(mqtt, args, medidor)
+    indices = {t: 0 for t in args.topicos}
+    aquecer(cliente, args, medidor, indices)
+    try:
+        if args.rampa:
+            rampa(cliente, args, medidor, indices)
+        else:
+            executar(cliente, args, medidor, indices)
+    except KeyboardInterrupt:
+        print("\ninterrompido")
+    cliente.loop_stop()
+    cliente.disconnect()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
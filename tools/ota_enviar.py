@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+"""Envia uma imagem de firmware ao painel pelo broker MQTT (atualização A/B, lib/ota.c).
+
+Protocolo (respostas em <prefixo>/ota/status; o prefixo é o do painel, ex.: casa/032F5A2B):
+    <prefixo>/ota/inicio  "<tamanho> <sha256 em hex>"            -> "ok 0"
+    <prefixo>/ota/bloco   deslocamento (u32 LE) + até 1024 bytes  -> "ok <próximo deslocamento>"
+    <prefixo>/ota/fim     "fim"                                   -> "verificado <bytes> <KB/s> KB/s ram <bytes>"
+Cada bloco só é enviado após a resposta do anterior (o painel grava a flash antes de responder);
+sem resposta, o bloco é reenviado a partir do último deslocamento confirmado. Após a troca o
+painel reinicia e publica "confirmado" ao reconectar (ou "revertido" se a imagem nova falhar).
+Sem --prefixo, o painel é o único online no broker (tools/mqtt_carga.py: descobrir_prefixo).
+
+Exemplos:
+    # atualiza o painel (build/smart_home_panel.bin)
+    python3 tools/ota_enviar.py 192.168.0.103 build/smart_home_panel.bin --usuario Vinicius --senha Vinicius
+
+    # testa o caminho completo no Linux sem o painel: um painel simulado (flash em memória, mesmo
+    # protocolo) responde pelo mesmo broker local (ex.: mosquitto de tools/tls_local.sh, porta 1883)
+    python3 tools/ota_enviar.py localhost build/smart_home_panel.bin --simular
+"""
+
+import argparse
+import hashlib
+import queue
+import struct
+import sys
+import threading
+import time
+
+from mqtt_carga import descobrir_prefixo
+
+BLOCO = 1024                    # OTA_BLOCO_MAX
+SETOR = 4096                    # FLASH_SETOR
+SLOT = 1000 * 1024              # FLASH_OTA_SLOT com 2 MB de flash
+TEMPO_SETOR = 0.045 + 16 * 0.0004  # apagamento + 16 páginas (tempos típicos da W25Q16)
+
+
+def conectar(mqtt, broker, porta, usuario, senha, id_cliente):
+    cliente = mqtt.Client(client_id=id_cliente)
+    if usuario:
+        cliente.username_pw_set(usuario, senha)
+    cliente.connect(broker, porta)
+    return cliente
+
+
+class PainelSimulado:
+    """Espelha lib/ota.c: setor em montagem, SHA-256 incremental, flash com o tempo típico de gravação."""
+
+    def __init__(self, mqtt, args):
+        self.cliente = conectar(mqtt, args.broker, args.porta, args.usuario, args.senha, "painel-simulado")
+        self.cliente.on_message = self.ao_receber
+        self.prefixo = args.prefixo
+        for topico in (f"{self.prefixo}/ota/inicio", f"{self.prefixo}/ota/bloco", f"{self.prefixo}/ota/fim"):
+            self.cliente.subscribe(topico, qos=1)
+        self.slot_b = bytearray()
+        self.tamanho = self.recebidos = 0
+        self.setor = bytearray()
+        self.resumo = None
+        self.inicio = 0.0
+
+    def responder(self, texto):
+        self.cliente.publish(f"{self.prefixo}/ota/status", texto, qos=1)
+
+    def ao_receber(self, _cliente, _dados, msg):
+        comando = msg.topic[len(self.prefixo) + 1:]
+        if comando == "ota/inicio":
+            tamanho, sha = msg.payload.decode().split()
+            self.tamanho, self.esperado = int(tamanho), bytes.fromhex(sha)
+            if not 0 < self.tamanho <= SLOT:
+                self.responder("erro inicio")
+                return
+            self.recebidos, self.setor, self.slot_b = 0, bytearray(), bytearray()
+            self.resumo, self.inicio = hashlib.sha256(), time.perf_counter()
+            self.responder("ok 0")
+        elif comando == "ota/bloco":
+            if self.resumo is None or len(msg.payload) <= 4:
+                self.responder("erro bloco")
+                return
+            (desloc,) = struct.unpack_from("<I", msg.payload)
+            dados = msg.payload[4:]
+            if desloc <= self.recebidos < desloc + len(dados):
+                novo = dados[self.recebidos - desloc:]
+                self.resumo.update(novo)
+                self.setor += novo
+                self.recebidos += len(novo)
+                while len(self.setor) >= SETOR or (self.setor and self.recebidos == self.tamanho):
+                    time.sleep(TEMPO_SETOR)     # o painel responde só depois de gravar
+                    self.slot_b += self.setor[:SETOR]
+                    self.setor = self.setor[SETOR:]
+            self.responder(f"ok {self.recebidos}")
+        elif comando == "ota/fim":
+            duracao = time.perf_counter() - self.inicio
+            if self.recebidos != self.tamanho or self.resumo.digest() != self.esperado or \
+                    hashlib.sha256(self.slot_b[:self.tamanho]).digest() != self.esperado:
+                self.responder("erro verificacao")
+                return
+            ram = SETOR + 108 + 4 + BLOCO       # rascunho + SHA-256 + bloco recebido, como no firmware
+            self.responder(f"verificado {self.tamanho} bytes {self.tamanho / 1024 / duracao:.1f} KB/s ram {ram}")
+
+
+def enviar(mqtt, args, imagem):
+    respostas = queue.Queue()
+    cliente = conectar(mqtt, args.broker, args.porta, args.usuario, args.senha, f"ota-enviar-{time.time_ns() % 100000}")
+    cliente.on_message = lambda _c, _d, msg: respostas.put(msg.payload.decode())
+    cliente.subscribe(f"{args.prefixo}/ota/status", qos=1)
+    cliente.loop_start()
+    time.sleep(0.5)
+
+    def pedir(topico, carga, timeout):
+        while not respostas.empty():
+            respostas.get_nowait()
+        cliente.publish(topico, carga, qos=1)
+        try:
+            return respostas.get(timeout=timeout)
+        except queue.Empty:
+            return None
+
+    sha = hashlib.sha256(imagem).hexdigest()
+    resposta = pedir(f"{args.prefixo}/ota/inicio", f"{len(imagem)} {sha}", 5.0)
+    if resposta != "ok 0":
+        print(f"painel recusou o início: {resposta}")
+        return 1
+    inicio = time.perf_counter()
+    confirmado, reenvios, rtts = 0, 0, []
+    while confirmado < len(imagem):
+        bloco = imagem[confirmado:confirmado + args.bloco]
+        t0 = time.perf_counter()
+        resposta = pedir(f"{args.prefixo}/ota/bloco", struct.pack("<I", confirmado) + bloco, args.timeout)
+        if resposta is None or not resposta.startswith("ok "):
+            if resposta and resposta.startswith("erro"):
+                print(f"painel abortou a recepção: {resposta}")
+                return 1
+            reenvios += 1
+            continue
+        rtts.append(time.perf_counter() - t0)
+        confirmado = int(resposta.split()[1])
+        print(f"\r{confirmado * 100 // len(imagem):3d}%  {confirmado / 1024 / (time.perf_counter() - inicio):6.1f} KB/s",
+              end="", flush=True)
+    duracao = time.perf_counter() - inicio
+    resposta = pedir(f"{args.prefixo}/ota/fim", "fim", 30.0)   # inclui a releitura do slot B
+    print()
+    rtts.sort()
+    print(f"enviados {len(imagem)} bytes em {duracao:.1f} s: {len(imagem) / 1024 / duracao:.1f} KB/s, "
+          f"{len(rtts)} blocos, {reenvios} reenvios, resposta p50 {rtts[len(rtts) // 2] * 1000:.1f} ms "
+          f"p99 {rtts[len(rtts) * 99 // 100] * 1000:.1f} ms")
+    print(f"painel: {resposta}")
+    if not resposta or not resposta.startswith("verificado"):
+        return 1
+    if not args.simular:
+        try:
+            print(f"após o reinício: {respostas.get(timeout=args.confirmacao)}")   # "confirmado" ou "revertido"
+        except queue.Empty:
+            print("painel não respondeu após o reinício")
+            return 1
+    cliente.loop_stop()
+    cliente.disconnect()
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("broker")
+    parser.add_argument("imagem", help="arquivo .bin gerado pelo build")
+    parser.add_argument("--porta", type=int, default=1883)
+    parser.add_argument("--usuario")
+    parser.add_argument("--senha")
+    parser.add_argument("--bloco", type=int, default=BLOCO, help="bytes por bloco (até 1024)")
+    parser.add_argument("--timeout", type=float, default=2.0, help="segundos até reenviar um bloco")
+    parser.add_argument("--confirmacao", type=float, default=150.0, help="segundos esperando confirmado/revertido")
+    parser.add_argument("--simular", action="store_true", help="responde com um painel simulado no mesmo broker")
+    parser.add_argument("--prefixo", help="prefixo dos tópicos do painel; padrão: o único painel online "
+                        "(casa/simulado com --simular)")
+    args = parser.parse_args()
+    try:
+        import paho.mqtt.client as mqtt
+    except ImportError:
+        raise SystemExit("instale paho-mqtt")
+    with open(args.imagem, "rb") as f:
+        imagem = f.read()
+    if not args.prefixo:
+        args.prefixo = "casa/simulado" if args.simular else descobrir_prefixo(mqtt, args.broker, args.porta,
+                                                                               args.usuario, args.senha)
+    if args.simular:
+        simulado = PainelSimulado(mqtt, args)
+        threading.Thread(target=simulado.cliente.loop_forever, daemon=True).start()
+    return enviar(mqtt, args, imagem)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
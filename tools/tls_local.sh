@@ -0,0 +1,43 @@
+#!/usr/bin/env bash
+# Prepara um mosquitto local com TLS para medir o handshake do painel (completo x retomado).
+# Gera CA + certificado ECDSA P-256 do broker, a configuração do mosquitto e o cabeçalho
+# com TLS_ROOT_CERT para o firmware.
+#
+# Uso: tools/tls_local.sh <ip_do_broker> [diretorio_saida]
+#   cmake -B build -DMQTT_TLS=ON -DMQTT_CERT_INC=<saida>/mqtt_ca.h
+#   mosquitto -c <saida>/mosquitto_tls.conf -v
+# O log do painel mostra, a cada conexão: tempo (ms), se a sessão anterior foi oferecida,
+# heap em uso e pico (KB). Derrube o broker (ou a rede) para forçar reconexões retomadas.
+
+set -euo pipefail
+
+IP=${1:?"informe o IP do broker"}
+SAIDA=${2:-tls_local}
+mkdir -p "$SAIDA"
+cd "$SAIDA"
+
+openssl ecparam -name prime256v1 -genkey -noout -out ca.key
+openssl req -x509 -new -key ca.key -days 3650 -subj "/CN=painel-ca" -out ca.crt
+openssl ecparam -name prime256v1 -genkey -noout -out broker.key
+openssl req -new -key broker.key -subj "/CN=${IP}" -out broker.csr
+printf "subjectAltName=IP:%s\n" "$IP" > broker.ext
+openssl x509 -req -in broker.csr -CA ca.crt -CAkey ca.key -CAcreateserial -days 825 \
+    -extfile broker.ext -out broker.crt
+
+cat > mosquitto_tls.conf <<CONF
+listener 8883
+cafile $(pwd)/ca.crt
+certfile $(pwd)/broker.crt
+keyfile $(pwd)/broker.key
+tls_version tlsv1.2
+allow_anonymous true
+CONF
+
+{
+    echo "// Gerado por tools/tls_local.sh - CA do broker local"
+    echo "#define TLS_ROOT_CERT \\"
+    sed 's/.*/"&\\n" \\/' ca.crt
+    echo '""'
+} > mqtt_ca.h
+
+echo "Pronto em $(pwd): mosquitto_tls.conf e mqtt_ca.h"
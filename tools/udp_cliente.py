@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""Cliente do canal UDP do painel e comparação de latência com o caminho MQTT.
+
+Exemplos:
+    # um lote: cômodo Cozinha + cor Azul, mostra o estado retornado
+    python3 tools/udp_cliente.py 192.168.0.50 comodo=Cozinha cor=Azul
+
+    # mede ida e volta (RTT) e taxa de pacotes com 1000 lotes
+    python3 tools/udp_cliente.py 192.168.0.50 --bench 1000
+
+    # mesma medição pelo broker (publica <prefixo>/comando/cor, espera <prefixo>/estado/cor); requer paho-mqtt
+    python3 tools/udp_cliente.py 192.168.0.50 --bench 200 --mqtt 192.168.0.103 --usuario Vinicius --senha Vinicius
+"""
+
+import argparse
+import random
+import socket
+import statistics
+import struct
+import sys
+import threading
+import time
+
+from mqtt_carga import descobrir_prefixo
+
+PORTA = 4950
+VERSAO = 1
+COMANDOS = ["led", "cor", "comodo", "alarme"]          # ordem de TipoComando
+VALORES = {
+    "led": ["Off", "On"],
+    "cor": ["Vermelho", "Verde", "Azul", "Amarelo", "Ciano", "Lilas"],
+    "comodo": ["Quarto1", "Quarto2", "Cozinha", "Banheiro"],
+    "alarme": ["Off"],
+}
+CONSULTA = 0xFF
+
+
+def montar(seq, comandos):
+    corpo = b"".join(struct.pack("<BB", t, v) for t, v in comandos)
+    return struct.pack("<2sBBH", b"PC", VERSAO, len(comandos), seq) + corpo
+
+
+def ler_resposta(dados):
+    magic, versao, aceitos, seq, led, cor, comodo, emergencia = struct.unpack("<2sBBHBBBB", dados)
+    if magic != b"PR" or versao != VERSAO:
+        raise ValueError("resposta inválida")
+    return {"seq": seq, "aceitos": aceitos, "led": bool(led), "cor": VALORES["cor"][cor],
+            "comodo": VALORES["comodo"][comodo], "emergencia": bool(emergencia)}
+
+
+def converter(argumento):
+    nome, _, valor = argumento.partition("=")
+    if nome not in COMANDOS or valor not in VALORES[nome]:
+        raise SystemExit(f"comando inválido: {argumento}")
+    indice = VALORES[nome].index(valor)
+    return COMANDOS.index(nome), indice
+
+
+def transacao(sock, destino, seq, comandos, tentativas=3, timeout=0.5):
+    """Envia o lote e espera a resposta com a mesma seq (retransmite com a mesma seq)."""
+    pacote = montar(seq, comandos)
+    sock.settimeout(timeout)
+    for _ in range(tentativas):
+        sock.sendto(pacote, destino)
+        try:
+            while True:
+                dados, _ = sock.recvfrom(64)
+                resposta = ler_resposta(dados)
+                if resposta["seq"] == seq:
+                    return resposta
+        except socket.timeout:
+            continue
+    return None
+
+
+def resumo(nome, rtts, perdidos, duracao):
+    if not rtts:
+        print(f"{nome}: nenhuma resposta")
+        return
+    rtts_ms = sorted(r * 1000 for r in rtts)
+    p = lambda q: rtts_ms[min(len(rtts_ms) - 1, int(len(rtts_ms) * q))]
+    print(f"{nome}: {len(rtts)} respostas, {perdidos} perdidos, {len(rtts) / duracao:.1f} transações/s")
+    print(f"  RTT (ms): média {statistics.mean(rtts_ms):.2f} | p50 {p(0.5):.2f} | p95 {p(0.95):.2f} "
+          f"| p99 {p(0.99):.2f} | máx {rtts_ms[-1]:.2f}")
+
+
+def bench_udp(ip, n):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    destino = (ip, PORTA)
+    rtts, perdidos = [], 0
+    seq = random.randrange(65536)
+    inicio = time.perf_counter()
+    for i in range(n):
+        seq = (seq + 1) & 0xFFFF
+        t0 = time.perf_counter()
+        if transacao(sock, destino, seq, [(1, i % 6)], tentativas=1) is None:
+            perdidos += 1
+        else:
+            rtts.append(time.perf_counter() - t0)
+    resumo("UDP", rtts, perdidos, time.perf_counter() - inicio)
+
+
+def bench_mqtt(broker, usuario, senha, prefixo, n):
+    try:
+        import paho.mqtt.client as mqtt
+    except ImportError:
+        raise SystemExit("instale paho-mqtt para medir o caminho MQTT")
+    prefixo = prefixo or descobrir_prefixo(mqtt, broker, 1883, usuario, senha)
+    recebido = threading.Event()
+    esperado = {"cor": None}
+
+    def ao_receber(_cliente, _dados, msg):
+        if msg.payload.decode() == esperado["cor"]:
+            recebido.set()
+
+    cliente = mqtt.Client()
+    if usuario:
+        cliente.username_pw_set(usuario, senha)
+    cliente.on_message = ao_receber
+    cliente.connect(broker)
+    cliente.subscribe(f"{prefixo}/estado/cor", qos=1)
+    cliente.loop_start()
+    time.sleep(0.5)
+    rtts, perdidos = [], 0
+    inicio = time.perf_counter()
+    for i in range(n):
+        esperado["cor"] = VALORES["cor"][i % 6]
+        recebido.clear()
+        t0 = time.perf_counter()
+        cliente.publish(f"{prefixo}/comando/cor", esperado["cor"], qos=1)
+        if recebido.wait(2.0):
+            rtts.append(time.perf_counter() - t0)
+        else:
+            perdidos += 1
+    resumo("MQTT", rtts, perdidos, time.perf_counter() - inicio)
+    cliente.loop_stop()
+    cliente.disconnect()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("ip", help="IP do painel")
+    parser.add_argument("comandos", nargs="*", help="comandos nome=valor (ex.: cor=Azul comodo=Cozinha)")
+    parser.add_argument("--bench", type=int, metavar="N", help="mede N transações")
+    parser.add_argument("--mqtt", metavar="BROKER", help="também mede o caminho MQTT por este broker")
+    parser.add_argument("--usuario")
+    parser.add_argument("--senha")
+    parser.add_argument("--prefixo", help="prefixo MQTT do painel (ex.: casa/032F5A2B); padrão: o único online")
+    args = parser.parse_args()
+
+    if args.bench:
+        bench_udp(args.ip, args.bench)
+        if args.mqtt:
+            bench_mqtt(args.mqtt, args.usuario, args.senha, args.prefixo, args.bench)
+        return 0
+
+    comandos = [converter(c) for c in args.comandos] or [(CONSULTA, 0)]
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    resposta = transacao(sock, (args.ip, PORTA), random.randrange(65536), comandos)
+    if resposta is None:
+        print("sem resposta do painel")
+        return 1
+    print(resposta)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())